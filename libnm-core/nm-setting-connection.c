@@ -34,6 +34,7 @@
 #include "nm-setting-bridge.h"
 #include "nm-setting-team.h"
 #include "nm-setting-vlan.h"
+#include "nm-utils/nm-ref-string.h"
 
 /**
  * SECTION:nm-setting-connection
@@ -62,9 +63,12 @@ typedef struct {
 
 typedef struct {
 	char *id;
-	char *uuid;
+
+	/* the UUID, interface name and zone are shared by the copies of a
+	 * connection, and interface names and zones by many profiles. */
+	NMRefString *uuid;
 	char *stable_id;
-	char *interface_name;
+	NMRefString *interface_name;
 	char *type;
 	char *master;
 	char *slave_type;
@@ -75,7 +79,7 @@ typedef struct {
 	gint autoconnect_retries;
 	guint64 timestamp;
 	gboolean read_only;
-	char *zone;
+	NMRefString *zone;
 	GSList *secondaries; /* secondary connections to activate with the base connection */
 	guint gateway_ping_timeout;
 	NMMetered metered;
@@ -231,7 +235,7 @@ nm_setting_connection_get_uuid (NMSettingConnection *setting)
 {
 	g_return_val_if_fail (NM_IS_SETTING_CONNECTION (setting), NULL);
 
-	return NM_SETTING_CONNECTION_GET_PRIVATE (setting)->uuid;
+	return nm_ref_string_get_str (NM_SETTING_CONNECTION_GET_PRIVATE (setting)->uuid);
 }
 
 /**
@@ -265,7 +269,7 @@ nm_setting_connection_get_interface_name (NMSettingConnection *setting)
 {
 	g_return_val_if_fail (NM_IS_SETTING_CONNECTION (setting), NULL);
 
-	return NM_SETTING_CONNECTION_GET_PRIVATE (setting)->interface_name;
+	return nm_ref_string_get_str (NM_SETTING_CONNECTION_GET_PRIVATE (setting)->interface_name);
 }
 
 /**
@@ -597,7 +601,7 @@ nm_setting_connection_get_zone (NMSettingConnection *setting)
 {
 	g_return_val_if_fail (NM_IS_SETTING_CONNECTION (setting), NULL);
 
-	return NM_SETTING_CONNECTION_GET_PRIVATE (setting)->zone;
+	return nm_ref_string_get_str (NM_SETTING_CONNECTION_GET_PRIVATE (setting)->zone);
 }
 
 /**
@@ -880,12 +884,12 @@ verify (NMSetting *setting, NMConnection *connection, GError **error)
 		return FALSE;
 	}
 
-	if (priv->uuid && !nm_utils_is_uuid (priv->uuid)) {
+	if (priv->uuid && !nm_utils_is_uuid (priv->uuid->str)) {
 		g_set_error (error,
 		             NM_CONNECTION_ERROR,
 		             NM_CONNECTION_ERROR_INVALID_PROPERTY,
 		             _("'%s' is not a valid UUID"),
-		             priv->uuid);
+		             priv->uuid->str);
 		g_prefix_error (error, "%s.%s: ", NM_SETTING_CONNECTION_SETTING_NAME, NM_SETTING_CONNECTION_UUID);
 		return FALSE;
 	}
@@ -893,11 +897,11 @@ verify (NMSetting *setting, NMConnection *connection, GError **error)
 	if (priv->interface_name) {
 		GError *tmp_error = NULL;
 
-		if (!nm_utils_is_valid_iface_name (priv->interface_name, &tmp_error)) {
+		if (!nm_utils_is_valid_iface_name (priv->interface_name->str, &tmp_error)) {
 			g_set_error (error,
 			             NM_CONNECTION_ERROR,
 			             NM_CONNECTION_ERROR_INVALID_PROPERTY,
-			             "'%s': %s", priv->interface_name, tmp_error->message);
+			             "'%s': %s", priv->interface_name->str, tmp_error->message);
 			g_prefix_error (error, "%s.%s: ", NM_SETTING_CONNECTION_SETTING_NAME, NM_SETTING_CONNECTION_INTERFACE_NAME);
 			g_error_free (tmp_error);
 			return FALSE;
@@ -1183,11 +1187,11 @@ finalize (GObject *object)
 	NMSettingConnectionPrivate *priv = NM_SETTING_CONNECTION_GET_PRIVATE (object);
 
 	g_free (priv->id);
-	g_free (priv->uuid);
+	nm_ref_string_unref (priv->uuid);
 	g_free (priv->stable_id);
-	g_free (priv->interface_name);
+	nm_ref_string_unref (priv->interface_name);
 	g_free (priv->type);
-	g_free (priv->zone);
+	nm_ref_string_unref (priv->zone);
 	g_free (priv->master);
 	g_free (priv->slave_type);
 	g_slist_free_full (priv->permissions, (GDestroyNotify) permission_free);
@@ -1228,16 +1232,14 @@ set_property (GObject *object, guint prop_id,
 		priv->id = g_value_dup_string (value);
 		break;
 	case PROP_UUID:
-		g_free (priv->uuid);
-		priv->uuid = g_value_dup_string (value);
+		nm_ref_string_reset_str (&priv->uuid, g_value_get_string (value));
 		break;
 	case PROP_STABLE_ID:
 		g_free (priv->stable_id);
 		priv->stable_id = g_value_dup_string (value);
 		break;
 	case PROP_INTERFACE_NAME:
-		g_free (priv->interface_name);
-		priv->interface_name = g_value_dup_string (value);
+		nm_ref_string_reset_str (&priv->interface_name, g_value_get_string (value));
 		break;
 	case PROP_TYPE:
 		g_free (priv->type);
@@ -1263,8 +1265,7 @@ set_property (GObject *object, guint prop_id,
 		priv->read_only = g_value_get_boolean (value);
 		break;
 	case PROP_ZONE:
-		g_free (priv->zone);
-		priv->zone = g_value_dup_string (value);
+		nm_ref_string_reset_str (&priv->zone, g_value_get_string (value));
 		break;
 	case PROP_MASTER:
 		g_free (priv->master);
@@ -63,6 +63,7 @@
 #include "nm-simple-connection.h"
 #include "nm-keyfile-internal.h"
 #include "nm-utils/nm-dedup-multi.h"
+#include "nm-utils/nm-ref-string.h"
 
 #include "test-general-enums.h"
 
@@ -490,6 +491,78 @@ test_dedup_multi (void)
 
 /*****************************************************************************/
 
+static void
+test_ref_string (void)
+{
+	nm_auto_ref_string NMRefString *s1 = NULL;
+	nm_auto_ref_string NMRefString *s2 = NULL;
+	nm_auto_ref_string NMRefString *s3 = NULL;
+	NMRefString *s_empty;
+	gs_unref_object NMSettingConnection *s_con1 = NULL;
+	gs_unref_object NMSettingConnection *s_con2 = NULL;
+	const char *uuid;
+	char buf[20];
+
+	g_assert (!nm_ref_string_new (NULL));
+
+	s1 = nm_ref_string_new ("eth0");
+	g_assert_cmpstr (s1->str, ==, "eth0");
+	g_assert_cmpint (s1->len, ==, 4);
+
+	/* equal strings are the same instance, also when created from a
+	 * buffer that is not NUL terminated. */
+	nm_sprintf_buf (buf, "eth0:1");
+	s2 = nm_ref_string_new_len (buf, 4);
+	g_assert (s1 == s2);
+	g_assert (!nm_ref_string_equals_str (s1, buf));
+	g_assert (nm_ref_string_equals_str (s1, "eth0"));
+	g_assert (nm_ref_string_equals_str (s1, s2->str));
+	g_assert (nm_ref_string_equals_str (NULL, NULL));
+	g_assert (!nm_ref_string_equals_str (NULL, "eth0"));
+	g_assert (!nm_ref_string_equals_str (s1, NULL));
+
+	s_empty = nm_ref_string_new ("");
+	g_assert_cmpstr (s_empty->str, ==, "");
+	g_assert (s_empty != s1);
+	nm_ref_string_unref (s_empty);
+
+	g_assert (nm_ref_string_ref (s1) == s1);
+	nm_ref_string_unref (s1);
+
+	g_assert (!nm_ref_string_reset_str (&s2, "eth0"));
+	g_assert (s2 == s1);
+	g_assert (nm_ref_string_reset_str (&s2, "eth1"));
+	g_assert_cmpstr (s2->str, ==, "eth1");
+	g_assert (s2 != s1);
+	g_assert (nm_ref_string_reset_str (&s2, NULL));
+	g_assert (!s2);
+
+	s3 = nm_ref_string_new ("eth1");
+	g_assert (nm_clear_ref_string (&s3));
+	g_assert (!nm_clear_ref_string (&s3));
+
+	/* NMSettingConnection interns the UUID, so copies of a setting share
+	 * the string. */
+	s_con1 = (NMSettingConnection *) nm_setting_connection_new ();
+	g_object_set (s_con1,
+	              NM_SETTING_CONNECTION_UUID, "2c1b2b3a-5db3-4a16-9e37-08d0c6a5e3c3",
+	              NM_SETTING_CONNECTION_INTERFACE_NAME, "eth0",
+	              NULL);
+	s_con2 = (NMSettingConnection *) nm_setting_duplicate (NM_SETTING (s_con1));
+	uuid = nm_setting_connection_get_uuid (s_con1);
+	g_assert_cmpstr (uuid, ==, "2c1b2b3a-5db3-4a16-9e37-08d0c6a5e3c3");
+	g_assert (uuid == nm_setting_connection_get_uuid (s_con2));
+	g_assert (nm_setting_connection_get_interface_name (s_con1) == s1->str);
+
+	g_object_set (s_con1, NM_SETTING_CONNECTION_UUID, uuid, NULL);
+	g_assert (uuid == nm_setting_connection_get_uuid (s_con1));
+	g_object_set (s_con1, NM_SETTING_CONNECTION_INTERFACE_NAME, NULL, NULL);
+	g_assert (!nm_setting_connection_get_interface_name (s_con1));
+	g_assert (nm_setting_connection_get_interface_name (s_con2) == s1->str);
+}
+
+/*****************************************************************************/
+
 static NMConnection *
 _connection_new_from_dbus (GVariant *dict, GError **error)
 {
@@ -6200,6 +6273,7 @@ int main (int argc, char **argv)
 	g_test_add_func ("/core/general/test_nm_g_slice_free_fcn", test_nm_g_slice_free_fcn);
 	g_test_add_func ("/core/general/test_c_list_sort", test_c_list_sort);
 	g_test_add_func ("/core/general/test_dedup_multi", test_dedup_multi);
+	g_test_add_func ("/core/general/test_ref_string", test_ref_string);
 	g_test_add_func ("/core/general/test_utils_str_utf8safe", test_utils_str_utf8safe);
 	g_test_add_func ("/core/general/test_nm_in_set", test_nm_in_set);
 	g_test_add_func ("/core/general/test_nm_in_strset", test_nm_in_strset);
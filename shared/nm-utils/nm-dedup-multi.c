@@ -39,14 +39,227 @@ typedef struct {
 	bool lookup_head;
 } LookupEntry;
 
+/* An open-addressing hash table with linear probing.
+ *
+ * The (mixed) hashes of the keys are kept in an array of their own, separate
+ * from the keys. Probing only walks the compact hashes array and calls the
+ * (indirect) equal function only for a matching hash. A hash of zero marks an
+ * empty slot. Removal uses backward shift deletion, so there are no tombstones.
+ *
+ * The table does not know how to hash or compare keys. The callers pass the
+ * hash and the equal function to the inline accessors, so that the compiler can
+ * resolve the calls for idx_entries and idx_objs statically. */
+typedef struct {
+	gconstpointer *keys;
+	guint *hashes;
+	guint mask;
+	guint len;
+} Table;
+
 struct _NMDedupMultiIndex {
 	int ref_count;
-	GHashTable *idx_entries;
-	GHashTable *idx_objs;
+	Table idx_entries;
+	Table idx_objs;
 };
 
 /*****************************************************************************/
 
+#define TABLE_SIZE_MIN 16u
+
+static inline guint
+_table_hash_mix (guint h)
+{
+	/* The table picks the bucket from the lower bits, but the hash functions
+	 * of the objects (NM_HASH_COMBINE) leave them poorly distributed. */
+	h ^= h >> 16;
+	h *= 0x45d9f3bu;
+	h ^= h >> 16;
+	return h ?: 1u;
+}
+
+static void
+_table_resize (Table *t, guint size)
+{
+	gconstpointer *keys_old = t->keys;
+	guint *hashes_old = t->hashes;
+	guint size_old = keys_old ? t->mask + 1 : 0;
+	guint i, j;
+
+	nm_assert (size >= TABLE_SIZE_MIN);
+	nm_assert (nm_utils_is_power_of_two (size));
+	nm_assert (t->len < size);
+
+	t->keys = g_malloc (size * (sizeof (gconstpointer) + sizeof (guint)));
+	t->hashes = (guint *) &t->keys[size];
+	memset (t->hashes, 0, size * sizeof (guint));
+	t->mask = size - 1;
+
+	for (i = 0; i < size_old; i++) {
+		if (!hashes_old[i])
+			continue;
+		for (j = hashes_old[i] & t->mask; t->hashes[j]; j = (j + 1) & t->mask) {
+		}
+		t->hashes[j] = hashes_old[i];
+		t->keys[j] = keys_old[i];
+	}
+
+	g_free (keys_old);
+}
+
+static void
+_table_destroy (Table *t)
+{
+	g_free (t->keys);
+	memset (t, 0, sizeof (*t));
+}
+
+static inline gconstpointer
+_table_lookup (const Table *t,
+               gconstpointer key,
+               guint hash,
+               GEqualFunc equal_func)
+{
+	guint h, i;
+
+	if (!t->len)
+		return NULL;
+
+	h = _table_hash_mix (hash);
+	for (i = h & t->mask; t->hashes[i]; i = (i + 1) & t->mask) {
+		if (   t->hashes[i] == h
+		    && (   t->keys[i] == key
+		        || equal_func (t->keys[i], key)))
+			return t->keys[i];
+	}
+	return NULL;
+}
+
+static inline void
+_table_add (Table *t,
+            gconstpointer key,
+            guint hash)
+{
+	guint h, i;
+
+	/* the caller ensures that no equal key is in the table yet. */
+
+	if (!t->keys)
+		_table_resize (t, TABLE_SIZE_MIN);
+	else if ((t->len + 1) * 4 > (t->mask + 1) * 3)
+		_table_resize (t, (t->mask + 1) * 2);
+
+	h = _table_hash_mix (hash);
+	for (i = h & t->mask; t->hashes[i]; i = (i + 1) & t->mask)
+		nm_assert (t->keys[i] != key);
+
+	t->hashes[i] = h;
+	t->keys[i] = key;
+	t->len++;
+}
+
+static inline gboolean
+_table_remove (Table *t,
+               gconstpointer key,
+               guint hash)
+{
+	guint h, i, j;
+
+	/* remove exactly @key (by pointer), not an equal one. */
+
+	if (!t->len)
+		return FALSE;
+
+	h = _table_hash_mix (hash);
+	for (i = h & t->mask; ; i = (i + 1) & t->mask) {
+		/* the keys of empty buckets are not initialized. Check the
+		 * hash first. */
+		if (!t->hashes[i])
+			return FALSE;
+		if (   t->hashes[i] == h
+		    && t->keys[i] == key)
+			break;
+	}
+
+	/* close the hole at @i by moving back the following entries of the
+	 * cluster, unless their home bucket lies cyclically in (i, j]. */
+	for (j = (i + 1) & t->mask; t->hashes[j]; j = (j + 1) & t->mask) {
+		if (((j - t->hashes[j]) & t->mask) >= ((j - i) & t->mask)) {
+			t->hashes[i] = t->hashes[j];
+			t->keys[i] = t->keys[j];
+			i = j;
+		}
+	}
+	t->hashes[i] = 0;
+	t->keys[i] = NULL;
+	t->len--;
+
+	if (   t->mask + 1 > TABLE_SIZE_MIN
+	    && t->len * 8 < t->mask + 1)
+		_table_resize (t, (t->mask + 1) / 2);
+	return TRUE;
+}
+
+static gboolean
+_table_iter_next (const Table *t, guint *state, gconstpointer *out_key)
+{
+	guint i;
+
+	if (!t->keys)
+		return FALSE;
+	for (i = *state; i <= t->mask; i++) {
+		if (t->hashes[i]) {
+			*state = i + 1;
+			*out_key = t->keys[i];
+			return TRUE;
+		}
+	}
+	*state = i;
+	return FALSE;
+}
+
+static guint _dict_idx_entries_hash (const NMDedupMultiEntry *entry);
+static gboolean _dict_idx_entries_equal (const NMDedupMultiEntry *entry_a,
+                                         const NMDedupMultiEntry *entry_b);
+static guint _dict_idx_objs_hash (const NMDedupMultiObj *obj);
+static gboolean _dict_idx_objs_equal (const NMDedupMultiObj *obj_a,
+                                      const NMDedupMultiObj *obj_b);
+
+#define _idx_entries_lookup(self, entry) \
+	({ \
+		const NMDedupMultiEntry *const _entry = (const NMDedupMultiEntry *) (entry); \
+		\
+		(gpointer) _table_lookup (&(self)->idx_entries, _entry, _dict_idx_entries_hash (_entry), (GEqualFunc) _dict_idx_entries_equal); \
+	})
+#define _idx_entries_add(self, entry) \
+	({ \
+		const NMDedupMultiEntry *const _entry = (entry); \
+		\
+		_table_add (&(self)->idx_entries, _entry, _dict_idx_entries_hash (_entry)); \
+	})
+#define _idx_entries_remove(self, entry) \
+	({ \
+		const NMDedupMultiEntry *const _entry = (entry); \
+		\
+		_table_remove (&(self)->idx_entries, _entry, _dict_idx_entries_hash (_entry)); \
+	})
+
+#define _idx_objs_lookup_h(self, obj, hash) \
+	((gconstpointer) _table_lookup (&(self)->idx_objs, (obj), (hash), (GEqualFunc) _dict_idx_objs_equal))
+#define _idx_objs_lookup(self, obj) \
+	({ \
+		const NMDedupMultiObj *const _obj = (obj); \
+		\
+		_idx_objs_lookup_h (self, _obj, _dict_idx_objs_hash (_obj)); \
+	})
+#define _idx_objs_remove(self, obj) \
+	({ \
+		const NMDedupMultiObj *const _obj = (obj); \
+		\
+		_table_remove (&(self)->idx_objs, _obj, _dict_idx_objs_hash (_obj)); \
+	})
+
+/*****************************************************************************/
+
 static void
 ASSERT_idx_type (const NMDedupMultiIdxType *idx_type)
 {
@@ -88,7 +301,7 @@ _entry_lookup_obj (const NMDedupMultiIndex *self,
 	};
 
 	ASSERT_idx_type (idx_type);
-	return g_hash_table_lookup (self->idx_entries, &stack_entry);
+	return _idx_entries_lookup (self, &stack_entry);
 }
 
 static NMDedupMultiHeadEntry *
@@ -112,11 +325,11 @@ _entry_lookup_head (const NMDedupMultiIndex *self,
 			nm_assert (c_list_length (&idx_type->lst_idx_head) == 1);
 			head_entry = c_list_entry (idx_type->lst_idx_head.next, NMDedupMultiHeadEntry, lst_idx);
 		}
-		nm_assert (head_entry == g_hash_table_lookup (self->idx_entries, &stack_entry));
+		nm_assert (head_entry == _idx_entries_lookup (self, &stack_entry));
 		return head_entry;
 	}
 
-	return g_hash_table_lookup (self->idx_entries, &stack_entry);
+	return _idx_entries_lookup (self, &stack_entry);
 }
 
 static void
@@ -383,12 +596,13 @@ _add (NMDedupMultiIndex *self,
 	idx_type->len++;
 	head_entry->len++;
 
-	if (   add_head_entry
-	    && !nm_g_hash_table_add (self->idx_entries, head_entry))
-		nm_assert_not_reached ();
+	if (add_head_entry) {
+		nm_assert (!_idx_entries_lookup (self, head_entry));
+		_idx_entries_add (self, head_entry);
+	}
 
-	if (!nm_g_hash_table_add (self->idx_entries, entry))
-		nm_assert_not_reached ();
+	nm_assert (!_idx_entries_lookup (self, entry));
+	_idx_entries_add (self, entry);
 
 	NM_SET_OUT (out_entry, entry);
 	NM_SET_OUT (out_obj_old, NULL);
@@ -511,14 +725,14 @@ _remove_entry (NMDedupMultiIndex *self,
 	nm_assert (entry->obj);
 	nm_assert (entry->head);
 	nm_assert (!c_list_is_empty (&entry->lst_entries));
-	nm_assert (g_hash_table_lookup (self->idx_entries, entry) == entry);
+	nm_assert (_idx_entries_lookup (self, entry) == entry);
 
 	head_entry = (NMDedupMultiHeadEntry *) entry->head;
 	obj = entry->obj;
 
 	nm_assert (head_entry);
 	nm_assert (head_entry->len > 0);
-	nm_assert (g_hash_table_lookup (self->idx_entries, head_entry) == head_entry);
+	nm_assert (_idx_entries_lookup (self, head_entry) == head_entry);
 
 	idx_type = (NMDedupMultiIdxType *) head_entry->idx_type;
 	ASSERT_idx_type (idx_type);
@@ -532,11 +746,11 @@ _remove_entry (NMDedupMultiIndex *self,
 
 	NM_SET_OUT (out_head_entry_removed, head_entry != NULL);
 
-	if (!g_hash_table_remove (self->idx_entries, entry))
+	if (!_idx_entries_remove (self, entry))
 		nm_assert_not_reached ();
 
 	if (   head_entry
-	    && !g_hash_table_remove (self->idx_entries, head_entry))
+	    && !_idx_entries_remove (self, head_entry))
 		nm_assert_not_reached ();
 
 	c_list_unlink (&entry->lst_entries);
@@ -565,7 +779,7 @@ _remove_head (NMDedupMultiIndex *self,
 	nm_assert (head_entry);
 	nm_assert (head_entry->len > 0);
 	nm_assert (head_entry->len == c_list_length (&head_entry->lst_entries_head));
-	nm_assert (g_hash_table_lookup (self->idx_entries, head_entry) == head_entry);
+	nm_assert (_idx_entries_lookup (self, head_entry) == head_entry);
 
 	n = 0;
 	c_list_for_each_safe (iter_entry, iter_entry_safe, &head_entry->lst_entries_head) {
@@ -795,7 +1009,8 @@ nm_dedup_multi_index_dirty_remove_idx (NMDedupMultiIndex *self,
 static guint
 _dict_idx_objs_hash (const NMDedupMultiObj *obj)
 {
-	return obj->klass->obj_full_hash (obj);
+	return    obj->_hash_full
+	       ?: obj->klass->obj_full_hash (obj);
 }
 
 static gboolean
@@ -804,6 +1019,7 @@ _dict_idx_objs_equal (const NMDedupMultiObj *obj_a,
 {
 	return    obj_a == obj_b
 	       || (   obj_a->klass == obj_b->klass
+	           && nm_dedup_multi_obj_hash_maybe_equal (obj_a, obj_b)
 	           && obj_a->klass->obj_full_equal (obj_a, obj_b));
 }
 
@@ -813,12 +1029,14 @@ nm_dedup_multi_index_obj_release (NMDedupMultiIndex *self,
 {
 	nm_assert (self);
 	nm_assert (obj);
-	nm_assert (g_hash_table_lookup (self->idx_objs, obj) == obj);
+	nm_assert (_idx_objs_lookup (self, obj) == obj);
 	nm_assert (((const NMDedupMultiObj *) obj)->_multi_idx == self);
 
-	((NMDedupMultiObj *) obj)->_multi_idx = NULL;
-	if (!g_hash_table_remove (self->idx_objs, obj))
+	if (!_idx_objs_remove (self, obj))
 		nm_assert_not_reached ();
+	((NMDedupMultiObj *) obj)->_multi_idx = NULL;
+	((NMDedupMultiObj *) obj)->_hash_full = 0;
+	((NMDedupMultiObj *) obj)->_hash_id = 0;
 }
 
 gconstpointer
@@ -828,7 +1046,7 @@ nm_dedup_multi_index_obj_find (NMDedupMultiIndex *self,
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (obj, NULL);
 
-	return g_hash_table_lookup (self->idx_objs, obj);
+	return _idx_objs_lookup (self, obj);
 }
 
 gconstpointer
@@ -837,17 +1055,20 @@ nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
 {
 	const NMDedupMultiObj *obj_new = obj;
 	const NMDedupMultiObj *obj_old;
+	guint hash;
 
 	nm_assert (self);
 	nm_assert (obj_new);
 
 	if (obj_new->_multi_idx == self) {
-		nm_assert (g_hash_table_lookup (self->idx_objs, obj_new) == obj_new);
+		nm_assert (_idx_objs_lookup (self, obj_new) == obj_new);
 		nm_dedup_multi_obj_ref (obj_new);
 		return obj_new;
 	}
 
-	obj_old = g_hash_table_lookup (self->idx_objs, obj_new);
+	hash = _dict_idx_objs_hash (obj_new);
+
+	obj_old = _idx_objs_lookup_h (self, obj_new, hash);
 	nm_assert (obj_old != obj_new);
 
 	if (obj_old) {
@@ -863,11 +1084,13 @@ nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
 
 	nm_assert (obj_new);
 	nm_assert (!obj_new->_multi_idx);
+	nm_assert (hash == obj_new->klass->obj_full_hash (obj_new));
 
-	if (!nm_g_hash_table_add (self->idx_objs, (gpointer) obj_new))
-		nm_assert_not_reached ();
+	_table_add (&self->idx_objs, obj_new, hash);
 
+	/* interned objects are immutable. Remember the hash. */
 	((NMDedupMultiObj *) obj_new)->_multi_idx = self;
+	((NMDedupMultiObj *) obj_new)->_hash_full = hash;
 	return obj_new;
 }
 
@@ -1076,8 +1299,6 @@ nm_dedup_multi_index_new (void)
 
 	self = g_slice_new0 (NMDedupMultiIndex);
 	self->ref_count = 1;
-	self->idx_entries = g_hash_table_new ((GHashFunc) _dict_idx_entries_hash, (GEqualFunc) _dict_idx_entries_equal);
-	self->idx_objs    = g_hash_table_new ((GHashFunc) _dict_idx_objs_hash,    (GEqualFunc) _dict_idx_objs_equal);
 	return self;
 }
 
@@ -1094,10 +1315,11 @@ nm_dedup_multi_index_ref (NMDedupMultiIndex *self)
 NMDedupMultiIndex *
 nm_dedup_multi_index_unref (NMDedupMultiIndex *self)
 {
-	GHashTableIter iter;
+	guint iter, i;
 	const NMDedupMultiIdxType *idx_type;
 	NMDedupMultiEntry *entry;
 	const NMDedupMultiObj *obj;
+	gs_unref_ptrarray GPtrArray *idx_types = NULL;
 
 	g_return_val_if_fail (self, NULL);
 	g_return_val_if_fail (self->ref_count > 0, NULL);
@@ -1105,28 +1327,38 @@ nm_dedup_multi_index_unref (NMDedupMultiIndex *self)
 	if (--self->ref_count > 0)
 		return NULL;
 
-more:
-	g_hash_table_iter_init (&iter, self->idx_entries);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &entry, NULL)) {
+	/* removing entries shifts and shrinks the table, so we cannot continue
+	 * a walk after a removal. Instead, collect the (few) index types in
+	 * one walk and then remove all entries of each type. */
+	idx_types = g_ptr_array_new ();
+	iter = 0;
+	while (_table_iter_next (&self->idx_entries, &iter, (gconstpointer *) &entry)) {
 		if (entry->is_head)
 			idx_type = ((NMDedupMultiHeadEntry *) entry)->idx_type;
 		else
 			idx_type = entry->head->idx_type;
-		_remove_idx_entry (self, (NMDedupMultiIdxType *) idx_type, TRUE, FALSE);
-		goto more;
+		for (i = 0; i < idx_types->len; i++) {
+			if (idx_types->pdata[i] == idx_type)
+				break;
+		}
+		if (i == idx_types->len)
+			g_ptr_array_add (idx_types, (gpointer) idx_type);
 	}
 
-	nm_assert (g_hash_table_size (self->idx_entries) == 0);
+	for (i = 0; i < idx_types->len; i++)
+		_remove_idx_entry (self, idx_types->pdata[i], TRUE, FALSE);
+	nm_assert (self->idx_entries.len == 0);
 
-	g_hash_table_iter_init (&iter, self->idx_objs);
-	while (g_hash_table_iter_next (&iter, (gpointer *) &obj, NULL)) {
+	iter = 0;
+	while (_table_iter_next (&self->idx_objs, &iter, (gconstpointer *) &obj)) {
 		nm_assert (obj->_multi_idx == self);
 		((NMDedupMultiObj * )obj)->_multi_idx = NULL;
+		((NMDedupMultiObj * )obj)->_hash_full = 0;
+		((NMDedupMultiObj * )obj)->_hash_id = 0;
 	}
-	g_hash_table_remove_all (self->idx_objs);
 
-	g_hash_table_unref (self->idx_entries);
-	g_hash_table_unref (self->idx_objs);
+	_table_destroy (&self->idx_entries);
+	_table_destroy (&self->idx_objs);
 
 	g_slice_free (NMDedupMultiIndex, self);
 	return NULL;
@@ -58,6 +58,16 @@ struct _NMDedupMultiObj {
 	};
 	NMDedupMultiIndex *_multi_idx;
 	guint _ref_count;
+
+	/* the memoized obj_full_hash() of the object. Objects are immutable while
+	 * they are interned, and only then the hash is set. Otherwise, and if the
+	 * hash happens to be zero, it is 0. */
+	guint _hash_full;
+
+	/* another hash that the user of the index may memoize while the object
+	 * is interned, for example of the identity of the object. Like
+	 * _hash_full, it is reset to 0 when the object leaves the index. */
+	guint _hash_id;
 };
 
 struct _NMDedupMultiObjClass {
@@ -83,6 +93,16 @@ const NMDedupMultiObj *nm_dedup_multi_obj_unref       (const NMDedupMultiObj *ob
 const NMDedupMultiObj *nm_dedup_multi_obj_clone       (const NMDedupMultiObj *obj);
 gboolean               nm_dedup_multi_obj_needs_clone (const NMDedupMultiObj *obj);
 
+static inline gboolean
+nm_dedup_multi_obj_hash_maybe_equal (const NMDedupMultiObj *obj_a,
+                                     const NMDedupMultiObj *obj_b)
+{
+	/* objects with differing memoized hashes are never equal. */
+	return    !obj_a->_hash_full
+	       || !obj_b->_hash_full
+	       || obj_a->_hash_full == obj_b->_hash_full;
+}
+
 gconstpointer nm_dedup_multi_index_obj_intern (NMDedupMultiIndex *self,
                                                /* const NMDedupMultiObj * */ gconstpointer obj);
 
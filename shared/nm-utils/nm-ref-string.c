@@ -0,0 +1,194 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * (C) Copyright 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-ref-string.h"
+
+/*****************************************************************************/
+
+typedef struct {
+	/* the same layout as the public NMRefString, but writable. */
+	const char *str;
+	gsize len;
+	int ref_count;
+	char str_data[];
+} RefString;
+
+G_STATIC_ASSERT (G_STRUCT_OFFSET (RefString, str) == G_STRUCT_OFFSET (NMRefString, str));
+G_STATIC_ASSERT (G_STRUCT_OFFSET (RefString, len) == G_STRUCT_OFFSET (NMRefString, len));
+
+/* The pool is shared by all threads. Taking a reference on an instance
+ * that is known to be alive only needs an atomic increment. Everything
+ * that can add or drop an instance from the pool happens while holding
+ * the lock. */
+G_LOCK_DEFINE_STATIC (gl_lock);
+static GHashTable *gl_hash;
+
+/*****************************************************************************/
+
+static guint
+_ref_string_hash (gconstpointer ptr)
+{
+	const RefString *a = ptr;
+	guint h = 5381;
+	gsize i;
+
+	for (i = 0; i < a->len; i++)
+		h = (h << 5) + h + ((guint8) a->str[i]);
+	return h ^ ((guint) a->len);
+}
+
+static gboolean
+_ref_string_equal (gconstpointer pa, gconstpointer pb)
+{
+	const RefString *a = pa;
+	const RefString *b = pb;
+
+	return    a->len == b->len
+	       && memcmp (a->str, b->str, a->len) == 0;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_ref_string_new_len:
+ * @cstr: the string. It doesn't need to be NUL terminated, but it
+ *   must not contain NUL characters within @len.
+ * @len: the length of @cstr
+ *
+ * Returns: (transfer full): the interned instance for @cstr. If the
+ *   pool already contains an equal string, that instance is returned
+ *   with an additional reference.
+ */
+NMRefString *
+nm_ref_string_new_len (const char *cstr, gsize len)
+{
+	RefString *rstr;
+	const RefString lookup = {
+		.str = cstr,
+		.len = len,
+	};
+
+	g_return_val_if_fail (cstr || len == 0, NULL);
+	nm_assert (!cstr || !memchr (cstr, '\0', len));
+
+	G_LOCK (gl_lock);
+
+	if (G_UNLIKELY (!gl_hash))
+		gl_hash = g_hash_table_new (_ref_string_hash, _ref_string_equal);
+	else {
+		rstr = g_hash_table_lookup (gl_hash, &lookup);
+		if (rstr) {
+			nm_assert (rstr->ref_count > 0);
+			g_atomic_int_inc (&rstr->ref_count);
+			G_UNLOCK (gl_lock);
+			return (NMRefString *) rstr;
+		}
+	}
+
+	rstr = g_malloc (sizeof (RefString) + len + 1);
+	if (len > 0)
+		memcpy (rstr->str_data, cstr, len);
+	rstr->str_data[len] = '\0';
+	rstr->str = rstr->str_data;
+	rstr->len = len;
+	rstr->ref_count = 1;
+
+	g_hash_table_add (gl_hash, rstr);
+
+	G_UNLOCK (gl_lock);
+	return (NMRefString *) rstr;
+}
+
+NMRefString *
+nm_ref_string_ref (NMRefString *rstr)
+{
+	RefString *const rstr0 = (RefString *) rstr;
+
+	if (!rstr0)
+		return NULL;
+
+	nm_assert (g_atomic_int_get (&rstr0->ref_count) > 0);
+
+	g_atomic_int_inc (&rstr0->ref_count);
+	return rstr;
+}
+
+void
+_nm_ref_string_unref_non_null (NMRefString *rstr)
+{
+	RefString *const rstr0 = (RefString *) rstr;
+	int r;
+
+	nm_assert (rstr0);
+
+	/* fast path: drop a reference that is not the last one without
+	 * taking the lock. */
+	r = g_atomic_int_get (&rstr0->ref_count);
+	while (r > 1) {
+		if (g_atomic_int_compare_and_exchange (&rstr0->ref_count, r, r - 1))
+			return;
+		r = g_atomic_int_get (&rstr0->ref_count);
+	}
+
+	G_LOCK (gl_lock);
+
+	/* the instance might have been looked up meanwhile, and only in that
+	 * case (while holding the lock) the reference count can increase again. */
+	if (!g_atomic_int_dec_and_test (&rstr0->ref_count)) {
+		G_UNLOCK (gl_lock);
+		return;
+	}
+
+	if (!g_hash_table_remove (gl_hash, rstr0))
+		nm_assert_not_reached ();
+
+	G_UNLOCK (gl_lock);
+
+	g_free (rstr0);
+}
+
+/**
+ * nm_ref_string_reset_str:
+ * @p_rstr: (inout): the location of the ref-string to reset
+ * @s: (allow-none): the new value
+ *
+ * Replaces *@p_rstr by an instance for @s. If *@p_rstr already
+ * has the content @s, nothing changes.
+ *
+ * Returns: whether *@p_rstr changed.
+ */
+gboolean
+nm_ref_string_reset_str (NMRefString **p_rstr, const char *s)
+{
+	NMRefString *rstr_old;
+
+	nm_assert (p_rstr);
+
+	rstr_old = *p_rstr;
+	if (nm_ref_string_equals_str (rstr_old, s))
+		return FALSE;
+
+	*p_rstr = nm_ref_string_new (s);
+	nm_ref_string_unref (rstr_old);
+	return TRUE;
+}
@@ -0,0 +1,106 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * (C) Copyright 2017 Red Hat, Inc.
+ */
+
+#ifndef __NM_REF_STRING_H__
+#define __NM_REF_STRING_H__
+
+/*****************************************************************************/
+
+/* NMRefString is an immutable, reference counted string that is interned
+ * in a global pool. Contrary to g_intern_string(), the string is released
+ * when the last reference is gone.
+ *
+ * Equal strings are always the same instance. Hence, two NMRefString can
+ * be compared by pointer and looking up a string returns the @str
+ * pointer of an existing instance. */
+
+typedef struct _NMRefString {
+	const char *const str;
+	const gsize len;
+} NMRefString;
+
+NMRefString *nm_ref_string_new_len (const char *cstr, gsize len);
+
+static inline NMRefString *
+nm_ref_string_new (const char *cstr)
+{
+	return cstr ? nm_ref_string_new_len (cstr, strlen (cstr)) : NULL;
+}
+
+NMRefString *nm_ref_string_ref (NMRefString *rstr);
+void _nm_ref_string_unref_non_null (NMRefString *rstr);
+
+static inline void
+nm_ref_string_unref (NMRefString *rstr)
+{
+	if (rstr)
+		_nm_ref_string_unref_non_null (rstr);
+}
+
+static inline void
+_nm_auto_ref_string_impl (NMRefString **prstr)
+{
+	nm_ref_string_unref (*prstr);
+}
+#define nm_auto_ref_string nm_auto(_nm_auto_ref_string_impl)
+
+static inline const char *
+nm_ref_string_get_str (NMRefString *rstr)
+{
+	return rstr ? rstr->str : NULL;
+}
+
+/**
+ * nm_ref_string_equals_str:
+ * @rstr: (allow-none): the ref-string
+ * @s: (allow-none): the string to compare
+ *
+ * Returns: whether @rstr has the content @s. If @s is the string of
+ *   @rstr itself (for example, because it was obtained via
+ *   nm_ref_string_get_str()), this is a pointer comparison.
+ */
+static inline gboolean
+nm_ref_string_equals_str (NMRefString *rstr, const char *s)
+{
+	if (!rstr)
+		return !s;
+	if (rstr->str == s)
+		return TRUE;
+	return s && strcmp (rstr->str, s) == 0;
+}
+
+static inline gboolean
+nm_clear_ref_string (NMRefString **p_rstr)
+{
+	NMRefString *rstr;
+
+	if (!p_rstr || !*p_rstr)
+		return FALSE;
+
+	rstr = *p_rstr;
+	*p_rstr = NULL;
+	_nm_ref_string_unref_non_null (rstr);
+	return TRUE;
+}
+
+gboolean nm_ref_string_reset_str (NMRefString **p_rstr, const char *s);
+
+#endif /* __NM_REF_STRING_H__ */
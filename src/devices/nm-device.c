@@ -36,6 +36,7 @@
 #include <linux/if_addr.h>
 
 #include "nm-utils/nm-dedup-multi.h"
+#include "nm-utils/nm-ref-string.h"
 
 #include "nm-common-macros.h"
 #include "nm-device-private.h"
@@ -214,6 +215,10 @@ typedef struct _NMDevicePrivate {
 	guint device_link_changed_id;
 	guint device_ip_link_changed_id;
 
+	/* the ifindexes for which we are subscribed to link changes. */
+	int link_subscribed_ifindex;
+	int link_subscribed_ip_ifindex;
+
 	NMDeviceState state;
 	NMDeviceStateReason state_reason;
 	struct {
@@ -232,7 +237,7 @@ typedef struct _NMDevicePrivate {
 	NMDevice *parent_device;
 
 	char *        udi;
-	char *        iface;   /* may change, could be renamed by user */
+	NMRefString * iface_;  /* may change, could be renamed by user */
 	int           ifindex;
 
 	int parent_ifindex;
@@ -251,14 +256,14 @@ typedef struct _NMDevicePrivate {
 	bool queued_ip4_config_pending:1;
 	bool queued_ip6_config_pending:1;
 
-	char *        ip_iface;
+	NMRefString * ip_iface_;
 	int           ip_ifindex;
 	NMDeviceType  type;
 	char *        type_desc;
 	char *        type_description;
 	NMLinkType    link_type;
 	NMDeviceCapabilities capabilities;
-	char *        driver;
+	NMRefString * driver_;
 	char *        driver_version;
 	char *        firmware_version;
 	RfKillType    rfkill_type;
@@ -351,6 +356,7 @@ typedef struct _NMDevicePrivate {
 
 	/* IP4 configuration info */
 	NMIP4Config *   ip4_config;     /* Combined config from VPN, settings, and device */
+	NMIPConfigCommitState ip4_commit_state; /* what the last commit configured */
 	union {
 		const IpState   ip4_state;
 		IpState         ip4_state_;
@@ -413,6 +419,7 @@ typedef struct _NMDevicePrivate {
 
 	/* IP6 configuration info */
 	NMIP6Config *  ip6_config;
+	NMIPConfigCommitState ip6_commit_state;
 	union {
 		const IpState   ip6_state;
 		IpState         ip6_state_;
@@ -482,10 +489,16 @@ typedef struct _NMDevicePrivate {
 	guint check_delete_unrealized_id;
 
 	struct {
-		guint timeout_id;
 		guint refresh_rate_ms;
 		guint64 tx_bytes;
 		guint64 rx_bytes;
+
+		/* the link statistics are only refreshed while the device is real. */
+		bool active:1;
+
+		/* the subscription at the platform, or 0. */
+		int subscribed_ifindex;
+		guint subscribed_rate_ms;
 	} stats;
 
 } NMDevicePrivate;
@@ -548,6 +561,7 @@ static void realize_start_setup (NMDevice *self,
 static void _commit_mtu (NMDevice *self, const NMIP4Config *config);
 static void dhcp_schedule_restart (NMDevice *self, int family, const char *reason);
 static void _cancel_activation (NMDevice *self);
+static void _link_subscriptions_update (NMDevice *self, gboolean enable);
 
 /*****************************************************************************/
 
@@ -827,6 +841,7 @@ nm_device_ipv4_sysctl_set (NMDevice *self, const char *property, const char *val
 	NMPlatform *platform = nm_device_get_platform (self);
 	gs_free char *value_to_free = NULL;
 	const char *value_to_set;
+	int ifindex;
 
 	if (value) {
 		value_to_set = value;
@@ -837,6 +852,10 @@ nm_device_ipv4_sysctl_set (NMDevice *self, const char *property, const char *val
 		value_to_set = value_to_free;
 	}
 
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex > 0)
+		return nm_platform_sysctl_ifdir_set (platform, ifindex, NMP_SYSCTL_IFDIR_IP4_CONF, property, value_to_set);
+
 	return nm_platform_sysctl_set (platform,
 	                               NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip4_property_path (nm_device_get_ip_iface (self), property)),
 	                               value_to_set);
@@ -845,6 +864,20 @@ nm_device_ipv4_sysctl_set (NMDevice *self, const char *property, const char *val
 static guint32
 nm_device_ipv4_sysctl_get_uint32 (NMDevice *self, const char *property, guint32 fallback)
 {
+	int ifindex;
+
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex > 0) {
+		return nm_platform_sysctl_ifdir_get_int_checked (nm_device_get_platform (self),
+		                                                 ifindex,
+		                                                 NMP_SYSCTL_IFDIR_IP4_CONF,
+		                                                 property,
+		                                                 10,
+		                                                 0,
+		                                                 G_MAXUINT32,
+		                                                 fallback);
+	}
+
 	return nm_platform_sysctl_get_int_checked (nm_device_get_platform (self),
 	                                           NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip4_property_path (nm_device_get_ip_iface (self), property)),
 	                                           10,
@@ -856,12 +889,48 @@ nm_device_ipv4_sysctl_get_uint32 (NMDevice *self, const char *property, guint32
 gboolean
 nm_device_ipv6_sysctl_set (NMDevice *self, const char *property, const char *value)
 {
+	int ifindex;
+
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex > 0)
+		return nm_platform_sysctl_ifdir_set (nm_device_get_platform (self), ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, property, value);
+
 	return nm_platform_sysctl_set (nm_device_get_platform (self), NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (nm_device_get_ip_iface (self), property)), value);
 }
 
+static void
+_ipv6_sysctl_set_batch (NMDevice *self, const NMPlatformSysctlEntry *entries, guint n_entries)
+{
+	int ifindex;
+	guint i;
+
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex > 0) {
+		nm_platform_sysctl_ifdir_set_batch (nm_device_get_platform (self), ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, entries, n_entries);
+		return;
+	}
+
+	for (i = 0; i < n_entries; i++)
+		nm_device_ipv6_sysctl_set (self, entries[i].property, entries[i].value);
+}
+
 static guint32
 nm_device_ipv6_sysctl_get_uint32 (NMDevice *self, const char *property, guint32 fallback)
 {
+	int ifindex;
+
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex > 0) {
+		return nm_platform_sysctl_ifdir_get_int_checked (nm_device_get_platform (self),
+		                                                 ifindex,
+		                                                 NMP_SYSCTL_IFDIR_IP6_CONF,
+		                                                 property,
+		                                                 10,
+		                                                 0,
+		                                                 G_MAXUINT32,
+		                                                 fallback);
+	}
+
 	return nm_platform_sysctl_get_int_checked (nm_device_get_platform (self),
 	                                           NMP_SYSCTL_PATHID_ABSOLUTE (nm_utils_ip6_property_path (nm_device_get_ip_iface (self), property)),
 	                                           10,
@@ -1006,7 +1075,7 @@ nm_device_get_iface (NMDevice *self)
 {
 	g_return_val_if_fail (NM_IS_DEVICE (self), NULL);
 
-	return NM_DEVICE_GET_PRIVATE (self)->iface;
+	return nm_ref_string_get_str (NM_DEVICE_GET_PRIVATE (self)->iface_);
 }
 
 gboolean
@@ -1037,6 +1106,7 @@ nm_device_take_over_link (NMDevice *self, const char *ifname)
 
 	if (success) {
 		priv->ifindex = ifindex;
+		_link_subscriptions_update (self, TRUE);
 		_notify (self, PROP_IFINDEX);
 	}
 
@@ -1089,7 +1159,7 @@ nm_device_get_ip_iface (NMDevice *self)
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 	/* If it's not set, default to iface */
-	return priv->ip_iface ? priv->ip_iface : priv->iface;
+	return nm_ref_string_get_str (priv->ip_iface_ ?: priv->iface_);
 }
 
 int
@@ -1101,7 +1171,7 @@ nm_device_get_ip_ifindex (NMDevice *self)
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 	/* If it's not set, default to ifindex */
-	return priv->ip_iface ? priv->ip_ifindex : priv->ifindex;
+	return priv->ip_iface_ ? priv->ip_ifindex : priv->ifindex;
 }
 
 /**
@@ -1123,7 +1193,7 @@ nm_device_set_ip_iface (NMDevice *self, const char *iface)
 	g_return_val_if_fail (NM_IS_DEVICE (self), FALSE);
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
-	if (nm_streq0 (iface, priv->ip_iface)) {
+	if (nm_ref_string_equals_str (priv->ip_iface_, iface)) {
 		if (!iface)
 			return FALSE;
 		ifindex = nm_platform_if_nametoindex (nm_device_get_platform (self), iface);
@@ -1134,8 +1204,7 @@ nm_device_set_ip_iface (NMDevice *self, const char *iface)
 		priv->ip_ifindex = ifindex;
 		_LOGD (LOGD_DEVICE, "ip-ifname: update ifindex for ifname '%s': %d", iface, priv->ip_ifindex);
 	} else {
-		g_free (priv->ip_iface);
-		priv->ip_iface = g_strdup (iface);
+		nm_ref_string_reset_str (&priv->ip_iface_, iface);
 
 		if (iface) {
 			/* The @iface name is not in sync with the platform cache.
@@ -1163,6 +1232,8 @@ nm_device_set_ip_iface (NMDevice *self, const char *iface)
 			nm_platform_link_set_up (nm_device_get_platform (self), priv->ip_ifindex, NULL);
 	}
 
+	_link_subscriptions_update (self, TRUE);
+
 	/* We don't care about any saved values from the old iface */
 	g_hash_table_remove_all (priv->ip6_saved_properties);
 
@@ -1179,21 +1250,20 @@ _ip_iface_update (NMDevice *self, const char *ip_iface)
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 
-	g_return_val_if_fail (priv->ip_iface, FALSE);
+	g_return_val_if_fail (priv->ip_iface_, FALSE);
 	g_return_val_if_fail (priv->ip_ifindex > 0, FALSE);
 	g_return_val_if_fail (ip_iface, FALSE);
 
 	if (!ip_iface[0])
 		return FALSE;
 
-	if (nm_streq (priv->ip_iface, ip_iface))
+	if (nm_ref_string_equals_str (priv->ip_iface_, ip_iface))
 		return FALSE;
 
 	_LOGI (LOGD_DEVICE, "ip-ifname: interface index %d renamed ip_iface (%d) from '%s' to '%s'",
 	       priv->ifindex, priv->ip_ifindex,
-	       priv->ip_iface, ip_iface);
-	g_free (priv->ip_iface);
-	priv->ip_iface = g_strdup (ip_iface);
+	       priv->ip_iface_->str, ip_iface);
+	nm_ref_string_reset_str (&priv->ip_iface_, ip_iface);
 	_notify (self, PROP_IP_IFACE);
 	return TRUE;
 }
@@ -1351,22 +1421,6 @@ _stats_update_counters_from_pllink (NMDevice *self, const NMPlatformLink *pllink
 	_stats_update_counters (self, pllink->tx_bytes, pllink->rx_bytes);
 }
 
-static gboolean
-_stats_timeout_cb (gpointer user_data)
-{
-	NMDevice *self = user_data;
-	int ifindex;
-
-	ifindex = nm_device_get_ip_ifindex (self);
-
-	_LOGT (LOGD_DEVICE, "stats: refresh %d", ifindex);
-
-	if (ifindex > 0)
-		nm_platform_link_refresh (nm_device_get_platform (self), ifindex);
-
-	return G_SOURCE_CONTINUE;
-}
-
 static guint
 _stats_refresh_rate_real (guint refresh_rate_ms)
 {
@@ -1384,6 +1438,53 @@ _stats_refresh_rate_real (guint refresh_rate_ms)
 	return refresh_rate_ms;
 }
 
+/* The platform polls the statistics of all subscribed links together.
+ * Update our subscription after the refresh-rate or the ip-ifindex changed. */
+static void
+_stats_subscription_update (NMDevice *self)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	NMPlatform *platform;
+	int ifindex = 0;
+	guint refresh_rate_ms = 0;
+
+	if (priv->stats.active) {
+		refresh_rate_ms = _stats_refresh_rate_real (priv->stats.refresh_rate_ms);
+		if (refresh_rate_ms)
+			ifindex = MAX (nm_device_get_ip_ifindex (self), 0);
+		if (!ifindex)
+			refresh_rate_ms = 0;
+	}
+
+	if (   priv->stats.subscribed_ifindex == ifindex
+	    && priv->stats.subscribed_rate_ms == refresh_rate_ms)
+		return;
+
+	platform = nm_device_get_platform (self);
+	if (priv->stats.subscribed_ifindex > 0) {
+		nm_platform_link_stats_unsubscribe (platform,
+		                                    priv->stats.subscribed_ifindex,
+		                                    priv->stats.subscribed_rate_ms);
+	}
+
+	priv->stats.subscribed_ifindex = ifindex;
+	priv->stats.subscribed_rate_ms = refresh_rate_ms;
+
+	if (ifindex > 0) {
+		_LOGT (LOGD_DEVICE, "stats: refresh %d every %u ms", ifindex, refresh_rate_ms);
+		nm_platform_link_stats_subscribe (platform, ifindex, refresh_rate_ms);
+	}
+}
+
+static void
+_stats_set_active (NMDevice *self, gboolean active)
+{
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+
+	priv->stats.active = active;
+	_stats_subscription_update (self);
+}
+
 static void
 _stats_set_refresh_rate (NMDevice *self, guint refresh_rate_ms)
 {
@@ -1409,7 +1510,7 @@ _stats_set_refresh_rate (NMDevice *self, guint refresh_rate_ms)
 	if (_stats_refresh_rate_real (old_rate) == refresh_rate_ms)
 		return;
 
-	nm_clear_g_source (&priv->stats.timeout_id);
+	_stats_subscription_update (self);
 
 	if (!refresh_rate_ms)
 		return;
@@ -1420,8 +1521,6 @@ _stats_set_refresh_rate (NMDevice *self, guint refresh_rate_ms)
 	ifindex = nm_device_get_ip_ifindex (self);
 	if (ifindex > 0)
 		nm_platform_link_refresh (nm_device_get_platform (self), ifindex);
-
-	priv->stats.timeout_id = g_timeout_add (refresh_rate_ms, _stats_timeout_cb, self);
 }
 
 /*****************************************************************************/
@@ -1500,7 +1599,7 @@ nm_device_get_driver (NMDevice *self)
 {
 	g_return_val_if_fail (self != NULL, NULL);
 
-	return NM_DEVICE_GET_PRIVATE (self)->driver;
+	return nm_ref_string_get_str (NM_DEVICE_GET_PRIVATE (self)->driver_);
 }
 
 const char *
@@ -2594,11 +2693,8 @@ device_link_changed (NMDevice *self)
 		_notify (self, PROP_UDI);
 	}
 
-	if (!nm_streq0 (info.driver, priv->driver)) {
-		g_free (priv->driver);
-		priv->driver = g_strdup (info.driver);
+	if (nm_ref_string_reset_str (&priv->driver_, info.driver))
 		_notify (self, PROP_DRIVER);
-	}
 
 	if (priv->mtu != info.mtu) {
 		priv->mtu = info.mtu;
@@ -2613,14 +2709,13 @@ device_link_changed (NMDevice *self)
 	got_hw_addr = (!had_hw_addr && priv->hw_addr);
 	nm_device_update_permanent_hw_address (self, FALSE);
 
-	if (info.name[0] && strcmp (priv->iface, info.name) != 0) {
+	if (info.name[0] && !nm_ref_string_equals_str (priv->iface_, info.name)) {
 		_LOGI (LOGD_DEVICE, "interface index %d renamed iface from '%s' to '%s'",
-		       priv->ifindex, priv->iface, info.name);
-		g_free (priv->iface);
-		priv->iface = g_strdup (info.name);
+		       priv->ifindex, nm_ref_string_get_str (priv->iface_), info.name);
+		nm_ref_string_reset_str (&priv->iface_, info.name);
 
 		/* If the device has no explicit ip_iface, then changing iface changes ip_iface too. */
-		ip_ifname_changed = !priv->ip_iface;
+		ip_ifname_changed = !priv->ip_iface_;
 
 		if (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT))
 			nm_device_set_unmanaged_by_user_settings (self);
@@ -2642,7 +2737,7 @@ device_link_changed (NMDevice *self)
 
 	if (priv->ndisc && info.inet6_token.id) {
 		if (nm_ndisc_set_iid (priv->ndisc, info.inet6_token))
-			_LOGD (LOGD_DEVICE, "IPv6 tokenized identifier present on device %s", priv->iface);
+			_LOGD (LOGD_DEVICE, "IPv6 tokenized identifier present on device %s", nm_ref_string_get_str (priv->iface_));
 	}
 
 	/* Update carrier from link event if applicable. */
@@ -2747,20 +2842,20 @@ device_ip_link_changed (NMDevice *self)
 }
 
 static void
-link_changed_cb (NMPlatform *platform,
-                 int obj_type_i,
-                 int ifindex,
-                 NMPlatformLink *info,
-                 int change_type_i,
-                 NMDevice *self)
+link_subscription_cb (NMPlatform *platform,
+                      const NMPObject *obj,
+                      NMPlatformSignalChangeType change_type,
+                      gpointer user_data)
 {
-	const NMPlatformSignalChangeType change_type = change_type_i;
+	NMDevice *self = user_data;
 	NMDevicePrivate *priv;
+	int ifindex;
 
 	if (change_type != NM_PLATFORM_SIGNAL_CHANGED)
 		return;
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
+	ifindex = obj->link.ifindex;
 
 	if (ifindex == nm_device_get_ifindex (self)) {
 		if (!priv->device_link_changed_id) {
@@ -2775,29 +2870,50 @@ link_changed_cb (NMPlatform *platform,
 	}
 }
 
-/*****************************************************************************/
-
-typedef struct {
-	in_addr_t network;
-	guint8 plen;
-} IP4RPFilterData;
-
-static guint
-_v4_has_shadowed_routes_detect_hash (const IP4RPFilterData *d)
+static void
+_link_subscription_set (NMDevice *self, int *p_subscribed, int ifindex)
 {
-	guint h = 0;
+	NMPlatform *platform;
 
-	h = NM_HASH_COMBINE (h, d->network);
-	h = NM_HASH_COMBINE (h, d->plen);
-	return h;
+	if (*p_subscribed == ifindex)
+		return;
+
+	platform = nm_device_get_platform (self);
+	if (*p_subscribed > 0) {
+		nm_platform_object_unsubscribe (platform, NMP_OBJECT_TYPE_LINK, *p_subscribed,
+		                                link_subscription_cb, self);
+	}
+	*p_subscribed = ifindex;
+	if (ifindex > 0) {
+		nm_platform_object_subscribe (platform, NMP_OBJECT_TYPE_LINK, ifindex,
+		                              link_subscription_cb, self);
+	}
 }
 
-static gboolean
-_v4_has_shadowed_routes_detect_equal (const IP4RPFilterData *d1, const IP4RPFilterData *d2)
+/* subscribe to link changes for the current ifindex and ip-ifindex.
+ * Must be called whenever one of them changes. */
+static void
+_link_subscriptions_update (NMDevice *self, gboolean enable)
 {
-	return d1->network == d2->network && d1->plen == d2->plen;
+	NMDevicePrivate *priv = NM_DEVICE_GET_PRIVATE (self);
+	int ifindex = 0;
+	int ip_ifindex = 0;
+
+	if (enable) {
+		ifindex = MAX (priv->ifindex, 0);
+		ip_ifindex = MAX (nm_device_get_ip_ifindex (self), 0);
+		if (ip_ifindex == ifindex)
+			ip_ifindex = 0;
+	}
+
+	_link_subscription_set (self, &priv->link_subscribed_ifindex, ifindex);
+	_link_subscription_set (self, &priv->link_subscribed_ip_ifindex, ip_ifindex);
+
+	_stats_subscription_update (self);
 }
 
+/*****************************************************************************/
+
 static gboolean
 _v4_has_shadowed_routes_detect (NMDevice *self)
 {
@@ -2807,9 +2923,6 @@ _v4_has_shadowed_routes_detect (NMDevice *self)
 	const NMDedupMultiHeadEntry *head_entry;
 	NMDedupMultiIter iter;
 	const NMPObject *o;
-	guint data_len;
-	gs_unref_hashtable GHashTable *data_hash = NULL;
-	gs_free IP4RPFilterData *data_arr = NULL;
 
 	ifindex = nm_device_get_ip_ifindex (self);
 	if (ifindex <= 0)
@@ -2824,15 +2937,14 @@ _v4_has_shadowed_routes_detect (NMDevice *self)
 	if (!head_entry)
 		return FALSE;
 
-	/* first, create a lookup index @data_hash for all network/plen pairs. */
-	data_len = 0;
-	data_arr = g_new (IP4RPFilterData, head_entry->len);
-	data_hash = g_hash_table_new ((GHashFunc) _v4_has_shadowed_routes_detect_hash,
-	                              (GEqualFunc) _v4_has_shadowed_routes_detect_equal);
-
+	/* search if there is any route on another interface with the same
+	 * network/plen destination as one of our routes. If yes, we consider
+	 * this a multihoming setup. */
 	nmp_cache_iter_for_each (&iter, head_entry, &o) {
 		const NMPlatformIP4Route *r = NMP_OBJECT_CAST_IP4_ROUTE (o);
-		IP4RPFilterData *d;
+		const NMDedupMultiHeadEntry *head_entry_dst;
+		NMDedupMultiIter iter_dst;
+		const NMPObject *o_dst;
 
 		nm_assert (r->ifindex == ifindex);
 
@@ -2840,31 +2952,16 @@ _v4_has_shadowed_routes_detect (NMDevice *self)
 		    || r->table_coerced)
 			continue;
 
-		d = &data_arr[data_len++];
-		d->network = nm_utils_ip4_address_clear_host_address (r->network, r->plen);
-		d->plen = r->plen;
-		g_hash_table_add (data_hash, d);
-	}
-
-	/* then, search if there is any route on another interface with the same
-	 * network/plen destination. If yes, we consider this a multihoming
-	 * setup. */
-	head_entry = nm_platform_lookup (platform,
-	                                 nmp_lookup_init_obj_type (&lookup,
-	                                                           NMP_OBJECT_TYPE_IP4_ROUTE));
-	nmp_cache_iter_for_each (&iter, head_entry, &o) {
-		const NMPlatformIP4Route *r = NMP_OBJECT_CAST_IP4_ROUTE (o);
-		IP4RPFilterData d;
-
-		if (   r->ifindex == ifindex
-		    || NM_PLATFORM_IP_ROUTE_IS_DEFAULT (r)
-		    || r->table_coerced)
-			continue;
-
-		d.network = nm_utils_ip4_address_clear_host_address (r->network, r->plen);
-		d.plen = r->plen;
-		if (g_hash_table_contains (data_hash, &d))
-			return TRUE;
+		head_entry_dst = nm_platform_lookup (platform,
+		                                     nmp_lookup_init_route_by_destination (&lookup,
+		                                                                           NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                                                           0,
+		                                                                           &r->network,
+		                                                                           r->plen));
+		nmp_cache_iter_for_each (&iter_dst, head_entry_dst, &o_dst) {
+			if (NMP_OBJECT_CAST_IP4_ROUTE (o_dst)->ifindex != ifindex)
+				return TRUE;
+		}
 	}
 
 	return FALSE;
@@ -3026,7 +3123,7 @@ nm_device_create_and_realize (NMDevice *self,
 	const NMPlatformLink *plink = NULL;
 
 	/* Must be set before device is realized */
-	priv->nm_owned = !nm_platform_link_get_by_ifname (nm_device_get_platform (self), priv->iface);
+	priv->nm_owned = !nm_platform_link_get_by_ifname (nm_device_get_platform (self), nm_ref_string_get_str (priv->iface_));
 
 	_LOGD (LOGD_DEVICE, "create (is %snm-owned)", priv->nm_owned ? "" : "not ");
 
@@ -3069,23 +3166,19 @@ update_device_from_platform_link (NMDevice *self, const NMPlatformLink *plink)
 		_notify (self, PROP_UDI);
 	}
 
-	if (!g_strcmp0 (plink->name, priv->iface)) {
-		g_free (priv->iface);
-		priv->iface = g_strdup (plink->name);
+	if (nm_ref_string_equals_str (priv->iface_, plink->name))
 		_notify (self, PROP_IFACE);
-	}
 
 	if (priv->ifindex != plink->ifindex) {
 		priv->ifindex = plink->ifindex;
+		_link_subscriptions_update (self, TRUE);
 		_notify (self, PROP_IFINDEX);
 	}
 
 	priv->up = NM_FLAGS_HAS (plink->n_ifi_flags, IFF_UP);
-	if (plink->driver && g_strcmp0 (plink->driver, priv->driver) != 0) {
-		g_free (priv->driver);
-		priv->driver = g_strdup (plink->driver);
+	if (   plink->driver
+	    && nm_ref_string_reset_str (&priv->driver_, plink->driver))
 		_notify (self, PROP_DRIVER);
-	}
 }
 
 static void
@@ -3164,7 +3257,6 @@ realize_start_setup (NMDevice *self,
 	static guint32 id = 0;
 	NMDeviceCapabilities capabilities = 0;
 	NMConfig *config;
-	guint real_rate;
 	guint32 mtu;
 
 	g_return_if_fail (NM_IS_DEVICE (self));
@@ -3175,7 +3267,7 @@ realize_start_setup (NMDevice *self,
 	g_return_if_fail (!priv->real);
 	g_return_if_fail (nm_device_get_unmanaged_flags (self, NM_UNMANAGED_PLATFORM_INIT));
 	g_return_if_fail (priv->ip_ifindex <= 0);
-	g_return_if_fail (priv->ip_iface == NULL);
+	g_return_if_fail (priv->ip_iface_ == NULL);
 	g_return_if_fail (!priv->queued_ip4_config_id);
 	g_return_if_fail (!priv->queued_ip6_config_id);
 
@@ -3276,10 +3368,8 @@ realize_start_setup (NMDevice *self,
 
 	device_init_sriov_num_vfs (self);
 
-	nm_assert (!priv->stats.timeout_id);
-	real_rate = _stats_refresh_rate_real (priv->stats.refresh_rate_ms);
-	if (real_rate)
-		priv->stats.timeout_id = g_timeout_add (real_rate, _stats_timeout_cb, self);
+	nm_assert (!priv->stats.active);
+	_stats_set_active (self, TRUE);
 
 	nm_device_set_autoconnect_full (self, !!DEFAULT_AUTOCONNECT, TRUE);
 
@@ -3409,7 +3499,7 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 
-	g_return_val_if_fail (priv->iface != NULL, FALSE);
+	g_return_val_if_fail (priv->iface_ != NULL, FALSE);
 	g_return_val_if_fail (priv->real, FALSE);
 
 	g_object_freeze_notify (G_OBJECT (self));
@@ -3438,7 +3528,8 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 		_notify (self, PROP_IFINDEX);
 	}
 	priv->ip_ifindex = 0;
-	if (nm_clear_g_free (&priv->ip_iface))
+	_link_subscriptions_update (self, TRUE);
+	if (nm_clear_ref_string (&priv->ip_iface_))
 		_notify (self, PROP_IP_IFACE);
 
 	if (priv->mtu != 0) {
@@ -3463,7 +3554,7 @@ nm_device_unrealize (NMDevice *self, gboolean remove_resources, GError **error)
 		_notify (self, PROP_PHYSICAL_PORT_ID);
 	}
 
-	nm_clear_g_source (&priv->stats.timeout_id);
+	_stats_set_active (self, FALSE);
 	_stats_update_counters (self, 0, 0);
 
 	priv->hw_addr_len_ = 0;
@@ -6433,8 +6524,10 @@ ip6_config_merge_and_apply (NMDevice *self,
 			                                                       nm_device_get_ip_ifindex (self),
 			                                                       FALSE,
 			                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
-			if (priv->ext_ip6_config_captured)
-				priv->ext_ip6_config = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
+			if (priv->ext_ip6_config_captured) {
+				nm_ip6_config_seal (priv->ext_ip6_config_captured);
+				priv->ext_ip6_config = g_object_ref (priv->ext_ip6_config_captured);
+			}
 		}
 	}
 
@@ -7540,13 +7633,18 @@ addrconf6_start_with_link_ready (NMDevice *self)
 
 	/* XXX: These sysctls would probably be better set by the lndp ndisc itself. */
 	switch (nm_ndisc_get_node_type (priv->ndisc)) {
-	case NM_NDISC_NODE_TYPE_HOST:
+	case NM_NDISC_NODE_TYPE_HOST: {
+		static const NMPlatformSysctlEntry entries[] = {
+			{ "accept_ra",          "1" },
+			{ "accept_ra_defrtr",   "0" },
+			{ "accept_ra_pinfo",    "0" },
+			{ "accept_ra_rtr_pref", "0" },
+		};
+
 		/* Accepting prefixes from discovered routers. */
-		nm_device_ipv6_sysctl_set (self, "accept_ra", "1");
-		nm_device_ipv6_sysctl_set (self, "accept_ra_defrtr", "0");
-		nm_device_ipv6_sysctl_set (self, "accept_ra_pinfo", "0");
-		nm_device_ipv6_sysctl_set (self, "accept_ra_rtr_pref", "0");
+		_ipv6_sysctl_set_batch (self, entries, G_N_ELEMENTS (entries));
 		break;
+	}
 	case NM_NDISC_NODE_TYPE_ROUTER:
 		/* We're the router. */
 		nm_device_ipv6_sysctl_set (self, "forwarding", "1");
@@ -7916,6 +8014,8 @@ act_stage3_ip6_config_start (NMDevice *self,
 	                                                       nm_device_get_ip_ifindex (self),
 	                                                       FALSE,
 	                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
+	if (priv->ext_ip6_config_captured)
+		nm_ip6_config_seal (priv->ext_ip6_config_captured);
 
 	ip6_privacy = _ip6_privacy_get (self);
 
@@ -9670,6 +9770,7 @@ _device_activate (NMDevice *self, NMActRequest *req)
 {
 	NMDevicePrivate *priv;
 	NMConnection *connection;
+	int ifindex;
 
 	g_return_val_if_fail (NM_IS_DEVICE (self), FALSE);
 	g_return_val_if_fail (NM_IS_ACT_REQUEST (req), FALSE);
@@ -9692,6 +9793,12 @@ _device_activate (NMDevice *self, NMActRequest *req)
 
 	delete_on_deactivate_unschedule (self);
 
+	/* somebody might have changed the sysctl values since we last set
+	 * them. Write them again during this activation. */
+	ifindex = nm_device_get_ip_ifindex (self);
+	if (ifindex > 0)
+		nm_platform_sysctl_ifdir_invalidate (nm_device_get_platform (self), ifindex);
+
 	act_request_set (self, req);
 
 	nm_device_activate_schedule_stage1_device_prepare (self);
@@ -9927,7 +10034,8 @@ nm_device_set_ip4_config (NMDevice *self,
 		_commit_mtu (self, new_config);
 		success = nm_ip4_config_commit (new_config,
 		                                nm_device_get_platform (self),
-		                                default_route_metric);
+		                                default_route_metric,
+		                                &priv->ip4_commit_state);
 	}
 
 	if (new_config) {
@@ -9952,6 +10060,7 @@ nm_device_set_ip4_config (NMDevice *self,
 	} else if (old_config) {
 		has_changes = TRUE;
 		priv->ip4_config = NULL;
+		nm_ip_config_commit_state_clear (&priv->ip4_commit_state);
 		_LOGD (LOGD_IP4, "ip4-config: clear IP4Config instance (%s)",
 		       nm_exported_object_get_path (NM_EXPORTED_OBJECT (old_config)));
 		/* Device config is invalid if combined config is invalid */
@@ -10093,7 +10202,8 @@ nm_device_set_ip6_config (NMDevice *self,
 	if (commit && new_config) {
 		_commit_mtu (self, priv->ip4_config);
 		success = nm_ip6_config_commit (new_config,
-		                                nm_device_get_platform (self));
+		                                nm_device_get_platform (self),
+		                                &priv->ip6_commit_state);
 	}
 
 	if (new_config) {
@@ -10119,6 +10229,7 @@ nm_device_set_ip6_config (NMDevice *self,
 		has_changes = TRUE;
 		priv->ip6_config = NULL;
 		priv->needs_ip6_subnet = FALSE;
+		nm_ip_config_commit_state_clear (&priv->ip6_commit_state);
 		_LOGD (LOGD_IP6, "ip6-config: clear IP6Config instance (%s)",
 		       nm_exported_object_get_path (NM_EXPORTED_OBJECT (old_config)));
 	}
@@ -10862,7 +10973,10 @@ update_ip6_config (NMDevice *self, gboolean initial)
 	                                                       NM_SETTING_IP6_CONFIG_PRIVACY_UNKNOWN);
 	if (priv->ext_ip6_config_captured) {
 
-		priv->ext_ip6_config = nm_ip6_config_new_cloned (priv->ext_ip6_config_captured);
+		/* the captured config is sealed and shared with ext_ip6_config. It
+		 * only gets cloned below, if there is something to subtract. */
+		nm_ip6_config_seal (priv->ext_ip6_config_captured);
+		priv->ext_ip6_config = g_object_ref (priv->ext_ip6_config_captured);
 
 		/* This function was called upon external changes. Remove the configuration
 		 * (addresses,routes) that is no longer present externally from the internal
@@ -10882,6 +10996,12 @@ update_ip6_config (NMDevice *self, gboolean initial)
 		/* Remove parts from ext_ip6_config to only contain the information that
 		 * was configured externally -- we already have the same configuration from
 		 * internal origins. */
+		if (   priv->con_ip6_config
+		    || priv->ac_ip6_config
+		    || priv->dhcp6.ip6_config
+		    || priv->wwan_ip6_config
+		    || priv->vpn6_configs)
+			nm_ip6_config_unshare (&priv->ext_ip6_config);
 		if (priv->con_ip6_config)
 			nm_ip6_config_subtract (priv->ext_ip6_config, priv->con_ip6_config);
 		if (priv->ac_ip6_config)
@@ -11015,20 +11135,13 @@ queued_ip6_config_change (gpointer user_data)
 }
 
 static void
-device_ipx_changed (NMPlatform *platform,
-                    int obj_type_i,
-                    int ifindex,
-                    gpointer platform_object,
-                    int change_type_i,
-                    NMDevice *self)
+device_ipx_changed (NMDevice *self,
+                    NMPObjectType obj_type,
+                    const NMPlatformChange *change)
 {
-	const NMPObjectType obj_type = obj_type_i;
-	const NMPlatformSignalChangeType change_type = change_type_i;
+	const NMPlatformSignalChangeType change_type = change->change_type;
 	NMDevicePrivate *priv;
-	NMPlatformIP6Address *addr;
-
-	if (nm_device_get_ip_ifindex (self) != ifindex)
-		return;
+	const NMPlatformIP6Address *addr;
 
 	priv = NM_DEVICE_GET_PRIVATE (self);
 
@@ -11045,7 +11158,7 @@ device_ipx_changed (NMPlatform *platform,
 		}
 		break;
 	case NMP_OBJECT_TYPE_IP6_ADDRESS:
-		addr = platform_object;
+		addr = NMP_OBJECT_CAST_IP6_ADDRESS (change->obj_new ?: change->obj_old);
 
 		if (   priv->state > NM_DEVICE_STATE_DISCONNECTED
 		    && priv->state < NM_DEVICE_STATE_DEACTIVATING
@@ -11070,6 +11183,33 @@ device_ipx_changed (NMPlatform *platform,
 	}
 }
 
+static void
+platform_changes_batch_cb (NMPlatform *platform,
+                           int obj_type_i,
+                           const NMPlatformChange *changes,
+                           guint n_changes,
+                           NMDevice *self)
+{
+	const NMPObjectType obj_type = obj_type_i;
+	int ip_ifindex;
+	guint i;
+
+	/* link changes are handled by link_subscription_cb(). */
+	if (obj_type == NMP_OBJECT_TYPE_LINK)
+		return;
+
+	ip_ifindex = nm_device_get_ip_ifindex (self);
+	if (ip_ifindex <= 0)
+		return;
+
+	for (i = 0; i < n_changes; i++) {
+		const NMPObject *obj = changes[i].obj_new ?: changes[i].obj_old;
+
+		if (obj->object.ifindex == ip_ifindex)
+			device_ipx_changed (self, obj_type, &changes[i]);
+	}
+}
+
 /*****************************************************************************/
 
 NM_UTILS_FLAGS2STR_DEFINE (nm_unmanaged_flags2str, NMUnmanagedFlags,
@@ -12224,9 +12364,18 @@ nm_device_cleanup (NMDevice *self, NMDeviceStateReason reason, CleanupType clean
 
 	/* Turn off kernel IPv6 */
 	if (cleanup_type == CLEANUP_TYPE_DECONFIGURE) {
+		static const NMPlatformSysctlEntry entries[] = {
+			{ "accept_ra",    "0" },
+			{ "use_tempaddr", "0" },
+		};
+
+		/* don't skip writing values that somebody else changed meanwhile. */
+		ifindex = nm_device_get_ip_ifindex (self);
+		if (ifindex > 0)
+			nm_platform_sysctl_ifdir_invalidate (nm_device_get_platform (self), ifindex);
+
 		set_disable_ipv6 (self, "1");
-		nm_device_ipv6_sysctl_set (self, "accept_ra", "0");
-		nm_device_ipv6_sysctl_set (self, "use_tempaddr", "0");
+		_ipv6_sysctl_set_batch (self, entries, G_N_ELEMENTS (entries));
 	}
 
 	/* Call device type-specific deactivation */
@@ -12501,13 +12650,17 @@ notify_ip_properties (NMDevice *self)
 static void
 ip6_managed_setup (NMDevice *self)
 {
+	static const NMPlatformSysctlEntry entries[] = {
+		{ "accept_ra_defrtr",   "0" },
+		{ "accept_ra_pinfo",    "0" },
+		{ "accept_ra_rtr_pref", "0" },
+		{ "use_tempaddr",       "0" },
+		{ "forwarding",         "0" },
+	};
+
 	set_nm_ipv6ll (self, TRUE);
 	set_disable_ipv6 (self, "1");
-	nm_device_ipv6_sysctl_set (self, "accept_ra_defrtr", "0");
-	nm_device_ipv6_sysctl_set (self, "accept_ra_pinfo", "0");
-	nm_device_ipv6_sysctl_set (self, "accept_ra_rtr_pref", "0");
-	nm_device_ipv6_sysctl_set (self, "use_tempaddr", "0");
-	nm_device_ipv6_sysctl_set (self, "forwarding", "0");
+	_ipv6_sysctl_set_batch (self, entries, G_N_ELEMENTS (entries));
 }
 
 static void
@@ -12852,7 +13005,7 @@ _set_state_full (NMDevice *self,
 		break;
 	case NM_DEVICE_STATE_IP_CHECK:
 		if (   priv->fw_state >= FIREWALL_STATE_INITIALIZED
-		    && priv->ip_iface
+		    && priv->ip_iface_
 		    && !nm_device_sys_iface_state_is_external (self)) {
 			priv->fw_state = FIREWALL_STATE_WAIT_IP_CONFIG;
 			fw_change_zone (self);
@@ -13853,9 +14006,9 @@ constructor (GType type,
 	self = NM_DEVICE (object);
 	priv = NM_DEVICE_GET_PRIVATE (self);
 
-	if (   priv->iface
+	if (   priv->iface_
 	    && G_LIKELY (!nm_utils_get_testing ())) {
-		pllink = nm_platform_link_get_by_ifname (nm_device_get_platform (self), priv->iface);
+		pllink = nm_platform_link_get_by_ifname (nm_device_get_platform (self), priv->iface_->str);
 
 		if (pllink && link_type_compatible (self, pllink->type, NULL, NULL)) {
 			priv->ifindex = pllink->ifindex;
@@ -13892,11 +14045,8 @@ constructed (GObject *object)
 
 	/* Watch for external IP config changes */
 	platform = nm_device_get_platform (self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (device_ipx_changed), self);
-	g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (link_changed_cb), self);
+	g_signal_connect (platform, NM_PLATFORM_SIGNAL_CHANGES_BATCH, G_CALLBACK (platform_changes_batch_cb), self);
+	_link_subscriptions_update (self, TRUE);
 
 	priv->settings = g_object_ref (NM_SETTINGS_GET);
 	g_assert (priv->settings);
@@ -13935,8 +14085,7 @@ dispose (GObject *object)
 	_parent_set_ifindex (self, 0, FALSE);
 
 	platform = nm_device_get_platform (self);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (device_ipx_changed), self);
-	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (link_changed_cb), self);
+	g_signal_handlers_disconnect_by_func (platform, G_CALLBACK (platform_changes_batch_cb), self);
 
 	g_slist_free_full (priv->arping.dad_list, (GDestroyNotify) nm_arping_manager_destroy);
 	priv->arping.dad_list = NULL;
@@ -13968,7 +14117,7 @@ dispose (GObject *object)
 
 	nm_clear_g_source (&priv->check_delete_unrealized_id);
 
-	nm_clear_g_source (&priv->stats.timeout_id);
+	_stats_set_active (self, FALSE);
 
 	carrier_disconnected_action_cancel (self);
 
@@ -13977,6 +14126,9 @@ dispose (GObject *object)
 		_notify (self, PROP_IFINDEX);
 	}
 
+	/* the cleanup above still updates the ip-ifindex, only unsubscribe now. */
+	_link_subscriptions_update (self, FALSE);
+
 	if (priv->settings) {
 		g_signal_handlers_disconnect_by_func (priv->settings, cp_connection_added, self);
 		g_signal_handlers_disconnect_by_func (priv->settings, cp_connection_updated, self);
@@ -14026,9 +14178,9 @@ finalize (GObject *object)
 	g_slist_free_full (priv->dad6_failed_addrs, g_free);
 	g_clear_pointer (&priv->physical_port_id, g_free);
 	g_free (priv->udi);
-	g_free (priv->iface);
-	g_free (priv->ip_iface);
-	g_free (priv->driver);
+	nm_ref_string_unref (priv->iface_);
+	nm_ref_string_unref (priv->ip_iface_);
+	nm_ref_string_unref (priv->driver_);
 	g_free (priv->driver_version);
 	g_free (priv->firmware_version);
 	g_free (priv->type_desc);
@@ -14039,6 +14191,9 @@ finalize (GObject *object)
 	g_hash_table_unref (priv->ip6_saved_properties);
 	g_hash_table_unref (priv->available_connections);
 
+	nm_ip_config_commit_state_clear (&priv->ip4_commit_state);
+	nm_ip_config_commit_state_clear (&priv->ip6_commit_state);
+
 	G_OBJECT_CLASS (nm_device_parent_class)->finalize (object);
 
 	/* for testing, NMDeviceTest does not invoke NMDevice::constructed,
@@ -14063,11 +14218,11 @@ set_property (GObject *object, guint prop_id,
 		break;
 	case PROP_IFACE:
 		/* construct-only */
-		priv->iface = g_value_dup_string (value);
+		priv->iface_ = nm_ref_string_new (g_value_get_string (value));
 		break;
 	case PROP_DRIVER:
 		/* construct-only */
-		priv->driver = g_value_dup_string (value);
+		priv->driver_ = nm_ref_string_new (g_value_get_string (value));
 		break;
 	case PROP_DRIVER_VERSION:
 		/* construct-only */
@@ -14167,7 +14322,7 @@ get_property (GObject *object, guint prop_id,
 		break;
 	case PROP_IFACE:
 		g_value_take_string (value,
-		                     nm_utils_str_utf8safe_escape_cp (priv->iface,
+		                     nm_utils_str_utf8safe_escape_cp (nm_ref_string_get_str (priv->iface_),
 		                                                      NM_UTILS_STR_UTF8_SAFE_FLAG_ESCAPE_CTRL));
 		break;
 	case PROP_IP_IFACE:
@@ -14183,7 +14338,7 @@ get_property (GObject *object, guint prop_id,
 		break;
 	case PROP_DRIVER:
 		g_value_take_string (value,
-		                     nm_utils_str_utf8safe_escape_cp (priv->driver,
+		                     nm_utils_str_utf8safe_escape_cp (nm_ref_string_get_str (priv->driver_),
 		                                                      NM_UTILS_STR_UTF8_SAFE_FLAG_ESCAPE_CTRL));
 		break;
 	case PROP_DRIVER_VERSION:
@@ -381,7 +381,20 @@ main (int argc, char *argv[])
 	             );
 
 	/* Set up platform interaction layer */
-	nm_linux_platform_setup ();
+	{
+		gs_free char *ignore_route_tables = NULL;
+		gs_free char *ignore_route_protocols = NULL;
+
+		ignore_route_tables = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+		                                                NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                                NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_ROUTE_TABLES,
+		                                                NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		ignore_route_protocols = nm_config_data_get_value (NM_CONFIG_GET_DATA_ORIG,
+		                                                   NM_CONFIG_KEYFILE_GROUP_MAIN,
+		                                                   NM_CONFIG_KEYFILE_KEY_MAIN_IGNORE_ROUTE_PROTOCOLS,
+		                                                   NM_CONFIG_GET_VALUE_STRIP | NM_CONFIG_GET_VALUE_NO_EMPTY);
+		nm_linux_platform_setup_full (ignore_route_tables, ignore_route_protocols);
+	}
 
 	NM_UTILS_KEEP_ALIVE (config, nm_netns_get (), "NMConfig-depends-on-NMNetns");
 
@@ -43,9 +43,14 @@ NM_GOBJECT_PROPERTIES_DEFINE_BASE (
 );
 
 typedef struct {
+	/* the entries, always kept sorted by _sort_entries_cmp(). */
 	GPtrArray *entries_ip4;
 	GPtrArray *entries_ip6;
 
+	/* index of the entries by their source. */
+	GHashTable *entries_by_source_ip4;
+	GHashTable *entries_by_source_ip6;
+
 	NMPlatform *platform;
 
 	struct {
@@ -188,26 +193,127 @@ typedef struct {
 	gboolean never_default;
 
 	guint32 effective_metric;
+
+	/* the position of the entry in the sorted entries array. */
+	guint idx;
 } Entry;
 
 typedef struct {
 	const NMPlatformVTableRoute *vt;
 	GPtrArray *(*get_entries) (NMDefaultRouteManagerPrivate *priv);
+	GHashTable *(*get_entries_by_source) (NMDefaultRouteManagerPrivate *priv);
 } VTableIP;
 
 static const VTableIP vtable_ip4, vtable_ip6;
 
+/*****************************************************************************/
+
+/* Hash tables to look up platform routes and entries by their ifindex
+ * and (effective) metric, instead of scanning all of them. */
+
+static guint
+_ifindex_metric_hash (int ifindex, guint32 metric)
+{
+	return ((guint) ifindex * 1103515245u) ^ metric;
+}
+
+static guint
+_route_ifindex_metric_hash (gconstpointer ptr)
+{
+	const NMPlatformIPRoute *r = ptr;
+
+	return _ifindex_metric_hash (r->ifindex, r->metric);
+}
+
+static gboolean
+_route_ifindex_metric_equal (gconstpointer a, gconstpointer b)
+{
+	const NMPlatformIPRoute *r_a = a;
+	const NMPlatformIPRoute *r_b = b;
+
+	return    r_a->ifindex == r_b->ifindex
+	       && r_a->metric == r_b->metric;
+}
+
+static guint
+_entry_ifindex_metric_hash (gconstpointer ptr)
+{
+	const Entry *e = ptr;
+
+	return _ifindex_metric_hash (e->route.rx.ifindex, e->effective_metric);
+}
+
+static gboolean
+_entry_ifindex_metric_equal (gconstpointer a, gconstpointer b)
+{
+	const Entry *e_a = a;
+	const Entry *e_b = b;
+
+	return    e_a->route.rx.ifindex == e_b->route.rx.ifindex
+	       && e_a->effective_metric == e_b->effective_metric;
+}
+
+/* returns a set of the @routes, keyed by ifindex and metric. For routes
+ * with the same ifindex and metric, only the first one is in the set. */
+static GHashTable *
+_routes_idx_new (const GPtrArray *routes)
+{
+	GHashTable *routes_idx;
+	guint i;
+
+	routes_idx = g_hash_table_new (_route_ifindex_metric_hash, _route_ifindex_metric_equal);
+	if (routes) {
+		for (i = 0; i < routes->len; i++) {
+			const NMPlatformIPRoute *r = NMP_OBJECT_CAST_IP_ROUTE (routes->pdata[i]);
+
+			if (!g_hash_table_contains (routes_idx, r))
+				g_hash_table_add (routes_idx, (gpointer) r);
+		}
+	}
+	return routes_idx;
+}
+
+/* returns the set of ifindexes that have a synced entry. */
+static GHashTable *
+_synced_ifindexes_new (const GPtrArray *entries)
+{
+	GHashTable *synced_ifindexes;
+	guint i;
+
+	synced_ifindexes = g_hash_table_new (NULL, NULL);
+	for (i = 0; i < entries->len; i++) {
+		const Entry *e = g_ptr_array_index (entries, i);
+
+		if (e->synced)
+			g_hash_table_add (synced_ifindexes, GINT_TO_POINTER (e->route.rx.ifindex));
+	}
+	return synced_ifindexes;
+}
+
+/*****************************************************************************/
+
 static gboolean
-_vt_routes_has_entry (const VTableIP *vtable, const GPtrArray *routes, const Entry *entry)
+_vt_routes_has_entry (const VTableIP *vtable, const GPtrArray *routes, GHashTable *routes_idx, const Entry *entry)
 {
 	guint i;
 	NMPlatformIPXRoute route = entry->route;
+	const NMPlatformIPRoute *r_idx;
 
 	if (!routes)
 		return FALSE;
 
 	route.rx.metric = entry->effective_metric;
 
+	/* the routes cannot be equal, unless ifindex and metric match. Usually,
+	 * the first route with that ifindex and metric is already the one we
+	 * are looking for. */
+	r_idx = g_hash_table_lookup (routes_idx, &route.rx);
+	if (!r_idx)
+		return FALSE;
+	route.rx.rt_source = r_idx->rt_source;
+	if (vtable->vt->route_cmp ((const NMPlatformIPXRoute *) r_idx, &route, NM_PLATFORM_IP_ROUTE_CMP_TYPE_FULL) == 0)
+		return TRUE;
+
 	if (vtable->vt->is_ip4) {
 		for (i = 0; i < routes->len; i++) {
 			const NMPlatformIP4Route *r = NMP_OBJECT_CAST_IP4_ROUTE (routes->pdata[i]);
@@ -237,24 +343,122 @@ _entry_free (Entry *entry)
 	}
 }
 
-static Entry *
-_entry_find_by_source (GPtrArray *entries, gpointer source, guint *out_idx)
+static int _sort_entries_cmp (gconstpointer a, gconstpointer b, gpointer user_data);
+
+/* returns the index of the first of the first @len (sorted) @entries that
+ * doesn't sort before @entry. With @upper, the first one that sorts after
+ * @entry. */
+static guint
+_entries_bsearch (const GPtrArray *entries, guint len, const Entry *entry, gboolean upper)
 {
-	guint i;
+	guint lo = 0;
+	guint hi = len;
 
-	for (i = 0; i < entries->len; i++) {
-		Entry *e = g_ptr_array_index (entries, i);
+	while (lo < hi) {
+		guint mid = lo + (hi - lo) / 2;
+		int c;
 
-		if (e->source.pointer == source) {
-			if (out_idx)
-				*out_idx = i;
-			return e;
-		}
+		c = _sort_entries_cmp (&entries->pdata[mid], &entry, NULL);
+		if (c < 0 || (upper && c == 0))
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
+	return lo;
+}
 
-	if (out_idx)
-		*out_idx = G_MAXUINT;
-	return NULL;
+static Entry *
+_entry_find_by_source (GHashTable *entries_by_source, gpointer source, guint *out_idx)
+{
+	Entry *entry;
+
+	entry = g_hash_table_lookup (entries_by_source, source);
+	NM_SET_OUT (out_idx, entry ? entry->idx : G_MAXUINT);
+	return entry;
+}
+
+static void
+_entries_update_idx (GPtrArray *entries, guint from, guint to)
+{
+	for (; from < to; from++)
+		((Entry *) entries->pdata[from])->idx = from;
+}
+
+/* the entry at @entry_idx was added or changed, while all other entries
+ * are still sorted. Move it to the position where a (stable) sort of the
+ * entries would put it: after the equal entries that were before it and
+ * before the equal entries that were after it.
+ *
+ * Returns: the new index of the entry. */
+static guint
+_entries_reposition (GPtrArray *entries, guint entry_idx)
+{
+	Entry *entry;
+	guint len, lower, upper, idx;
+
+	nm_assert (entry_idx < entries->len);
+
+	entry = entries->pdata[entry_idx];
+	len = entries->len - 1;
+
+	memmove (&entries->pdata[entry_idx],
+	         &entries->pdata[entry_idx + 1],
+	         (len - entry_idx) * sizeof (gpointer));
+
+	lower = _entries_bsearch (entries, len, entry, FALSE);
+	upper = _entries_bsearch (entries, len, entry, TRUE);
+	idx = CLAMP (entry_idx, lower, upper);
+
+	memmove (&entries->pdata[idx + 1],
+	         &entries->pdata[idx],
+	         (len - idx) * sizeof (gpointer));
+	entries->pdata[idx] = entry;
+
+	/* only the entries between the old and the new position moved. */
+	_entries_update_idx (entries, MIN (entry_idx, idx), MAX (entry_idx, idx) + 1);
+
+#if NM_MORE_ASSERTS > 5
+	for (len = 1; len < entries->len; len++)
+		nm_assert (_sort_entries_cmp (&entries->pdata[len - 1], &entries->pdata[len], NULL) <= 0);
+	for (len = 0; len < entries->len; len++)
+		nm_assert (((Entry *) entries->pdata[len])->idx == len);
+#endif
+
+	return idx;
+}
+
+/* append the new @entry to the @entries. The caller must move it into
+ * place with _entries_reposition().
+ *
+ * Returns: the index of the entry. */
+static guint
+_entries_append (GPtrArray *entries, GHashTable *entries_by_source, Entry *entry)
+{
+	nm_assert (!g_hash_table_contains (entries_by_source, entry->source.pointer));
+
+	entry->idx = entries->len;
+	g_ptr_array_add (entries, entry);
+	g_hash_table_insert (entries_by_source, entry->source.pointer, entry);
+	return entry->idx;
+}
+
+/* remove the entry at @entry_idx, without freeing it.
+ *
+ * Returns: the removed entry, which the caller must free. */
+static Entry *
+_entries_steal (GPtrArray *entries, GHashTable *entries_by_source, guint entry_idx)
+{
+	Entry *entry;
+
+	nm_assert (entry_idx < entries->len);
+
+	entry = entries->pdata[entry_idx];
+	if (!g_hash_table_remove (entries_by_source, entry->source.pointer))
+		nm_assert_not_reached ();
+	entries->pdata[entry_idx] = NULL;
+	g_ptr_array_remove_index (entries, entry_idx);
+	_entries_update_idx (entries, entry_idx, entries->len);
+	return entry;
 }
 
 static gboolean
@@ -372,12 +576,13 @@ _platform_route_sync_add (const VTableIP *vtable, NMDefaultRouteManager *self, g
 }
 
 static gboolean
-_platform_route_sync_flush (const VTableIP *vtable, NMDefaultRouteManager *self, int ifindex_to_flush)
+_platform_route_sync_flush (const VTableIP *vtable, NMDefaultRouteManager *self, GHashTable *synced_ifindexes, int ifindex_to_flush)
 {
 	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
 	GPtrArray *entries = vtable->get_entries (priv);
 	gs_unref_ptrarray GPtrArray *routes = NULL;
-	guint i, j;
+	gs_unref_hashtable GHashTable *synced_entries = NULL;
+	guint i;
 	gboolean changed = FALSE;
 
 	/* prune all other default routes from this device. */
@@ -389,26 +594,28 @@ _platform_route_sync_flush (const VTableIP *vtable, NMDefaultRouteManager *self,
 	if (!routes)
 		return FALSE;
 
+	/* the synced entries with a default route, by ifindex and effective metric. */
+	synced_entries = g_hash_table_new (_entry_ifindex_metric_hash, _entry_ifindex_metric_equal);
+	for (i = 0; i < entries->len; i++) {
+		Entry *e = g_ptr_array_index (entries, i);
+
+		if (e->synced && !e->never_default)
+			g_hash_table_add (synced_entries, e);
+	}
+
 	for (i = 0; i < routes->len; i++) {
 		const NMPlatformIPRoute *route;
-		gboolean has_ifindex_synced = FALSE;
-		Entry *entry = NULL;
+		gboolean has_ifindex_synced;
+		Entry *entry;
+		Entry needle;
 
 		route = NMP_OBJECT_CAST_IP_ROUTE (routes->pdata[i]);
 
-		/* look at all entries and see if the route for this ifindex pair is
-		 * a known entry. */
-		for (j = 0; j < entries->len; j++) {
-			Entry *e = g_ptr_array_index (entries, j);
-
-			if (   e->route.rx.ifindex == route->ifindex
-			    && e->synced) {
-				has_ifindex_synced = TRUE;
-				if (   !e->never_default
-				    && e->effective_metric == route->metric)
-					entry = e;
-			}
-		}
+		/* see if the route for this ifindex pair is a known entry. */
+		needle.route.rx.ifindex = route->ifindex;
+		needle.effective_metric = route->metric;
+		entry = g_hash_table_lookup (synced_entries, &needle);
+		has_ifindex_synced = g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (route->ifindex));
 
 		/* we only delete the route if we don't have a matching entry,
 		 * and there is at least one entry that references this ifindex
@@ -469,11 +676,11 @@ _sort_entries_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
 }
 
 static GHashTable *
-_get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *self, const GPtrArray *routes)
+_get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *self, const GPtrArray *routes, GHashTable *synced_ifindexes)
 {
 	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
 	GPtrArray *entries;
-	guint i, j;
+	guint i;
 	GHashTable *result;
 
 	/* create a list of all metrics that are currently assigned on an interface
@@ -487,22 +694,11 @@ _get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *s
 
 	if (routes) {
 		for (i = 0; i < routes->len; i++) {
-			gboolean ifindex_has_synced_entry = FALSE;
 			const NMPlatformIPRoute *route;
 
 			route = NMP_OBJECT_CAST_IP_ROUTE (routes->pdata[i]);
 
-			for (j = 0; j < entries->len; j++) {
-				Entry *e = g_ptr_array_index (entries, j);
-
-				if (   e->synced
-				    && e->route.rx.ifindex == route->ifindex) {
-					ifindex_has_synced_entry = TRUE;
-					break;
-				}
-			}
-
-			if (!ifindex_has_synced_entry)
+			if (!g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (route->ifindex)))
 				g_hash_table_add (result, GUINT_TO_POINTER (vtable->vt->metric_normalize (route->metric)));
 		}
 	}
@@ -511,23 +707,12 @@ _get_assumed_interface_metrics (const VTableIP *vtable, NMDefaultRouteManager *s
 	 * we track as non-synced but that are no longer part of platform routes. Anyway, for now
 	 * we still want to treat them as assumed. */
 	for (i = 0; i < entries->len; i++) {
-		gboolean ifindex_has_synced_entry = FALSE;
 		Entry *e_i = g_ptr_array_index (entries, i);
 
 		if (e_i->synced)
 			continue;
 
-		for (j = 0; j < entries->len; j++) {
-			Entry *e_j = g_ptr_array_index (entries, j);
-
-			if (   j != i
-			    && (e_j->synced && e_j->route.rx.ifindex == e_i->route.rx.ifindex)) {
-				ifindex_has_synced_entry = TRUE;
-				break;
-			}
-		}
-
-		if (!ifindex_has_synced_entry)
+		if (!g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (e_i->route.rx.ifindex)))
 			g_hash_table_add (result, GUINT_TO_POINTER (vtable->vt->metric_normalize (e_i->route.rx.metric)));
 	}
 
@@ -546,6 +731,8 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 	GArray *changed_metrics = g_array_new (FALSE, FALSE, sizeof (guint32));
 	GHashTable *assumed_metrics;
 	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_hashtable GHashTable *routes_idx = NULL;
+	gs_unref_hashtable GHashTable *synced_ifindexes = NULL;
 	gboolean changed = FALSE;
 	int ifindex_to_flush = 0;
 
@@ -563,12 +750,20 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 
 	entries = vtable->get_entries (priv);
 
+	/* This is not incremental: every change re-reads the default routes from
+	 * the platform cache and walks all entries once. The effective metric
+	 * of an entry depends on all entries that sort before it and on the
+	 * metrics of assumed routes, which can change externally. The walk is
+	 * linear in the number of entries and default routes, which are few. */
 	routes = nm_platform_lookup_route_default_clone (priv->platform,
 	                                                 vtable->vt->obj_type,
 	                                                 nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
 	                                                 NULL);
 
-	assumed_metrics = _get_assumed_interface_metrics (vtable, self, routes);
+	routes_idx = _routes_idx_new (routes);
+	synced_ifindexes = _synced_ifindexes_new (entries);
+
+	assumed_metrics = _get_assumed_interface_metrics (vtable, self, routes, synced_ifindexes);
 
 	if (old_entry && old_entry->synced && !old_entry->never_default) {
 		/* The old version obviously changed. */
@@ -583,22 +778,11 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 			continue;
 
 		if (!entry->synced) {
-			gboolean has_synced_entry = FALSE;
-
 			/* A non synced entry is completely ignored, if we have
 			 * a synced entry for the same if index.
 			 * Otherwise the metric of the entry is still remembered as
 			 * last_metric to avoid reusing it. */
-			for (j = 0; j < entries->len; j++) {
-				const Entry *e = g_ptr_array_index (entries, j);
-
-				if (   e->synced
-					&& e->route.rx.ifindex == entry->route.rx.ifindex) {
-					has_synced_entry = TRUE;
-					break;
-				}
-			}
-			if (!has_synced_entry)
+			if (!g_hash_table_contains (synced_ifindexes, GINT_TO_POINTER (entry->route.rx.ifindex)))
 				last_metric = MAX (last_metric, (gint64) entry->effective_metric);
 			continue;
 		}
@@ -609,24 +793,15 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 
 		while (   expected_metric < G_MAXUINT32
 		       && g_hash_table_contains (assumed_metrics, GUINT_TO_POINTER (expected_metric))) {
-			gboolean has_metric_for_ifindex = FALSE;
+			NMPlatformIPRoute needle;
 
 			/* Check if there are assumed devices that have default routes with this metric.
 			 * If there are any, we have to pick another effective_metric. */
 
 			/* However, if there is a matching route (ifindex+metric) for our current entry, we are done. */
-			if (routes) {
-				for (j = 0; j < routes->len; j++) {
-					const NMPlatformIPRoute *r = NMP_OBJECT_CAST_IP_ROUTE (routes->pdata[i]);
-
-					if (   r->metric == expected_metric
-					    && r->ifindex == entry->route.rx.ifindex) {
-						has_metric_for_ifindex = TRUE;
-						break;
-					}
-				}
-			}
-			if (has_metric_for_ifindex)
+			needle.ifindex = entry->route.rx.ifindex;
+			needle.metric = expected_metric;
+			if (g_hash_table_contains (routes_idx, &needle))
 				break;
 			expected_metric++;
 		}
@@ -653,7 +828,7 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 			        vtable->vt->route_to_string (&entry->route, NULL, 0), (guint) entry->effective_metric,
 			        (guint) expected_metric);
 		} else {
-			if (!_vt_routes_has_entry (vtable, routes, entry)) {
+			if (!_vt_routes_has_entry (vtable, routes, routes_idx, entry)) {
 				g_array_append_val (changed_metrics, entry->effective_metric);
 				_LOG2D (vtable, i, entry, "sync:re-add %s (%u -> %u)",
 				        vtable->vt->route_to_string (&entry->route, NULL, 0), (guint) entry->effective_metric,
@@ -691,7 +866,7 @@ _resync_all (const VTableIP *vtable, NMDefaultRouteManager *self, const Entry *c
 		ifindex_to_flush = old_entry->route.rx.ifindex;
 	}
 
-	changed |= _platform_route_sync_flush (vtable, self, ifindex_to_flush);
+	changed |= _platform_route_sync_flush (vtable, self, synced_ifindexes, ifindex_to_flush);
 
 	g_array_free (changed_metrics, TRUE);
 	g_hash_table_unref (assumed_metrics);
@@ -727,7 +902,7 @@ _entry_at_idx_update (const VTableIP *vtable, NMDefaultRouteManager *self, guint
 	        vtable->vt->route_to_string (&entry->route, NULL, 0),
 	        entry->effective_metric);
 
-	g_ptr_array_sort_with_data (entries, _sort_entries_cmp, NULL);
+	_entries_reposition (entries, entry_idx);
 
 	return _resync_all (vtable, self, entry, old_entry, FALSE);
 }
@@ -750,8 +925,7 @@ _entry_at_idx_remove (const VTableIP *vtable, NMDefaultRouteManager *self, guint
 	       vtable->vt->route_to_string (&entry->route, NULL, 0), (guint) entry->effective_metric);
 
 	/* Remove the entry from the list (but don't free it yet) */
-	g_ptr_array_index (entries, entry_idx) = NULL;
-	g_ptr_array_remove_index (entries, entry_idx);
+	_entries_steal (entries, vtable->get_entries_by_source (priv), entry_idx);
 
 	ret = _resync_all (vtable, self, NULL, entry, FALSE);
 	_entry_free (entry);
@@ -797,7 +971,7 @@ _ipx_update_default_route (const VTableIP *vtable,
 		ip_ifindex = nm_vpn_connection_get_ip_ifindex (vpn, TRUE);
 
 	entries = vtable->get_entries (priv);
-	entry = _entry_find_by_source (entries, source, &entry_idx);
+	entry = _entry_find_by_source (vtable->get_entries_by_source (priv), source, &entry_idx);
 
 	if (   entry
 	    && entry->route.rx.ifindex != ip_ifindex) {
@@ -807,7 +981,7 @@ _ipx_update_default_route (const VTableIP *vtable,
 
 		g_object_freeze_notify (G_OBJECT (self));
 		_entry_at_idx_remove (vtable, self, entry_idx);
-		g_assert (!_entry_find_by_source (entries, source, NULL));
+		g_assert (!_entry_find_by_source (vtable->get_entries_by_source (priv), source, NULL));
 		ret = _ipx_update_default_route (vtable, self, source);
 		g_object_thaw_notify (G_OBJECT (self));
 		return ret;
@@ -913,8 +1087,8 @@ _ipx_update_default_route (const VTableIP *vtable,
 		entry->effective_metric = entry->route.rx.metric;
 		entry->synced = synced;
 
-		g_ptr_array_add (entries, entry);
-		return _entry_at_idx_update (vtable, self, entries->len - 1, NULL);
+		entry_idx = _entries_append (entries, vtable->get_entries_by_source (priv), entry);
+		return _entry_at_idx_update (vtable, self, entry_idx, NULL);
 	} else if (default_route) {
 		/* update */
 		Entry old_entry, new_entry;
@@ -1028,6 +1202,8 @@ _ipx_get_best_device (const VTableIP *vtable, NMDefaultRouteManager *self, const
 {
 	NMDefaultRouteManagerPrivate *priv;
 	GPtrArray *entries;
+	gs_unref_hashtable GHashTable *devices_set = NULL;
+	const GSList *iter;
 	guint i;
 
 	g_return_val_if_fail (NM_IS_DEFAULT_ROUTE_MANAGER (self), NULL);
@@ -1040,6 +1216,10 @@ _ipx_get_best_device (const VTableIP *vtable, NMDefaultRouteManager *self, const
 		return NULL;
 	entries = vtable->get_entries (priv);
 
+	devices_set = g_hash_table_new (NULL, NULL);
+	for (iter = devices; iter; iter = iter->next)
+		g_hash_table_add (devices_set, iter->data);
+
 	for (i = 0; i < entries->len; i++) {
 		Entry *entry = g_ptr_array_index (entries, i);
 		NMDeviceState state;
@@ -1062,7 +1242,7 @@ _ipx_get_best_device (const VTableIP *vtable, NMDefaultRouteManager *self, const
 			continue;
 		}
 
-		if (g_slist_find ((GSList *) devices, entry->source.device)) {
+		if (g_hash_table_contains (devices_set, entry->source.device)) {
 			g_return_val_if_fail (nm_device_get_act_request (entry->source.pointer), entry->source.pointer);
 			return entry->source.pointer;
 		}
@@ -1102,7 +1282,7 @@ _ipx_get_best_activating_device (const VTableIP *vtable, NMDefaultRouteManager *
 		guint32 prio;
 		Entry *entry;
 
-		entry = _entry_find_by_source (vtable->get_entries (priv), device, NULL);
+		entry = _entry_find_by_source (vtable->get_entries_by_source (priv), device, NULL);
 
 		if (entry) {
 			/* of all the device that have an entry, we already know that best_activated_device
@@ -1294,6 +1474,109 @@ nm_default_route_manager_ip6_get_best_config (NMDefaultRouteManager *self,
 
 /*****************************************************************************/
 
+/* functions to test the bookkeeping of the entries, without
+ * touching the platform. */
+
+static const VTableIP *
+_nmtst_vtable (int addr_family)
+{
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+
+	return addr_family == AF_INET ? &vtable_ip4 : &vtable_ip6;
+}
+
+guint
+_nmtst_default_route_manager_entry_set (NMDefaultRouteManager *self,
+                                        int addr_family,
+                                        gpointer source,
+                                        guint32 metric,
+                                        gboolean never_default,
+                                        gboolean synced)
+{
+	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
+	const VTableIP *vtable = _nmtst_vtable (addr_family);
+	GPtrArray *entries = vtable->get_entries (priv);
+	Entry *entry;
+	guint entry_idx;
+
+	entry = _entry_find_by_source (vtable->get_entries_by_source (priv), source, &entry_idx);
+	if (!entry) {
+		entry = g_slice_new0 (Entry);
+		entry->source.object = g_object_ref (source);
+		entry_idx = _entries_append (entries, vtable->get_entries_by_source (priv), entry);
+	}
+	entry->route.rx.metric = metric;
+	entry->effective_metric = metric;
+	entry->never_default = never_default;
+	entry->synced = synced;
+	return _entries_reposition (entries, entry_idx);
+}
+
+void
+_nmtst_default_route_manager_entry_remove (NMDefaultRouteManager *self,
+                                           int addr_family,
+                                           gpointer source)
+{
+	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
+	const VTableIP *vtable = _nmtst_vtable (addr_family);
+	guint entry_idx;
+
+	if (!_entry_find_by_source (vtable->get_entries_by_source (priv), source, &entry_idx))
+		g_return_if_reached ();
+	_entry_free (_entries_steal (vtable->get_entries (priv), vtable->get_entries_by_source (priv), entry_idx));
+}
+
+guint
+_nmtst_default_route_manager_entry_find_by_source (NMDefaultRouteManager *self,
+                                                   int addr_family,
+                                                   gpointer source)
+{
+	NMDefaultRouteManagerPrivate *priv = NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self);
+	guint entry_idx;
+
+	_entry_find_by_source (_nmtst_vtable (addr_family)->get_entries_by_source (priv), source, &entry_idx);
+	return entry_idx;
+}
+
+guint
+_nmtst_default_route_manager_get_num_entries (NMDefaultRouteManager *self,
+                                              int addr_family)
+{
+	return _nmtst_vtable (addr_family)->get_entries (NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self))->len;
+}
+
+gpointer
+_nmtst_default_route_manager_entry_get_source (NMDefaultRouteManager *self,
+                                               int addr_family,
+                                               guint entry_idx)
+{
+	GPtrArray *entries = _nmtst_vtable (addr_family)->get_entries (NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self));
+
+	g_return_val_if_fail (entry_idx < entries->len, NULL);
+
+	return ((Entry *) entries->pdata[entry_idx])->source.pointer;
+}
+
+guint
+_nmtst_default_route_manager_entries_bsearch (NMDefaultRouteManager *self,
+                                              int addr_family,
+                                              guint32 metric,
+                                              gboolean never_default,
+                                              gboolean synced,
+                                              gboolean upper)
+{
+	GPtrArray *entries = _nmtst_vtable (addr_family)->get_entries (NM_DEFAULT_ROUTE_MANAGER_GET_PRIVATE (self));
+	Entry needle = {
+		.never_default = never_default,
+		.synced = synced,
+	};
+
+	needle.route.rx.metric = metric;
+	return _entries_bsearch (entries, entries->len, &needle, upper);
+}
+
+/*****************************************************************************/
+
 static GPtrArray *
 _v4_get_entries (NMDefaultRouteManagerPrivate *priv)
 {
@@ -1306,14 +1589,28 @@ _v6_get_entries (NMDefaultRouteManagerPrivate *priv)
 	return priv->entries_ip6;
 }
 
+static GHashTable *
+_v4_get_entries_by_source (NMDefaultRouteManagerPrivate *priv)
+{
+	return priv->entries_by_source_ip4;
+}
+
+static GHashTable *
+_v6_get_entries_by_source (NMDefaultRouteManagerPrivate *priv)
+{
+	return priv->entries_by_source_ip6;
+}
+
 static const VTableIP vtable_ip4 = {
 	.vt                             = &nm_platform_vtable_route_v4,
 	.get_entries                    = _v4_get_entries,
+	.get_entries_by_source          = _v4_get_entries_by_source,
 };
 
 static const VTableIP vtable_ip6 = {
 	.vt                             = &nm_platform_vtable_route_v6,
 	.get_entries                    = _v6_get_entries,
+	.get_entries_by_source          = _v6_get_entries_by_source,
 };
 
 /*****************************************************************************/
@@ -1453,12 +1750,25 @@ _resync_idle_reschedule (NMDefaultRouteManager *self)
 	}
 }
 
+static gboolean
+_platform_changes_has_default_route (const NMPlatformChange *changes, guint n_changes)
+{
+	guint i;
+
+	for (i = 0; i < n_changes; i++) {
+		const NMPObject *obj = changes[i].obj_new ?: changes[i].obj_old;
+
+		if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (&obj->ip_route))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 static void
 _platform_changed_cb (NMPlatform *platform,
                       int obj_type_i,
-                      int ifindex,
-                      gpointer platform_object,
-                      int change_type_i,
+                      const NMPlatformChange *changes,
+                      guint n_changes,
                       NMDefaultRouteManager *self)
 {
 	NMDefaultRouteManagerPrivate *priv;
@@ -1466,6 +1776,8 @@ _platform_changed_cb (NMPlatform *platform,
 	const VTableIP *vtable;
 
 	switch (obj_type) {
+	case NMP_OBJECT_TYPE_LINK:
+		return;
 	case NMP_OBJECT_TYPE_IP4_ADDRESS:
 		vtable = &vtable_ip4;
 		break;
@@ -1473,12 +1785,12 @@ _platform_changed_cb (NMPlatform *platform,
 		vtable = &vtable_ip6;
 		break;
 	case NMP_OBJECT_TYPE_IP4_ROUTE:
-		if (!NM_PLATFORM_IP_ROUTE_IS_DEFAULT (platform_object))
+		if (!_platform_changes_has_default_route (changes, n_changes))
 			return;
 		vtable = &vtable_ip4;
 		break;
 	case NMP_OBJECT_TYPE_IP6_ROUTE:
-		if (!NM_PLATFORM_IP_ROUTE_IS_DEFAULT (platform_object))
+		if (!_platform_changes_has_default_route (changes, n_changes))
 			return;
 		vtable = &vtable_ip6;
 		break;
@@ -1543,11 +1855,10 @@ constructed (GObject *object)
 
 	priv->entries_ip4 = g_ptr_array_new_full (0, (GDestroyNotify) _entry_free);
 	priv->entries_ip6 = g_ptr_array_new_full (0, (GDestroyNotify) _entry_free);
+	priv->entries_by_source_ip4 = g_hash_table_new (NULL, NULL);
+	priv->entries_by_source_ip6 = g_hash_table_new (NULL, NULL);
 
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, G_CALLBACK (_platform_changed_cb), self);
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, G_CALLBACK (_platform_changed_cb), self);
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, G_CALLBACK (_platform_changed_cb), self);
-	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED, G_CALLBACK (_platform_changed_cb), self);
+	g_signal_connect (priv->platform, NM_PLATFORM_SIGNAL_CHANGES_BATCH, G_CALLBACK (_platform_changed_cb), self);
 }
 
 NMDefaultRouteManager *
@@ -1581,6 +1892,8 @@ dispose (GObject *object)
 	 * If you remove priv->dispose, you must refactor the lines below to remove enties
 	 * one-by-one.
 	 */
+	g_clear_pointer (&priv->entries_by_source_ip4, g_hash_table_unref);
+	g_clear_pointer (&priv->entries_by_source_ip6, g_hash_table_unref);
 	if (priv->entries_ip4) {
 		g_ptr_array_free (priv->entries_ip4, TRUE);
 		priv->entries_ip4 = NULL;
@@ -64,4 +64,29 @@ NMIP6Config *nm_default_route_manager_ip6_get_best_config (NMDefaultRouteManager
 gboolean nm_default_route_manager_resync (NMDefaultRouteManager *self,
                                           int af_family);
 
+/* for testing the bookkeeping of the entries. */
+guint _nmtst_default_route_manager_entry_set (NMDefaultRouteManager *self,
+                                              int addr_family,
+                                              gpointer source,
+                                              guint32 metric,
+                                              gboolean never_default,
+                                              gboolean synced);
+void _nmtst_default_route_manager_entry_remove (NMDefaultRouteManager *self,
+                                                int addr_family,
+                                                gpointer source);
+guint _nmtst_default_route_manager_entry_find_by_source (NMDefaultRouteManager *self,
+                                                         int addr_family,
+                                                         gpointer source);
+guint _nmtst_default_route_manager_get_num_entries (NMDefaultRouteManager *self,
+                                                    int addr_family);
+gpointer _nmtst_default_route_manager_entry_get_source (NMDefaultRouteManager *self,
+                                                        int addr_family,
+                                                        guint entry_idx);
+guint _nmtst_default_route_manager_entries_bsearch (NMDefaultRouteManager *self,
+                                                    int addr_family,
+                                                    guint32 metric,
+                                                    gboolean never_default,
+                                                    gboolean synced,
+                                                    gboolean upper);
+
 #endif  /* NM_DEFAULT_ROUTE_MANAGER_H */
@@ -125,7 +125,8 @@ dhcp4_state_changed (NMDhcpClient *client,
 		nm_ip4_config_merge (existing, ip4_config, NM_IP_CONFIG_MERGE_DEFAULT);
 		if (!nm_ip4_config_commit (existing,
 		                           NM_PLATFORM_GET,
-		                           global_opt.priority_v4))
+		                           global_opt.priority_v4,
+		                           NULL))
 			_LOGW (LOGD_DHCP4, "failed to apply DHCPv4 config");
 
 		if (last_config)
@@ -219,7 +220,7 @@ ndisc_config_changed (NMNDisc *ndisc, const NMNDiscData *rdata, guint changed_in
 	}
 
 	nm_ip6_config_merge (existing, ndisc_config, NM_IP_CONFIG_MERGE_DEFAULT);
-	if (!nm_ip6_config_commit (existing, NM_PLATFORM_GET))
+	if (!nm_ip6_config_commit (existing, NM_PLATFORM_GET, NULL))
 		_LOGW (LOGD_IP6, "failed to apply IPv6 config");
 }
 
@@ -0,0 +1,465 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nm-ip-config-set.h"
+
+#include <string.h>
+
+#include "nm-core-utils.h"
+
+/*****************************************************************************/
+
+/* up to this length, a linear search is cheaper than creating the index. */
+#define IDX_LEN_THRESHOLD 8
+
+/*****************************************************************************/
+
+static guint
+_ip6_hash (gconstpointer ptr)
+{
+	return nm_utils_in6_addr_hash (ptr);
+}
+
+static gboolean
+_ip6_equal (gconstpointer a, gconstpointer b)
+{
+	return IN6_ARE_ADDR_EQUAL ((const struct in6_addr *) a, (const struct in6_addr *) b);
+}
+
+/* returns the key of @elem for looking it up in the index. */
+static gconstpointer
+_idx_lookup_key (NMIPConfigSetType type, gconstpointer elem)
+{
+	if (type == NM_IP_CONFIG_SET_TYPE_IP4)
+		return GUINT_TO_POINTER (*((const guint32 *) elem));
+	return elem;
+}
+
+/* returns the element at @i, in the form that the public functions
+ * accept as @elem. */
+static gconstpointer
+_get_elem (const NMIPConfigSet *set, guint i)
+{
+	switch (set->type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		return &g_array_index (set->arr, guint32, i);
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		return &g_array_index (set->arr, struct in6_addr, i);
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		return set->strs->pdata[i];
+	}
+	nm_assert_not_reached ();
+	return NULL;
+}
+
+static gboolean
+_elem_equal (NMIPConfigSetType type, gconstpointer a, gconstpointer b)
+{
+	switch (type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		return *((const guint32 *) a) == *((const guint32 *) b);
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		return IN6_ARE_ADDR_EQUAL ((const struct in6_addr *) a, (const struct in6_addr *) b);
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		return nm_streq (a, b);
+	}
+	nm_assert_not_reached ();
+	return FALSE;
+}
+
+static void
+_idx_add (GHashTable *idx, NMIPConfigSetType type, gconstpointer elem)
+{
+	switch (type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		g_hash_table_add (idx, GUINT_TO_POINTER (*((const guint32 *) elem)));
+		return;
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		/* the elements of the array move around, the index owns a copy. */
+		g_hash_table_add (idx, g_memdup (elem, sizeof (struct in6_addr)));
+		return;
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		/* the string is owned by the array. */
+		g_hash_table_add (idx, (gpointer) elem);
+		return;
+	}
+	nm_assert_not_reached ();
+}
+
+static GHashTable *
+_idx_ensure (const NMIPConfigSet *set)
+{
+	NMIPConfigSet *set_mutable = (NMIPConfigSet *) set;
+	guint i, len;
+
+	/* the index is a cache, which is also created for const sets. */
+	if (set->idx)
+		return set->idx;
+
+	switch (set->type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		set_mutable->idx = g_hash_table_new (g_direct_hash, g_direct_equal);
+		break;
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		set_mutable->idx = g_hash_table_new_full (_ip6_hash, _ip6_equal, g_free, NULL);
+		break;
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		set_mutable->idx = g_hash_table_new (g_str_hash, g_str_equal);
+		break;
+	}
+
+	len = nm_ip_config_set_get_len (set);
+	for (i = 0; i < len; i++)
+		_idx_add (set->idx, set->type, _get_elem (set, i));
+	return set->idx;
+}
+
+/*****************************************************************************/
+
+void
+nm_ip_config_set_init (NMIPConfigSet *set, NMIPConfigSetType type)
+{
+	nm_assert (set);
+
+	set->type = type;
+	set->idx = NULL;
+	switch (type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		set->arr = g_array_new (FALSE, TRUE, sizeof (guint32));
+		return;
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		set->arr = g_array_new (FALSE, TRUE, sizeof (struct in6_addr));
+		return;
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		set->strs = g_ptr_array_new_with_free_func (g_free);
+		return;
+	}
+	nm_assert_not_reached ();
+}
+
+void
+nm_ip_config_set_clear (NMIPConfigSet *set)
+{
+	nm_assert (set);
+
+	nm_ip_config_set_invalidate_idx (set);
+	if (set->type == NM_IP_CONFIG_SET_TYPE_STR)
+		g_clear_pointer (&set->strs, g_ptr_array_unref);
+	else
+		g_clear_pointer (&set->arr, g_array_unref);
+}
+
+/**
+ * nm_ip_config_set_invalidate_idx:
+ * @set: the set
+ *
+ * Drops the index. Call this after modifying the array of
+ * @set directly.
+ */
+void
+nm_ip_config_set_invalidate_idx (NMIPConfigSet *set)
+{
+	g_clear_pointer (&set->idx, g_hash_table_unref);
+}
+
+/*****************************************************************************/
+
+gboolean
+nm_ip_config_set_contains (const NMIPConfigSet *set, gconstpointer elem)
+{
+	guint i, len;
+
+	nm_assert (set);
+	nm_assert (elem);
+
+	len = nm_ip_config_set_get_len (set);
+	if (   set->idx
+	    || len > IDX_LEN_THRESHOLD)
+		return g_hash_table_contains (_idx_ensure (set), _idx_lookup_key (set->type, elem));
+
+	for (i = 0; i < len; i++) {
+		if (_elem_equal (set->type, _get_elem (set, i), elem))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * nm_ip_config_set_add:
+ * @set: the set
+ * @elem: the element to append
+ *
+ * Returns: %TRUE if @elem was appended, or %FALSE, if @set
+ *   already contains it.
+ */
+gboolean
+nm_ip_config_set_add (NMIPConfigSet *set, gconstpointer elem)
+{
+	if (nm_ip_config_set_contains (set, elem))
+		return FALSE;
+
+	switch (set->type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		g_array_append_val (set->arr, *((const guint32 *) elem));
+		break;
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		g_array_append_val (set->arr, *((const struct in6_addr *) elem));
+		break;
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		g_ptr_array_add (set->strs, g_strdup (elem));
+		break;
+	}
+
+	if (set->idx)
+		_idx_add (set->idx, set->type, _get_elem (set, nm_ip_config_set_get_len (set) - 1));
+	return TRUE;
+}
+
+void
+nm_ip_config_set_del (NMIPConfigSet *set, guint i)
+{
+	nm_assert (set);
+	nm_assert (i < nm_ip_config_set_get_len (set));
+
+	if (set->idx) {
+		if (!g_hash_table_remove (set->idx, _idx_lookup_key (set->type, _get_elem (set, i))))
+			nm_assert_not_reached ();
+	}
+
+	if (set->type == NM_IP_CONFIG_SET_TYPE_STR)
+		g_ptr_array_remove_index (set->strs, i);
+	else
+		g_array_remove_index (set->arr, i);
+}
+
+/**
+ * nm_ip_config_set_reset:
+ * @set: the set
+ *
+ * Returns: %TRUE if @set was not empty.
+ */
+gboolean
+nm_ip_config_set_reset (NMIPConfigSet *set)
+{
+	nm_assert (set);
+
+	if (nm_ip_config_set_get_len (set) == 0)
+		return FALSE;
+
+	nm_ip_config_set_invalidate_idx (set);
+	if (set->type == NM_IP_CONFIG_SET_TYPE_STR)
+		g_ptr_array_set_size (set->strs, 0);
+	else
+		g_array_set_size (set->arr, 0);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+/**
+ * nm_ip_config_set_equal:
+ * @a: a set
+ * @b: another set
+ *
+ * Returns: whether @a and @b contain the same elements in
+ *   the same order.
+ */
+gboolean
+nm_ip_config_set_equal (const NMIPConfigSet *a, const NMIPConfigSet *b)
+{
+	guint i, len;
+
+	nm_assert (a);
+	nm_assert (b);
+	nm_assert (a->type == b->type);
+
+	len = nm_ip_config_set_get_len (a);
+	if (len != nm_ip_config_set_get_len (b))
+		return FALSE;
+
+	switch (a->type) {
+	case NM_IP_CONFIG_SET_TYPE_IP4:
+		return memcmp (a->arr->data, b->arr->data, len * sizeof (guint32)) == 0;
+	case NM_IP_CONFIG_SET_TYPE_IP6:
+		return memcmp (a->arr->data, b->arr->data, len * sizeof (struct in6_addr)) == 0;
+	case NM_IP_CONFIG_SET_TYPE_STR:
+		for (i = 0; i < len; i++) {
+			if (!nm_streq (a->strs->pdata[i], b->strs->pdata[i]))
+				return FALSE;
+		}
+		return TRUE;
+	}
+	nm_assert_not_reached ();
+	return FALSE;
+}
+
+/**
+ * nm_ip_config_set_merge:
+ * @dst: the set to modify
+ * @src: the elements to add
+ *
+ * Appends the elements of @src that are not yet in @dst.
+ *
+ * Returns: whether @dst changed.
+ */
+gboolean
+nm_ip_config_set_merge (NMIPConfigSet *dst, const NMIPConfigSet *src)
+{
+	gboolean changed = FALSE;
+	guint i, len;
+
+	nm_assert (dst);
+	nm_assert (src);
+	nm_assert (dst != src);
+	nm_assert (dst->type == src->type);
+
+	len = nm_ip_config_set_get_len (src);
+	for (i = 0; i < len; i++) {
+		if (nm_ip_config_set_add (dst, _get_elem (src, i)))
+			changed = TRUE;
+	}
+	return changed;
+}
+
+/* keeps the elements of @dst, for which the membership in @src
+ * is @keep_contained, preserving their order. */
+static gboolean
+_filter (NMIPConfigSet *dst, const NMIPConfigSet *src, gboolean keep_contained)
+{
+	guint i, j, len;
+
+	nm_assert (dst);
+	nm_assert (src);
+	nm_assert (dst != src);
+	nm_assert (dst->type == src->type);
+
+	len = nm_ip_config_set_get_len (dst);
+	if (len == 0)
+		return FALSE;
+	if (   !keep_contained
+	    && nm_ip_config_set_get_len (src) == 0)
+		return FALSE;
+
+	for (i = 0, j = 0; i < len; i++) {
+		gconstpointer elem = _get_elem (dst, i);
+
+		if ((!!nm_ip_config_set_contains (src, elem)) == (!!keep_contained)) {
+			if (i != j) {
+				if (dst->type == NM_IP_CONFIG_SET_TYPE_STR)
+					dst->strs->pdata[j] = dst->strs->pdata[i];
+				else {
+					memcpy (&dst->arr->data[j * g_array_get_element_size (dst->arr)],
+					        elem,
+					        g_array_get_element_size (dst->arr));
+				}
+			}
+			j++;
+			continue;
+		}
+
+		if (dst->idx) {
+			if (!g_hash_table_remove (dst->idx, _idx_lookup_key (dst->type, elem)))
+				nm_assert_not_reached ();
+		}
+		if (dst->type == NM_IP_CONFIG_SET_TYPE_STR) {
+			g_free (dst->strs->pdata[i]);
+			dst->strs->pdata[i] = NULL;
+		}
+	}
+
+	if (j == len)
+		return FALSE;
+
+	if (dst->type == NM_IP_CONFIG_SET_TYPE_STR) {
+		/* the moved strings are still referenced by the tail. Clear it,
+		 * so that shrinking doesn't free them. */
+		for (i = j; i < len; i++)
+			dst->strs->pdata[i] = NULL;
+		g_ptr_array_set_size (dst->strs, j);
+	} else
+		g_array_set_size (dst->arr, j);
+	return TRUE;
+}
+
+/**
+ * nm_ip_config_set_subtract:
+ * @dst: the set to modify
+ * @src: the elements to remove
+ *
+ * Removes the elements of @src from @dst.
+ *
+ * Returns: whether @dst changed.
+ */
+gboolean
+nm_ip_config_set_subtract (NMIPConfigSet *dst, const NMIPConfigSet *src)
+{
+	return _filter (dst, src, FALSE);
+}
+
+/**
+ * nm_ip_config_set_intersect:
+ * @dst: the set to modify
+ * @src: the elements to keep
+ *
+ * Removes the elements from @dst that are not in @src.
+ *
+ * Returns: whether @dst changed.
+ */
+gboolean
+nm_ip_config_set_intersect (NMIPConfigSet *dst, const NMIPConfigSet *src)
+{
+	return _filter (dst, src, TRUE);
+}
+
+/**
+ * nm_ip_config_set_replace:
+ * @dst: the set to modify
+ * @src: the source set
+ *
+ * Makes @dst a copy of @src.
+ *
+ * Returns: whether @dst changed.
+ */
+gboolean
+nm_ip_config_set_replace (NMIPConfigSet *dst, const NMIPConfigSet *src)
+{
+	guint i, len;
+
+	nm_assert (dst);
+	nm_assert (src);
+	nm_assert (dst->type == src->type);
+
+	if (nm_ip_config_set_equal (dst, src))
+		return FALSE;
+
+	nm_ip_config_set_reset (dst);
+
+	/* @src has no duplicates, so the elements can be copied without
+	 * checking. The index is created anew when needed. */
+	len = nm_ip_config_set_get_len (src);
+	if (src->type == NM_IP_CONFIG_SET_TYPE_STR) {
+		for (i = 0; i < len; i++)
+			g_ptr_array_add (dst->strs, g_strdup (src->strs->pdata[i]));
+	} else
+		g_array_append_vals (dst->arr, src->arr->data, len);
+	return TRUE;
+}
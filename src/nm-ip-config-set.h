@@ -0,0 +1,116 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#ifndef __NETWORKMANAGER_IP_CONFIG_SET_H__
+#define __NETWORKMANAGER_IP_CONFIG_SET_H__
+
+#include <netinet/in.h>
+
+/*****************************************************************************/
+
+/* NMIPConfigSet is the ordered list without duplicates that NMIP4Config
+ * and NMIP6Config use for nameservers, domains, searches, DNS options,
+ * NIS and WINS servers.
+ *
+ * Small sets are searched linearly. Once a set grows larger, it creates
+ * a hash index of its elements on the first lookup and keeps it up to
+ * date afterwards. */
+
+typedef enum {
+	/* guint32 addresses, in network byte order. */
+	NM_IP_CONFIG_SET_TYPE_IP4,
+
+	/* struct in6_addr addresses. */
+	NM_IP_CONFIG_SET_TYPE_IP6,
+
+	/* strings, owned by the set. */
+	NM_IP_CONFIG_SET_TYPE_STR,
+} NMIPConfigSetType;
+
+typedef struct {
+	union {
+		/* for NM_IP_CONFIG_SET_TYPE_IP4 and NM_IP_CONFIG_SET_TYPE_IP6. */
+		GArray *arr;
+
+		/* for NM_IP_CONFIG_SET_TYPE_STR. */
+		GPtrArray *strs;
+	};
+
+	/* lazily created index of the elements, or %NULL. */
+	GHashTable *idx;
+
+	NMIPConfigSetType type;
+} NMIPConfigSet;
+
+void nm_ip_config_set_init (NMIPConfigSet *set, NMIPConfigSetType type);
+void nm_ip_config_set_clear (NMIPConfigSet *set);
+
+static inline guint
+nm_ip_config_set_get_len (const NMIPConfigSet *set)
+{
+	return   set->type == NM_IP_CONFIG_SET_TYPE_STR
+	       ? set->strs->len
+	       : set->arr->len;
+}
+
+static inline guint32
+nm_ip_config_set_get_ip4 (const NMIPConfigSet *set, guint i)
+{
+	nm_assert (set->type == NM_IP_CONFIG_SET_TYPE_IP4);
+	nm_assert (i < set->arr->len);
+
+	return g_array_index (set->arr, guint32, i);
+}
+
+static inline const struct in6_addr *
+nm_ip_config_set_get_ip6 (const NMIPConfigSet *set, guint i)
+{
+	nm_assert (set->type == NM_IP_CONFIG_SET_TYPE_IP6);
+	nm_assert (i < set->arr->len);
+
+	return &g_array_index (set->arr, struct in6_addr, i);
+}
+
+static inline const char *
+nm_ip_config_set_get_str (const NMIPConfigSet *set, guint i)
+{
+	nm_assert (set->type == NM_IP_CONFIG_SET_TYPE_STR);
+	nm_assert (i < set->strs->len);
+
+	return set->strs->pdata[i];
+}
+
+/* The @elem arguments below point to a guint32 or a struct in6_addr.
+ * For strings, @elem is the string itself. */
+
+gboolean nm_ip_config_set_contains (const NMIPConfigSet *set, gconstpointer elem);
+gboolean nm_ip_config_set_add (NMIPConfigSet *set, gconstpointer elem);
+void nm_ip_config_set_del (NMIPConfigSet *set, guint i);
+gboolean nm_ip_config_set_reset (NMIPConfigSet *set);
+void nm_ip_config_set_invalidate_idx (NMIPConfigSet *set);
+
+gboolean nm_ip_config_set_equal (const NMIPConfigSet *a, const NMIPConfigSet *b);
+
+gboolean nm_ip_config_set_merge (NMIPConfigSet *dst, const NMIPConfigSet *src);
+gboolean nm_ip_config_set_subtract (NMIPConfigSet *dst, const NMIPConfigSet *src);
+gboolean nm_ip_config_set_intersect (NMIPConfigSet *dst, const NMIPConfigSet *src);
+gboolean nm_ip_config_set_replace (NMIPConfigSet *dst, const NMIPConfigSet *src);
+
+#endif /* __NETWORKMANAGER_IP_CONFIG_SET_H__ */
@@ -32,6 +32,8 @@
 #include "platform/nmp-object.h"
 #include "platform/nm-platform.h"
 #include "platform/nm-platform-utils.h"
+#include "platform/nmp-prefix-trie.h"
+#include "nm-ip-config-set.h"
 #include "NetworkManagerUtils.h"
 #include "nm-core-internal.h"
 
@@ -331,6 +333,290 @@ _nm_ip_config_lookup_ip_route (const NMDedupMultiIndex *multi_idx,
 
 /*****************************************************************************/
 
+void
+nm_ip_config_commit_state_clear (NMIPConfigCommitState *state)
+{
+	g_clear_pointer (&state->routes, g_hash_table_unref);
+	g_clear_pointer (&state->addresses, g_ptr_array_unref);
+	state->ifindex = 0;
+}
+
+/**
+ * _nm_ip_config_commit_state_check:
+ * @state: (allow-none): the state of the last commit
+ * @platform: the platform instance
+ * @ifindex: the interface to commit
+ * @addresses_head: (allow-none): the addresses to commit
+ * @out_sync_addresses: (out): whether the addresses differ from the
+ *   last commit and need to be synced.
+ *
+ * Returns: whether the addresses and routes of @ifindex in platform are
+ *   still those of the last commit, so that the commit can only push the
+ *   differences. This is not the case if somebody else changed them or if
+ *   addresses are to be removed or added, because kernel then might add
+ *   or remove routes on its own.
+ */
+gboolean
+_nm_ip_config_commit_state_check (const NMIPConfigCommitState *state,
+                                  NMPlatform *platform,
+                                  int ifindex,
+                                  const NMDedupMultiHeadEntry *addresses_head,
+                                  gboolean *out_sync_addresses)
+{
+	NMDedupMultiIter iter;
+	const NMPObject *o_new;
+	guint i, len;
+
+	*out_sync_addresses = TRUE;
+
+	if (   !state
+	    || state->ifindex != ifindex
+	    || state->addrroute_generation != nm_platform_get_addrroute_generation (platform, ifindex))
+		return FALSE;
+
+	nm_assert (state->routes);
+
+	len = addresses_head ? addresses_head->len : 0;
+	if (len != (state->addresses ? state->addresses->len : 0))
+		return FALSE;
+
+	*out_sync_addresses = FALSE;
+	i = 0;
+	nmp_cache_iter_for_each (&iter, addresses_head, &o_new) {
+		const NMPObject *o_old = state->addresses->pdata[i++];
+
+		if (nmp_object_equal (o_old, o_new))
+			continue;
+
+		/* updating an address in place, for example with new lifetimes,
+		 * is fine. */
+		if (!nmp_object_id_equal (o_old, o_new)) {
+			*out_sync_addresses = TRUE;
+			return FALSE;
+		}
+		*out_sync_addresses = TRUE;
+	}
+
+	return TRUE;
+}
+
+static gboolean
+_commit_state_route_equal (const NMPObject *a, const NMPObject *b)
+{
+	if (a == b)
+		return TRUE;
+	if (NMP_OBJECT_GET_TYPE (a) == NMP_OBJECT_TYPE_IP4_ROUTE) {
+		return nm_platform_ip4_route_cmp (NMP_OBJECT_CAST_IP4_ROUTE (a),
+		                                  NMP_OBJECT_CAST_IP4_ROUTE (b),
+		                                  NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0;
+	}
+	return nm_platform_ip6_route_cmp (NMP_OBJECT_CAST_IP6_ROUTE (a),
+	                                  NMP_OBJECT_CAST_IP6_ROUTE (b),
+	                                  NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0;
+}
+
+static void
+_commit_state_diff_route (NMIPConfigCommitState *state,
+                          const NMPObject *o,
+                          gpointer epoch,
+                          guint *n_kept,
+                          GPtrArray **routes_del,
+                          GPtrArray **routes_add)
+{
+	gpointer o_old, epoch_old;
+
+	if (g_hash_table_lookup_extended (state->routes, o, &o_old, &epoch_old)) {
+		if (epoch_old == epoch) {
+			/* a duplicate. Like route-sync, ignore all but the first. */
+			return;
+		}
+		(*n_kept)++;
+		if (!_commit_state_route_equal (o_old, o)) {
+			if (!*routes_del)
+				*routes_del = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+			g_ptr_array_add (*routes_del, (gpointer) nmp_object_ref (o_old));
+			if (!*routes_add)
+				*routes_add = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+			g_ptr_array_add (*routes_add, (gpointer) nmp_object_ref (o));
+		}
+	} else {
+		if (!*routes_add)
+			*routes_add = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+		g_ptr_array_add (*routes_add, (gpointer) nmp_object_ref (o));
+	}
+	g_hash_table_replace (state->routes, (gpointer) nmp_object_ref (o), epoch);
+}
+
+/**
+ * _nm_ip_config_commit_state_diff_routes:
+ * @state: the state of the last commit
+ * @routes_head: (allow-none): the routes to commit, as tracked by the
+ *   #NMIP4Config or #NMIP6Config.
+ * @routes: (allow-none): more routes to commit, after those of @routes_head.
+ * @out_routes_del: (out) (transfer full): the routes of the last commit
+ *   that are no longer wanted or changed, or %NULL.
+ * @out_routes_add: (out) (transfer full): the routes that are new or
+ *   changed, or %NULL.
+ *
+ * Compares the routes with the routes of the last commit and updates
+ * @state to the new routes. The routes of @routes_head are visited in
+ * place, so that a commit without changes doesn't allocate.
+ */
+void
+_nm_ip_config_commit_state_diff_routes (NMIPConfigCommitState *state,
+                                        const NMDedupMultiHeadEntry *routes_head,
+                                        const GPtrArray *routes,
+                                        GPtrArray **out_routes_del,
+                                        GPtrArray **out_routes_add)
+{
+	GPtrArray *routes_del = NULL;
+	GPtrArray *routes_add = NULL;
+	GHashTableIter iter;
+	NMDedupMultiIter ipconf_iter;
+	const NMPObject *o;
+	gpointer epoch;
+	gpointer o_old, epoch_old;
+	guint n_old, n_kept = 0;
+	guint i;
+
+	nm_assert (state->routes);
+
+	n_old = g_hash_table_size (state->routes);
+	epoch = GUINT_TO_POINTER (++state->epoch);
+
+	nmp_cache_iter_for_each (&ipconf_iter, routes_head, &o)
+		_commit_state_diff_route (state, o, epoch, &n_kept, &routes_del, &routes_add);
+	for (i = 0; routes && i < routes->len; i++)
+		_commit_state_diff_route (state, routes->pdata[i], epoch, &n_kept, &routes_del, &routes_add);
+
+	if (n_kept < n_old) {
+		/* some routes of the last commit are gone. Only now visit
+		 * all routes to find them. */
+		g_hash_table_iter_init (&iter, state->routes);
+		while (g_hash_table_iter_next (&iter, &o_old, &epoch_old)) {
+			if (epoch_old == epoch)
+				continue;
+			if (!routes_del)
+				routes_del = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+			g_ptr_array_add (routes_del, (gpointer) nmp_object_ref (o_old));
+			g_hash_table_iter_remove (&iter);
+		}
+	}
+
+	*out_routes_del = routes_del;
+	*out_routes_add = routes_add;
+}
+
+/**
+ * _nm_ip_config_commit_state_update:
+ * @state: (allow-none): the state to update
+ * @platform: the platform instance
+ * @addr_family: AF_INET or AF_INET6
+ * @ifindex: the committed interface
+ * @success: whether the commit succeeded
+ * @addresses_synced: whether the addresses were synced. Otherwise,
+ *   _nm_ip_config_commit_state_check() found them to be those of @state
+ *   and @addresses is ignored.
+ * @addresses: (allow-none): the synced addresses. The state takes
+ *   a reference to the array, which must not be modified afterwards.
+ * @routes: (allow-none): the committed routes
+ * @routes_diffed: whether _nm_ip_config_commit_state_diff_routes()
+ *   already updated the routes of @state. In that case, @routes is
+ *   ignored.
+ *
+ * Remembers the commit, so that the next commit can push only the
+ * differences. A commit that failed invalidates @state. So does a
+ * commit after which the platform cache does not have exactly the
+ * committed addresses and routes, because adding some of them failed
+ * silently or because somebody else changed them meanwhile. Only then
+ * the generation of @ifindex is taken to detect later changes.
+ */
+void
+_nm_ip_config_commit_state_update (NMIPConfigCommitState *state,
+                                   NMPlatform *platform,
+                                   int addr_family,
+                                   int ifindex,
+                                   gboolean success,
+                                   gboolean addresses_synced,
+                                   GPtrArray *addresses,
+                                   const GPtrArray *routes,
+                                   gboolean routes_diffed)
+{
+	gpointer epoch;
+	guint i;
+
+	if (!state)
+		return;
+
+	if (!success)
+		goto invalidate;
+
+	if (!addresses_synced) {
+		/* the addresses are those of the last commit. */
+		nm_assert (state->ifindex == ifindex);
+		addresses = state->addresses;
+	}
+
+	if (addresses) {
+		for (i = 0; i < addresses->len; i++) {
+			if (!addresses->pdata[i]) {
+				/* the address expired or we failed to add it. */
+				goto invalidate;
+			}
+			if (!nm_platform_lookup_entry (platform,
+			                               NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+			                               addresses->pdata[i])) {
+				/* adding the address failed or it was removed meanwhile. */
+				goto invalidate;
+			}
+		}
+	}
+
+	if (!routes_diffed) {
+		if (!state->routes) {
+			state->routes = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+			                                       (GEqualFunc) nmp_object_id_equal,
+			                                       (GDestroyNotify) nmp_object_unref,
+			                                       NULL);
+		} else
+			g_hash_table_remove_all (state->routes);
+
+		epoch = GUINT_TO_POINTER (++state->epoch);
+		for (i = 0; routes && i < routes->len; i++) {
+			/* on duplicates, the first route stays and the reference
+			 * of the other is dropped. */
+			g_hash_table_insert (state->routes, (gpointer) nmp_object_ref (routes->pdata[i]), epoch);
+		}
+	}
+
+	nm_assert (state->routes);
+
+	/* route-sync ignores failures to add some routes, and meanwhile
+	 * the routes might have been changed by somebody else. Only trust
+	 * the state if platform has what we just recorded. */
+	if (!nm_platform_ip_route_is_synced (platform,
+	                                     addr_family,
+	                                     ifindex,
+	                                     state->routes,
+	                                     nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
+	                                     NULL))
+		goto invalidate;
+
+	if (addresses_synced) {
+		g_clear_pointer (&state->addresses, g_ptr_array_unref);
+		if (addresses)
+			state->addresses = g_ptr_array_ref (addresses);
+	}
+	state->ifindex = ifindex;
+	state->addrroute_generation = nm_platform_get_addrroute_generation (platform, ifindex);
+	return;
+
+invalidate:
+	nm_ip_config_commit_state_clear (state);
+}
+
+/*****************************************************************************/
+
 NM_GOBJECT_PROPERTIES_DEFINE (NMIP4Config,
 	PROP_MULTI_IDX,
 	PROP_IFINDEX,
@@ -358,17 +644,23 @@ typedef struct {
 	NMIPConfigSource mtu_source;
 	gint dns_priority;
 	gint64 route_metric;
-	GArray *nameservers;
-	GPtrArray *domains;
-	GPtrArray *searches;
-	GPtrArray *dns_options;
-	GArray *nis;
+	NMIPConfigSet nameservers;
+	NMIPConfigSet domains;
+	NMIPConfigSet searches;
+	NMIPConfigSet dns_options;
+	NMIPConfigSet nis;
 	char *nis_domain;
-	GArray *wins;
+	NMIPConfigSet wins;
 	GVariant *address_data_variant;
 	GVariant *addresses_variant;
 	GVariant *route_data_variant;
 	GVariant *routes_variant;
+	GVariant *nameservers_variant;
+	GVariant *wins_variant;
+	/* lazily built longest-prefix-match indexes of the directly
+	 * reachable destinations. Dropped whenever addresses or routes change. */
+	NMPPrefixTrie *lpm_addresses;
+	NMPPrefixTrie *lpm_routes;
 	NMDedupMultiIndex *multi_idx;
 	union {
 		NMIPConfigDedupMultiIdxType idx_ip4_addresses_;
@@ -471,6 +763,7 @@ _notify_addresses (NMIP4Config *self)
 
 	nm_clear_g_variant (&priv->address_data_variant);
 	nm_clear_g_variant (&priv->addresses_variant);
+	g_clear_pointer (&priv->lpm_addresses, nmp_prefix_trie_free);
 	_notify (self, PROP_ADDRESS_DATA);
 	_notify (self, PROP_ADDRESSES);
 }
@@ -482,10 +775,37 @@ _notify_routes (NMIP4Config *self)
 
 	nm_clear_g_variant (&priv->route_data_variant);
 	nm_clear_g_variant (&priv->routes_variant);
+	g_clear_pointer (&priv->lpm_routes, nmp_prefix_trie_free);
 	_notify (self, PROP_ROUTE_DATA);
 	_notify (self, PROP_ROUTES);
 }
 
+static void
+_notify_gateway (NMIP4Config *self)
+{
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
+
+	/* the legacy "Addresses" property contains the gateway too. */
+	nm_clear_g_variant (&priv->address_data_variant);
+	nm_clear_g_variant (&priv->addresses_variant);
+	_notify (self, PROP_GATEWAY);
+	_notify (self, PROP_ADDRESSES);
+}
+
+static void
+_notify_nameservers (NMIP4Config *self)
+{
+	nm_clear_g_variant (&NM_IP4_CONFIG_GET_PRIVATE (self)->nameservers_variant);
+	_notify (self, PROP_NAMESERVERS);
+}
+
+static void
+_notify_wins (NMIP4Config *self)
+{
+	nm_clear_g_variant (&NM_IP4_CONFIG_GET_PRIVATE (self)->wins_variant);
+	_notify (self, PROP_WINS_SERVERS);
+}
+
 /*****************************************************************************/
 
 /**
@@ -693,8 +1013,11 @@ nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	 * nameservers from /etc/resolv.conf.
 	 */
 	if (has_addresses && priv->has_gateway && capture_resolv_conf) {
-		if (nm_ip4_config_capture_resolv_conf (priv->nameservers, priv->dns_options, NULL))
-			_notify (self, PROP_NAMESERVERS);
+		/* this modifies the arrays directly, behind the back of their indexes. */
+		if (nm_ip4_config_capture_resolv_conf (priv->nameservers.arr, priv->dns_options.strs, NULL))
+			_notify_nameservers (self);
+		nm_ip_config_set_invalidate_idx (&priv->nameservers);
+		nm_ip_config_set_invalidate_idx (&priv->dns_options);
 	}
 
 	/* actually, nobody should be connected to the signal, just to be sure, notify */
@@ -702,23 +1025,99 @@ nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	_notify_routes (self);
 	if (   priv->gateway != old_gateway
 	    || priv->has_gateway != old_has_gateway)
-		_notify (self, PROP_GATEWAY);
+		_notify_gateway (self);
 
 	return self;
 }
 
+typedef struct {
+	const NMIP4Config *self;
+	guint32 default_route_metric;
+} CommitRoutesKeepData;
+
+static gboolean
+_commit_routes_keep_predicate (const NMPObject *obj, gpointer user_data)
+{
+	const CommitRoutesKeepData *data = user_data;
+	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (data->self);
+	const NMPlatformIP4Route *plat_route = NMP_OBJECT_CAST_IP4_ROUTE (obj);
+	const NMDedupMultiEntry *entry;
+	NMPlatformIP4Route dev_route;
+	NMPObject obj_stack;
+
+	/* Whether @obj from platform is identical to one of the routes that
+	 * nm_ip4_config_commit() configures. That is either a route of the
+	 * config, or the device-route of one of its addresses. Answer it
+	 * from our indexes instead of building a lookup table each time. */
+
+	entry = _nm_ip_config_lookup_ip_route (priv->multi_idx,
+	                                       &priv->idx_ip4_routes_,
+	                                       obj,
+	                                       NM_PLATFORM_IP_ROUTE_CMP_TYPE_DST);
+	if (entry) {
+		if (nm_platform_ip4_route_cmp (NMP_OBJECT_CAST_IP4_ROUTE (entry->obj),
+		                               plat_route,
+		                               NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0)
+			return TRUE;
+		if (nm_platform_ip4_route_cmp (NMP_OBJECT_CAST_IP4_ROUTE (entry->obj),
+		                               plat_route,
+		                               NM_PLATFORM_IP_ROUTE_CMP_TYPE_ID) == 0) {
+			/* we track a different route with this ID. The device-route
+			 * for the address would not be configured. */
+			return FALSE;
+		}
+	}
+
+	if (   plat_route->plen == 0
+	    || _ipv4_is_zeronet (plat_route->network))
+		return FALSE;
+
+	nmp_object_stackinit_id_ip4_address (&obj_stack,
+	                                     priv->ifindex,
+	                                     plat_route->pref_src,
+	                                     plat_route->plen,
+	                                     plat_route->network);
+	if (!nm_dedup_multi_index_lookup_obj (priv->multi_idx,
+	                                      &priv->idx_ip4_addresses,
+	                                      &obj_stack))
+		return FALSE;
+
+	dev_route = (NMPlatformIP4Route) {
+		.ifindex = priv->ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_KERNEL,
+		.network = plat_route->network,
+		.plen = plat_route->plen,
+		.pref_src = plat_route->pref_src,
+		.metric = data->default_route_metric,
+		.scope_inv = nm_platform_route_scope_inv (NM_RT_SCOPE_LINK),
+	};
+	nm_platform_ip_route_normalize (AF_INET, (NMPlatformIPRoute *) &dev_route);
+
+	return nm_platform_ip4_route_cmp (&dev_route,
+	                                  plat_route,
+	                                  NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0;
+}
+
 gboolean
 nm_ip4_config_commit (const NMIP4Config *self,
                       NMPlatform *platform,
-                      guint32 default_route_metric)
+                      guint32 default_route_metric,
+                      NMIPConfigCommitState *state)
 {
 	const NMIP4ConfigPrivate *priv;
+	const NMDedupMultiHeadEntry *addresses_head;
+	const NMDedupMultiHeadEntry *routes_head;
+	NMDedupMultiIter ipconf_iter;
+	const NMPObject *o;
 	gs_unref_ptrarray GPtrArray *addresses = NULL;
 	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_ptrarray GPtrArray *dev_routes = NULL;
 	gs_unref_ptrarray GPtrArray *ip4_dev_route_blacklist = NULL;
 	int ifindex;
 	guint i;
 	gboolean success = TRUE;
+	gboolean delta;
+	gboolean sync_addresses;
 
 	g_return_val_if_fail (NM_IS_IP4_CONFIG (self), FALSE);
 
@@ -727,26 +1126,21 @@ nm_ip4_config_commit (const NMIP4Config *self,
 	ifindex = nm_ip4_config_get_ifindex (self);
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	addresses = nm_dedup_multi_objs_to_ptr_array_head (nm_ip4_config_lookup_addresses (self),
-	                                                   NULL, NULL);
+	/* the addresses and routes are visited in place. Only copy them
+	 * when they are to be synced. */
+	addresses_head = nm_ip4_config_lookup_addresses (self);
+	routes_head = nm_ip4_config_lookup_routes (self);
 
-	routes = nm_dedup_multi_objs_to_ptr_array_head (nm_ip4_config_lookup_routes (self),
-	                                                NULL, NULL);
-
-	if (addresses) {
+	if (addresses_head) {
 		/* For IPv6, we explicitly add the device-routes (onlink) to NMIP6Config.
 		 * As we don't do that for IPv4, add it here shortly before syncing
 		 * the routes. */
-		for (i = 0; i < addresses->len; i++) {
-			const NMPObject *o = addresses->pdata[i];
+		nmp_cache_iter_for_each (&ipconf_iter, addresses_head, &o) {
 			const NMPlatformIP4Address *addr;
 			nm_auto_nmpobj NMPObject *r = NULL;
 			NMPlatformIP4Route *route;
 			in_addr_t network;
 
-			if (!o)
-				continue;
-
 			addr = NMP_OBJECT_CAST_IP4_ADDRESS (o);
 			if (addr->plen == 0)
 				continue;
@@ -780,9 +1174,9 @@ nm_ip4_config_commit (const NMIP4Config *self,
 			                   NM_PLATFORM_IP_ROUTE_CMP_TYPE_ID)) {
 				/* we already track this route. Don't add it again. */
 			} else {
-				if (!routes)
-					routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
-				g_ptr_array_add (routes, (gpointer) nmp_object_ref (r));
+				if (!dev_routes)
+					dev_routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+				g_ptr_array_add (dev_routes, (gpointer) nmp_object_ref (r));
 			}
 
 			if (default_route_metric != NM_PLATFORM_ROUTE_METRIC_IP4_DEVICE_ROUTE) {
@@ -809,20 +1203,58 @@ nm_ip4_config_commit (const NMIP4Config *self,
 		}
 	}
 
-	nm_platform_ip4_address_sync (platform, ifindex, addresses);
+	delta = _nm_ip_config_commit_state_check (state, platform, ifindex, addresses_head, &sync_addresses);
+
+	if (sync_addresses) {
+		addresses = nm_dedup_multi_objs_to_ptr_array_head (addresses_head, NULL, NULL);
+		nm_platform_ip4_address_sync (platform, ifindex, addresses);
+	}
+
+	if (delta) {
+		gs_unref_ptrarray GPtrArray *routes_del = NULL;
+		gs_unref_ptrarray GPtrArray *routes_add = NULL;
+
+		/* nothing changed the interface since the last commit. Only
+		 * push the differences to that commit. */
+		_nm_ip_config_commit_state_diff_routes (state, routes_head, dev_routes, &routes_del, &routes_add);
+		if (!nm_platform_ip_route_sync_delta (platform,
+		                                      AF_INET,
+		                                      ifindex,
+		                                      routes_del,
+		                                      routes_add,
+		                                      nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
+		                                      NULL))
+			success = FALSE;
+	} else {
+		routes = nm_dedup_multi_objs_to_ptr_array_head (routes_head, NULL, NULL);
+		if (dev_routes) {
+			if (!routes)
+				routes = g_ptr_array_new_full (dev_routes->len, (GDestroyNotify) nmp_object_unref);
+			for (i = 0; i < dev_routes->len; i++)
+				g_ptr_array_add (routes, nmp_object_ref (dev_routes->pdata[i]));
+		}
 
-	if (!nm_platform_ip_route_sync (platform,
-	                                AF_INET,
-	                                ifindex,
-	                                routes,
-	                                nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
-	                                NULL))
-		success = FALSE;
+		if (!nm_platform_ip_route_sync (platform,
+		                                AF_INET,
+		                                ifindex,
+		                                routes,
+		                                _commit_routes_keep_predicate,
+		                                &((CommitRoutesKeepData) {
+		                                    .self = self,
+		                                    .default_route_metric = default_route_metric,
+		                                }),
+		                                nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
+		                                NULL))
+			success = FALSE;
+	}
 
 	nm_platform_ip4_dev_route_blacklist_set (platform,
 	                                         ifindex,
 	                                         ip4_dev_route_blacklist);
 
+	_nm_ip_config_commit_state_update (state, platform, AF_INET, ifindex, success,
+	                                   sync_addresses, addresses, routes, delta);
+
 	return success;
 }
 
@@ -1097,7 +1529,6 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 {
 	NMIP4ConfigPrivate *dst_priv;
 	const NMIP4ConfigPrivate *src_priv;
-	guint32 i;
 	NMDedupMultiIter ipconf_iter;
 	const NMPlatformIP4Address *address = NULL;
 
@@ -1115,8 +1546,8 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 	/* nameservers */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip4_config_get_num_nameservers (src); i++)
-			nm_ip4_config_add_nameserver (dst, nm_ip4_config_get_nameserver (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->nameservers, &src_priv->nameservers))
+			_notify_nameservers (dst);
 	}
 
 	/* default gateway */
@@ -1138,20 +1569,20 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 	/* domains */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip4_config_get_num_domains (src); i++)
-			nm_ip4_config_add_domain (dst, nm_ip4_config_get_domain (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->domains, &src_priv->domains))
+			_notify (dst, PROP_DOMAINS);
 	}
 
 	/* dns searches */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip4_config_get_num_searches (src); i++)
-			nm_ip4_config_add_search (dst, nm_ip4_config_get_search (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->searches, &src_priv->searches))
+			_notify (dst, PROP_SEARCHES);
 	}
 
 	/* dns options */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip4_config_get_num_dns_options (src); i++)
-			nm_ip4_config_add_dns_option (dst, nm_ip4_config_get_dns_option (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->dns_options, &src_priv->dns_options))
+			_notify (dst, PROP_DNS_OPTIONS);
 	}
 
 	/* MSS */
@@ -1167,8 +1598,7 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 	/* NIS */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip4_config_get_num_nis_servers (src); i++)
-			nm_ip4_config_add_nis_server (dst, nm_ip4_config_get_nis_server (src, i));
+		nm_ip_config_set_merge (&dst_priv->nis, &src_priv->nis);
 
 		if (nm_ip4_config_get_nis_domain (src))
 			nm_ip4_config_set_nis_domain (dst, nm_ip4_config_get_nis_domain (src));
@@ -1176,8 +1606,8 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 	/* WINS */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip4_config_get_num_wins (src); i++)
-			nm_ip4_config_add_wins (dst, nm_ip4_config_get_wins (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->wins, &src_priv->wins))
+			_notify_wins (dst);
 	}
 
 	/* metered flag */
@@ -1193,98 +1623,6 @@ nm_ip4_config_merge (NMIP4Config *dst, const NMIP4Config *src, NMIPConfigMergeFl
 
 /*****************************************************************************/
 
-static int
-_nameservers_get_index (const NMIP4Config *self, guint32 ns)
-{
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->nameservers->len; i++) {
-		guint32 n = g_array_index (priv->nameservers, guint32, i);
-
-		if (ns == n)
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_domains_get_index (const NMIP4Config *self, const char *domain)
-{
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->domains->len; i++) {
-		const char *d = g_ptr_array_index (priv->domains, i);
-
-		if (g_strcmp0 (domain, d) == 0)
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_searches_get_index (const NMIP4Config *self, const char *search)
-{
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->searches->len; i++) {
-		const char *s = g_ptr_array_index (priv->searches, i);
-
-		if (g_strcmp0 (search, s) == 0)
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_dns_options_get_index (const NMIP4Config *self, const char *option)
-{
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->dns_options->len; i++) {
-		const char *s = g_ptr_array_index (priv->dns_options, i);
-
-		if (g_strcmp0 (option, s) == 0)
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_nis_servers_get_index (const NMIP4Config *self, guint32 nis_server)
-{
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->nis->len; i++) {
-		guint32 n = g_array_index (priv->nis, guint32, i);
-
-		if (n == nis_server)
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_wins_get_index (const NMIP4Config *self, guint32 wins_server)
-{
-	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->wins->len; i++) {
-		guint32 n = g_array_index (priv->wins, guint32, i);
-
-		if (n == wins_server)
-			return (int) i;
-	}
-	return -1;
-}
-
-/*****************************************************************************/
-
 /**
  * nm_ip4_config_subtract:
  * @dst: config from which to remove everything in @src
@@ -1296,8 +1634,7 @@ void
 nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 {
 	NMIP4ConfigPrivate *dst_priv;
-	guint i;
-	gint idx;
+	const NMIP4ConfigPrivate *src_priv;
 	const NMPlatformIP4Address *a;
 	const NMPlatformIP4Route *r;
 	NMDedupMultiIter ipconf_iter;
@@ -1307,6 +1644,7 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 	g_return_if_fail (dst != NULL);
 
 	dst_priv = NM_IP4_CONFIG_GET_PRIVATE (dst);
+	src_priv = NM_IP4_CONFIG_GET_PRIVATE (src);
 
 	g_object_freeze_notify (G_OBJECT (dst));
 
@@ -1323,11 +1661,8 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 		_notify_addresses (dst);
 
 	/* nameservers */
-	for (i = 0; i < nm_ip4_config_get_num_nameservers (src); i++) {
-		idx = _nameservers_get_index (dst, nm_ip4_config_get_nameserver (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_nameserver (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->nameservers, &src_priv->nameservers))
+		_notify_nameservers (dst);
 
 	/* default gateway */
 	if (   (nm_ip4_config_has_gateway (src) == nm_ip4_config_has_gateway (dst))
@@ -1352,25 +1687,16 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 		_notify_routes (dst);
 
 	/* domains */
-	for (i = 0; i < nm_ip4_config_get_num_domains (src); i++) {
-		idx = _domains_get_index (dst, nm_ip4_config_get_domain (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_domain (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->domains, &src_priv->domains))
+		_notify (dst, PROP_DOMAINS);
 
 	/* dns searches */
-	for (i = 0; i < nm_ip4_config_get_num_searches (src); i++) {
-		idx = _searches_get_index (dst, nm_ip4_config_get_search (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_search (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->searches, &src_priv->searches))
+		_notify (dst, PROP_SEARCHES);
 
 	/* dns options */
-	for (i = 0; i < nm_ip4_config_get_num_dns_options (src); i++) {
-		idx = _dns_options_get_index (dst, nm_ip4_config_get_dns_option (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_dns_option (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->dns_options, &src_priv->dns_options))
+		_notify (dst, PROP_DNS_OPTIONS);
 
 	/* MSS */
 	if (nm_ip4_config_get_mss (src) == nm_ip4_config_get_mss (dst))
@@ -1382,21 +1708,14 @@ nm_ip4_config_subtract (NMIP4Config *dst, const NMIP4Config *src)
 		nm_ip4_config_set_mtu (dst, 0, NM_IP_CONFIG_SOURCE_UNKNOWN);
 
 	/* NIS */
-	for (i = 0; i < nm_ip4_config_get_num_nis_servers (src); i++) {
-		idx = _nis_servers_get_index (dst, nm_ip4_config_get_nis_server (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_nis_server (dst, idx);
-	}
+	nm_ip_config_set_subtract (&dst_priv->nis, &src_priv->nis);
 
 	if (g_strcmp0 (nm_ip4_config_get_nis_domain (src), nm_ip4_config_get_nis_domain (dst)) == 0)
 		nm_ip4_config_set_nis_domain (dst, NULL);
 
 	/* WINS */
-	for (i = 0; i < nm_ip4_config_get_num_wins (src); i++) {
-		idx = _wins_get_index (dst, nm_ip4_config_get_wins (src, i));
-		if (idx >= 0)
-			nm_ip4_config_del_wins (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->wins, &src_priv->wins))
+		_notify_wins (dst);
 
 	/* DNS priority */
 	if (nm_ip4_config_get_dns_priority (src) == nm_ip4_config_get_dns_priority (dst))
@@ -1496,7 +1815,6 @@ nm_ip4_config_replace (NMIP4Config *dst, const NMIP4Config *src, gboolean *relev
 	gboolean config_equal;
 #endif
 	gboolean has_minor_changes = FALSE, has_relevant_changes = FALSE, are_equal;
-	guint i, num;
 	NMIP4ConfigPrivate *dst_priv;
 	const NMIP4ConfigPrivate *src_priv;
 	NMDedupMultiIter ipconf_iter_src, ipconf_iter_dst;
@@ -1631,77 +1949,26 @@ nm_ip4_config_replace (NMIP4Config *dst, const NMIP4Config *src, gboolean *relev
 	}
 
 	/* nameservers */
-	num = nm_ip4_config_get_num_nameservers (src);
-	are_equal = num == nm_ip4_config_get_num_nameservers (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (nm_ip4_config_get_nameserver (src, i) != nm_ip4_config_get_nameserver (dst, i)) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip4_config_reset_nameservers (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_nameserver (dst, nm_ip4_config_get_nameserver (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->nameservers, &src_priv->nameservers)) {
+		_notify_nameservers (dst);
 		has_relevant_changes = TRUE;
 	}
 
 	/* domains */
-	num = nm_ip4_config_get_num_domains (src);
-	are_equal = num == nm_ip4_config_get_num_domains (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (g_strcmp0 (nm_ip4_config_get_domain (src, i),
-			               nm_ip4_config_get_domain (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip4_config_reset_domains (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_domain (dst, nm_ip4_config_get_domain (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->domains, &src_priv->domains)) {
+		_notify (dst, PROP_DOMAINS);
 		has_relevant_changes = TRUE;
 	}
 
 	/* dns searches */
-	num = nm_ip4_config_get_num_searches (src);
-	are_equal = num == nm_ip4_config_get_num_searches (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (g_strcmp0 (nm_ip4_config_get_search (src, i),
-			               nm_ip4_config_get_search (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip4_config_reset_searches (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_search (dst, nm_ip4_config_get_search (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->searches, &src_priv->searches)) {
+		_notify (dst, PROP_SEARCHES);
 		has_relevant_changes = TRUE;
 	}
 
 	/* dns options */
-	num = nm_ip4_config_get_num_dns_options (src);
-	are_equal = num == nm_ip4_config_get_num_dns_options (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (g_strcmp0 (nm_ip4_config_get_dns_option (src, i),
-			               nm_ip4_config_get_dns_option (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip4_config_reset_dns_options (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_dns_option (dst, nm_ip4_config_get_dns_option (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->dns_options, &src_priv->dns_options)) {
+		_notify (dst, PROP_DNS_OPTIONS);
 		has_relevant_changes = TRUE;
 	}
 
@@ -1718,20 +1985,7 @@ nm_ip4_config_replace (NMIP4Config *dst, const NMIP4Config *src, gboolean *relev
 	}
 
 	/* nis */
-	num = nm_ip4_config_get_num_nis_servers (src);
-	are_equal = num == nm_ip4_config_get_num_nis_servers (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (nm_ip4_config_get_nis_server (src, i) != nm_ip4_config_get_nis_server (dst, i)) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip4_config_reset_nis_servers (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_nis_server (dst, nm_ip4_config_get_nis_server (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->nis, &src_priv->nis)) {
 		has_relevant_changes = TRUE;
 	}
 
@@ -1742,20 +1996,8 @@ nm_ip4_config_replace (NMIP4Config *dst, const NMIP4Config *src, gboolean *relev
 	}
 
 	/* wins */
-	num = nm_ip4_config_get_num_wins (src);
-	are_equal = num == nm_ip4_config_get_num_wins (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (nm_ip4_config_get_wins (src, i) != nm_ip4_config_get_wins (dst, i)) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip4_config_reset_wins (dst);
-		for (i = 0; i < num; i++)
-			nm_ip4_config_add_wins (dst, nm_ip4_config_get_wins (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->wins, &src_priv->wins)) {
+		_notify_wins (dst);
 		has_relevant_changes = TRUE;
 	}
 
@@ -1862,28 +2104,41 @@ nm_ip4_config_dump (const NMIP4Config *self, const char *detail)
 	g_message (" mtrd:   %d", (int) nm_ip4_config_get_metered (self));
 }
 
-gboolean
-nm_ip4_config_destination_is_direct (const NMIP4Config *self, guint32 network, guint8 plen)
+static NMPPrefixTrie *
+_lpm_addresses_get (const NMIP4Config *self)
 {
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE ((NMIP4Config *) self);
 	const NMPlatformIP4Address *item;
 	in_addr_t peer_network;
 	NMDedupMultiIter iter;
 
-	nm_ip_config_iter_ip4_address_for_each (&iter, self, &item) {
-		if (item->plen > plen)
-			continue;
+	if (priv->lpm_addresses)
+		return priv->lpm_addresses;
 
+	priv->lpm_addresses = nmp_prefix_trie_new (AF_INET);
+	nm_ip_config_iter_ip4_address_for_each (&iter, self, &item) {
 		peer_network = nm_utils_ip4_address_clear_host_address (item->peer_address, item->plen);
 		if (_ipv4_is_zeronet (peer_network))
 			continue;
-
-		if (peer_network != nm_utils_ip4_address_clear_host_address (network, item->plen))
+		if (nmp_prefix_trie_lookup (priv->lpm_addresses, 0, &peer_network, item->plen))
 			continue;
-
-		return TRUE;
+		nmp_prefix_trie_set (priv->lpm_addresses, 0, &peer_network, item->plen, (gpointer) item);
 	}
+	return priv->lpm_addresses;
+}
 
-	return FALSE;
+gboolean
+nm_ip4_config_destination_is_direct (const NMIP4Config *self, guint32 network, guint8 plen)
+{
+	g_return_val_if_fail (plen <= 32, FALSE);
+
+	return !!nmp_prefix_trie_lookup_covering (_lpm_addresses_get (self),
+	                                          0,
+	                                          &network,
+	                                          plen,
+	                                          NULL,
+	                                          NULL,
+	                                          NULL);
 }
 
 /*****************************************************************************/
@@ -1912,7 +2167,7 @@ nm_ip4_config_set_gateway (NMIP4Config *self, guint32 gateway)
 	if (priv->gateway != gateway || !priv->has_gateway) {
 		priv->gateway = gateway;
 		priv->has_gateway = TRUE;
-		_notify (self, PROP_GATEWAY);
+		_notify_gateway (self);
 	}
 }
 
@@ -1924,7 +2179,7 @@ nm_ip4_config_unset_gateway (NMIP4Config *self)
 	if (priv->has_gateway) {
 		priv->gateway = 0;
 		priv->has_gateway = FALSE;
-		_notify (self, PROP_GATEWAY);
+		_notify_gateway (self);
 	}
 }
 
@@ -2193,31 +2448,44 @@ _nmtst_nm_ip4_config_get_route (const NMIP4Config *self, guint i)
 	g_return_val_if_reached (NULL);
 }
 
-const NMPlatformIP4Route *
-nm_ip4_config_get_direct_route_for_host (const NMIP4Config *self, guint32 host)
+static NMPPrefixTrie *
+_lpm_routes_get (const NMIP4Config *self)
 {
-	const NMPlatformIP4Route *best_route = NULL;
+	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE ((NMIP4Config *) self);
 	const NMPlatformIP4Route *item;
+	const NMPlatformIP4Route *best;
 	NMDedupMultiIter ipconf_iter;
 
-	g_return_val_if_fail (host, NULL);
+	if (priv->lpm_routes)
+		return priv->lpm_routes;
 
+	/* for each destination, track the device route with the lowest metric. */
+	priv->lpm_routes = nmp_prefix_trie_new (AF_INET);
 	nm_ip_config_iter_ip4_route_for_each (&ipconf_iter, self, &item) {
 		if (item->gateway != 0)
 			continue;
 
-		if (best_route && best_route->plen > item->plen)
+		best = nmp_prefix_trie_lookup (priv->lpm_routes, 0, &item->network, item->plen);
+		if (best && best->metric <= item->metric)
 			continue;
 
-		if (nm_utils_ip4_address_clear_host_address (host, item->plen) != nm_utils_ip4_address_clear_host_address (item->network, item->plen))
-			continue;
+		nmp_prefix_trie_set (priv->lpm_routes, 0, &item->network, item->plen, (gpointer) item);
+	}
+	return priv->lpm_routes;
+}
 
-		if (best_route && best_route->metric <= item->metric)
-			continue;
+const NMPlatformIP4Route *
+nm_ip4_config_get_direct_route_for_host (const NMIP4Config *self, guint32 host)
+{
+	g_return_val_if_fail (host, NULL);
 
-		best_route = item;
-	}
-	return best_route;
+	return nmp_prefix_trie_lookup_covering (_lpm_routes_get (self),
+	                                        0,
+	                                        &host,
+	                                        32,
+	                                        NULL,
+	                                        NULL,
+	                                        NULL);
 }
 
 /*****************************************************************************/
@@ -2227,26 +2495,19 @@ nm_ip4_config_reset_nameservers (NMIP4Config *self)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	if (priv->nameservers->len != 0) {
-		g_array_set_size (priv->nameservers, 0);
-		_notify (self, PROP_NAMESERVERS);
-	}
+	if (nm_ip_config_set_reset (&priv->nameservers))
+		_notify_nameservers (self);
 }
 
 void
 nm_ip4_config_add_nameserver (NMIP4Config *self, guint32 new)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	int i;
 
 	g_return_if_fail (new != 0);
 
-	for (i = 0; i < priv->nameservers->len; i++)
-		if (new == g_array_index (priv->nameservers, guint32, i))
-			return;
-
-	g_array_append_val (priv->nameservers, new);
-	_notify (self, PROP_NAMESERVERS);
+	if (nm_ip_config_set_add (&priv->nameservers, &new))
+		_notify_nameservers (self);
 }
 
 void
@@ -2254,10 +2515,10 @@ nm_ip4_config_del_nameserver (NMIP4Config *self, guint i)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_return_if_fail (i < priv->nameservers->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->nameservers));
 
-	g_array_remove_index (priv->nameservers, i);
-	_notify (self, PROP_NAMESERVERS);
+	nm_ip_config_set_del (&priv->nameservers, i);
+	_notify_nameservers (self);
 }
 
 guint
@@ -2265,7 +2526,7 @@ nm_ip4_config_get_num_nameservers (const NMIP4Config *self)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return priv->nameservers->len;
+	return nm_ip_config_set_get_len (&priv->nameservers);
 }
 
 guint32
@@ -2273,7 +2534,7 @@ nm_ip4_config_get_nameserver (const NMIP4Config *self, guint i)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return g_array_index (priv->nameservers, guint32, i);
+	return nm_ip_config_set_get_ip4 (&priv->nameservers, i);
 }
 
 /*****************************************************************************/
@@ -2283,27 +2544,20 @@ nm_ip4_config_reset_domains (NMIP4Config *self)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	if (priv->domains->len != 0) {
-		g_ptr_array_set_size (priv->domains, 0);
+	if (nm_ip_config_set_reset (&priv->domains))
 		_notify (self, PROP_DOMAINS);
-	}
 }
 
 void
 nm_ip4_config_add_domain (NMIP4Config *self, const char *domain)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	int i;
 
 	g_return_if_fail (domain != NULL);
 	g_return_if_fail (domain[0] != '\0');
 
-	for (i = 0; i < priv->domains->len; i++)
-		if (!g_strcmp0 (g_ptr_array_index (priv->domains, i), domain))
-			return;
-
-	g_ptr_array_add (priv->domains, g_strdup (domain));
-	_notify (self, PROP_DOMAINS);
+	if (nm_ip_config_set_add (&priv->domains, domain))
+		_notify (self, PROP_DOMAINS);
 }
 
 void
@@ -2311,9 +2565,9 @@ nm_ip4_config_del_domain (NMIP4Config *self, guint i)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_return_if_fail (i < priv->domains->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->domains));
 
-	g_ptr_array_remove_index (priv->domains, i);
+	nm_ip_config_set_del (&priv->domains, i);
 	_notify (self, PROP_DOMAINS);
 }
 
@@ -2322,7 +2576,7 @@ nm_ip4_config_get_num_domains (const NMIP4Config *self)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return priv->domains->len;
+	return nm_ip_config_set_get_len (&priv->domains);
 }
 
 const char *
@@ -2330,7 +2584,7 @@ nm_ip4_config_get_domain (const NMIP4Config *self, guint i)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return g_ptr_array_index (priv->domains, i);
+	return nm_ip_config_set_get_str (&priv->domains, i);
 }
 
 /*****************************************************************************/
@@ -2340,42 +2594,31 @@ nm_ip4_config_reset_searches (NMIP4Config *self)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	if (priv->searches->len != 0) {
-		g_ptr_array_set_size (priv->searches, 0);
+	if (nm_ip_config_set_reset (&priv->searches))
 		_notify (self, PROP_SEARCHES);
-	}
 }
 
 void
 nm_ip4_config_add_search (NMIP4Config *self, const char *new)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	char *search;
+	gs_free char *search_free = NULL;
+	const char *search = new;
 	size_t len;
 
 	g_return_if_fail (new != NULL);
 	g_return_if_fail (new[0] != '\0');
 
-	search = g_strdup (new);
-
 	/* Remove trailing dot as it has no effect */
-	len = strlen (search);
-	if (search[len - 1] == '.')
-		search[len - 1] = 0;
-
-	if (!search[0]) {
-		g_free (search);
-		return;
-	}
-
-	if (nm_utils_strv_find_first ((char **) priv->searches->pdata,
-	                               priv->searches->len, search) >= 0) {
-		g_free (search);
-		return;
+	len = strlen (new);
+	if (new[len - 1] == '.') {
+		if (len == 1)
+			return;
+		search = search_free = g_strndup (new, len - 1);
 	}
 
-	g_ptr_array_add (priv->searches, search);
-	_notify (self, PROP_SEARCHES);
+	if (nm_ip_config_set_add (&priv->searches, search))
+		_notify (self, PROP_SEARCHES);
 }
 
 void
@@ -2383,9 +2626,9 @@ nm_ip4_config_del_search (NMIP4Config *self, guint i)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_return_if_fail (i < priv->searches->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->searches));
 
-	g_ptr_array_remove_index (priv->searches, i);
+	nm_ip_config_set_del (&priv->searches, i);
 	_notify (self, PROP_SEARCHES);
 }
 
@@ -2394,7 +2637,7 @@ nm_ip4_config_get_num_searches (const NMIP4Config *self)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return priv->searches->len;
+	return nm_ip_config_set_get_len (&priv->searches);
 }
 
 const char *
@@ -2402,7 +2645,7 @@ nm_ip4_config_get_search (const NMIP4Config *self, guint i)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return g_ptr_array_index (priv->searches, i);
+	return nm_ip_config_set_get_str (&priv->searches, i);
 }
 
 /*****************************************************************************/
@@ -2412,27 +2655,20 @@ nm_ip4_config_reset_dns_options (NMIP4Config *self)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	if (priv->dns_options->len != 0) {
-		g_ptr_array_set_size (priv->dns_options, 0);
+	if (nm_ip_config_set_reset (&priv->dns_options))
 		_notify (self, PROP_DNS_OPTIONS);
-	}
 }
 
 void
 nm_ip4_config_add_dns_option (NMIP4Config *self, const char *new)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	int i;
 
 	g_return_if_fail (new != NULL);
 	g_return_if_fail (new[0] != '\0');
 
-	for (i = 0; i < priv->dns_options->len; i++)
-		if (!g_strcmp0 (g_ptr_array_index (priv->dns_options, i), new))
-			return;
-
-	g_ptr_array_add (priv->dns_options, g_strdup (new));
-	_notify (self, PROP_DNS_OPTIONS);
+	if (nm_ip_config_set_add (&priv->dns_options, new))
+		_notify (self, PROP_DNS_OPTIONS);
 }
 
 void
@@ -2440,9 +2676,9 @@ nm_ip4_config_del_dns_option(NMIP4Config *self, guint i)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_return_if_fail (i < priv->dns_options->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->dns_options));
 
-	g_ptr_array_remove_index (priv->dns_options, i);
+	nm_ip_config_set_del (&priv->dns_options, i);
 	_notify (self, PROP_DNS_OPTIONS);
 }
 
@@ -2451,7 +2687,7 @@ nm_ip4_config_get_num_dns_options (const NMIP4Config *self)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return priv->dns_options->len;
+	return nm_ip_config_set_get_len (&priv->dns_options);
 }
 
 const char *
@@ -2459,7 +2695,7 @@ nm_ip4_config_get_dns_option (const NMIP4Config *self, guint i)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return g_ptr_array_index (priv->dns_options, i);
+	return nm_ip_config_set_get_str (&priv->dns_options, i);
 }
 
 /*****************************************************************************/
@@ -2508,20 +2744,15 @@ nm_ip4_config_reset_nis_servers (NMIP4Config *self)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_array_set_size (priv->nis, 0);
+	nm_ip_config_set_reset (&priv->nis);
 }
 
 void
 nm_ip4_config_add_nis_server (NMIP4Config *self, guint32 nis)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	int i;
-
-	for (i = 0; i < priv->nis->len; i++)
-		if (nis == g_array_index (priv->nis, guint32, i))
-			return;
 
-	g_array_append_val (priv->nis, nis);
+	nm_ip_config_set_add (&priv->nis, &nis);
 }
 
 void
@@ -2529,9 +2760,9 @@ nm_ip4_config_del_nis_server (NMIP4Config *self, guint i)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_return_if_fail (i < priv->nis->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->nis));
 
-	g_array_remove_index (priv->nis, i);
+	nm_ip_config_set_del (&priv->nis, i);
 }
 
 guint
@@ -2539,7 +2770,7 @@ nm_ip4_config_get_num_nis_servers (const NMIP4Config *self)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return priv->nis->len;
+	return nm_ip_config_set_get_len (&priv->nis);
 }
 
 guint32
@@ -2547,7 +2778,7 @@ nm_ip4_config_get_nis_server (const NMIP4Config *self, guint i)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return g_array_index (priv->nis, guint32, i);
+	return nm_ip_config_set_get_ip4 (&priv->nis, i);
 }
 
 void
@@ -2574,26 +2805,19 @@ nm_ip4_config_reset_wins (NMIP4Config *self)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	if (priv->wins->len != 0) {
-		g_array_set_size (priv->wins, 0);
-		_notify (self, PROP_WINS_SERVERS);
-	}
+	if (nm_ip_config_set_reset (&priv->wins))
+		_notify_wins (self);
 }
 
 void
 nm_ip4_config_add_wins (NMIP4Config *self, guint32 wins)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
-	int i;
 
 	g_return_if_fail (wins != 0);
 
-	for (i = 0; i < priv->wins->len; i++)
-		if (wins == g_array_index (priv->wins, guint32, i))
-			return;
-
-	g_array_append_val (priv->wins, wins);
-	_notify (self, PROP_WINS_SERVERS);
+	if (nm_ip_config_set_add (&priv->wins, &wins))
+		_notify_wins (self);
 }
 
 void
@@ -2601,10 +2825,10 @@ nm_ip4_config_del_wins (NMIP4Config *self, guint i)
 {
 	NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	g_return_if_fail (i < priv->wins->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->wins));
 
-	g_array_remove_index (priv->wins, i);
-	_notify (self, PROP_WINS_SERVERS);
+	nm_ip_config_set_del (&priv->wins, i);
+	_notify_wins (self);
 }
 
 guint
@@ -2612,7 +2836,7 @@ nm_ip4_config_get_num_wins (const NMIP4Config *self)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return priv->wins->len;
+	return nm_ip_config_set_get_len (&priv->wins);
 }
 
 guint32
@@ -2620,7 +2844,7 @@ nm_ip4_config_get_wins (const NMIP4Config *self, guint i)
 {
 	const NMIP4ConfigPrivate *priv = NM_IP4_CONFIG_GET_PRIVATE (self);
 
-	return g_array_index (priv->wins, guint32, i);
+	return nm_ip_config_set_get_ip4 (&priv->wins, i);
 }
 
 /*****************************************************************************/
@@ -2933,30 +3157,34 @@ out_routes_cached:
 			g_value_set_string (value, NULL);
 		break;
 	case PROP_NAMESERVERS:
-		g_value_take_variant (value,
-		                      g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
-		                                                 priv->nameservers->data,
-		                                                 priv->nameservers->len,
-		                                                 sizeof (guint32)));
+		if (!priv->nameservers_variant) {
+			priv->nameservers_variant = g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
+			                                                                           priv->nameservers.arr->data,
+			                                                                           priv->nameservers.arr->len,
+			                                                                           sizeof (guint32)));
+		}
+		g_value_set_variant (value, priv->nameservers_variant);
 		break;
 	case PROP_DOMAINS:
-		nm_utils_g_value_set_strv (value, priv->domains);
+		nm_utils_g_value_set_strv (value, priv->domains.strs);
 		break;
 	case PROP_SEARCHES:
-		nm_utils_g_value_set_strv (value, priv->searches);
+		nm_utils_g_value_set_strv (value, priv->searches.strs);
 		break;
 	case PROP_DNS_OPTIONS:
-		nm_utils_g_value_set_strv (value, priv->dns_options);
+		nm_utils_g_value_set_strv (value, priv->dns_options.strs);
 		break;
 	case PROP_DNS_PRIORITY:
 		g_value_set_int (value, priv->dns_priority);
 		break;
 	case PROP_WINS_SERVERS:
-		g_value_take_variant (value,
-		                      g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
-		                                                 priv->wins->data,
-		                                                 priv->wins->len,
-		                                                 sizeof (guint32)));
+		if (!priv->wins_variant) {
+			priv->wins_variant = g_variant_ref_sink (g_variant_new_fixed_array (G_VARIANT_TYPE_UINT32,
+			                                                                    priv->wins.arr->data,
+			                                                                    priv->wins.arr->len,
+			                                                                    sizeof (guint32)));
+		}
+		g_value_set_variant (value, priv->wins_variant);
 		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -3003,12 +3231,12 @@ nm_ip4_config_init (NMIP4Config *self)
 	nm_ip_config_dedup_multi_idx_type_init ((NMIPConfigDedupMultiIdxType *) &priv->idx_ip4_routes,
 	                                        NMP_OBJECT_TYPE_IP4_ROUTE);
 
-	priv->nameservers = g_array_new (FALSE, FALSE, sizeof (guint32));
-	priv->domains = g_ptr_array_new_with_free_func (g_free);
-	priv->searches = g_ptr_array_new_with_free_func (g_free);
-	priv->dns_options = g_ptr_array_new_with_free_func (g_free);
-	priv->nis = g_array_new (FALSE, TRUE, sizeof (guint32));
-	priv->wins = g_array_new (FALSE, TRUE, sizeof (guint32));
+	nm_ip_config_set_init (&priv->nameservers, NM_IP_CONFIG_SET_TYPE_IP4);
+	nm_ip_config_set_init (&priv->domains, NM_IP_CONFIG_SET_TYPE_STR);
+	nm_ip_config_set_init (&priv->searches, NM_IP_CONFIG_SET_TYPE_STR);
+	nm_ip_config_set_init (&priv->dns_options, NM_IP_CONFIG_SET_TYPE_STR);
+	nm_ip_config_set_init (&priv->nis, NM_IP_CONFIG_SET_TYPE_IP4);
+	nm_ip_config_set_init (&priv->wins, NM_IP_CONFIG_SET_TYPE_IP4);
 	priv->route_metric = -1;
 }
 
@@ -3035,14 +3263,19 @@ finalize (GObject *object)
 	nm_clear_g_variant (&priv->addresses_variant);
 	nm_clear_g_variant (&priv->route_data_variant);
 	nm_clear_g_variant (&priv->routes_variant);
+	nm_clear_g_variant (&priv->nameservers_variant);
+	nm_clear_g_variant (&priv->wins_variant);
+
+	g_clear_pointer (&priv->lpm_addresses, nmp_prefix_trie_free);
+	g_clear_pointer (&priv->lpm_routes, nmp_prefix_trie_free);
 
-	g_array_unref (priv->nameservers);
-	g_ptr_array_unref (priv->domains);
-	g_ptr_array_unref (priv->searches);
-	g_ptr_array_unref (priv->dns_options);
-	g_array_unref (priv->nis);
+	nm_ip_config_set_clear (&priv->nameservers);
+	nm_ip_config_set_clear (&priv->domains);
+	nm_ip_config_set_clear (&priv->searches);
+	nm_ip_config_set_clear (&priv->dns_options);
+	nm_ip_config_set_clear (&priv->nis);
 	g_free (priv->nis_domain);
-	g_array_unref (priv->wins);
+	nm_ip_config_set_clear (&priv->wins);
 
 	G_OBJECT_CLASS (nm_ip4_config_parent_class)->finalize (object);
 
@@ -99,6 +99,51 @@ const NMDedupMultiEntry *_nm_ip_config_lookup_ip_route (const NMDedupMultiIndex
 
 /*****************************************************************************/
 
+/* NMIPConfigCommitState remembers what nm_ip4_config_commit() or
+ * nm_ip6_config_commit() configured last on an interface. As long as
+ * nobody else changed the addresses and routes of the interface since,
+ * the next commit only pushes the differences to platform. */
+struct _NMIPConfigCommitState {
+	/* the routes of the last commit, by their platform ID. The values
+	 * are the @epoch of the commit that configured them. */
+	GHashTable *routes;
+
+	/* the addresses of the last commit, or %NULL. */
+	GPtrArray *addresses;
+
+	guint epoch;
+
+	/* see nm_platform_get_addrroute_generation(). */
+	guint64 addrroute_generation;
+
+	/* the interface of the last commit, or zero if there is none. */
+	int ifindex;
+};
+
+void nm_ip_config_commit_state_clear (NMIPConfigCommitState *state);
+
+gboolean _nm_ip_config_commit_state_check (const NMIPConfigCommitState *state,
+                                           NMPlatform *platform,
+                                           int ifindex,
+                                           const NMDedupMultiHeadEntry *addresses_head,
+                                           gboolean *out_sync_addresses);
+void _nm_ip_config_commit_state_diff_routes (NMIPConfigCommitState *state,
+                                             const NMDedupMultiHeadEntry *routes_head,
+                                             const GPtrArray *routes,
+                                             GPtrArray **out_routes_del,
+                                             GPtrArray **out_routes_add);
+void _nm_ip_config_commit_state_update (NMIPConfigCommitState *state,
+                                        NMPlatform *platform,
+                                        int addr_family,
+                                        int ifindex,
+                                        gboolean success,
+                                        gboolean addresses_synced,
+                                        GPtrArray *addresses,
+                                        const GPtrArray *routes,
+                                        gboolean routes_diffed);
+
+/*****************************************************************************/
+
 #define NM_TYPE_IP4_CONFIG (nm_ip4_config_get_type ())
 #define NM_IP4_CONFIG(obj) (G_TYPE_CHECK_INSTANCE_CAST ((obj), NM_TYPE_IP4_CONFIG, NMIP4Config))
 #define NM_IP4_CONFIG_CLASS(klass) (G_TYPE_CHECK_CLASS_CAST ((klass), NM_TYPE_IP4_CONFIG, NMIP4ConfigClass))
@@ -140,7 +185,8 @@ NMDedupMultiIndex *nm_ip4_config_get_multi_idx (const NMIP4Config *self);
 NMIP4Config *nm_ip4_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex, gboolean capture_resolv_conf);
 gboolean nm_ip4_config_commit (const NMIP4Config *self,
                                NMPlatform *platform,
-                               guint32 default_route_metric);
+                               guint32 default_route_metric,
+                               NMIPConfigCommitState *state);
 void nm_ip4_config_merge_setting (NMIP4Config *self, NMSettingIPConfig *setting, guint32 default_route_metric);
 NMSetting *nm_ip4_config_create_setting (const NMIP4Config *self);
 
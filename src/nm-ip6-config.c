@@ -32,6 +32,8 @@
 #include "platform/nmp-object.h"
 #include "platform/nm-platform.h"
 #include "platform/nm-platform-utils.h"
+#include "platform/nmp-prefix-trie.h"
+#include "nm-ip-config-set.h"
 #include "nm-core-internal.h"
 #include "NetworkManagerUtils.h"
 #include "nm-ip4-config.h"
@@ -57,20 +59,26 @@ _route_valid (const NMPlatformIP6Route *r)
 
 typedef struct {
 	bool never_default:1;
+	bool sealed:1;
 	guint32 mss;
 	int ifindex;
 	int dns_priority;
 	NMSettingIP6ConfigPrivacy privacy;
 	gint64 route_metric;
 	struct in6_addr gateway;
-	GArray *nameservers;
-	GPtrArray *domains;
-	GPtrArray *searches;
-	GPtrArray *dns_options;
+	NMIPConfigSet nameservers;
+	NMIPConfigSet domains;
+	NMIPConfigSet searches;
+	NMIPConfigSet dns_options;
 	GVariant *address_data_variant;
 	GVariant *addresses_variant;
 	GVariant *route_data_variant;
 	GVariant *routes_variant;
+	GVariant *nameservers_variant;
+	/* lazily built longest-prefix-match indexes of the directly
+	 * reachable destinations. Dropped whenever addresses or routes change. */
+	NMPPrefixTrie *lpm_addresses;
+	NMPPrefixTrie *lpm_routes;
 	NMDedupMultiIndex *multi_idx;
 	union {
 		NMIPConfigDedupMultiIdxType idx_ip6_addresses_;
@@ -95,6 +103,16 @@ G_DEFINE_TYPE (NMIP6Config, nm_ip6_config, NM_TYPE_EXPORTED_OBJECT)
 
 #define NM_IP6_CONFIG_GET_PRIVATE(self) _NM_GET_PRIVATE(self, NMIP6Config, NM_IS_IP6_CONFIG)
 
+/* like NM_IP6_CONFIG_GET_PRIVATE(), for functions that modify the
+ * instance. A sealed instance may be shared and must not be modified. */
+#define NM_IP6_CONFIG_GET_PRIVATE_MUTABLE(self) \
+	({ \
+		NMIP6ConfigPrivate *_priv_mutable = NM_IP6_CONFIG_GET_PRIVATE (self); \
+		\
+		nm_assert (!_priv_mutable->sealed); \
+		_priv_mutable; \
+	})
+
 NM_GOBJECT_PROPERTIES_DEFINE (NMIP6Config,
 	PROP_MULTI_IDX,
 	PROP_IFINDEX,
@@ -129,10 +147,61 @@ nm_ip6_config_get_multi_idx (const NMIP6Config *self)
 	return NM_IP6_CONFIG_GET_PRIVATE (self)->multi_idx;
 }
 
+/*****************************************************************************/
+
+/**
+ * nm_ip6_config_seal:
+ * @self: the #NMIP6Config instance
+ *
+ * Marks @self as immutable. Afterwards, @self can be shared by reference
+ * instead of being copied. Use nm_ip6_config_unshare() to get a
+ * writable instance again.
+ */
+void
+nm_ip6_config_seal (NMIP6Config *self)
+{
+	g_return_if_fail (NM_IS_IP6_CONFIG (self));
+
+	NM_IP6_CONFIG_GET_PRIVATE (self)->sealed = TRUE;
+}
+
+gboolean
+nm_ip6_config_is_sealed (const NMIP6Config *self)
+{
+	g_return_val_if_fail (NM_IS_IP6_CONFIG (self), FALSE);
+
+	return NM_IP6_CONFIG_GET_PRIVATE (self)->sealed;
+}
+
+/**
+ * nm_ip6_config_unshare:
+ * @p_config: (inout): the location of the #NMIP6Config
+ *
+ * If *@p_config is sealed, it is replaced by a writable clone and the
+ * reference to the sealed instance is dropped. Otherwise, *@p_config is
+ * left unchanged.
+ *
+ * Returns: (transfer none): the writable instance in *@p_config.
+ */
+NMIP6Config *
+nm_ip6_config_unshare (NMIP6Config **p_config)
+{
+	NMIP6Config *self;
+
+	g_return_val_if_fail (p_config && NM_IS_IP6_CONFIG (*p_config), NULL);
+
+	self = *p_config;
+	if (NM_IP6_CONFIG_GET_PRIVATE (self)->sealed) {
+		*p_config = nm_ip6_config_new_cloned (self);
+		g_object_unref (self);
+	}
+	return *p_config;
+}
+
 void
 nm_ip6_config_set_privacy (NMIP6Config *self, NMSettingIP6ConfigPrivacy privacy)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	priv->privacy = privacy;
 }
@@ -184,6 +253,7 @@ _notify_addresses (NMIP6Config *self)
 
 	nm_clear_g_variant (&priv->address_data_variant);
 	nm_clear_g_variant (&priv->addresses_variant);
+	g_clear_pointer (&priv->lpm_addresses, nmp_prefix_trie_free);
 	_notify (self, PROP_ADDRESS_DATA);
 	_notify (self, PROP_ADDRESSES);
 }
@@ -195,10 +265,30 @@ _notify_routes (NMIP6Config *self)
 
 	nm_clear_g_variant (&priv->route_data_variant);
 	nm_clear_g_variant (&priv->routes_variant);
+	g_clear_pointer (&priv->lpm_routes, nmp_prefix_trie_free);
 	_notify (self, PROP_ROUTE_DATA);
 	_notify (self, PROP_ROUTES);
 }
 
+static void
+_notify_gateway (NMIP6Config *self)
+{
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+
+	/* the legacy "Addresses" property contains the gateway too. */
+	nm_clear_g_variant (&priv->address_data_variant);
+	nm_clear_g_variant (&priv->addresses_variant);
+	_notify (self, PROP_GATEWAY);
+	_notify (self, PROP_ADDRESSES);
+}
+
+static void
+_notify_nameservers (NMIP6Config *self)
+{
+	nm_clear_g_variant (&NM_IP6_CONFIG_GET_PRIVATE (self)->nameservers_variant);
+	_notify (self, PROP_NAMESERVERS);
+}
+
 /*****************************************************************************/
 
 /**
@@ -378,7 +468,7 @@ _nmtst_nm_ip6_config_addresses_sort (NMIP6Config *self)
 		guint naddr, j;
 		NMDedupMultiIter iter;
 
-		priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+		priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 		addresses_old = nm_dedup_multi_objs_to_array_head (head_entry, NULL, NULL, &naddr);
 		nm_assert (addresses_old);
@@ -490,49 +580,104 @@ nm_ip6_config_capture (NMDedupMultiIndex *multi_idx, NMPlatform *platform, int i
 	/* If the interface has the default route, and has IPv6 addresses, capture
 	 * nameservers from /etc/resolv.conf.
 	 */
-	if (has_addresses && has_gateway && capture_resolv_conf)
-		notify_nameservers = nm_ip6_config_capture_resolv_conf (priv->nameservers,
-		                                                        priv->dns_options,
+	if (has_addresses && has_gateway && capture_resolv_conf) {
+		/* this modifies the arrays directly, behind the back of their indexes. */
+		notify_nameservers = nm_ip6_config_capture_resolv_conf (priv->nameservers.arr,
+		                                                        priv->dns_options.strs,
 		                                                        NULL);
+		nm_ip_config_set_invalidate_idx (&priv->nameservers);
+		nm_ip_config_set_invalidate_idx (&priv->dns_options);
+	}
 
 	/* actually, nobody should be connected to the signal, just to be sure, notify */
 	if (notify_nameservers)
-		_notify (self, PROP_NAMESERVERS);
+		_notify_nameservers (self);
 	_notify_addresses (self);
 	_notify_routes (self);
 	if (!IN6_ARE_ADDR_EQUAL (&priv->gateway, &old_gateway))
-		_notify (self, PROP_GATEWAY);
+		_notify_gateway (self);
 
 	return self;
 }
 
+static gboolean
+_commit_routes_keep_predicate (const NMPObject *obj, gpointer user_data)
+{
+	const NMIP6Config *self = user_data;
+	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	const NMDedupMultiEntry *entry;
+
+	/* Whether @obj from platform is identical to one of our routes. */
+	entry = nm_dedup_multi_index_lookup_obj (priv->multi_idx,
+	                                         &priv->idx_ip6_routes,
+	                                         obj);
+	return    entry
+	       && nm_platform_ip6_route_cmp (NMP_OBJECT_CAST_IP6_ROUTE (entry->obj),
+	                                     NMP_OBJECT_CAST_IP6_ROUTE (obj),
+	                                     NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0;
+}
+
 gboolean
 nm_ip6_config_commit (const NMIP6Config *self,
-                      NMPlatform *platform)
+                      NMPlatform *platform,
+                      NMIPConfigCommitState *state)
 {
+	const NMDedupMultiHeadEntry *addresses_head;
+	const NMDedupMultiHeadEntry *routes_head;
 	gs_unref_ptrarray GPtrArray *addresses = NULL;
 	gs_unref_ptrarray GPtrArray *routes = NULL;
 	int ifindex;
 	gboolean success = TRUE;
+	gboolean delta;
+	gboolean sync_addresses;
+	gboolean addresses_success = TRUE;
 
 	g_return_val_if_fail (NM_IS_IP6_CONFIG (self), FALSE);
 
 	ifindex = nm_ip6_config_get_ifindex (self);
 	g_return_val_if_fail (ifindex > 0, FALSE);
 
-	addresses = nm_dedup_multi_objs_to_ptr_array_head (nm_ip6_config_lookup_addresses (self),
-	                                                   NULL, NULL);
-	routes = nm_dedup_multi_objs_to_ptr_array_head (nm_ip6_config_lookup_routes (self),
-	                                                NULL, NULL);
-	nm_platform_ip6_address_sync (platform, ifindex, addresses, TRUE);
-
-	if (!nm_platform_ip_route_sync (platform,
-	                                AF_INET6,
-	                                ifindex,
-	                                routes,
-	                                nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
-	                                NULL))
-		success = FALSE;
+	/* the addresses and routes are visited in place. Only copy them
+	 * when they are to be synced. */
+	addresses_head = nm_ip6_config_lookup_addresses (self);
+	routes_head = nm_ip6_config_lookup_routes (self);
+	delta = _nm_ip_config_commit_state_check (state, platform, ifindex, addresses_head, &sync_addresses);
+
+	if (sync_addresses) {
+		addresses = nm_dedup_multi_objs_to_ptr_array_head (addresses_head, NULL, NULL);
+		addresses_success = nm_platform_ip6_address_sync (platform, ifindex, addresses, TRUE);
+	}
+
+	if (delta) {
+		gs_unref_ptrarray GPtrArray *routes_del = NULL;
+		gs_unref_ptrarray GPtrArray *routes_add = NULL;
+
+		_nm_ip_config_commit_state_diff_routes (state, routes_head, NULL, &routes_del, &routes_add);
+		if (!nm_platform_ip_route_sync_delta (platform,
+		                                      AF_INET6,
+		                                      ifindex,
+		                                      routes_del,
+		                                      routes_add,
+		                                      nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
+		                                      NULL))
+			success = FALSE;
+	} else {
+		routes = nm_dedup_multi_objs_to_ptr_array_head (routes_head, NULL, NULL);
+		if (!nm_platform_ip_route_sync (platform,
+		                                AF_INET6,
+		                                ifindex,
+		                                routes,
+		                                _commit_routes_keep_predicate,
+		                                (gpointer) self,
+		                                nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel,
+		                                NULL))
+			success = FALSE;
+	}
+
+	/* if some addresses could not be added, the next commit must not
+	 * rely on the platform state. */
+	_nm_ip_config_commit_state_update (state, platform, AF_INET6, ifindex, success && addresses_success,
+	                                   sync_addresses, addresses, routes, delta);
 
 	return success;
 }
@@ -600,7 +745,7 @@ nm_ip6_config_merge_setting (NMIP6Config *self, NMSettingIPConfig *setting, guin
 
 	g_return_if_fail (NM_IS_SETTING_IP6_CONFIG (setting));
 
-	priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	naddresses = nm_setting_ip_config_get_num_addresses (setting);
 	nroutes = nm_setting_ip_config_get_num_routes (setting);
@@ -829,14 +974,13 @@ nm_ip6_config_merge (NMIP6Config *dst, const NMIP6Config *src, NMIPConfigMergeFl
 {
 	NMIP6ConfigPrivate *dst_priv;
 	const NMIP6ConfigPrivate *src_priv;
-	guint32 i;
 	NMDedupMultiIter ipconf_iter;
 	const NMPlatformIP6Address *address = NULL;
 
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
-	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (dst);
 	src_priv = NM_IP6_CONFIG_GET_PRIVATE (src);
 
 	g_object_freeze_notify (G_OBJECT (dst));
@@ -847,8 +991,8 @@ nm_ip6_config_merge (NMIP6Config *dst, const NMIP6Config *src, NMIPConfigMergeFl
 
 	/* nameservers */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip6_config_get_num_nameservers (src); i++)
-			nm_ip6_config_add_nameserver (dst, nm_ip6_config_get_nameserver (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->nameservers, &src_priv->nameservers))
+			_notify_nameservers (dst);
 	}
 
 	/* default gateway */
@@ -870,20 +1014,20 @@ nm_ip6_config_merge (NMIP6Config *dst, const NMIP6Config *src, NMIPConfigMergeFl
 
 	/* domains */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip6_config_get_num_domains (src); i++)
-			nm_ip6_config_add_domain (dst, nm_ip6_config_get_domain (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->domains, &src_priv->domains))
+			_notify (dst, PROP_DOMAINS);
 	}
 
 	/* dns searches */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip6_config_get_num_searches (src); i++)
-			nm_ip6_config_add_search (dst, nm_ip6_config_get_search (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->searches, &src_priv->searches))
+			_notify (dst, PROP_SEARCHES);
 	}
 
 	/* dns options */
 	if (!NM_FLAGS_HAS (merge_flags, NM_IP_CONFIG_MERGE_NO_DNS)) {
-		for (i = 0; i < nm_ip6_config_get_num_dns_options (src); i++)
-			nm_ip6_config_add_dns_option (dst, nm_ip6_config_get_dns_option (src, i));
+		if (nm_ip_config_set_merge (&dst_priv->dns_options, &src_priv->dns_options))
+			_notify (dst, PROP_DNS_OPTIONS);
 	}
 
 	if (nm_ip6_config_get_mss (src))
@@ -896,85 +1040,40 @@ nm_ip6_config_merge (NMIP6Config *dst, const NMIP6Config *src, NMIPConfigMergeFl
 	g_object_thaw_notify (G_OBJECT (dst));
 }
 
-gboolean
-nm_ip6_config_destination_is_direct (const NMIP6Config *self, const struct in6_addr *network, guint8 plen)
+static NMPPrefixTrie *
+_lpm_addresses_get (const NMIP6Config *self)
 {
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE ((NMIP6Config *) self);
 	const NMPlatformIP6Address *item;
 	NMDedupMultiIter iter;
 
-	nm_assert (network);
-	nm_assert (plen <= 128);
+	if (priv->lpm_addresses)
+		return priv->lpm_addresses;
 
+	priv->lpm_addresses = nmp_prefix_trie_new (AF_INET6);
 	nm_ip_config_iter_ip6_address_for_each (&iter, self, &item) {
-		if (   item->plen <= plen
-		    && !NM_FLAGS_HAS (item->n_ifa_flags, IFA_F_NOPREFIXROUTE)
-		    && nm_utils_ip6_address_same_prefix (&item->address, network, item->plen))
-			return TRUE;
-	}
-
-	return FALSE;
-}
-
-/*****************************************************************************/
-
-static int
-_nameservers_get_index (const NMIP6Config *self, const struct in6_addr *ns)
-{
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->nameservers->len; i++) {
-		const struct in6_addr *n = &g_array_index (priv->nameservers, struct in6_addr, i);
-
-		if (IN6_ARE_ADDR_EQUAL (ns, n))
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_domains_get_index (const NMIP6Config *self, const char *domain)
-{
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->domains->len; i++) {
-		const char *d = g_ptr_array_index (priv->domains, i);
-
-		if (g_strcmp0 (domain, d) == 0)
-			return (int) i;
-	}
-	return -1;
-}
-
-static int
-_searches_get_index (const NMIP6Config *self, const char *search)
-{
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->searches->len; i++) {
-		const char *s = g_ptr_array_index (priv->searches, i);
-
-		if (g_strcmp0 (search, s) == 0)
-			return (int) i;
+		if (NM_FLAGS_HAS (item->n_ifa_flags, IFA_F_NOPREFIXROUTE))
+			continue;
+		if (nmp_prefix_trie_lookup (priv->lpm_addresses, 0, &item->address, item->plen))
+			continue;
+		nmp_prefix_trie_set (priv->lpm_addresses, 0, &item->address, item->plen, (gpointer) item);
 	}
-	return -1;
+	return priv->lpm_addresses;
 }
 
-static int
-_dns_options_get_index (const NMIP6Config *self, const char *option)
+gboolean
+nm_ip6_config_destination_is_direct (const NMIP6Config *self, const struct in6_addr *network, guint8 plen)
 {
-	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	guint i;
-
-	for (i = 0; i < priv->dns_options->len; i++) {
-		const char *s = g_ptr_array_index (priv->dns_options, i);
+	nm_assert (network);
+	nm_assert (plen <= 128);
 
-		if (g_strcmp0 (option, s) == 0)
-			return (int) i;
-	}
-	return -1;
+	return !!nmp_prefix_trie_lookup_covering (_lpm_addresses_get (self),
+	                                          0,
+	                                          network,
+	                                          plen,
+	                                          NULL,
+	                                          NULL,
+	                                          NULL);
 }
 
 /*****************************************************************************/
@@ -990,8 +1089,7 @@ void
 nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 {
 	NMIP6ConfigPrivate *dst_priv;
-	guint i;
-	gint idx;
+	const NMIP6ConfigPrivate *src_priv;
 	const NMPlatformIP6Address *a;
 	const NMPlatformIP6Route *r;
 	NMDedupMultiIter ipconf_iter;
@@ -1001,7 +1099,8 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 	g_return_if_fail (src != NULL);
 	g_return_if_fail (dst != NULL);
 
-	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (dst);
+	src_priv = NM_IP6_CONFIG_GET_PRIVATE (src);
 
 	g_object_freeze_notify (G_OBJECT (dst));
 
@@ -1018,11 +1117,8 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 		_notify_addresses (dst);
 
 	/* nameservers */
-	for (i = 0; i < nm_ip6_config_get_num_nameservers (src); i++) {
-		idx = _nameservers_get_index (dst, nm_ip6_config_get_nameserver (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_nameserver (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->nameservers, &src_priv->nameservers))
+		_notify_nameservers (dst);
 
 	/* default gateway */
 	src_tmp = nm_ip6_config_get_gateway (src);
@@ -1048,25 +1144,16 @@ nm_ip6_config_subtract (NMIP6Config *dst, const NMIP6Config *src)
 		_notify_routes (dst);
 
 	/* domains */
-	for (i = 0; i < nm_ip6_config_get_num_domains (src); i++) {
-		idx = _domains_get_index (dst, nm_ip6_config_get_domain (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_domain (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->domains, &src_priv->domains))
+		_notify (dst, PROP_DOMAINS);
 
 	/* dns searches */
-	for (i = 0; i < nm_ip6_config_get_num_searches (src); i++) {
-		idx = _searches_get_index (dst, nm_ip6_config_get_search (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_search (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->searches, &src_priv->searches))
+		_notify (dst, PROP_SEARCHES);
 
 	/* dns options */
-	for (i = 0; i < nm_ip6_config_get_num_dns_options (src); i++) {
-		idx = _dns_options_get_index (dst, nm_ip6_config_get_dns_option (src, i));
-		if (idx >= 0)
-			nm_ip6_config_del_dns_option (dst, idx);
-	}
+	if (nm_ip_config_set_subtract (&dst_priv->dns_options, &src_priv->dns_options))
+		_notify (dst, PROP_DNS_OPTIONS);
 
 	if (nm_ip6_config_get_mss (src) == nm_ip6_config_get_mss (dst))
 		nm_ip6_config_set_mss (dst, 0);
@@ -1092,7 +1179,7 @@ nm_ip6_config_intersect (NMIP6Config *dst, const NMIP6Config *src)
 	g_return_if_fail (src);
 	g_return_if_fail (dst);
 
-	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (dst);
 	src_priv = NM_IP6_CONFIG_GET_PRIVATE (src);
 
 	g_object_freeze_notify (G_OBJECT (dst));
@@ -1170,7 +1257,6 @@ nm_ip6_config_replace (NMIP6Config *dst, const NMIP6Config *src, gboolean *relev
 	gboolean config_equal;
 #endif
 	gboolean has_minor_changes = FALSE, has_relevant_changes = FALSE, are_equal;
-	guint i, num;
 	NMIP6ConfigPrivate *dst_priv;
 	const NMIP6ConfigPrivate *src_priv;
 	NMDedupMultiIter ipconf_iter_src, ipconf_iter_dst;
@@ -1184,7 +1270,7 @@ nm_ip6_config_replace (NMIP6Config *dst, const NMIP6Config *src, gboolean *relev
 	config_equal = nm_ip6_config_equal (dst, src);
 #endif
 
-	dst_priv = NM_IP6_CONFIG_GET_PRIVATE (dst);
+	dst_priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (dst);
 	src_priv = NM_IP6_CONFIG_GET_PRIVATE (src);
 
 	g_return_val_if_fail (src_priv->ifindex > 0, FALSE);
@@ -1306,78 +1392,26 @@ nm_ip6_config_replace (NMIP6Config *dst, const NMIP6Config *src, gboolean *relev
 	}
 
 	/* nameservers */
-	num = nm_ip6_config_get_num_nameservers (src);
-	are_equal = num == nm_ip6_config_get_num_nameservers (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (!IN6_ARE_ADDR_EQUAL (nm_ip6_config_get_nameserver (src, i),
-			                         nm_ip6_config_get_nameserver (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip6_config_reset_nameservers (dst);
-		for (i = 0; i < num; i++)
-			nm_ip6_config_add_nameserver (dst, nm_ip6_config_get_nameserver (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->nameservers, &src_priv->nameservers)) {
+		_notify_nameservers (dst);
 		has_relevant_changes = TRUE;
 	}
 
 	/* domains */
-	num = nm_ip6_config_get_num_domains (src);
-	are_equal = num == nm_ip6_config_get_num_domains (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (g_strcmp0 (nm_ip6_config_get_domain (src, i),
-			                nm_ip6_config_get_domain (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip6_config_reset_domains (dst);
-		for (i = 0; i < num; i++)
-			nm_ip6_config_add_domain (dst, nm_ip6_config_get_domain (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->domains, &src_priv->domains)) {
+		_notify (dst, PROP_DOMAINS);
 		has_relevant_changes = TRUE;
 	}
 
 	/* dns searches */
-	num = nm_ip6_config_get_num_searches (src);
-	are_equal = num == nm_ip6_config_get_num_searches (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (g_strcmp0 (nm_ip6_config_get_search (src, i),
-			                nm_ip6_config_get_search (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip6_config_reset_searches (dst);
-		for (i = 0; i < num; i++)
-			nm_ip6_config_add_search (dst, nm_ip6_config_get_search (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->searches, &src_priv->searches)) {
+		_notify (dst, PROP_SEARCHES);
 		has_relevant_changes = TRUE;
 	}
 
 	/* dns options */
-	num = nm_ip6_config_get_num_dns_options (src);
-	are_equal = num == nm_ip6_config_get_num_dns_options (dst);
-	if (are_equal) {
-		for (i = 0; i < num; i++ ) {
-			if (g_strcmp0 (nm_ip6_config_get_dns_option (src, i),
-			               nm_ip6_config_get_dns_option (dst, i))) {
-				are_equal = FALSE;
-				break;
-			}
-		}
-	}
-	if (!are_equal) {
-		nm_ip6_config_reset_dns_options (dst);
-		for (i = 0; i < num; i++)
-			nm_ip6_config_add_dns_option (dst, nm_ip6_config_get_dns_option (src, i));
+	if (nm_ip_config_set_replace (&dst_priv->dns_options, &src_priv->dns_options)) {
+		_notify (dst, PROP_DNS_OPTIONS);
 		has_relevant_changes = TRUE;
 	}
 
@@ -1472,7 +1506,7 @@ nm_ip6_config_dump (const NMIP6Config *self, const char *detail)
 void
 nm_ip6_config_set_never_default (NMIP6Config *self, gboolean never_default)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	priv->never_default = never_default;
 }
@@ -1488,7 +1522,7 @@ nm_ip6_config_get_never_default (const NMIP6Config *self)
 void
 nm_ip6_config_set_gateway (NMIP6Config *self, const struct in6_addr *gateway)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	if (gateway) {
 		if (IN6_ARE_ADDR_EQUAL (&priv->gateway, gateway))
@@ -1499,7 +1533,7 @@ nm_ip6_config_set_gateway (NMIP6Config *self, const struct in6_addr *gateway)
 			return;
 		memset (&priv->gateway, 0, sizeof (priv->gateway));
 	}
-	_notify (self, PROP_GATEWAY);
+	_notify_gateway (self);
 }
 
 const struct in6_addr *
@@ -1533,7 +1567,7 @@ nm_ip6_config_reset_addresses_ndisc (NMIP6Config *self,
 
 	g_return_if_fail (NM_IS_IP6_CONFIG (self));
 
-	priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	g_return_if_fail (priv->ifindex > 0);
 
@@ -1575,7 +1609,7 @@ nm_ip6_config_reset_addresses_ndisc (NMIP6Config *self,
 void
 nm_ip6_config_reset_addresses (NMIP6Config *self)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	if (nm_dedup_multi_index_remove_idx (priv->multi_idx,
 	                                     &priv->idx_ip6_addresses) > 0)
@@ -1587,7 +1621,7 @@ _add_address (NMIP6Config *self,
               const NMPObject *obj_new,
               const NMPlatformIP6Address *new)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	if (_nm_ip_config_add_obj (priv->multi_idx,
 	                           &priv->idx_ip6_addresses_,
@@ -1623,7 +1657,7 @@ nm_ip6_config_add_address (NMIP6Config *self, const NMPlatformIP6Address *new)
 void
 _nmtst_nm_ip6_config_del_address (NMIP6Config *self, guint i)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 	const NMPlatformIP6Address *a;
 
 	a = _nmtst_nm_ip6_config_get_address (self, i);
@@ -1762,7 +1796,7 @@ nm_ip6_config_reset_routes_ndisc (NMIP6Config *self,
 
 	g_return_if_fail (NM_IS_IP6_CONFIG (self));
 
-	priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	g_return_if_fail (priv->ifindex > 0);
 
@@ -1802,7 +1836,7 @@ nm_ip6_config_reset_routes_ndisc (NMIP6Config *self,
 void
 nm_ip6_config_reset_routes (NMIP6Config *self)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	if (nm_dedup_multi_index_remove_idx (priv->multi_idx,
 	                                     &priv->idx_ip6_routes) > 0)
@@ -1812,7 +1846,7 @@ nm_ip6_config_reset_routes (NMIP6Config *self)
 static void
 _add_route (NMIP6Config *self, const NMPObject *obj_new, const NMPlatformIP6Route *new)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	nm_assert ((!new) != (!obj_new));
 	nm_assert (!new || _route_valid (new));
@@ -1852,7 +1886,7 @@ nm_ip6_config_add_route (NMIP6Config *self, const NMPlatformIP6Route *new)
 void
 _nmtst_ip6_config_del_route (NMIP6Config *self, guint i)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 	const NMPlatformIP6Route *r;
 
 	r = _nmtst_ip6_config_get_route (self, i);
@@ -1892,32 +1926,45 @@ _nmtst_ip6_config_get_route (const NMIP6Config *self, guint i)
 	g_return_val_if_reached (NULL);
 }
 
-const NMPlatformIP6Route *
-nm_ip6_config_get_direct_route_for_host (const NMIP6Config *self, const struct in6_addr *host)
+static NMPPrefixTrie *
+_lpm_routes_get (const NMIP6Config *self)
 {
-	const NMPlatformIP6Route *best_route = NULL;
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE ((NMIP6Config *) self);
 	const NMPlatformIP6Route *item;
+	const NMPlatformIP6Route *best;
 	NMDedupMultiIter ipconf_iter;
 
-	g_return_val_if_fail (host && !IN6_IS_ADDR_UNSPECIFIED (host), NULL);
+	if (priv->lpm_routes)
+		return priv->lpm_routes;
 
+	/* for each destination, track the device route with the lowest metric. */
+	priv->lpm_routes = nmp_prefix_trie_new (AF_INET6);
 	nm_ip_config_iter_ip6_route_for_each (&ipconf_iter, self, &item) {
 		if (!IN6_IS_ADDR_UNSPECIFIED (&item->gateway))
 			continue;
 
-		if (best_route && best_route->plen > item->plen)
+		best = nmp_prefix_trie_lookup (priv->lpm_routes, 0, &item->network, item->plen);
+		if (   best
+		    && nm_utils_ip6_route_metric_normalize (best->metric) <= nm_utils_ip6_route_metric_normalize (item->metric))
 			continue;
 
-		if (!nm_utils_ip6_address_same_prefix (host, &item->network, item->plen))
-			continue;
+		nmp_prefix_trie_set (priv->lpm_routes, 0, &item->network, item->plen, (gpointer) item);
+	}
+	return priv->lpm_routes;
+}
 
-		if (best_route &&
-		    nm_utils_ip6_route_metric_normalize (best_route->metric) <= nm_utils_ip6_route_metric_normalize (item->metric))
-			continue;
+const NMPlatformIP6Route *
+nm_ip6_config_get_direct_route_for_host (const NMIP6Config *self, const struct in6_addr *host)
+{
+	g_return_val_if_fail (host && !IN6_IS_ADDR_UNSPECIFIED (host), NULL);
 
-		best_route = item;
-	}
-	return best_route;
+	return nmp_prefix_trie_lookup_covering (_lpm_routes_get (self),
+	                                        0,
+	                                        host,
+	                                        128,
+	                                        NULL,
+	                                        NULL,
+	                                        NULL);
 }
 
 const NMPlatformIP6Address *
@@ -1950,39 +1997,32 @@ nm_ip6_config_get_subnet_for_host (const NMIP6Config *self, const struct in6_add
 void
 nm_ip6_config_reset_nameservers (NMIP6Config *self)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	if (priv->nameservers->len != 0) {
-		g_array_set_size (priv->nameservers, 0);
-		_notify (self, PROP_NAMESERVERS);
-	}
+	if (nm_ip_config_set_reset (&priv->nameservers))
+		_notify_nameservers (self);
 }
 
 void
 nm_ip6_config_add_nameserver (NMIP6Config *self, const struct in6_addr *new)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	int i;
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	g_return_if_fail (new != NULL);
 
-	for (i = 0; i < priv->nameservers->len; i++)
-		if (IN6_ARE_ADDR_EQUAL (new, &g_array_index (priv->nameservers, struct in6_addr, i)))
-			return;
-
-	g_array_append_val (priv->nameservers, *new);
-	_notify (self, PROP_NAMESERVERS);
+	if (nm_ip_config_set_add (&priv->nameservers, new))
+		_notify_nameservers (self);
 }
 
 void
 nm_ip6_config_del_nameserver (NMIP6Config *self, guint i)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	g_return_if_fail (i < priv->nameservers->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->nameservers));
 
-	g_array_remove_index (priv->nameservers, i);
-	_notify (self, PROP_NAMESERVERS);
+	nm_ip_config_set_del (&priv->nameservers, i);
+	_notify_nameservers (self);
 }
 
 guint
@@ -1990,7 +2030,7 @@ nm_ip6_config_get_num_nameservers (const NMIP6Config *self)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return priv->nameservers->len;
+	return nm_ip_config_set_get_len (&priv->nameservers);
 }
 
 const struct in6_addr *
@@ -1998,7 +2038,7 @@ nm_ip6_config_get_nameserver (const NMIP6Config *self, guint i)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return &g_array_index (priv->nameservers, struct in6_addr, i);
+	return nm_ip_config_set_get_ip6 (&priv->nameservers, i);
 }
 
 /*****************************************************************************/
@@ -2006,39 +2046,32 @@ nm_ip6_config_get_nameserver (const NMIP6Config *self, guint i)
 void
 nm_ip6_config_reset_domains (NMIP6Config *self)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	if (priv->domains->len != 0) {
-		g_ptr_array_set_size (priv->domains, 0);
+	if (nm_ip_config_set_reset (&priv->domains))
 		_notify (self, PROP_DOMAINS);
-	}
 }
 
 void
 nm_ip6_config_add_domain (NMIP6Config *self, const char *domain)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	int i;
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	g_return_if_fail (domain != NULL);
 	g_return_if_fail (domain[0] != '\0');
 
-	for (i = 0; i < priv->domains->len; i++)
-		if (!g_strcmp0 (g_ptr_array_index (priv->domains, i), domain))
-			return;
-
-	g_ptr_array_add (priv->domains, g_strdup (domain));
-	_notify (self, PROP_DOMAINS);
+	if (nm_ip_config_set_add (&priv->domains, domain))
+		_notify (self, PROP_DOMAINS);
 }
 
 void
 nm_ip6_config_del_domain (NMIP6Config *self, guint i)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	g_return_if_fail (i < priv->domains->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->domains));
 
-	g_ptr_array_remove_index (priv->domains, i);
+	nm_ip_config_set_del (&priv->domains, i);
 	_notify (self, PROP_DOMAINS);
 }
 
@@ -2047,7 +2080,7 @@ nm_ip6_config_get_num_domains (const NMIP6Config *self)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return priv->domains->len;
+	return nm_ip_config_set_get_len (&priv->domains);
 }
 
 const char *
@@ -2055,7 +2088,7 @@ nm_ip6_config_get_domain (const NMIP6Config *self, guint i)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return g_ptr_array_index (priv->domains, i);
+	return nm_ip_config_set_get_str (&priv->domains, i);
 }
 
 /*****************************************************************************/
@@ -2063,54 +2096,43 @@ nm_ip6_config_get_domain (const NMIP6Config *self, guint i)
 void
 nm_ip6_config_reset_searches (NMIP6Config *self)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	if (priv->searches->len != 0) {
-		g_ptr_array_set_size (priv->searches, 0);
+	if (nm_ip_config_set_reset (&priv->searches))
 		_notify (self, PROP_SEARCHES);
-	}
 }
 
 void
 nm_ip6_config_add_search (NMIP6Config *self, const char *new)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	char *search;
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
+	gs_free char *search_free = NULL;
+	const char *search = new;
 	size_t len;
 
 	g_return_if_fail (new != NULL);
 	g_return_if_fail (new[0] != '\0');
 
-	search = g_strdup (new);
-
 	/* Remove trailing dot as it has no effect */
-	len = strlen (search);
-	if (search[len - 1] == '.')
-		search[len - 1] = 0;
-
-	if (!search[0]) {
-		g_free (search);
-		return;
-	}
-
-	if (nm_utils_strv_find_first ((char **) priv->searches->pdata,
-	                               priv->searches->len, search) >= 0) {
-		g_free (search);
-		return;
+	len = strlen (new);
+	if (new[len - 1] == '.') {
+		if (len == 1)
+			return;
+		search = search_free = g_strndup (new, len - 1);
 	}
 
-	g_ptr_array_add (priv->searches, search);
-	_notify (self, PROP_SEARCHES);
+	if (nm_ip_config_set_add (&priv->searches, search))
+		_notify (self, PROP_SEARCHES);
 }
 
 void
 nm_ip6_config_del_search (NMIP6Config *self, guint i)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	g_return_if_fail (i < priv->searches->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->searches));
 
-	g_ptr_array_remove_index (priv->searches, i);
+	nm_ip_config_set_del (&priv->searches, i);
 	_notify (self, PROP_SEARCHES);
 }
 
@@ -2119,7 +2141,7 @@ nm_ip6_config_get_num_searches (const NMIP6Config *self)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return priv->searches->len;
+	return nm_ip_config_set_get_len (&priv->searches);
 }
 
 const char *
@@ -2127,7 +2149,7 @@ nm_ip6_config_get_search (const NMIP6Config *self, guint i)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return g_ptr_array_index (priv->searches, i);
+	return nm_ip_config_set_get_str (&priv->searches, i);
 }
 
 /*****************************************************************************/
@@ -2135,39 +2157,32 @@ nm_ip6_config_get_search (const NMIP6Config *self, guint i)
 void
 nm_ip6_config_reset_dns_options (NMIP6Config *self)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	if (priv->dns_options->len != 0) {
-		g_ptr_array_set_size (priv->dns_options, 0);
+	if (nm_ip_config_set_reset (&priv->dns_options))
 		_notify (self, PROP_DNS_OPTIONS);
-	}
 }
 
 void
 nm_ip6_config_add_dns_option (NMIP6Config *self, const char *new)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
-	int i;
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	g_return_if_fail (new != NULL);
 	g_return_if_fail (new[0] != '\0');
 
-	for (i = 0; i < priv->dns_options->len; i++)
-		if (!g_strcmp0 (g_ptr_array_index (priv->dns_options, i), new))
-			return;
-
-	g_ptr_array_add (priv->dns_options, g_strdup (new));
-	_notify (self, PROP_DNS_OPTIONS);
+	if (nm_ip_config_set_add (&priv->dns_options, new))
+		_notify (self, PROP_DNS_OPTIONS);
 }
 
 void
 nm_ip6_config_del_dns_option (NMIP6Config *self, guint i)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
-	g_return_if_fail (i < priv->dns_options->len);
+	g_return_if_fail (i < nm_ip_config_set_get_len (&priv->dns_options));
 
-	g_ptr_array_remove_index (priv->dns_options, i);
+	nm_ip_config_set_del (&priv->dns_options, i);
 	_notify (self, PROP_DNS_OPTIONS);
 }
 
@@ -2176,7 +2191,7 @@ nm_ip6_config_get_num_dns_options (const NMIP6Config *self)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return priv->dns_options->len;
+	return nm_ip_config_set_get_len (&priv->dns_options);
 }
 
 const char *
@@ -2184,7 +2199,7 @@ nm_ip6_config_get_dns_option (const NMIP6Config *self, guint i)
 {
 	const NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
 
-	return g_ptr_array_index (priv->dns_options, i);
+	return nm_ip_config_set_get_str (&priv->dns_options, i);
 }
 
 /*****************************************************************************/
@@ -2192,7 +2207,7 @@ nm_ip6_config_get_dns_option (const NMIP6Config *self, guint i)
 void
 nm_ip6_config_set_dns_priority (NMIP6Config *self, gint priority)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	if (priority != priv->dns_priority) {
 		priv->dns_priority = priority;
@@ -2213,7 +2228,7 @@ nm_ip6_config_get_dns_priority (const NMIP6Config *self)
 void
 nm_ip6_config_set_mss (NMIP6Config *self, guint32 mss)
 {
-	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE (self);
+	NMIP6ConfigPrivate *priv = NM_IP6_CONFIG_GET_PRIVATE_MUTABLE (self);
 
 	priv->mss = mss;
 }
@@ -2332,8 +2347,8 @@ nm_ip6_config_equal (const NMIP6Config *a, const NMIP6Config *b)
 
 /*****************************************************************************/
 
-static void
-nameservers_to_gvalue (GArray *array, GValue *value)
+static GVariant *
+nameservers_to_variant (GArray *array)
 {
 	GVariantBuilder builder;
 	guint i = 0;
@@ -2349,7 +2364,7 @@ nameservers_to_gvalue (GArray *array, GValue *value)
 		                                                  addr, 16, 1));
 	}
 
-	g_value_take_variant (value, g_variant_builder_end (&builder));
+	return g_variant_builder_end (&builder);
 }
 
 static void
@@ -2493,16 +2508,18 @@ out_routes_cached:
 			g_value_set_string (value, NULL);
 		break;
 	case PROP_NAMESERVERS:
-		nameservers_to_gvalue (priv->nameservers, value);
+		if (!priv->nameservers_variant)
+			priv->nameservers_variant = g_variant_ref_sink (nameservers_to_variant (priv->nameservers.arr));
+		g_value_set_variant (value, priv->nameservers_variant);
 		break;
 	case PROP_DOMAINS:
-		nm_utils_g_value_set_strv (value, priv->domains);
+		nm_utils_g_value_set_strv (value, priv->domains.strs);
 		break;
 	case PROP_SEARCHES:
-		nm_utils_g_value_set_strv (value, priv->searches);
+		nm_utils_g_value_set_strv (value, priv->searches.strs);
 		break;
 	case PROP_DNS_OPTIONS:
-		nm_utils_g_value_set_strv (value, priv->dns_options);
+		nm_utils_g_value_set_strv (value, priv->dns_options.strs);
 		break;
 	case PROP_DNS_PRIORITY:
 		g_value_set_int (value, priv->dns_priority);
@@ -2552,10 +2569,10 @@ nm_ip6_config_init (NMIP6Config *self)
 	nm_ip_config_dedup_multi_idx_type_init ((NMIPConfigDedupMultiIdxType *) &priv->idx_ip6_routes,
 	                                        NMP_OBJECT_TYPE_IP6_ROUTE);
 
-	priv->nameservers = g_array_new (FALSE, TRUE, sizeof (struct in6_addr));
-	priv->domains = g_ptr_array_new_with_free_func (g_free);
-	priv->searches = g_ptr_array_new_with_free_func (g_free);
-	priv->dns_options = g_ptr_array_new_with_free_func (g_free);
+	nm_ip_config_set_init (&priv->nameservers, NM_IP_CONFIG_SET_TYPE_IP6);
+	nm_ip_config_set_init (&priv->domains, NM_IP_CONFIG_SET_TYPE_STR);
+	nm_ip_config_set_init (&priv->searches, NM_IP_CONFIG_SET_TYPE_STR);
+	nm_ip_config_set_init (&priv->dns_options, NM_IP_CONFIG_SET_TYPE_STR);
 	priv->route_metric = -1;
 }
 
@@ -2595,11 +2612,15 @@ finalize (GObject *object)
 	nm_clear_g_variant (&priv->addresses_variant);
 	nm_clear_g_variant (&priv->route_data_variant);
 	nm_clear_g_variant (&priv->routes_variant);
+	nm_clear_g_variant (&priv->nameservers_variant);
+
+	g_clear_pointer (&priv->lpm_addresses, nmp_prefix_trie_free);
+	g_clear_pointer (&priv->lpm_routes, nmp_prefix_trie_free);
 
-	g_array_unref (priv->nameservers);
-	g_ptr_array_unref (priv->domains);
-	g_ptr_array_unref (priv->searches);
-	g_ptr_array_unref (priv->dns_options);
+	nm_ip_config_set_clear (&priv->nameservers);
+	nm_ip_config_set_clear (&priv->domains);
+	nm_ip_config_set_clear (&priv->searches);
+	nm_ip_config_set_clear (&priv->dns_options);
 
 	G_OBJECT_CLASS (nm_ip6_config_parent_class)->finalize (object);
 
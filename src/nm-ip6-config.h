@@ -105,10 +105,20 @@ int nm_ip6_config_get_ifindex (const NMIP6Config *self);
 
 struct _NMDedupMultiIndex *nm_ip6_config_get_multi_idx (const NMIP6Config *self);
 
+/* A sealed config is an immutable snapshot that can be shared by
+ * reference, instead of being copied with nm_ip6_config_new_cloned().
+ * The modifying functions below must only be called on an unsealed
+ * instance; nm_ip6_config_unshare() replaces a sealed instance by a
+ * writable clone, so that it can be used as builder. */
+void nm_ip6_config_seal (NMIP6Config *self);
+gboolean nm_ip6_config_is_sealed (const NMIP6Config *self);
+NMIP6Config *nm_ip6_config_unshare (NMIP6Config **p_config);
+
 NMIP6Config *nm_ip6_config_capture (struct _NMDedupMultiIndex *multi_idx, NMPlatform *platform, int ifindex,
                                     gboolean capture_resolv_conf, NMSettingIP6ConfigPrivacy use_temporary);
 gboolean nm_ip6_config_commit (const NMIP6Config *self,
-                               NMPlatform *platform);
+                               NMPlatform *platform,
+                               NMIPConfigCommitState *state);
 void nm_ip6_config_merge_setting (NMIP6Config *self, NMSettingIPConfig *setting, guint32 default_route_metric);
 NMSetting *nm_ip6_config_create_setting (const NMIP6Config *self);
 
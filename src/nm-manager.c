@@ -2473,13 +2473,10 @@ out:
 
 static void
 platform_link_cb (NMPlatform *platform,
-                  int obj_type_i,
-                  int ifindex,
-                  NMPlatformLink *plink,
-                  int change_type_i,
+                  const NMPObject *obj,
+                  NMPlatformSignalChangeType change_type,
                   gpointer user_data)
 {
-	const NMPlatformSignalChangeType change_type = change_type_i;
 	PlatformLinkCbData *data;
 
 	switch (change_type) {
@@ -2487,7 +2484,7 @@ platform_link_cb (NMPlatform *platform,
 	case NM_PLATFORM_SIGNAL_REMOVED:
 		data = g_slice_new (PlatformLinkCbData);
 		data->self = NM_MANAGER (user_data);
-		data->ifindex = ifindex;
+		data->ifindex = obj->link.ifindex;
 		g_object_add_weak_pointer (G_OBJECT (data->self), (gpointer *) &data->self);
 		g_idle_add ((GSourceFunc) _platform_link_cb_idle, data);
 		break;
@@ -5186,10 +5183,11 @@ nm_manager_start (NMManager *self, GError **error)
 
 	nm_platform_process_events (NM_PLATFORM_GET);
 
-	g_signal_connect (NM_PLATFORM_GET,
-	                  NM_PLATFORM_SIGNAL_LINK_CHANGED,
-	                  G_CALLBACK (platform_link_cb),
-	                  self);
+	nm_platform_object_subscribe (NM_PLATFORM_GET,
+	                              NMP_OBJECT_TYPE_LINK,
+	                              0,
+	                              platform_link_cb,
+	                              self);
 
 	platform_query_devices (self);
 
@@ -45,6 +45,7 @@ typedef struct _NMDhcp6Config        NMDhcp6Config;
 typedef struct _NMProxyConfig        NMProxyConfig;
 typedef struct _NMIP4Config          NMIP4Config;
 typedef struct _NMIP6Config          NMIP6Config;
+typedef struct _NMIPConfigCommitState NMIPConfigCommitState;
 typedef struct _NMManager            NMManager;
 typedef struct _NMNetns              NMNetns;
 typedef struct _NMPolicy             NMPolicy;
@@ -47,6 +47,7 @@
 #include "nm-core-utils.h"
 #include "nmp-object.h"
 #include "nmp-netns.h"
+#include "nmp-nl-builder.h"
 #include "nm-platform-utils.h"
 #include "nm-platform-private.h"
 #include "wifi/wifi-utils.h"
@@ -66,6 +67,25 @@
 
 /*****************************************************************************/
 
+#ifndef RTM_NEWSTATS
+/* added in kernel 4.7 */
+#define RTM_NEWSTATS                    92
+#define RTM_GETSTATS                    94
+
+#define IFLA_STATS_LINK_64              1
+#define IFLA_STATS_FILTER_BIT(ATTR)     (1 << ((ATTR) - 1))
+
+struct if_stats_msg {
+	__u8  family;
+	__u8  pad1;
+	__u16 pad2;
+	__u32 ifindex;
+	__u32 filter_mask;
+};
+#endif
+
+/*****************************************************************************/
+
 #ifndef IFLA_PROMISCUITY
 #define IFLA_PROMISCUITY                30
 #endif
@@ -108,6 +128,14 @@
 #define MACVLAN_FLAG_NOPROMISC          1
 #endif
 
+#ifndef SOL_NETLINK
+#define SOL_NETLINK                     270
+#endif
+
+#ifndef NETLINK_GET_STRICT_CHK
+#define NETLINK_GET_STRICT_CHK          12
+#endif
+
 #define IP6_FLOWINFO_TCLASS_MASK        0x0FF00000
 #define IP6_FLOWINFO_TCLASS_SHIFT       20
 #define IP6_FLOWINFO_FLOWLABEL_MASK     0x000FFFFF
@@ -218,6 +246,7 @@ typedef enum {
 	DELAYED_ACTION_TYPE_MASTER_CONNECTED            = (1LL << 6),
 	DELAYED_ACTION_TYPE_READ_NETLINK                = (1LL << 7),
 	DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE        = (1LL << 8),
+	DELAYED_ACTION_TYPE_REFRESH_IFINDEX             = (1LL << 9),
 	__DELAYED_ACTION_TYPE_MAX,
 
 	DELAYED_ACTION_TYPE_REFRESH_ALL                 = DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
@@ -226,6 +255,11 @@ typedef enum {
 	                                                  DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
 	                                                  DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
 
+	DELAYED_ACTION_TYPE_REFRESH_ALL_ADDRROUTES      = DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
+	                                                  DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
+	                                                  DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
+	                                                  DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
+
 	DELAYED_ACTION_TYPE_MAX                         = __DELAYED_ACTION_TYPE_MAX -1,
 } DelayedActionType;
 
@@ -252,16 +286,25 @@ typedef void (*WaitForNlResponseCallback) (NMPlatform *platform,
                                            WaitForNlResponseResult seq_result,
                                            gpointer user_data);
 
+typedef struct {
+	/* one of the DELAYED_ACTION_TYPE_REFRESH_ALL_* flags for addresses
+	 * or routes. */
+	DelayedActionType refresh_type;
+	int ifindex;
+} DelayedActionRefreshIfindexData;
+
 static void delayed_action_schedule (NMPlatform *platform, DelayedActionType action_type, gpointer user_data);
 static gboolean delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink);
 static void do_request_link_no_delayed_actions (NMPlatform *platform, int ifindex, const char *name);
 static void do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType action_type);
+static void do_request_ifindex_no_delayed_actions (NMPlatform *platform, const DelayedActionRefreshIfindexData *request);
 static void cache_on_change (NMPlatform *platform,
                              NMPCacheOpsType cache_op,
                              const NMPObject *obj_old,
                              const NMPObject *obj_new);
 static void cache_prune_all (NMPlatform *platform);
 static gboolean event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks);
+static void resync_check_complete (NMPlatform *platform);
 
 /*****************************************************************************/
 
@@ -340,16 +383,11 @@ static int _support_kernel_extended_ifa_flags = 0;
 #define _support_kernel_extended_ifa_flags_still_undecided() (G_UNLIKELY (_support_kernel_extended_ifa_flags == 0))
 
 static void
-_support_kernel_extended_ifa_flags_detect (struct nl_msg *msg)
+_support_kernel_extended_ifa_flags_detect (const struct nlmsghdr *msg_hdr)
 {
-	struct nlmsghdr *msg_hdr;
 	gboolean support;
 
 	nm_assert (_support_kernel_extended_ifa_flags_still_undecided ());
-	nm_assert (msg);
-
-	msg_hdr = nlmsg_hdr (msg);
-
 	nm_assert (msg_hdr && msg_hdr->nlmsg_type == RTM_NEWADDR);
 
 	/* IFA_FLAGS is set for IPv4 and IPv6 addresses. It was added first to IPv6,
@@ -364,11 +402,34 @@ _support_kernel_extended_ifa_flags_detect (struct nl_msg *msg)
 	 *
 	 * For IPv4, IFA_F_NOPREFIXROUTE was added later, but there is no easy
 	 * way to detect kernel support. */
-	support = !!nlmsg_find_attr (msg_hdr, sizeof (struct ifaddrmsg), IFA_FLAGS);
+	support = !!nlmsg_find_attr ((struct nlmsghdr *) msg_hdr, sizeof (struct ifaddrmsg), IFA_FLAGS);
 	_support_kernel_extended_ifa_flags = support ? 1 : -1;
 	_LOG2D ("kernel-support: extended-ifa-flags: %s", support ? "detected" : "not detected");
 }
 
+/*****************************************************************************
+ * RTM_GETSTATS support
+ *****************************************************************************/
+
+static int _support_rtm_getstats = 0;
+
+static gboolean
+_support_rtm_getstats_get (void)
+{
+	return _support_rtm_getstats >= 0;
+}
+
+static void
+_support_rtm_getstats_set (gboolean supported)
+{
+	if (_support_rtm_getstats != 0)
+		return;
+	_support_rtm_getstats = supported ? 1 : -1;
+	_LOG2D ("kernel-support: RTM_GETSTATS: %s", supported ? "detected" : "not detected");
+}
+
+/*****************************************************************************/
+
 static gboolean
 _support_kernel_extended_ifa_flags_get (void)
 {
@@ -676,6 +737,8 @@ _linktype_read_devtype (int dirfd)
 	return NULL;
 }
 
+static const NMPUtilsEthtoolDriverInfo *_ethtool_get_driver_info (NMPlatform *platform, int ifindex, NMPUtilsEthtoolDriverInfo *buf);
+
 static NMLinkType
 _linktype_get_type (NMPlatform *platform,
                     const NMPCache *cache,
@@ -719,6 +782,20 @@ _linktype_get_type (NMPlatform *platform,
 			*out_kind = obj->link.kind;
 			return obj->link.type;
 		}
+
+		/* Links of a kind that we don't know stay unknown. Once udev
+		 * announced the link, sysfs is complete and there is no race
+		 * anymore. Don't look at ethtool and sysfs again for every
+		 * change of the link. */
+		if (   obj
+		    && obj->link.type == NM_LINK_TYPE_UNKNOWN
+		    && obj->link.initialized
+		    && kind
+		    && nm_streq (ifname, obj->link.name)
+		    && nm_streq0 (kind, obj->link.kind)) {
+			*out_kind = obj->link.kind;
+			return NM_LINK_TYPE_UNKNOWN;
+		}
 	}
 
 	*out_kind = g_intern_string (kind);
@@ -759,18 +836,20 @@ _linktype_get_type (NMPlatform *platform,
 		return NM_LINK_TYPE_PPP;
 
 	{
-		NMPUtilsEthtoolDriverInfo driver_info;
+		NMPUtilsEthtoolDriverInfo driver_info_buf;
+		const NMPUtilsEthtoolDriverInfo *driver_info;
 
 		/* Fallback OVS detection for kernel <= 3.16 */
-		if (nmp_utils_ethtool_get_driver_info (ifindex, &driver_info)) {
-			if (nm_streq (driver_info.driver, "openvswitch"))
+		driver_info = _ethtool_get_driver_info (platform, ifindex, &driver_info_buf);
+		if (driver_info) {
+			if (nm_streq (driver_info->driver, "openvswitch"))
 				return NM_LINK_TYPE_OPENVSWITCH;
 
 			if (arptype == 256) {
 				/* Some s390 CTC-type devices report 256 for the encapsulation type
 				 * for some reason, but we need to call them Ethernet.
 				 */
-				if (nm_streq (driver_info.driver, "ctcm"))
+				if (nm_streq (driver_info->driver, "ctcm"))
 					return NM_LINK_TYPE_ETHERNET;
 			}
 		}
@@ -1870,7 +1949,7 @@ errout:
 
 /* Copied and heavily modified from libnl3's addr_msg_parser(). */
 static NMPObject *
-_new_from_nl_addr (struct nlmsghdr *nlh, gboolean id_only)
+_new_from_nl_addr (struct nlmsghdr *nlh, gboolean id_only, NMPObject *obj_stack)
 {
 	static struct nla_policy policy[IFA_MAX+1] = {
 		[IFA_LABEL]     = { .type = NLA_STRING,
@@ -1907,7 +1986,10 @@ _new_from_nl_addr (struct nlmsghdr *nlh, gboolean id_only)
 
 	/*****************************************************************/
 
-	obj = nmp_object_new (is_v4 ? NMP_OBJECT_TYPE_IP4_ADDRESS : NMP_OBJECT_TYPE_IP6_ADDRESS, NULL);
+	if (obj_stack)
+		obj = (NMPObject *) nmp_object_stackinit (obj_stack, is_v4 ? NMP_OBJECT_TYPE_IP4_ADDRESS : NMP_OBJECT_TYPE_IP6_ADDRESS, NULL);
+	else
+		obj = nmp_object_new (is_v4 ? NMP_OBJECT_TYPE_IP4_ADDRESS : NMP_OBJECT_TYPE_IP6_ADDRESS, NULL);
 
 	obj->ip_address.ifindex = ifa->ifa_index;
 	obj->ip_address.plen = ifa->ifa_prefixlen;
@@ -1980,12 +2062,16 @@ _new_from_nl_addr (struct nlmsghdr *nlh, gboolean id_only)
 	obj_result = obj;
 	obj = NULL;
 errout:
+	if (obj == obj_stack) {
+		/* the stack instance is owned by the caller. */
+		obj = NULL;
+	}
 	return obj_result;
 }
 
 /* Copied and heavily modified from libnl3's rtnl_route_parse() and parse_multipath(). */
 static NMPObject *
-_new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
+_new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only, const NMPlatformIPRouteFilter *route_filter, NMPObject *obj_stack)
 {
 	static struct nla_policy policy[RTA_MAX+1] = {
 		[RTA_IIF]       = { .type = NLA_U32 },
@@ -2026,6 +2112,19 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	if (rtm->rtm_type != RTN_UNICAST)
 		goto errout;
 
+	/* drop routes of ignored tables and protocols early, before parsing
+	 * the attributes. Responses to RTM_GETROUTE are never ignored. For tables
+	 * beyond 255, the header only contains RT_TABLE_COMPAT and we have to check
+	 * RTA_TABLE below. */
+	if (   route_filter
+	    && !NM_FLAGS_HAS (rtm->rtm_flags, RTM_F_CLONED)) {
+		if (nm_platform_ip_route_filter_ignores_protocol (route_filter, rtm->rtm_protocol))
+			goto errout;
+		if (   rtm->rtm_table != RT_TABLE_COMPAT
+		    && nm_platform_ip_route_filter_ignores_table (route_filter, rtm->rtm_table))
+			goto errout;
+	}
+
 	err = nlmsg_parse (nlh, sizeof (struct rtmsg), tb, RTA_MAX, policy);
 	if (err < 0)
 		goto errout;
@@ -2034,6 +2133,12 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	        ? nla_get_u32 (tb[RTA_TABLE])
 	        : (guint32) rtm->rtm_table;
 
+	if (   route_filter
+	    && table >= 256
+	    && !NM_FLAGS_HAS (rtm->rtm_flags, RTM_F_CLONED)
+	    && nm_platform_ip_route_filter_ignores_table (route_filter, table))
+		goto errout;
+
 	/*****************************************************************/
 
 	is_v4 = rtm->rtm_family == AF_INET;
@@ -2147,7 +2252,10 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 
 	/*****************************************************************/
 
-	obj = nmp_object_new (is_v4 ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE, NULL);
+	if (obj_stack)
+		obj = (NMPObject *) nmp_object_stackinit (obj_stack, is_v4 ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE, NULL);
+	else
+		obj = nmp_object_new (is_v4 ? NMP_OBJECT_TYPE_IP4_ROUTE : NMP_OBJECT_TYPE_IP6_ROUTE, NULL);
 
 	obj->ip_route.table_coerced = nm_platform_route_table_coerce (table);
 	obj->ip_route.ifindex = nh.ifindex;
@@ -2213,6 +2321,10 @@ _new_from_nl_route (struct nlmsghdr *nlh, gboolean id_only)
 	obj_result = obj;
 	obj = NULL;
 errout:
+	if (obj == obj_stack) {
+		/* the stack instance is owned by the caller. */
+		obj = NULL;
+	}
 	return obj_result;
 }
 
@@ -2223,21 +2335,17 @@ errout:
  *   be correctly detected.
  * @cache: (allow-none): for certain objects, the netlink message doesn't contain all the information.
  *   If a cache is given, the object is completed with information from the cache.
- * @nlh: the netlink message header
+ * @msghdr: the netlink message header
  * @id_only: whether only to create an empty object with only the ID fields set.
+ * @obj_stack: (allow-none): for addresses and routes, initialize this stack
+ *   instance instead of allocating a new object.
  *
- * Returns: %NULL or a newly created NMPObject instance.
+ * Returns: %NULL or a newly created NMPObject instance. If @obj_stack is given
+ *   and the message is an address or a route, @obj_stack is returned.
  **/
 static NMPObject *
-nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_msg *msg, gboolean id_only)
+nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nlmsghdr *msghdr, gboolean id_only, NMPObject *obj_stack)
 {
-	struct nlmsghdr *msghdr;
-
-	if (nlmsg_get_proto (msg) != NETLINK_ROUTE)
-		return NULL;
-
-	msghdr = nlmsg_hdr (msg);
-
 	switch (msghdr->nlmsg_type) {
 	case RTM_NEWLINK:
 	case RTM_DELLINK:
@@ -2247,11 +2355,14 @@ nmp_object_new_from_nl (NMPlatform *platform, const NMPCache *cache, struct nl_m
 	case RTM_NEWADDR:
 	case RTM_DELADDR:
 	case RTM_GETADDR:
-		return _new_from_nl_addr (msghdr, id_only);
+		return _new_from_nl_addr (msghdr, id_only, obj_stack);
 	case RTM_NEWROUTE:
 	case RTM_DELROUTE:
 	case RTM_GETROUTE:
-		return _new_from_nl_route (msghdr, id_only);
+		return _new_from_nl_route (msghdr,
+		                           id_only,
+		                           platform ? nm_platform_get_ip_route_filter (platform) : NULL,
+		                           obj_stack);
 	default:
 		return NULL;
 	}
@@ -2479,22 +2590,25 @@ nla_put_failure:
 	g_return_val_if_reached (NULL);
 }
 
+/* a buffer on the stack that is large enough for any address or route request. */
+#define NL_BUILDER_STACK(name) NMP_NL_BUILDER_DEFINE_STACK (name, 256)
+
 /* Copied and modified from libnl3's build_addr_msg(). */
-static struct nl_msg *
-_nl_msg_new_address (int nlmsg_type,
-                     int nlmsg_flags,
-                     int family,
-                     int ifindex,
-                     gconstpointer address,
-                     guint8 plen,
-                     gconstpointer peer_address,
-                     guint32 flags,
-                     int scope,
-                     guint32 lifetime,
-                     guint32 preferred,
-                     const char *label)
+static gboolean
+_nl_builder_append_address (NMPNlBuilder *builder,
+                            int nlmsg_type,
+                            int nlmsg_flags,
+                            int family,
+                            int ifindex,
+                            gconstpointer address,
+                            guint8 plen,
+                            gconstpointer peer_address,
+                            guint32 flags,
+                            int scope,
+                            guint32 lifetime,
+                            guint32 preferred,
+                            const char *label)
 {
-	struct nl_msg *msg;
 	struct ifaddrmsg am = {
 		.ifa_family = family,
 		.ifa_index = ifindex,
@@ -2502,14 +2616,15 @@ _nl_msg_new_address (int nlmsg_type,
 		.ifa_flags = flags,
 	};
 	gsize addr_len;
+	gsize attrs_len = 0;
+	gboolean has_label;
+	gboolean has_broadcast;
+	gboolean has_cacheinfo;
+	gboolean has_flags;
 
 	nm_assert (NM_IN_SET (family, AF_INET, AF_INET6));
 	nm_assert (NM_IN_SET (nlmsg_type, RTM_NEWADDR, RTM_DELADDR));
 
-	msg = nlmsg_alloc_simple (nlmsg_type, nlmsg_flags);
-	if (!msg)
-		g_return_val_if_reached (NULL);
-
 	if (scope == -1) {
 		/* Allow having scope unset, and detect the scope (including IPv4 compatibility hack). */
 		if (   family == AF_INET
@@ -2523,55 +2638,73 @@ _nl_msg_new_address (int nlmsg_type,
 
 	addr_len = family == AF_INET ? sizeof (in_addr_t) : sizeof (struct in6_addr);
 
-	if (nlmsg_append (msg, &am, sizeof (am), NLMSG_ALIGNTO) < 0)
-		goto nla_put_failure;
+	has_label = label && label[0];
+	has_broadcast =    family == AF_INET
+	                && nlmsg_type != RTM_DELADDR
+	                && address
+	                && *((in_addr_t *) address) != 0;
+	has_cacheinfo =    lifetime != NM_PLATFORM_LIFETIME_PERMANENT
+	                || preferred != NM_PLATFORM_LIFETIME_PERMANENT;
+
+	/* only set the IFA_FLAGS attribute, if they actually contain additional
+	 * flags that are not already set to am.ifa_flags.
+	 *
+	 * Older kernels refuse RTM_NEWADDR and RTM_NEWROUTE messages with EINVAL
+	 * if they contain unknown netlink attributes. See net/core/rtnetlink.c, which
+	 * was fixed by kernel commit 661d2967b3f1b34eeaa7e212e7b9bbe8ee072b59. */
+	has_flags = NM_FLAGS_ANY (flags, ~((guint32) 0xFF));
+
+	if (address)
+		attrs_len += NMP_NL_BUILDER_ATTR_SIZE (addr_len);
+	if (peer_address || address)
+		attrs_len += NMP_NL_BUILDER_ATTR_SIZE (addr_len);
+	if (has_label)
+		attrs_len += NMP_NL_BUILDER_ATTR_SIZE (strlen (label) + 1);
+	if (has_broadcast)
+		attrs_len += NMP_NL_BUILDER_ATTR_SIZE (addr_len);
+	if (has_cacheinfo)
+		attrs_len += NMP_NL_BUILDER_ATTR_SIZE (sizeof (struct ifa_cacheinfo));
+	if (has_flags)
+		attrs_len += NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32));
+
+	nmp_nl_builder_msg_begin (builder, nlmsg_type, nlmsg_flags, &am, sizeof (am), attrs_len);
 
 	if (address)
-		NLA_PUT (msg, IFA_LOCAL, addr_len, address);
+		NMP_NL_BUILDER_PUT (builder, IFA_LOCAL, address, addr_len);
 
 	if (peer_address)
-		NLA_PUT (msg, IFA_ADDRESS, addr_len, peer_address);
+		NMP_NL_BUILDER_PUT (builder, IFA_ADDRESS, peer_address, addr_len);
 	else if (address)
-		NLA_PUT (msg, IFA_ADDRESS, addr_len, address);
+		NMP_NL_BUILDER_PUT (builder, IFA_ADDRESS, address, addr_len);
 
-	if (label && label[0])
-		NLA_PUT_STRING (msg, IFA_LABEL, label);
+	if (has_label)
+		NMP_NL_BUILDER_PUT_STRING (builder, IFA_LABEL, label);
 
-	if (   family == AF_INET
-	    && nlmsg_type != RTM_DELADDR
-	    && address
-	    && *((in_addr_t *) address) != 0) {
+	if (has_broadcast) {
 		in_addr_t broadcast;
 
 		broadcast = *((in_addr_t *) address) | ~nm_utils_ip4_prefix_to_netmask (plen);
-		NLA_PUT (msg, IFA_BROADCAST, addr_len, &broadcast);
+		NMP_NL_BUILDER_PUT (builder, IFA_BROADCAST, &broadcast, addr_len);
 	}
 
-	if (   lifetime != NM_PLATFORM_LIFETIME_PERMANENT
-	    || preferred != NM_PLATFORM_LIFETIME_PERMANENT) {
+	if (has_cacheinfo) {
 		struct ifa_cacheinfo ca = {
 			.ifa_valid = lifetime,
 			.ifa_prefered = preferred,
 		};
 
-		NLA_PUT (msg, IFA_CACHEINFO, sizeof(ca), &ca);
+		NMP_NL_BUILDER_PUT (builder, IFA_CACHEINFO, &ca, sizeof (ca));
 	}
 
-	if (flags & ~((guint32) 0xFF)) {
-		/* only set the IFA_FLAGS attribute, if they actually contain additional
-		 * flags that are not already set to am.ifa_flags.
-		 *
-		 * Older kernels refuse RTM_NEWADDR and RTM_NEWROUTE messages with EINVAL
-		 * if they contain unknown netlink attributes. See net/core/rtnetlink.c, which
-		 * was fixed by kernel commit 661d2967b3f1b34eeaa7e212e7b9bbe8ee072b59. */
-		NLA_PUT_U32 (msg, IFA_FLAGS, flags);
-	}
+	if (has_flags)
+		NMP_NL_BUILDER_PUT_U32 (builder, IFA_FLAGS, flags);
 
-	return msg;
+	nmp_nl_builder_msg_end (builder);
+	return TRUE;
 
 nla_put_failure:
-	nlmsg_free (msg);
-	g_return_val_if_reached (NULL);
+	nmp_nl_builder_msg_cancel (builder);
+	g_return_val_if_reached (FALSE);
 }
 
 static guint32
@@ -2585,12 +2718,12 @@ ip_route_get_lock_flag (const NMPlatformIPRoute *route)
 }
 
 /* Copied and modified from libnl3's build_route_msg() and rtnl_route_build_msg(). */
-static struct nl_msg *
-_nl_msg_new_route (int nlmsg_type,
-                   guint16 nlmsgflags,
-                   const NMPObject *obj)
+static gboolean
+_nl_builder_append_route (NMPNlBuilder *builder,
+                          int nlmsg_type,
+                          guint16 nlmsgflags,
+                          const NMPObject *obj)
 {
-	struct nl_msg *msg;
 	const NMPClass *klass = NMP_OBJECT_GET_CLASS (obj);
 	gboolean is_v4 = klass->addr_family == AF_INET;
 	const guint32 lock = ip_route_get_lock_flag (NMP_OBJECT_CAST_IP_ROUTE (obj));
@@ -2612,85 +2745,175 @@ _nl_msg_new_route (int nlmsg_type,
 		               ? 0
 		               : NMP_OBJECT_CAST_IP6_ROUTE (obj)->src_plen,
 	};
-
 	gsize addr_len;
+	gsize attrs_len;
+	guint n_metrics;
+	gboolean has_src;
+	gboolean has_pref_src;
+	gboolean has_gateway;
 
 	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ROUTE, NMP_OBJECT_TYPE_IP6_ROUTE));
 	nm_assert (NM_IN_SET (nlmsg_type, RTM_NEWROUTE, RTM_DELROUTE));
 
-	msg = nlmsg_alloc_simple (nlmsg_type, (int) nlmsgflags);
-	if (!msg)
-		g_return_val_if_reached (NULL);
-
-	if (nlmsg_append (msg, &rtmsg, sizeof (rtmsg), NLMSG_ALIGNTO) < 0)
-		goto nla_put_failure;
-
 	addr_len = is_v4
 	             ? sizeof (in_addr_t)
 	             : sizeof (struct in6_addr);
 
-	NLA_PUT (msg, RTA_DST, addr_len,
-	         is_v4
-	           ? (gconstpointer) &obj->ip4_route.network
-	           : (gconstpointer) &obj->ip6_route.network);
-
-	if (!is_v4) {
-		if (!IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (obj)->src))
-			NLA_PUT (msg, RTA_SRC, addr_len, &obj->ip6_route.src);
-	}
-
-	NLA_PUT_U32 (msg, RTA_PRIORITY, obj->ip_route.metric);
+	if (is_v4) {
+		has_src = FALSE;
+		has_pref_src = !!NMP_OBJECT_CAST_IP4_ROUTE (obj)->pref_src;
+		/* We currently don't have need for multi-hop routes... */
+		has_gateway = TRUE;
+	} else {
+		has_src = !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (obj)->src);
+		has_pref_src = !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (obj)->pref_src);
+		has_gateway = !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (obj)->gateway);
+	}
+
+	n_metrics =   (!!obj->ip_route.mss)
+	            + (!!obj->ip_route.window)
+	            + (!!obj->ip_route.cwnd)
+	            + (!!obj->ip_route.initcwnd)
+	            + (!!obj->ip_route.initrwnd)
+	            + (!!obj->ip_route.mtu)
+	            + (!!lock);
+
+	attrs_len =   NMP_NL_BUILDER_ATTR_SIZE (addr_len)                          /* RTA_DST */
+	            + (has_src ? NMP_NL_BUILDER_ATTR_SIZE (addr_len) : 0)          /* RTA_SRC */
+	            + NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32))                  /* RTA_PRIORITY */
+	            + (table > 0xFF ? NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32)) : 0) /* RTA_TABLE */
+	            + (has_pref_src ? NMP_NL_BUILDER_ATTR_SIZE (addr_len) : 0)     /* RTA_PREFSRC */
+	            + (n_metrics > 0                                               /* RTA_METRICS */
+	               ? NMP_NL_BUILDER_ATTR_SIZE (0) + n_metrics * NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32))
+	               : 0)
+	            + (has_gateway ? NMP_NL_BUILDER_ATTR_SIZE (addr_len) : 0)      /* RTA_GATEWAY */
+	            + NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32));                 /* RTA_OIF */
+
+	nmp_nl_builder_msg_begin (builder, nlmsg_type, nlmsgflags, &rtmsg, sizeof (rtmsg), attrs_len);
+
+	NMP_NL_BUILDER_PUT (builder, RTA_DST,
+	                    is_v4
+	                      ? (gconstpointer) &obj->ip4_route.network
+	                      : (gconstpointer) &obj->ip6_route.network,
+	                    addr_len);
+
+	if (has_src)
+		NMP_NL_BUILDER_PUT (builder, RTA_SRC, &obj->ip6_route.src, addr_len);
+
+	NMP_NL_BUILDER_PUT_U32 (builder, RTA_PRIORITY, obj->ip_route.metric);
 
 	if (table > 0xFF)
-		NLA_PUT_U32 (msg, RTA_TABLE, table);
+		NMP_NL_BUILDER_PUT_U32 (builder, RTA_TABLE, table);
 
-	if (is_v4) {
-		if (NMP_OBJECT_CAST_IP4_ROUTE (obj)->pref_src)
-			NLA_PUT (msg, RTA_PREFSRC, addr_len, &obj->ip4_route.pref_src);
-	} else {
-		if (!IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (obj)->pref_src))
-			NLA_PUT (msg, RTA_PREFSRC, addr_len, &obj->ip6_route.pref_src);
+	if (has_pref_src) {
+		NMP_NL_BUILDER_PUT (builder, RTA_PREFSRC,
+		                    is_v4
+		                      ? (gconstpointer) &obj->ip4_route.pref_src
+		                      : (gconstpointer) &obj->ip6_route.pref_src,
+		                    addr_len);
 	}
 
-	if (   obj->ip_route.mss
-	    || obj->ip_route.window
-	    || obj->ip_route.cwnd
-	    || obj->ip_route.initcwnd
-	    || obj->ip_route.initrwnd
-	    || obj->ip_route.mtu
-	    || lock) {
-		struct nlattr *metrics;
+	if (n_metrics > 0) {
+		gsize metrics;
 
-		metrics = nla_nest_start (msg, RTA_METRICS);
+		metrics = nmp_nl_builder_nest_start (builder, RTA_METRICS);
 		if (!metrics)
 			goto nla_put_failure;
 
 		if (obj->ip_route.mss)
-			NLA_PUT_U32 (msg, RTAX_ADVMSS, obj->ip_route.mss);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_ADVMSS, obj->ip_route.mss);
 		if (obj->ip_route.window)
-			NLA_PUT_U32 (msg, RTAX_WINDOW, obj->ip_route.window);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_WINDOW, obj->ip_route.window);
 		if (obj->ip_route.cwnd)
-			NLA_PUT_U32 (msg, RTAX_CWND, obj->ip_route.cwnd);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_CWND, obj->ip_route.cwnd);
 		if (obj->ip_route.initcwnd)
-			NLA_PUT_U32 (msg, RTAX_INITCWND, obj->ip_route.initcwnd);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_INITCWND, obj->ip_route.initcwnd);
 		if (obj->ip_route.initrwnd)
-			NLA_PUT_U32 (msg, RTAX_INITRWND, obj->ip_route.initrwnd);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_INITRWND, obj->ip_route.initrwnd);
 		if (obj->ip_route.mtu)
-			NLA_PUT_U32 (msg, RTAX_MTU, obj->ip_route.mtu);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_MTU, obj->ip_route.mtu);
 		if (lock)
-			NLA_PUT_U32 (msg, RTAX_LOCK, lock);
+			NMP_NL_BUILDER_PUT_U32 (builder, RTAX_LOCK, lock);
 
-		nla_nest_end(msg, metrics);
+		nmp_nl_builder_nest_end (builder, metrics);
 	}
 
-	/* We currently don't have need for multi-hop routes... */
-	if (is_v4) {
-		NLA_PUT (msg, RTA_GATEWAY, addr_len, &obj->ip4_route.gateway);
-	} else {
-		if (!IN6_IS_ADDR_UNSPECIFIED (&obj->ip6_route.gateway))
-			NLA_PUT (msg, RTA_GATEWAY, addr_len, &obj->ip6_route.gateway);
+	if (has_gateway) {
+		NMP_NL_BUILDER_PUT (builder, RTA_GATEWAY,
+		                    is_v4
+		                      ? (gconstpointer) &obj->ip4_route.gateway
+		                      : (gconstpointer) &obj->ip6_route.gateway,
+		                    addr_len);
+	}
+	NMP_NL_BUILDER_PUT_U32 (builder, RTA_OIF, obj->ip_route.ifindex);
+
+	nmp_nl_builder_msg_end (builder);
+	return TRUE;
+
+nla_put_failure:
+	nmp_nl_builder_msg_cancel (builder);
+	g_return_val_if_reached (FALSE);
+}
+
+/* Create a dump request for @obj_type. Unlike nl_rtgen_request(), we always
+ * send the full header of the message type (instead of a struct rtgenmsg).
+ * That is required by kernels with NETLINK_GET_STRICT_CHK enabled and
+ * is accepted by older kernels too, which only look at the family.
+ *
+ * The @ifindex filter is only honored by the kernel with strict checking
+ * enabled. Otherwise, it is silently ignored and the reply contains all
+ * objects. */
+static struct nl_msg *
+_nl_msg_new_dump (NMPObjectType obj_type,
+                  int ifindex)
+{
+	struct nl_msg *msg;
+	const NMPClass *klass = nmp_class_from_type (obj_type);
+
+	msg = nlmsg_alloc_simple (klass->rtm_gettype, NLM_F_DUMP);
+	if (!msg)
+		g_return_val_if_reached (NULL);
+
+	switch (obj_type) {
+	case NMP_OBJECT_TYPE_LINK: {
+		const struct ifinfomsg ifi = {
+			.ifi_family = klass->addr_family,
+		};
+
+		nm_assert (ifindex == 0);
+		if (nlmsg_append (msg, &ifi, sizeof (ifi), NLMSG_ALIGNTO) < 0)
+			goto nla_put_failure;
+		break;
+	}
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+	case NMP_OBJECT_TYPE_IP6_ADDRESS: {
+		const struct ifaddrmsg ifa = {
+			.ifa_family = klass->addr_family,
+			.ifa_index = ifindex,
+		};
+
+		nm_assert (ifindex >= 0);
+		if (nlmsg_append (msg, &ifa, sizeof (ifa), NLMSG_ALIGNTO) < 0)
+			goto nla_put_failure;
+		break;
+	}
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE: {
+		const struct rtmsg rtm = {
+			.rtm_family = klass->addr_family,
+		};
+
+		nm_assert (ifindex >= 0);
+		if (nlmsg_append (msg, &rtm, sizeof (rtm), NLMSG_ALIGNTO) < 0)
+			goto nla_put_failure;
+		if (ifindex > 0)
+			NLA_PUT_U32 (msg, RTA_OIF, ifindex);
+		break;
+	}
+	default:
+		nm_assert_not_reached ();
+		goto nla_put_failure;
 	}
-	NLA_PUT_U32 (msg, RTA_OIF, obj->ip_route.ifindex);
 
 	return msg;
 
@@ -2722,6 +2945,17 @@ typedef struct {
 	} response;
 } DelayedActionWaitForNlResponseData;
 
+typedef struct {
+	DelayedActionRefreshIfindexData request;
+	WaitForNlResponseResult seq_result;
+} RefreshIfindexPruneData;
+
+static void
+_refresh_ifindex_prune_data_free (gpointer data)
+{
+	g_slice_free (RefreshIfindexPruneData, data);
+}
+
 typedef struct {
 	struct nl_sock *nlh;
 	guint32 nlh_seq_next;
@@ -2732,8 +2966,39 @@ typedef struct {
 	GIOChannel *event_channel;
 	guint event_id;
 
+	/* route events are received on a separate socket, which is read after
+	 * @nlh. They are by far the most frequent events, and when this socket
+	 * overflows, only the routes must be resynchronized. */
+	struct nl_sock *nlh_route_events;
+	GIOChannel *event_channel_route_events;
+	guint event_id_route_events;
+
+	struct {
+		/* the buffer for receiving from both netlink sockets. If it is too
+		 * small for a message, it grows. */
+		unsigned char *data;
+		gsize len;
+		bool in_use;
+	} recv_buf;
+
+	struct {
+		/* the DELAYED_ACTION_TYPE_REFRESH_ALL_* types that are resynchronized
+		 * after an overflow of the receive buffer, and when that started. */
+		DelayedActionType types;
+		gint64 start_ns;
+		NMLinuxPlatformResyncStats stats;
+	} resync;
+
 	bool pruning[_DELAYED_ACTION_IDX_REFRESH_ALL_NUM];
 
+	/* whether the kernel supports NETLINK_GET_STRICT_CHK, which we need
+	 * to filter dump requests by ifindex. */
+	bool nlh_strict_check;
+
+	/* filtered dump requests (of type RefreshIfindexPruneData) that were sent
+	 * and whose objects must be pruned once the reply is complete. */
+	GPtrArray *pruning_ifindex;
+
 	bool sysctl_get_warned;
 	GHashTable *sysctl_get_prev_values;
 
@@ -2750,12 +3015,27 @@ typedef struct {
 
 		GPtrArray *list_master_connected;
 		GPtrArray *list_refresh_link;
+		GArray *list_refresh_ifindex;
 		GArray *list_wait_for_nl_response;
 
 		gint is_handling;
 	} delayed_action;
 
 	GHashTable *wifi_data;
+
+	/* EthtoolInfo by ifindex, for links in the cache. */
+	GHashTable *ethtool_infos;
+	NMLinuxPlatformEthtoolStats ethtool_stats;
+
+	/* the sorted ifindexes, for which link_stats_refresh() currently
+	 * waits for the RTM_GETSTATS dump. */
+	struct {
+		const int *ifindexes;
+		guint n_ifindexes;
+	} link_stats;
+
+	/* the buffer for the requests of ip_batch(), reused for each window. */
+	NMPNlBuilder nl_builder;
 } NMLinuxPlatformPrivate;
 
 struct _NMLinuxPlatform {
@@ -2771,26 +3051,185 @@ G_DEFINE_TYPE (NMLinuxPlatform, nm_linux_platform, NM_TYPE_PLATFORM)
 
 #define NM_LINUX_PLATFORM_GET_PRIVATE(self) _NM_GET_PRIVATE_VOID(self, NMLinuxPlatform, NM_IS_LINUX_PLATFORM)
 
+static gboolean
+_platform_use_udev (void)
+{
+	/* udev only works in the initial network namespace, and only
+	 * if we may write /sys. */
+	return    nmp_netns_is_initial ()
+	       && access ("/sys", W_OK) == 0;
+}
+
 NMPlatform *
 nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support)
 {
-	gboolean use_udev = FALSE;
-
-	if (   nmp_netns_is_initial ()
-	    && access ("/sys", W_OK) == 0)
-		use_udev = TRUE;
-
 	return g_object_new (NM_TYPE_LINUX_PLATFORM,
 	                     NM_PLATFORM_LOG_WITH_PTR, log_with_ptr,
-	                     NM_PLATFORM_USE_UDEV, use_udev,
+	                     NM_PLATFORM_USE_UDEV, _platform_use_udev (),
 	                     NM_PLATFORM_NETNS_SUPPORT, netns_support,
 	                     NULL);
 }
 
+/**
+ * nm_linux_platform_get_resync_stats:
+ * @self: the #NMLinuxPlatform instance
+ * @out_stats: (out): the statistics about resynchronizations of the
+ *   cache after the netlink sockets overflowed.
+ */
+void
+nm_linux_platform_get_resync_stats (NMPlatform *self, NMLinuxPlatformResyncStats *out_stats)
+{
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (self));
+	g_return_if_fail (out_stats);
+
+	*out_stats = NM_LINUX_PLATFORM_GET_PRIVATE (self)->resync.stats;
+}
+
+/**
+ * nm_linux_platform_get_ethtool_stats:
+ * @self: the #NMLinuxPlatform instance
+ * @out_stats: (out): the number of ethtool requests, and how many
+ *   requests were answered from the cache.
+ */
+void
+nm_linux_platform_get_ethtool_stats (NMPlatform *self, NMLinuxPlatformEthtoolStats *out_stats)
+{
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (self));
+	g_return_if_fail (out_stats);
+
+	*out_stats = NM_LINUX_PLATFORM_GET_PRIVATE (self)->ethtool_stats;
+}
+
 void
 nm_linux_platform_setup (void)
 {
-	nm_platform_setup (nm_linux_platform_new (FALSE, FALSE));
+	nm_linux_platform_setup_full (NULL, NULL);
+}
+
+void
+nm_linux_platform_setup_full (const char *ignore_route_tables,
+                              const char *ignore_route_protocols)
+{
+	nm_platform_setup (g_object_new (NM_TYPE_LINUX_PLATFORM,
+	                                 NM_PLATFORM_LOG_WITH_PTR, FALSE,
+	                                 NM_PLATFORM_USE_UDEV, _platform_use_udev (),
+	                                 NM_PLATFORM_NETNS_SUPPORT, FALSE,
+	                                 NM_PLATFORM_IGNORE_ROUTE_TABLES, ignore_route_tables,
+	                                 NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS, ignore_route_protocols,
+	                                 NULL));
+}
+
+/*****************************************************************************/
+
+/* Results of ethtool requests that don't change while the link exists. */
+typedef struct {
+	NMPUtilsEthtoolDriverInfo driver_info;
+	guint8 perm_addr[NM_UTILS_HWADDR_LEN_MAX];
+	size_t perm_addr_len;
+
+	/* the index of the "vlan-challenged" feature, or -1 if the driver
+	 * doesn't have it. */
+	int feature_idx_vlan_challenged;
+
+	bool carrier_detect:1;
+
+	/* for each of the values above, whether it is known. A failure to get
+	 * the driver info or the permanent address might be temporary (for
+	 * example, while the driver is still loading), so they are only cached
+	 * on success. Missing carrier-detect support and a missing
+	 * "vlan-challenged" feature are cached too, but they are forgotten
+	 * whenever the link changes. */
+	bool driver_info_cached:1;
+	bool perm_addr_cached:1;
+	bool feature_idx_vlan_challenged_cached:1;
+	bool carrier_detect_cached:1;
+} EthtoolInfo;
+
+static void
+_ethtool_info_free (gpointer data)
+{
+	g_slice_free (EthtoolInfo, data);
+}
+
+static void
+_ethtool_stats_inc (NMPlatform *platform, gboolean cached)
+{
+	NMLinuxPlatformEthtoolStats *stats;
+
+	if (!platform)
+		return;
+
+	stats = &NM_LINUX_PLATFORM_GET_PRIVATE (platform)->ethtool_stats;
+	if (cached)
+		stats->n_cached++;
+	else
+		stats->n_requests++;
+}
+
+/* forget the results that are cached although the request failed. After
+ * the link changed, they might succeed. */
+static void
+_ethtool_info_drop_negative (NMPlatform *platform, int ifindex)
+{
+	EthtoolInfo *info;
+
+	info = g_hash_table_lookup (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->ethtool_infos, GINT_TO_POINTER (ifindex));
+	if (!info)
+		return;
+
+	if (!info->carrier_detect)
+		info->carrier_detect_cached = FALSE;
+	if (info->feature_idx_vlan_challenged < 0)
+		info->feature_idx_vlan_challenged_cached = FALSE;
+}
+
+/* returns the cached ethtool information for @ifindex. Returns %NULL if
+ * the link is not in the cache, because then we would not notice when
+ * the ifindex gets reused. */
+static EthtoolInfo *
+_ethtool_info_get (NMPlatform *platform, int ifindex)
+{
+	NMLinuxPlatformPrivate *priv;
+	EthtoolInfo *info;
+
+	if (!platform)
+		return NULL;
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	info = g_hash_table_lookup (priv->ethtool_infos, GINT_TO_POINTER (ifindex));
+	if (info)
+		return info;
+
+	if (!nm_platform_link_get_obj (platform, ifindex, FALSE))
+		return NULL;
+
+	info = g_slice_new0 (EthtoolInfo);
+	g_hash_table_insert (priv->ethtool_infos, GINT_TO_POINTER (ifindex), info);
+	return info;
+}
+
+/* like nmp_utils_ethtool_get_driver_info(), but cached. Must be called
+ * in the netns of @platform. */
+static const NMPUtilsEthtoolDriverInfo *
+_ethtool_get_driver_info (NMPlatform *platform, int ifindex, NMPUtilsEthtoolDriverInfo *buf)
+{
+	EthtoolInfo *info;
+
+	info = _ethtool_info_get (platform, ifindex);
+	if (!info) {
+		_ethtool_stats_inc (platform, FALSE);
+		return nmp_utils_ethtool_get_driver_info (ifindex, buf) ? buf : NULL;
+	}
+
+	if (!info->driver_info_cached) {
+		_ethtool_stats_inc (platform, FALSE);
+		if (!nmp_utils_ethtool_get_driver_info (ifindex, &info->driver_info))
+			return NULL;
+		info->driver_info_cached = TRUE;
+	} else
+		_ethtool_stats_inc (platform, TRUE);
+	return &info->driver_info;
 }
 
 /*****************************************************************************/
@@ -2854,6 +3293,7 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 	gsize len;
 	char *actual;
 	gs_free char *actual_free = NULL;
+	NMPlatformSysctlStats *stats;
 	int errsv;
 
 	g_return_val_if_fail (path != NULL, FALSE);
@@ -2861,6 +3301,8 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 
 	ASSERT_SYSCTL_ARGS (pathid, dirfd, path);
 
+	stats = _nm_platform_sysctl_stats (platform);
+
 	if (dirfd < 0) {
 		if (!nm_platform_netns_push (platform, &netns)) {
 			errno = ENETDOWN;
@@ -2869,6 +3311,7 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 
 		pathid = path;
 
+		stats->n_syscalls++;
 		fd = open (path, O_WRONLY | O_TRUNC | O_CLOEXEC);
 		if (fd == -1) {
 			errsv = errno;
@@ -2883,6 +3326,7 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 			return FALSE;
 		}
 	} else {
+		stats->n_syscalls++;
 		fd = openat (dirfd, path, O_WRONLY | O_TRUNC | O_CLOEXEC);
 		if (fd == -1) {
 			errsv = errno;
@@ -2917,6 +3361,7 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 	/* Try to write the entire value three times if a partial write occurs */
 	errsv = 0;
 	for (tries = 0, nwrote = 0; tries < 3 && nwrote < len - 1; tries++) {
+		stats->n_syscalls++;
 		nwrote = write (fd, actual, len);
 		if (nwrote == -1) {
 			errsv = errno;
@@ -2935,6 +3380,7 @@ sysctl_set (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 		       path, value);
 	}
 
+	stats->n_syscalls++;
 	if (nwrote < len - 1) {
 		if (close (fd) != 0) {
 			if (errsv != 0)
@@ -3026,7 +3472,20 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 		pathid = path;
 	}
 
+	/* open, read and close. */
+	_nm_platform_sysctl_stats (platform)->n_syscalls += 3;
+
 	if (nm_utils_file_get_contents (dirfd, path, 1*1024*1024, &contents, NULL, &error) < 0) {
+		int errsv;
+
+		/* the caller might want to know whether the file is gone. */
+		if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+			errsv = ENOENT;
+		else if (g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NODEV))
+			errsv = ENODEV;
+		else
+			errsv = EIO;
+
 		/* We assume FAILED means EOPNOTSUP */
 		if (   g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NOENT)
 		    || g_error_matches (error, G_FILE_ERROR, G_FILE_ERROR_NODEV)
@@ -3035,6 +3494,7 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 		else
 			_LOGE ("error reading %s: %s", pathid, error->message);
 		g_clear_error (&error);
+		errno = errsv;
 		return NULL;
 	}
 
@@ -3045,6 +3505,41 @@ sysctl_get (NMPlatform *platform, const char *pathid, int dirfd, const char *pat
 	return contents;
 }
 
+static int
+sysctl_ifdir_open (NMPlatform *platform, int ifindex, const char *ifname, NMPSysctlIfdir ifdir)
+{
+	nm_auto_pop_netns NMPNetns *netns = NULL;
+	const char *path;
+	int fd;
+
+	if (!nm_platform_netns_push (platform, &netns))
+		return -1;
+
+	_nm_platform_sysctl_stats (platform)->n_syscalls++;
+
+	switch (ifdir) {
+	case NMP_SYSCTL_IFDIR_NET:
+		return nmp_utils_sysctl_open_netdir (ifindex, ifname, NULL);
+	case NMP_SYSCTL_IFDIR_IP4_CONF:
+		path = nm_sprintf_bufa (256, "/proc/sys/net/ipv4/conf/%s", ifname);
+		break;
+	case NMP_SYSCTL_IFDIR_IP6_CONF:
+		path = nm_sprintf_bufa (256, "/proc/sys/net/ipv6/conf/%s", ifname);
+		break;
+	default:
+		g_return_val_if_reached (-1);
+	}
+
+	fd = open (path, O_DIRECTORY | O_CLOEXEC);
+	if (fd < 0) {
+		int errsv = errno;
+
+		_LOGD ("sysctl: failed to open directory '%s': (%d) %s",
+		       path, errsv, strerror (errsv));
+	}
+	return fd;
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -3112,8 +3607,10 @@ NM_UTILS_LOOKUP_STR_DEFINE_STATIC (delayed_action_to_string, DelayedActionType,
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_MASTER_CONNECTED,          "master-connected"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_READ_NETLINK,              "read-netlink"),
 	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE,      "wait-for-nl-response"),
+	NM_UTILS_LOOKUP_STR_ITEM (DELAYED_ACTION_TYPE_REFRESH_IFINDEX,           "refresh-ifindex"),
 	NM_UTILS_LOOKUP_ITEM_IGNORE (DELAYED_ACTION_TYPE_NONE),
 	NM_UTILS_LOOKUP_ITEM_IGNORE (DELAYED_ACTION_TYPE_REFRESH_ALL),
+	NM_UTILS_LOOKUP_ITEM_IGNORE (DELAYED_ACTION_TYPE_REFRESH_ALL_ADDRROUTES),
 	NM_UTILS_LOOKUP_ITEM_IGNORE (__DELAYED_ACTION_TYPE_MAX),
 );
 
@@ -3122,6 +3619,7 @@ delayed_action_to_string_full (DelayedActionType action_type, gpointer user_data
 {
 	char *buf0 = buf;
 	const DelayedActionWaitForNlResponseData *data;
+	const DelayedActionRefreshIfindexData *data_ifindex;
 
 	nm_utils_strbuf_append_str (&buf, &buf_size, delayed_action_to_string (action_type));
 	switch (action_type) {
@@ -3131,6 +3629,17 @@ delayed_action_to_string_full (DelayedActionType action_type, gpointer user_data
 	case DELAYED_ACTION_TYPE_REFRESH_LINK:
 		nm_utils_strbuf_append (&buf, &buf_size, " (ifindex %d)", GPOINTER_TO_INT (user_data));
 		break;
+	case DELAYED_ACTION_TYPE_REFRESH_IFINDEX:
+		data_ifindex = user_data;
+
+		if (data_ifindex) {
+			nm_utils_strbuf_append (&buf, &buf_size, " (%s, ifindex %d",
+			                        nmp_class_from_type (delayed_action_refresh_to_object_type (data_ifindex->refresh_type))->obj_type_name,
+			                        data_ifindex->ifindex);
+			nm_utils_strbuf_append_c (&buf, &buf_size, ')');
+		} else
+			nm_utils_strbuf_append_str (&buf, &buf_size, " (any)");
+		break;
 	case DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE:
 		data = user_data;
 
@@ -3278,6 +3787,12 @@ delayed_action_handle_REFRESH_ALL (NMPlatform *platform, DelayedActionType flags
 	do_request_all_no_delayed_actions (platform, flags);
 }
 
+static void
+delayed_action_handle_REFRESH_IFINDEX (NMPlatform *platform, const DelayedActionRefreshIfindexData *request)
+{
+	do_request_ifindex_no_delayed_actions (platform, request);
+}
+
 static void
 delayed_action_handle_READ_NETLINK (NMPlatform *platform)
 {
@@ -3359,6 +3874,23 @@ delayed_action_handle_one (NMPlatform *platform)
 		return TRUE;
 	}
 
+	if (NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_REFRESH_IFINDEX)) {
+		DelayedActionRefreshIfindexData request;
+
+		nm_assert (priv->delayed_action.list_refresh_ifindex->len > 0);
+
+		request = g_array_index (priv->delayed_action.list_refresh_ifindex, DelayedActionRefreshIfindexData, 0);
+		g_array_remove_index (priv->delayed_action.list_refresh_ifindex, 0);
+		if (priv->delayed_action.list_refresh_ifindex->len == 0)
+			priv->delayed_action.flags &= ~DELAYED_ACTION_TYPE_REFRESH_IFINDEX;
+
+		_LOGt_delayed_action (DELAYED_ACTION_TYPE_REFRESH_IFINDEX, &request, "handle");
+
+		delayed_action_handle_REFRESH_IFINDEX (platform, &request);
+
+		return TRUE;
+	}
+
 	if (NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE)) {
 		nm_assert (priv->delayed_action.list_wait_for_nl_response->len > 0);
 		_LOGt_delayed_action (DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE, NULL, "handle");
@@ -3377,6 +3909,8 @@ delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 
 	g_return_val_if_fail (priv->delayed_action.is_handling == 0, FALSE);
 
+	nm_platform_changes_batch_begin (platform);
+
 	priv->delayed_action.is_handling++;
 	if (read_netlink)
 		delayed_action_schedule (platform, DELAYED_ACTION_TYPE_READ_NETLINK, NULL);
@@ -3385,10 +3919,46 @@ delayed_action_handle_all (NMPlatform *platform, gboolean read_netlink)
 	priv->delayed_action.is_handling--;
 
 	cache_prune_all (platform);
+	resync_check_complete (platform);
+
+	nm_platform_changes_batch_end (platform);
 
 	return any;
 }
 
+static gssize
+delayed_action_refresh_ifindex_find (GArray *list, const DelayedActionRefreshIfindexData *request)
+{
+	guint i;
+
+	for (i = 0; i < list->len; i++) {
+		const DelayedActionRefreshIfindexData *r = &g_array_index (list, DelayedActionRefreshIfindexData, i);
+
+		if (   r->refresh_type == request->refresh_type
+		    && r->ifindex == request->ifindex)
+			return i;
+	}
+	return -1;
+}
+
+static void
+delayed_action_refresh_ifindex_clear (NMPlatform *platform, DelayedActionType refresh_type)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	GArray *list = priv->delayed_action.list_refresh_ifindex;
+	guint i;
+
+	if (!NM_FLAGS_HAS (priv->delayed_action.flags, DELAYED_ACTION_TYPE_REFRESH_IFINDEX))
+		return;
+
+	for (i = list->len; i > 0; i--) {
+		if (g_array_index (list, DelayedActionRefreshIfindexData, i - 1).refresh_type == refresh_type)
+			g_array_remove_index (list, i - 1);
+	}
+	if (list->len == 0)
+		priv->delayed_action.flags &= ~DELAYED_ACTION_TYPE_REFRESH_IFINDEX;
+}
+
 static void
 delayed_action_schedule (NMPlatform *platform, DelayedActionType action_type, gpointer user_data)
 {
@@ -3406,6 +3976,10 @@ delayed_action_schedule (NMPlatform *platform, DelayedActionType action_type, gp
 		if (_nm_utils_ptrarray_find_first ((gconstpointer *) priv->delayed_action.list_master_connected->pdata, priv->delayed_action.list_master_connected->len, user_data) < 0)
 			g_ptr_array_add (priv->delayed_action.list_master_connected, user_data);
 		break;
+	case DELAYED_ACTION_TYPE_REFRESH_IFINDEX:
+		if (delayed_action_refresh_ifindex_find (priv->delayed_action.list_refresh_ifindex, user_data) < 0)
+			g_array_append_vals (priv->delayed_action.list_refresh_ifindex, user_data, 1);
+		break;
 	case DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE:
 		g_array_append_vals (priv->delayed_action.list_wait_for_nl_response, user_data, 1);
 		break;
@@ -3413,6 +3987,7 @@ delayed_action_schedule (NMPlatform *platform, DelayedActionType action_type, gp
 		nm_assert (!user_data);
 		nm_assert (!NM_FLAGS_HAS (action_type, DELAYED_ACTION_TYPE_REFRESH_LINK));
 		nm_assert (!NM_FLAGS_HAS (action_type, DELAYED_ACTION_TYPE_MASTER_CONNECTED));
+		nm_assert (!NM_FLAGS_HAS (action_type, DELAYED_ACTION_TYPE_REFRESH_IFINDEX));
 		nm_assert (!NM_FLAGS_HAS (action_type, DELAYED_ACTION_TYPE_WAIT_FOR_NL_RESPONSE));
 		break;
 	}
@@ -3446,6 +4021,43 @@ delayed_action_schedule_WAIT_FOR_NL_RESPONSE (NMPlatform *platform,
 	                         &data);
 }
 
+/* Schedule a refresh of the addresses and routes of one interface,
+ * for the types in @refresh_types.
+ *
+ * The kernel only honors the filter if NETLINK_GET_STRICT_CHK is enabled.
+ * Otherwise fall back to refresh all objects of the type. */
+static void
+delayed_action_schedule_REFRESH_IFINDEX (NMPlatform *platform,
+                                         DelayedActionType refresh_types,
+                                         int ifindex)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType iflags;
+
+	nm_assert (refresh_types != DELAYED_ACTION_TYPE_NONE);
+	nm_assert (!NM_FLAGS_ANY (refresh_types, ~DELAYED_ACTION_TYPE_REFRESH_ALL_ADDRROUTES));
+	nm_assert (ifindex > 0);
+
+	if (!priv->nlh_strict_check) {
+		delayed_action_schedule (platform, refresh_types, NULL);
+		return;
+	}
+
+	FOR_EACH_DELAYED_ACTION (iflags, refresh_types) {
+		DelayedActionRefreshIfindexData request = {
+			.refresh_type = iflags,
+			.ifindex = ifindex,
+		};
+
+		/* no need for a filtered refresh, if all objects of the type are
+		 * going to be refreshed anyway. */
+		if (NM_FLAGS_HAS (priv->delayed_action.flags, iflags))
+			continue;
+
+		delayed_action_schedule (platform, DELAYED_ACTION_TYPE_REFRESH_IFINDEX, &request);
+	}
+}
+
 /*****************************************************************************/
 
 static void
@@ -3476,11 +4088,51 @@ cache_prune_one_type (NMPlatform *platform, NMPObjectType obj_type)
 	}
 }
 
+static void
+cache_prune_addrroute (NMPlatform *platform, NMPObjectType obj_type, int ifindex)
+{
+	gs_unref_ptrarray GPtrArray *prune = NULL;
+	NMDedupMultiIter iter;
+	const NMPObject *obj;
+	NMPCacheOpsType cache_op;
+	NMPLookup lookup;
+	NMPCache *cache = nm_platform_get_cache (platform);
+	guint i;
+
+	/* the dirty flag is on the entries of the object-type index. Collect the objects
+	 * first, because removing them modifies the per-ifindex list. */
+	nmp_lookup_init_addrroute (&lookup, obj_type, ifindex);
+	nmp_cache_iter_for_each (&iter, nmp_cache_lookup (cache, &lookup), &obj) {
+		if (!nmp_cache_lookup_entry (cache, obj)->dirty)
+			continue;
+		if (!prune)
+			prune = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+		g_ptr_array_add (prune, (gpointer) nmp_object_ref (obj));
+	}
+
+	if (!prune)
+		return;
+
+	for (i = 0; i < prune->len; i++) {
+		nm_auto_nmpobj const NMPObject *obj_old = NULL;
+
+		obj = prune->pdata[i];
+		_LOGt ("cache-prune: prune %s", nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_ALL, NULL, 0));
+		cache_op = nmp_cache_remove (cache, obj, TRUE, TRUE, &obj_old);
+		if (cache_op == NMP_CACHE_OPS_UNCHANGED)
+			continue;
+		nm_assert (cache_op == NMP_CACHE_OPS_REMOVED);
+		cache_on_change (platform, cache_op, obj_old, NULL);
+		nm_platform_cache_update_emit_signal (platform, cache_op, obj_old, NULL);
+	}
+}
+
 static void
 cache_prune_all (NMPlatform *platform)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
 	DelayedActionType iflags, action_type;
+	guint i;
 
 	action_type = DELAYED_ACTION_TYPE_REFRESH_ALL;
 	FOR_EACH_DELAYED_ACTION (iflags, action_type) {
@@ -3491,6 +4143,39 @@ cache_prune_all (NMPlatform *platform)
 			cache_prune_one_type (platform, delayed_action_refresh_to_object_type (iflags));
 		}
 	}
+
+	for (i = 0; i < priv->pruning_ifindex->len; ) {
+		RefreshIfindexPruneData *data = priv->pruning_ifindex->pdata[i];
+		DelayedActionRefreshIfindexData request;
+		WaitForNlResponseResult seq_result;
+
+		if (data->seq_result == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+			/* still waiting for the reply. */
+			i++;
+			continue;
+		}
+
+		request = data->request;
+		seq_result = data->seq_result;
+		g_ptr_array_remove_index (priv->pruning_ifindex, i);
+
+		/* ENODEV means that the interface is gone, and so are its objects. */
+		if (   seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+		    || seq_result == -ENODEV) {
+			cache_prune_addrroute (platform,
+			                       delayed_action_refresh_to_object_type (request.refresh_type),
+			                       request.ifindex);
+		} else {
+			char buf1[255];
+			char buf2[255];
+
+			/* we don't know which objects are gone. Resync them all. */
+			_LOGD ("cache-prune: %s failed with %s. Refresh all",
+			       delayed_action_to_string_full (DELAYED_ACTION_TYPE_REFRESH_IFINDEX, &request, buf1, sizeof (buf1)),
+			       wait_for_nl_response_to_string (seq_result, buf2, sizeof (buf2)));
+			delayed_action_schedule (platform, request.refresh_type, NULL);
+		}
+	}
 }
 
 static void
@@ -3556,14 +4241,21 @@ cache_on_change (NMPlatform *platform,
 				ifindex = obj_new->link.ifindex;
 
 			if (ifindex > 0) {
-				delayed_action_schedule (platform,
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-				                         NULL);
+				delayed_action_schedule_REFRESH_IFINDEX (platform,
+				                                         DELAYED_ACTION_TYPE_REFRESH_ALL_ADDRROUTES,
+				                                         ifindex);
 			}
 		}
+		{
+			/* the ethtool information is only valid while the link exists,
+			 * and the failed requests are retried after it changed. */
+			if (   cache_op == NMP_CACHE_OPS_REMOVED
+			    && obj_old /* <-- nonsensical, make coverity happy */)
+				g_hash_table_remove (NM_LINUX_PLATFORM_GET_PRIVATE (platform)->ethtool_infos, GINT_TO_POINTER (obj_old->link.ifindex));
+			else if (   cache_op == NMP_CACHE_OPS_UPDATED
+			         && obj_new /* <-- nonsensical, make coverity happy */)
+				_ethtool_info_drop_negative (platform, obj_new->link.ifindex);
+		}
 		{
 			int ifindex = -1;
 
@@ -3609,10 +4301,10 @@ cache_on_change (NMPlatform *platform,
 				/* FIXME: I suspect that IFF_LOWER_UP must not be considered, and I
 				 * think kernel does send RTM_DELROUTE events for IPv6 routes, so
 				 * we might not need to refresh IPv6 routes. */
-				delayed_action_schedule (platform,
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-				                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-				                         NULL);
+				delayed_action_schedule_REFRESH_IFINDEX (platform,
+				                                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
+				                                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
+				                                         obj_new->link.ifindex);
 			}
 		}
 		if (   NM_IN_SET (cache_op, NMP_CACHE_OPS_ADDED, NMP_CACHE_OPS_UPDATED)
@@ -3692,11 +4384,11 @@ cache_on_change (NMPlatform *platform,
 			/* Address deletion is sometimes accompanied by route deletion. We need to
 			 * check all routes belonging to the same interface. */
 			if (cache_op == NMP_CACHE_OPS_REMOVED) {
-				delayed_action_schedule (platform,
-				                         (klass->obj_type == NMP_OBJECT_TYPE_IP4_ADDRESS)
-				                             ? DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
-				                             : DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-				                         NULL);
+				delayed_action_schedule_REFRESH_IFINDEX (platform,
+				                                         (klass->obj_type == NMP_OBJECT_TYPE_IP4_ADDRESS)
+				                                             ? DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES
+				                                             : DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
+				                                         obj_old->ip_address.ifindex);
 			}
 		}
 		break;
@@ -3714,6 +4406,53 @@ _nlh_seq_next_get (NMLinuxPlatformPrivate *priv)
 	return priv->nlh_seq_next++ ?: priv->nlh_seq_next++;
 }
 
+/* Send @len bytes of netlink messages at @buf with one sendmsg().
+ * Returns 0 on success or a negative errno. */
+static int
+_nl_sendmsg (NMPlatform *platform,
+             gpointer buf,
+             gsize len)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct sockaddr_nl nladdr = {
+		.nl_family = AF_NETLINK,
+	};
+	struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = len,
+	};
+	struct msghdr msg = {
+		.msg_name = &nladdr,
+		.msg_namelen = sizeof(nladdr),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+	};
+	int try_count;
+	int nle;
+
+	try_count = 0;
+again:
+	nle = sendmsg (nl_socket_get_fd (priv->nlh), &msg, 0);
+	if (nle < 0) {
+		nle = errno;
+		if (nle == EINTR && try_count++ < 100)
+			goto again;
+		return -nle;
+	}
+	return 0;
+}
+
+static void
+_nl_nlmsghdr_prepare_request (NMLinuxPlatformPrivate *priv,
+                              struct nlmsghdr *nlhdr,
+                              guint32 seq)
+{
+	nlhdr->nlmsg_seq = seq;
+	if (!nlhdr->nlmsg_pid)
+		nlhdr->nlmsg_pid = nl_socket_get_local_port (priv->nlh);
+	nlhdr->nlmsg_flags |= (NLM_F_REQUEST | NLM_F_ACK);
+}
+
 /**
  * _nl_send_nlmsghdr:
  * @platform:
@@ -3738,38 +4477,12 @@ _nl_send_nlmsghdr (NMPlatform *platform,
 	nm_assert (nlhdr);
 
 	seq = _nlh_seq_next_get (priv);
-	nlhdr->nlmsg_seq = seq;
-
-	{
-		struct sockaddr_nl nladdr = {
-			.nl_family = AF_NETLINK,
-		};
-		struct iovec iov = {
-			.iov_base = nlhdr,
-			.iov_len = nlhdr->nlmsg_len
-		};
-		struct msghdr msg = {
-			.msg_name = &nladdr,
-			.msg_namelen = sizeof(nladdr),
-			.msg_iov = &iov,
-			.msg_iovlen = 1,
-		};
-		int try_count;
-
-		if (!nlhdr->nlmsg_pid)
-			nlhdr->nlmsg_pid = nl_socket_get_local_port (priv->nlh);
-		nlhdr->nlmsg_flags |= (NLM_F_REQUEST | NLM_F_ACK);
+	_nl_nlmsghdr_prepare_request (priv, nlhdr, seq);
 
-		try_count = 0;
-again:
-		nle = sendmsg (nl_socket_get_fd (priv->nlh), &msg, 0);
-		if (nle < 0) {
-			nle = errno;
-			if (nle == EINTR && try_count++ < 100)
-				goto again;
-			_LOGD ("netlink: nl-send-nlmsghdr: failed sending message: %s (%d)", g_strerror (nle), nle);
-			return -nle;
-		}
+	nle = _nl_sendmsg (platform, nlhdr, nlhdr->nlmsg_len);
+	if (nle < 0) {
+		_LOGD ("netlink: nl-send-nlmsghdr: failed sending message: %s (%d)", g_strerror (-nle), -nle);
+		return nle;
 	}
 
 	delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, seq, out_seq_result,
@@ -3777,6 +4490,60 @@ again:
 	return 0;
 }
 
+/**
+ * _nl_send_nl_builder:
+ * @platform:
+ * @builder: the builder with the messages to send.
+ * @out_seq_results: for each message of @builder, the location
+ *   where to store the result.
+ *
+ * Send all messages of @builder with one sendmsg(). Kernel processes
+ * (and acknowledges) them one by one, as if they were sent separately.
+ *
+ * Returns: 0 on success or a negative errno. Beware, it's an errno, not nlerror.
+ *   On failure, none of the messages was sent.
+ */
+static int
+_nl_send_nl_builder (NMPlatform *platform,
+                     NMPNlBuilder *builder,
+                     WaitForNlResponseResult *const*out_seq_results)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	struct nlmsghdr *nlhdr;
+	gsize len;
+	int remaining;
+	guint i, n_msgs;
+	int nle;
+
+	n_msgs = nmp_nl_builder_get_n_msgs (builder);
+	nlhdr = nmp_nl_builder_get_msgs (builder, &len);
+	if (!nlhdr)
+		return 0;
+
+	remaining = len;
+	for (i = 0; i < n_msgs; i++) {
+		nm_assert (NLMSG_OK (nlhdr, remaining));
+
+		_nl_nlmsghdr_prepare_request (priv, nlhdr, _nlh_seq_next_get (priv));
+		nlhdr = NLMSG_NEXT (nlhdr, remaining);
+	}
+	nm_assert (remaining == 0);
+
+	nle = _nl_sendmsg (platform, nmp_nl_builder_get_msgs (builder, NULL), len);
+	if (nle < 0) {
+		_LOGD ("netlink: nl-send-nl-builder: failed sending %u messages: %s (%d)", n_msgs, g_strerror (-nle), -nle);
+		return nle;
+	}
+
+	for (i = 0, nlhdr = nmp_nl_builder_get_msgs (builder, NULL), remaining = len;
+	     i < n_msgs;
+	     i++, nlhdr = NLMSG_NEXT (nlhdr, remaining)) {
+		delayed_action_schedule_WAIT_FOR_NL_RESPONSE (platform, nlhdr->nlmsg_seq, out_seq_results[i],
+		                                              DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	}
+	return 0;
+}
+
 /**
  * _nl_send_nlmsg:
  * @platform:
@@ -3873,12 +4640,7 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 
 	FOR_EACH_DELAYED_ACTION (iflags, action_type) {
 		NMPObjectType obj_type = delayed_action_refresh_to_object_type (iflags);
-		const NMPClass *klass = nmp_class_from_type (obj_type);
 		nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-		struct rtgenmsg gmsg = {
-			.rtgen_family = klass->addr_family,
-		};
-		int nle;
 		gint *out_refresh_all_in_progess;
 
 		out_refresh_all_in_progess = &priv->delayed_action.refresh_all_in_progess[delayed_action_refresh_all_to_idx (iflags)];
@@ -3892,22 +4654,19 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 			priv->delayed_action.flags &= ~DELAYED_ACTION_TYPE_REFRESH_LINK;
 			g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
 			_LOGt_delayed_action (DELAYED_ACTION_TYPE_REFRESH_LINK, NULL, "clear (do-request-all)");
-		}
+		} else
+			delayed_action_refresh_ifindex_clear (platform, iflags);
 
 		event_handler_read_netlink (platform, FALSE);
 
 		/* reimplement
 		 *   nl_rtgen_request (sk, klass->rtm_gettype, klass->addr_family, NLM_F_DUMP);
-		 * because we need the sequence number.
+		 * because we need the sequence number and the full header.
 		 */
-		nlmsg = nlmsg_alloc_simple (klass->rtm_gettype, NLM_F_DUMP);
+		nlmsg = _nl_msg_new_dump (obj_type, 0);
 		if (!nlmsg)
 			continue;
 
-		nle = nlmsg_append (nlmsg, &gmsg, sizeof (gmsg), NLMSG_ALIGNTO);
-		if (nle < 0)
-			continue;
-
 		if (_nl_send_nlmsg (platform, nlmsg, NULL, DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS, out_refresh_all_in_progess) < 0) {
 			nm_assert (*out_refresh_all_in_progess > 0);
 			*out_refresh_all_in_progess -= 1;
@@ -3915,6 +4674,49 @@ do_request_all_no_delayed_actions (NMPlatform *platform, DelayedActionType actio
 	}
 }
 
+static void
+do_request_ifindex_no_delayed_actions (NMPlatform *platform, const DelayedActionRefreshIfindexData *request)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	NMPObjectType obj_type = delayed_action_refresh_to_object_type (request->refresh_type);
+	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	RefreshIfindexPruneData *data;
+	gint *out_refresh_all_in_progess;
+
+	nm_assert (priv->nlh_strict_check);
+	nm_assert (request->ifindex > 0);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nlmsg = _nl_msg_new_dump (obj_type, request->ifindex);
+	if (!nlmsg) {
+		delayed_action_schedule (platform, request->refresh_type, NULL);
+		return;
+	}
+
+	/* only the objects of this interface are part of the reply. Mark them
+	 * dirty, so that cache_prune_all() removes those that are gone. */
+	nmp_cache_dirty_set_addrroute (nm_platform_get_cache (platform),
+	                               obj_type,
+	                               request->ifindex);
+
+	data = g_slice_new (RefreshIfindexPruneData);
+	data->request = *request;
+	data->seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	g_ptr_array_add (priv->pruning_ifindex, data);
+
+	/* the reply is a dump, just a filtered one. */
+	out_refresh_all_in_progess = &priv->delayed_action.refresh_all_in_progess[delayed_action_refresh_all_to_idx (request->refresh_type)];
+	nm_assert (*out_refresh_all_in_progess >= 0);
+	*out_refresh_all_in_progess += 1;
+
+	if (_nl_send_nlmsg (platform, nlmsg, &data->seq_result, DELAYED_ACTION_RESPONSE_TYPE_REFRESH_ALL_IN_PROGRESS, out_refresh_all_in_progess) < 0) {
+		nm_assert (*out_refresh_all_in_progess > 0);
+		*out_refresh_all_in_progess -= 1;
+		data->seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_UNKNOWN;
+	}
+}
+
 static void
 do_request_one_type (NMPlatform *platform, NMPObjectType obj_type)
 {
@@ -3988,35 +4790,153 @@ event_seq_check (NMPlatform *platform, guint32 seq_number, WaitForNlResponseResu
 #endif
 }
 
+/* Check whether @obj (as parsed from netlink) is identical to the cached
+ * instance, and the cache update would do nothing but clearing the dirty flag.
+ * In that case, we can skip creating a new object. */
+static gboolean
+event_valid_msg_is_unchanged (NMPCache *cache, const NMPObject *obj, gboolean is_dump, guint16 nlmsg_flags)
+{
+	const NMDedupMultiEntry *entry;
+
+	if (   !is_dump
+	    && NM_FLAGS_HAS (nlmsg_flags, NLM_F_REPLACE)
+	    && NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                             NMP_OBJECT_TYPE_IP6_ROUTE)) {
+		/* the route might replace another one. Let nmp_cache_update_netlink_route()
+		 * figure that out. */
+		return FALSE;
+	}
+
+	if (!nmp_object_is_alive (obj))
+		return FALSE;
+
+	entry = nmp_cache_lookup_entry (cache, obj);
+	if (   !entry
+	    || !nmp_object_equal (entry->obj, obj))
+		return FALSE;
+
+	nm_dedup_multi_entry_set_dirty (entry, FALSE);
+	return TRUE;
+}
+
 static void
-event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_events)
+event_valid_msg_link_stats (NMPlatform *platform, struct nlmsghdr *msghdr)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	static const struct nla_policy policy[IFLA_STATS_LINK_64 + 1] = {
+		[IFLA_STATS_LINK_64] = { .minlen = nm_offsetofend (struct rtnl_link_stats64, tx_bytes) },
+	};
+	struct nlattr *tb[IFLA_STATS_LINK_64 + 1];
+	NMPCache *cache = nm_platform_get_cache (platform);
+	const struct if_stats_msg *ifsm;
+	const NMPObject *obj_cached;
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	nm_auto_nmpobj const NMPObject *obj_old = NULL;
+	nm_auto_nmpobj const NMPObject *obj_new = NULL;
+	NMPCacheOpsType cache_op;
+	const char *stats;
+	int ifindex;
+	guint64 rx_packets, rx_bytes, tx_packets, tx_bytes;
+
+	if (!priv->link_stats.ifindexes)
+		return;
+
+	if (!nlmsg_valid_hdr (msghdr, sizeof (*ifsm)))
+		return;
+	ifsm = nlmsg_data (msghdr);
+	ifindex = ifsm->ifindex;
+
+	/* the dump contains all links, but we only update the subscribed ones. */
+	if (!bsearch (&ifindex,
+	              priv->link_stats.ifindexes,
+	              priv->link_stats.n_ifindexes,
+	              sizeof (int),
+	              _nm_platform_link_stats_ifindex_cmp))
+		return;
+
+	if (nlmsg_parse (msghdr, sizeof (*ifsm), tb, IFLA_STATS_LINK_64, policy) < 0)
+		return;
+	if (!tb[IFLA_STATS_LINK_64])
+		return;
+
+	/* like IFLA_STATS64, the attribute is only 32bit-aligned. */
+	stats = nla_data (tb[IFLA_STATS_LINK_64]);
+	rx_packets = READ_STAT64 (rx_packets);
+	rx_bytes   = READ_STAT64 (rx_bytes);
+	tx_packets = READ_STAT64 (tx_packets);
+	tx_bytes   = READ_STAT64 (tx_bytes);
+
+	obj_cached = nmp_cache_lookup_link (cache, ifindex);
+	if (   !obj_cached
+	    || !obj_cached->_link.netlink.is_in_netlink)
+		return;
+
+	if (   obj_cached->link.rx_packets == rx_packets
+	    && obj_cached->link.rx_bytes == rx_bytes
+	    && obj_cached->link.tx_packets == tx_packets
+	    && obj_cached->link.tx_bytes == tx_bytes)
+		return;
+
+	/* a link from netlink has no udev fields. They get merged back by
+	 * nmp_cache_update_netlink(). */
+	obj = nmp_object_clone (obj_cached, FALSE);
+	udev_device_unref (obj->_link.udev.device);
+	obj->_link.udev.device = NULL;
+	obj->link.driver = NULL;
+	obj->link.initialized = FALSE;
+
+	obj->link.rx_packets = rx_packets;
+	obj->link.rx_bytes = rx_bytes;
+	obj->link.tx_packets = tx_packets;
+	obj->link.tx_bytes = tx_bytes;
+
+	cache_op = nmp_cache_update_netlink (cache, g_steal_pointer (&obj), FALSE, &obj_old, &obj_new);
+	if (cache_op != NMP_CACHE_OPS_UNCHANGED) {
+		cache_on_change (platform, cache_op, obj_old, obj_new);
+		nm_platform_cache_update_emit_signal (platform, cache_op, obj_old, obj_new);
+	}
+}
+
+static void
+event_valid_msg (NMPlatform *platform, struct nlmsghdr *msghdr, gboolean maybe_dump, gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv;
 	nm_auto_nmpobj NMPObject *obj = NULL;
+	NMPObject obj_stack;
+	NMPObject *obj_parsed;
 	NMPCacheOpsType cache_op;
-	struct nlmsghdr *msghdr;
 	char buf_nlmsghdr[400];
 	gboolean id_only = FALSE;
 	NMPCache *cache = nm_platform_get_cache (platform);
 	gboolean is_dump;
 
-	msghdr = nlmsg_hdr (msg);
-
 	if (   _support_kernel_extended_ifa_flags_still_undecided ()
 	    && msghdr->nlmsg_type == RTM_NEWADDR)
-		_support_kernel_extended_ifa_flags_detect (msg);
+		_support_kernel_extended_ifa_flags_detect (msghdr);
 
 	if (!handle_events)
 		return;
 
+	if (msghdr->nlmsg_type == RTM_NEWSTATS) {
+		event_valid_msg_link_stats (platform, msghdr);
+		return;
+	}
+
 	if (NM_IN_SET (msghdr->nlmsg_type, RTM_DELLINK, RTM_DELADDR, RTM_DELROUTE)) {
 		/* The event notifies about a deleted object. We don't need to initialize all
 		 * fields of the object. */
 		id_only = TRUE;
 	}
 
-	obj = nmp_object_new_from_nl (platform, cache, msg, id_only);
-	if (!obj) {
+	/* addresses and routes are first parsed into a stack instance. */
+	obj_parsed = nmp_object_new_from_nl (platform,
+	                                     cache,
+	                                     msghdr,
+	                                     id_only,
+	                                     NM_IN_SET (msghdr->nlmsg_type, RTM_NEWADDR, RTM_NEWROUTE)
+	                                       ? &obj_stack
+	                                       : NULL);
+	if (!obj_parsed) {
 		_LOGT ("event-notification: %s: ignore",
 		       _nl_nlmsghdr_to_str (msghdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
 		return;
@@ -4026,8 +4946,9 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	case RTM_NEWADDR:
 	case RTM_NEWLINK:
 	case RTM_NEWROUTE:
-		is_dump = delayed_action_refresh_all_in_progress (platform,
-		                                                  delayed_action_refresh_from_object_type (NMP_OBJECT_GET_TYPE (obj)));
+		is_dump =    maybe_dump
+		          && delayed_action_refresh_all_in_progress (platform,
+		                                                     delayed_action_refresh_from_object_type (NMP_OBJECT_GET_TYPE (obj_parsed)));
 		break;
 	default:
 		is_dump = FALSE;
@@ -4036,10 +4957,19 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 	_LOGT ("event-notification: %s%s: %s",
 	       _nl_nlmsghdr_to_str (msghdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)),
 	       is_dump ? ", in-dump" : "",
-	       nmp_object_to_string (obj,
+	       nmp_object_to_string (obj_parsed,
 	                             id_only ? NMP_OBJECT_TO_STRING_ID : NMP_OBJECT_TO_STRING_PUBLIC,
 	                             NULL, 0));
 
+	if (obj_parsed == &obj_stack) {
+		/* during dumps, most objects are usually unchanged. Only create a
+		 * new instance if the cache needs it. */
+		if (event_valid_msg_is_unchanged (cache, &obj_stack, is_dump, msghdr->nlmsg_flags))
+			return;
+		obj = nmp_object_clone (&obj_stack, FALSE);
+	} else
+		obj = obj_parsed;
+
 	{
 		nm_auto_nmpobj const NMPObject *obj_old = NULL;
 		nm_auto_nmpobj const NMPObject *obj_new = NULL;
@@ -4075,7 +5005,7 @@ event_valid_msg (NMPlatform *platform, struct nl_msg *msg, gboolean handle_event
 						if (   data->response_type == DELAYED_ACTION_RESPONSE_TYPE_ROUTE_GET
 						    && data->response.out_route_get) {
 							nm_assert (!*data->response.out_route_get);
-							if (data->seq_number == nlmsg_hdr (msg)->nlmsg_seq) {
+							if (data->seq_number == msghdr->nlmsg_seq) {
 								*data->response.out_route_get = nmp_object_clone (obj, FALSE);
 								data->response.out_route_get = NULL;
 								break;
@@ -4202,15 +5132,54 @@ do_add_link_with_lookup (NMPlatform *platform,
 	return seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 }
 
+static NMPlatformError
+_do_add_addrroute_complete (NMPlatform *platform,
+                            const NMPObject *obj_id,
+                            WaitForNlResponseResult seq_result,
+                            gboolean suppress_netlink_failure)
+{
+	char s_buf[256];
+
+	nm_assert (seq_result);
+
+	_NMLOG ((   seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
+	         || (   suppress_netlink_failure
+	             && seq_result < 0))
+	            ? LOGL_DEBUG
+	            : LOGL_WARN,
+	        "do-add-%s[%s]: %s",
+	        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+	        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)));
+
+	return wait_for_nl_response_to_plerr (seq_result);
+}
+
+static gboolean
+_do_add_addrroute_needs_refetch (NMPlatform *platform,
+                                 const NMPObject *obj_id)
+{
+	/* In rare cases, the object is not yet ready as we received the ACK from
+	 * kernel. Need to refetch.
+	 *
+	 * We want to safe the expensive refetch, thus we look first into the cache
+	 * whether the object exists.
+	 *
+	 * rh#1484434 */
+	return    NMP_OBJECT_GET_TYPE (obj_id) == NMP_OBJECT_TYPE_IP6_ADDRESS
+	       && !nmp_cache_lookup_obj (nm_platform_get_cache (platform),
+	                                 obj_id);
+}
+
 static NMPlatformError
 do_add_addrroute (NMPlatform *platform,
                   const NMPObject *obj_id,
-                  struct nl_msg *nlmsg,
+                  struct nlmsghdr *nlhdr,
                   gboolean suppress_netlink_failure)
 {
 	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	NMPlatformError plerr;
 	int nle;
-	char s_buf[256];
 
 	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj_id),
 	                      NMP_OBJECT_TYPE_IP4_ADDRESS, NMP_OBJECT_TYPE_IP6_ADDRESS,
@@ -4218,67 +5187,38 @@ do_add_addrroute (NMPlatform *platform,
 
 	event_handler_read_netlink (platform, FALSE);
 
-	nle = _nl_send_nlmsg (platform, nlmsg, &seq_result, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	nle = _nl_send_nlmsghdr (platform, nlhdr, &seq_result, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
 	if (nle < 0) {
 		_LOGE ("do-add-%s[%s]: failure sending netlink request \"%s\" (%d)",
 		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
 		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-		       nl_geterror (nle), -nle);
+		       g_strerror (-nle), -nle);
 		return NM_PLATFORM_ERROR_NETLINK;
 	}
 
 	delayed_action_handle_all (platform, FALSE);
 
-	nm_assert (seq_result);
-
-	_NMLOG ((   seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK
-	         || (   suppress_netlink_failure
-	             && seq_result < 0))
-	            ? LOGL_DEBUG
-	            : LOGL_WARN,
-	        "do-add-%s[%s]: %s",
-	        NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
-	        nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-	        wait_for_nl_response_to_string (seq_result, s_buf, sizeof (s_buf)));
+	plerr = _do_add_addrroute_complete (platform, obj_id, seq_result, suppress_netlink_failure);
 
-	if (NMP_OBJECT_GET_TYPE (obj_id) == NMP_OBJECT_TYPE_IP6_ADDRESS) {
-		/* In rare cases, the object is not yet ready as we received the ACK from
-		 * kernel. Need to refetch.
-		 *
-		 * We want to safe the expensive refetch, thus we look first into the cache
-		 * whether the object exists.
-		 *
-		 * rh#1484434 */
-		if (!nmp_cache_lookup_obj (nm_platform_get_cache (platform),
-		                           obj_id))
-			do_request_one_type (platform, NMP_OBJECT_GET_TYPE (obj_id));
+	if (_do_add_addrroute_needs_refetch (platform, obj_id)) {
+		delayed_action_schedule_REFRESH_IFINDEX (platform,
+		                                         delayed_action_refresh_from_object_type (NMP_OBJECT_GET_TYPE (obj_id)),
+		                                         obj_id->object.ifindex);
+		delayed_action_handle_all (platform, FALSE);
 	}
 
-	return wait_for_nl_response_to_plerr (seq_result);
+	return plerr;
 }
 
 static gboolean
-do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *nlmsg)
+_do_delete_object_complete (NMPlatform *platform,
+                            const NMPObject *obj_id,
+                            WaitForNlResponseResult seq_result)
 {
-	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
-	int nle;
 	char s_buf[256];
 	gboolean success;
 	const char *log_detail = "";
 
-	event_handler_read_netlink (platform, FALSE);
-
-	nle = _nl_send_nlmsg (platform, nlmsg, &seq_result, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
-	if (nle < 0) {
-		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
-		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
-		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
-		       nl_geterror (nle), -nle);
-		return FALSE;
-	}
-
-	delayed_action_handle_all (platform, FALSE);
-
 	nm_assert (seq_result);
 
 	success = TRUE;
@@ -4306,6 +5246,28 @@ do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nl_msg *
 	return success;
 }
 
+static gboolean
+do_delete_object (NMPlatform *platform, const NMPObject *obj_id, struct nlmsghdr *nlhdr)
+{
+	WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+	int nle;
+
+	event_handler_read_netlink (platform, FALSE);
+
+	nle = _nl_send_nlmsghdr (platform, nlhdr, &seq_result, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL);
+	if (nle < 0) {
+		_LOGE ("do-delete-%s[%s]: failure sending netlink request \"%s\" (%d)",
+		       NMP_OBJECT_GET_CLASS (obj_id)->obj_type_name,
+		       nmp_object_to_string (obj_id, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+		       g_strerror (-nle), -nle);
+		return FALSE;
+	}
+
+	delayed_action_handle_all (platform, FALSE);
+
+	return _do_delete_object_complete (platform, obj_id, seq_result);
+}
+
 static WaitForNlResponseResult
 do_change_link_request (NMPlatform *platform,
                         int ifindex,
@@ -4442,22 +5404,75 @@ link_delete (NMPlatform *platform, int ifindex)
 	if (!obj || !obj->_link.netlink.is_in_netlink)
 		return FALSE;
 
-	nlmsg = _nl_msg_new_link (RTM_DELLINK,
-	                          0,
-	                          ifindex,
-	                          NULL,
-	                          0,
-	                          0);
+	nlmsg = _nl_msg_new_link (RTM_DELLINK,
+	                          0,
+	                          ifindex,
+	                          NULL,
+	                          0,
+	                          0);
+
+	nmp_object_stackinit_id_link (&obj_id, ifindex);
+	return do_delete_object (platform, &obj_id, nlmsg_hdr (nlmsg));
+}
+
+static gboolean
+link_refresh (NMPlatform *platform, int ifindex)
+{
+	do_request_link (platform, ifindex, NULL);
+	return !!nm_platform_link_get_obj (platform, ifindex, TRUE);
+}
+
+static void
+link_stats_refresh (NMPlatform *platform, const int *ifindexes, guint n_ifindexes)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	guint i;
+
+	nm_assert (ifindexes && n_ifindexes > 0);
+	nm_assert (!priv->link_stats.ifindexes);
+
+	if (_support_rtm_getstats_get ()) {
+		nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+		WaitForNlResponseResult seq_result = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+		const struct if_stats_msg ifsm = {
+			.family = AF_UNSPEC,
+			.filter_mask = IFLA_STATS_FILTER_BIT (IFLA_STATS_LINK_64),
+		};
+
+		/* one dump of the counters of all links, instead of a RTM_GETLINK
+		 * request for each link. */
+		nlmsg = nlmsg_alloc_simple (RTM_GETSTATS, NLM_F_DUMP);
+		if (   !nlmsg
+		    || nlmsg_append (nlmsg, (gpointer) &ifsm, sizeof (ifsm), NLMSG_ALIGNTO) < 0)
+			g_return_if_reached ();
+
+		event_handler_read_netlink (platform, FALSE);
+
+		if (_nl_send_nlmsg (platform, nlmsg, &seq_result, DELAYED_ACTION_RESPONSE_TYPE_VOID, NULL) < 0)
+			return;
+
+		priv->link_stats.ifindexes = ifindexes;
+		priv->link_stats.n_ifindexes = n_ifindexes;
+		delayed_action_handle_all (platform, FALSE);
+		priv->link_stats.ifindexes = NULL;
+		priv->link_stats.n_ifindexes = 0;
 
-	nmp_object_stackinit_id_link (&obj_id, ifindex);
-	return do_delete_object (platform, &obj_id, nlmsg);
-}
+		if (seq_result == WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK) {
+			_support_rtm_getstats_set (TRUE);
+			return;
+		}
 
-static gboolean
-link_refresh (NMPlatform *platform, int ifindex)
-{
-	do_request_link (platform, ifindex, NULL);
-	return !!nm_platform_link_get_obj (platform, ifindex, TRUE);
+		/* only fall back to RTM_GETLINK, if the kernel rejects the very
+		 * first request. Otherwise, try again next time. */
+		if (   seq_result >= 0
+		    || _support_rtm_getstats != 0)
+			return;
+		_support_rtm_getstats_set (FALSE);
+	}
+
+	for (i = 0; i < n_ifindexes; i++)
+		do_request_link_no_delayed_actions (platform, ifindexes[i], NULL);
+	delayed_action_handle_all (platform, FALSE);
 }
 
 static gboolean
@@ -4600,15 +5615,34 @@ static gboolean
 link_supports_carrier_detect (NMPlatform *platform, int ifindex)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
+	EthtoolInfo *info;
+	gboolean supported;
 
 	if (!nm_platform_netns_push (platform, &netns))
 		return FALSE;
 
+	info = _ethtool_info_get (platform, ifindex);
+	if (info && info->carrier_detect_cached) {
+		_ethtool_stats_inc (platform, TRUE);
+		return info->carrier_detect;
+	}
+
 	/* We use netlink for the actual carrier detection, but netlink can't tell
 	 * us whether the device actually supports carrier detection in the first
 	 * place. We assume any device that does implements one of these two APIs.
 	 */
-	return nmp_utils_ethtool_supports_carrier_detect (ifindex) || nmp_utils_mii_supports_carrier_detect (ifindex);
+	_ethtool_stats_inc (platform, FALSE);
+	supported = nmp_utils_ethtool_supports_carrier_detect (ifindex);
+	if (!supported) {
+		_ethtool_stats_inc (platform, FALSE);
+		supported = nmp_utils_mii_supports_carrier_detect (ifindex);
+	}
+
+	if (info) {
+		info->carrier_detect = supported;
+		info->carrier_detect_cached = TRUE;
+	}
+	return supported;
 }
 
 static gboolean
@@ -4616,6 +5650,8 @@ link_supports_vlans (NMPlatform *platform, int ifindex)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
 	const NMPObject *obj;
+	EthtoolInfo *info;
+	gboolean vlan_challenged;
 
 	obj = nm_platform_link_get_obj (platform, ifindex, TRUE);
 
@@ -4626,7 +5662,30 @@ link_supports_vlans (NMPlatform *platform, int ifindex)
 	if (!nm_platform_netns_push (platform, &netns))
 		return FALSE;
 
-	return nmp_utils_ethtool_supports_vlans (ifindex);
+	info = _ethtool_info_get (platform, ifindex);
+	if (!info) {
+		_ethtool_stats_inc (platform, FALSE);
+		return nmp_utils_ethtool_supports_vlans (ifindex);
+	}
+
+	if (!info->feature_idx_vlan_challenged_cached) {
+		_ethtool_stats_inc (platform, FALSE);
+		info->feature_idx_vlan_challenged = nmp_utils_ethtool_get_feature_index (ifindex, "vlan-challenged");
+		info->feature_idx_vlan_challenged_cached = TRUE;
+		if (info->feature_idx_vlan_challenged < 0)
+			_LOGD ("ethtool: vlan-challenged ethtool feature does not exist for %d?", ifindex);
+	} else
+		_ethtool_stats_inc (platform, TRUE);
+
+	if (info->feature_idx_vlan_challenged < 0)
+		return FALSE;
+
+	/* whether the feature is active can change, so always ask. */
+	_ethtool_stats_inc (platform, FALSE);
+	if (!nmp_utils_ethtool_get_feature_active (ifindex, info->feature_idx_vlan_challenged, &vlan_challenged))
+		return FALSE;
+
+	return !vlan_challenged;
 }
 
 static gboolean
@@ -4737,11 +5796,28 @@ link_get_permanent_address (NMPlatform *platform,
                             size_t *length)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
+	EthtoolInfo *info;
 
 	if (!nm_platform_netns_push (platform, &netns))
 		return FALSE;
 
-	return nmp_utils_ethtool_get_permanent_address (ifindex, buf, length);
+	info = _ethtool_info_get (platform, ifindex);
+	if (!info) {
+		_ethtool_stats_inc (platform, FALSE);
+		return nmp_utils_ethtool_get_permanent_address (ifindex, buf, length);
+	}
+
+	if (!info->perm_addr_cached) {
+		_ethtool_stats_inc (platform, FALSE);
+		if (!nmp_utils_ethtool_get_permanent_address (ifindex, info->perm_addr, &info->perm_addr_len))
+			return FALSE;
+		info->perm_addr_cached = TRUE;
+	} else
+		_ethtool_stats_inc (platform, TRUE);
+
+	memcpy (buf, info->perm_addr, info->perm_addr_len);
+	*length = info->perm_addr_len;
+	return TRUE;
 }
 
 static gboolean
@@ -5838,16 +6914,18 @@ link_get_driver_info (NMPlatform *platform,
                       char **out_fw_version)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
-	NMPUtilsEthtoolDriverInfo driver_info;
+	NMPUtilsEthtoolDriverInfo driver_info_buf;
+	const NMPUtilsEthtoolDriverInfo *driver_info;
 
 	if (!nm_platform_netns_push (platform, &netns))
 		return FALSE;
 
-	if (!nmp_utils_ethtool_get_driver_info (ifindex, &driver_info))
+	driver_info = _ethtool_get_driver_info (platform, ifindex, &driver_info_buf);
+	if (!driver_info)
 		return FALSE;
-	NM_SET_OUT (out_driver_name,    g_strdup (driver_info.driver));
-	NM_SET_OUT (out_driver_version, g_strdup (driver_info.version));
-	NM_SET_OUT (out_fw_version,     g_strdup (driver_info.fw_version));
+	NM_SET_OUT (out_driver_name,    g_strdup (driver_info->driver));
+	NM_SET_OUT (out_driver_version, g_strdup (driver_info->version));
+	NM_SET_OUT (out_fw_version,     g_strdup (driver_info->fw_version));
 	return TRUE;
 }
 
@@ -5865,23 +6943,25 @@ ip4_address_add (NMPlatform *platform,
                  const char *label)
 {
 	NMPObject obj_id;
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-
-	nlmsg = _nl_msg_new_address (RTM_NEWADDR,
-	                             NLM_F_CREATE | NLM_F_REPLACE,
-	                             AF_INET,
-	                             ifindex,
-	                             &addr,
-	                             plen,
-	                             &peer_addr,
-	                             flags,
-	                             nm_utils_ip4_address_is_link_local (addr) ? RT_SCOPE_LINK : RT_SCOPE_UNIVERSE,
-	                             lifetime,
-	                             preferred,
-	                             label);
+	NL_BUILDER_STACK (builder);
+
+	if (!_nl_builder_append_address (&builder,
+	                                 RTM_NEWADDR,
+	                                 NLM_F_CREATE | NLM_F_REPLACE,
+	                                 AF_INET,
+	                                 ifindex,
+	                                 &addr,
+	                                 plen,
+	                                 &peer_addr,
+	                                 flags,
+	                                 nm_utils_ip4_address_is_link_local (addr) ? RT_SCOPE_LINK : RT_SCOPE_UNIVERSE,
+	                                 lifetime,
+	                                 preferred,
+	                                 label))
+		return FALSE;
 
 	nmp_object_stackinit_id_ip4_address (&obj_id, ifindex, addr, plen, peer_addr);
-	return do_add_addrroute (platform, &obj_id, nlmsg, FALSE) == NM_PLATFORM_ERROR_SUCCESS;
+	return do_add_addrroute (platform, &obj_id, nmp_nl_builder_get_msgs (&builder, NULL), FALSE) == NM_PLATFORM_ERROR_SUCCESS;
 }
 
 static gboolean
@@ -5895,73 +6975,75 @@ ip6_address_add (NMPlatform *platform,
                  guint32 flags)
 {
 	NMPObject obj_id;
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
-
-	nlmsg = _nl_msg_new_address (RTM_NEWADDR,
-	                             NLM_F_CREATE | NLM_F_REPLACE,
-	                             AF_INET6,
-	                             ifindex,
-	                             &addr,
-	                             plen,
-	                             &peer_addr,
-	                             flags,
-	                             RT_SCOPE_UNIVERSE,
-	                             lifetime,
-	                             preferred,
-	                             NULL);
+	NL_BUILDER_STACK (builder);
+
+	if (!_nl_builder_append_address (&builder,
+	                                 RTM_NEWADDR,
+	                                 NLM_F_CREATE | NLM_F_REPLACE,
+	                                 AF_INET6,
+	                                 ifindex,
+	                                 &addr,
+	                                 plen,
+	                                 &peer_addr,
+	                                 flags,
+	                                 RT_SCOPE_UNIVERSE,
+	                                 lifetime,
+	                                 preferred,
+	                                 NULL))
+		return FALSE;
 
 	nmp_object_stackinit_id_ip6_address (&obj_id, ifindex, &addr);
-	return do_add_addrroute (platform, &obj_id, nlmsg, FALSE) == NM_PLATFORM_ERROR_SUCCESS;
+	return do_add_addrroute (platform, &obj_id, nmp_nl_builder_get_msgs (&builder, NULL), FALSE) == NM_PLATFORM_ERROR_SUCCESS;
 }
 
 static gboolean
 ip4_address_delete (NMPlatform *platform, int ifindex, in_addr_t addr, guint8 plen, in_addr_t peer_address)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NL_BUILDER_STACK (builder);
 	NMPObject obj_id;
 
-	nlmsg = _nl_msg_new_address (RTM_DELADDR,
-	                             0,
-	                             AF_INET,
-	                             ifindex,
-	                             &addr,
-	                             plen,
-	                             &peer_address,
-	                             0,
-	                             RT_SCOPE_NOWHERE,
-	                             NM_PLATFORM_LIFETIME_PERMANENT,
-	                             NM_PLATFORM_LIFETIME_PERMANENT,
-	                             NULL);
-	if (!nlmsg)
-		g_return_val_if_reached (FALSE);
+	if (!_nl_builder_append_address (&builder,
+	                                 RTM_DELADDR,
+	                                 0,
+	                                 AF_INET,
+	                                 ifindex,
+	                                 &addr,
+	                                 plen,
+	                                 &peer_address,
+	                                 0,
+	                                 RT_SCOPE_NOWHERE,
+	                                 NM_PLATFORM_LIFETIME_PERMANENT,
+	                                 NM_PLATFORM_LIFETIME_PERMANENT,
+	                                 NULL))
+		return FALSE;
 
 	nmp_object_stackinit_id_ip4_address (&obj_id, ifindex, addr, plen, peer_address);
-	return do_delete_object (platform, &obj_id, nlmsg);
+	return do_delete_object (platform, &obj_id, nmp_nl_builder_get_msgs (&builder, NULL));
 }
 
 static gboolean
 ip6_address_delete (NMPlatform *platform, int ifindex, struct in6_addr addr, guint8 plen)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NL_BUILDER_STACK (builder);
 	NMPObject obj_id;
 
-	nlmsg = _nl_msg_new_address (RTM_DELADDR,
-	                             0,
-	                             AF_INET6,
-	                             ifindex,
-	                             &addr,
-	                             plen,
-	                             NULL,
-	                             0,
-	                             RT_SCOPE_NOWHERE,
-	                             NM_PLATFORM_LIFETIME_PERMANENT,
-	                             NM_PLATFORM_LIFETIME_PERMANENT,
-	                             NULL);
-	if (!nlmsg)
-		g_return_val_if_reached (FALSE);
+	if (!_nl_builder_append_address (&builder,
+	                                 RTM_DELADDR,
+	                                 0,
+	                                 AF_INET6,
+	                                 ifindex,
+	                                 &addr,
+	                                 plen,
+	                                 NULL,
+	                                 0,
+	                                 RT_SCOPE_NOWHERE,
+	                                 NM_PLATFORM_LIFETIME_PERMANENT,
+	                                 NM_PLATFORM_LIFETIME_PERMANENT,
+	                                 NULL))
+		return FALSE;
 
 	nmp_object_stackinit_id_ip6_address (&obj_id, ifindex, &addr);
-	return do_delete_object (platform, &obj_id, nlmsg);
+	return do_delete_object (platform, &obj_id, nmp_nl_builder_get_msgs (&builder, NULL));
 }
 
 /*****************************************************************************/
@@ -5972,7 +7054,7 @@ ip_route_add (NMPlatform *platform,
               int addr_family,
               const NMPlatformIPRoute *route)
 {
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NL_BUILDER_STACK (builder);
 	NMPObject obj;
 
 	switch (addr_family) {
@@ -5988,12 +7070,11 @@ ip_route_add (NMPlatform *platform,
 
 	nm_platform_ip_route_normalize (addr_family, NMP_OBJECT_CAST_IP_ROUTE (&obj));
 
-	nlmsg = _nl_msg_new_route (RTM_NEWROUTE, flags & NMP_NLM_FLAG_FMASK, &obj);
-	if (!nlmsg)
-		g_return_val_if_reached (NM_PLATFORM_ERROR_BUG);
+	if (!_nl_builder_append_route (&builder, RTM_NEWROUTE, flags & NMP_NLM_FLAG_FMASK, &obj))
+		return NM_PLATFORM_ERROR_BUG;
 	return do_add_addrroute (platform,
 	                         &obj,
-	                         nlmsg,
+	                         nmp_nl_builder_get_msgs (&builder, NULL),
 	                         NM_FLAGS_HAS (flags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE));
 }
 
@@ -6002,7 +7083,7 @@ ip_route_delete (NMPlatform *platform,
                  const NMPObject *obj)
 {
 	nm_auto_nmpobj const NMPObject *obj_keep_alive = NULL;
-	nm_auto_nlmsg struct nl_msg *nlmsg = NULL;
+	NL_BUILDER_STACK (builder);
 
 	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ROUTE,
 	                                                 NMP_OBJECT_TYPE_IP6_ROUTE));
@@ -6010,10 +7091,182 @@ ip_route_delete (NMPlatform *platform,
 	if (!NMP_OBJECT_IS_STACKINIT (obj))
 		obj_keep_alive = nmp_object_ref (obj);
 
-	nlmsg = _nl_msg_new_route (RTM_DELROUTE, 0, obj);
-	if (!nlmsg)
+	if (!_nl_builder_append_route (&builder, RTM_DELROUTE, 0, obj))
+		return FALSE;
+	return do_delete_object (platform, obj, nmp_nl_builder_get_msgs (&builder, NULL));
+}
+
+/* The number of requests of a batch that we send before waiting for the
+ * responses. Every request results in an ACK and usually in a notification,
+ * which pile up in the receive buffer of the socket until we read them.
+ * Don't let too many requests be in flight, or the socket overflows. */
+#define IP_BATCH_MAX_IN_FLIGHT 100
+
+static gboolean
+_nl_builder_append_ip_batch_op (NMPNlBuilder *builder,
+                                const NMPlatformIPBatchOp *op)
+{
+	const NMPObject *o = op->obj;
+	NMPObject obj;
+
+	switch (NMP_OBJECT_GET_TYPE (o)) {
+	case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		if (op->is_delete) {
+			return _nl_builder_append_address (builder,
+			                                   RTM_DELADDR,
+			                                   0,
+			                                   AF_INET,
+			                                   o->ip4_address.ifindex,
+			                                   &o->ip4_address.address,
+			                                   o->ip4_address.plen,
+			                                   &o->ip4_address.peer_address,
+			                                   0,
+			                                   RT_SCOPE_NOWHERE,
+			                                   NM_PLATFORM_LIFETIME_PERMANENT,
+			                                   NM_PLATFORM_LIFETIME_PERMANENT,
+			                                   NULL);
+		}
+		return _nl_builder_append_address (builder,
+		                                   RTM_NEWADDR,
+		                                   NLM_F_CREATE | NLM_F_REPLACE,
+		                                   AF_INET,
+		                                   o->ip4_address.ifindex,
+		                                   &o->ip4_address.address,
+		                                   o->ip4_address.plen,
+		                                   &o->ip4_address.peer_address,
+		                                   op->ifa_flags,
+		                                     nm_utils_ip4_address_is_link_local (o->ip4_address.address)
+		                                   ? RT_SCOPE_LINK
+		                                   : RT_SCOPE_UNIVERSE,
+		                                   op->lifetime,
+		                                   op->preferred,
+		                                   o->ip4_address.label);
+	case NMP_OBJECT_TYPE_IP6_ADDRESS:
+		if (op->is_delete) {
+			return _nl_builder_append_address (builder,
+			                                   RTM_DELADDR,
+			                                   0,
+			                                   AF_INET6,
+			                                   o->ip6_address.ifindex,
+			                                   &o->ip6_address.address,
+			                                   o->ip6_address.plen,
+			                                   NULL,
+			                                   0,
+			                                   RT_SCOPE_NOWHERE,
+			                                   NM_PLATFORM_LIFETIME_PERMANENT,
+			                                   NM_PLATFORM_LIFETIME_PERMANENT,
+			                                   NULL);
+		}
+		return _nl_builder_append_address (builder,
+		                                   RTM_NEWADDR,
+		                                   NLM_F_CREATE | NLM_F_REPLACE,
+		                                   AF_INET6,
+		                                   o->ip6_address.ifindex,
+		                                   &o->ip6_address.address,
+		                                   o->ip6_address.plen,
+		                                   &o->ip6_address.peer_address,
+		                                   op->ifa_flags,
+		                                   RT_SCOPE_UNIVERSE,
+		                                   op->lifetime,
+		                                   op->preferred,
+		                                   NULL);
+	case NMP_OBJECT_TYPE_IP4_ROUTE:
+	case NMP_OBJECT_TYPE_IP6_ROUTE:
+		if (op->is_delete)
+			return _nl_builder_append_route (builder, RTM_DELROUTE, 0, o);
+
+		nmp_object_stackinit_obj (&obj, o);
+		nm_platform_ip_route_normalize (NMP_OBJECT_GET_CLASS (&obj)->addr_family,
+		                                NMP_OBJECT_CAST_IP_ROUTE (&obj));
+		return _nl_builder_append_route (builder, RTM_NEWROUTE, op->flags & NMP_NLM_FLAG_FMASK, &obj);
+	default:
 		g_return_val_if_reached (FALSE);
-	return do_delete_object (platform, obj, nlmsg);
+	}
+}
+
+static void
+ip_batch (NMPlatform *platform,
+          NMPlatformIPBatchOp *ops,
+          guint n_ops)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	WaitForNlResponseResult seq_results[IP_BATCH_MAX_IN_FLIGHT];
+	WaitForNlResponseResult *out_seq_results[IP_BATCH_MAX_IN_FLIGHT];
+	guint i_start, i, n_window, n_msgs;
+	gboolean needs_refetch = FALSE;
+
+	nm_assert (ops && n_ops > 0);
+
+	event_handler_read_netlink (platform, FALSE);
+
+	for (i_start = 0; i_start < n_ops; i_start += n_window) {
+		int nle;
+
+		n_window = MIN (n_ops - i_start, IP_BATCH_MAX_IN_FLIGHT);
+
+		/* build the requests of the window into the reused buffer
+		 * and send them at once. */
+		nmp_nl_builder_reset (&priv->nl_builder);
+		n_msgs = 0;
+		for (i = 0; i < n_window; i++) {
+			NMPlatformIPBatchOp *op = &ops[i_start + i];
+
+			seq_results[i] = WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN;
+
+			if (!_nl_builder_append_ip_batch_op (&priv->nl_builder, op)) {
+				op->result = NM_PLATFORM_ERROR_BUG;
+				continue;
+			}
+			out_seq_results[n_msgs++] = &seq_results[i];
+		}
+
+		if (n_msgs == 0)
+			continue;
+
+		nle = _nl_send_nl_builder (platform, &priv->nl_builder, out_seq_results);
+		if (nle < 0) {
+			for (i = 0; i < n_msgs; i++) {
+				NMPlatformIPBatchOp *op = &ops[i_start + (out_seq_results[i] - seq_results)];
+
+				_LOGE ("do-%s-%s[%s]: failure sending netlink request \"%s\" (%d)",
+				       op->is_delete ? "delete" : "add",
+				       NMP_OBJECT_GET_CLASS (op->obj)->obj_type_name,
+				       nmp_object_to_string (op->obj, NMP_OBJECT_TO_STRING_ID, NULL, 0),
+				       g_strerror (-nle), -nle);
+				op->result = NM_PLATFORM_ERROR_NETLINK;
+			}
+			continue;
+		}
+
+		delayed_action_handle_all (platform, FALSE);
+
+		for (i = 0; i < n_window; i++) {
+			NMPlatformIPBatchOp *op = &ops[i_start + i];
+
+			if (seq_results[i] == WAIT_FOR_NL_RESPONSE_RESULT_UNKNOWN) {
+				/* the request was not sent. */
+				continue;
+			}
+
+			if (op->is_delete) {
+				op->result =   _do_delete_object_complete (platform, op->obj, seq_results[i])
+				             ? NM_PLATFORM_ERROR_SUCCESS
+				             : wait_for_nl_response_to_plerr (seq_results[i]);
+			} else {
+				op->result = _do_add_addrroute_complete (platform,
+				                                         op->obj,
+				                                         seq_results[i],
+				                                         NM_FLAGS_HAS (op->flags, NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE));
+				if (   !needs_refetch
+				    && op->result == NM_PLATFORM_ERROR_SUCCESS)
+					needs_refetch = _do_add_addrroute_needs_refetch (platform, op->obj);
+			}
+		}
+	}
+
+	/* refetch the IPv6 addresses at most once for the entire batch. */
+	if (needs_refetch)
+		do_request_one_type (platform, NMP_OBJECT_TYPE_IP6_ADDRESS);
 }
 
 /*****************************************************************************/
@@ -6104,99 +7357,135 @@ event_handler (GIOChannel *channel,
 
 /*****************************************************************************/
 
+/* Like libnl3's nl_recv(), but receives into @buf instead of allocating
+ * a new buffer for each call. MSG_PEEK is not used, so a message that
+ * does not fit into @buf is lost and -NLE_MSG_TRUNC is returned. */
+static int
+_nl_recv (struct nl_sock *sk,
+          unsigned char *buf,
+          gsize buf_len,
+          struct sockaddr_nl *nla,
+          struct ucred *out_creds,
+          gboolean *out_creds_has)
+{
+	struct iovec iov = {
+		.iov_base = buf,
+		.iov_len = buf_len,
+	};
+	union {
+		struct cmsghdr cmsghdr;
+		char buf[CMSG_SPACE (sizeof (struct ucred))];
+	} cmsgbuf;
+	struct msghdr msg = {
+		.msg_name = nla,
+		.msg_namelen = sizeof (*nla),
+		.msg_iov = &iov,
+		.msg_iovlen = 1,
+		.msg_control = &cmsgbuf,
+		.msg_controllen = sizeof (cmsgbuf),
+	};
+	struct cmsghdr *cmsg;
+	gssize n;
+
+	*out_creds_has = FALSE;
+
+retry:
+	n = recvmsg (nl_socket_get_fd (sk), &msg, 0);
+	if (n < 0) {
+		int errsv = errno;
+
+		if (errsv == EINTR)
+			goto retry;
+		if (errsv == EAGAIN)
+			return -NLE_AGAIN;
+		if (errsv == ENOBUFS) {
+			/* we are very much interested in a overrun of the receive buffer.
+			 * Hack our own return code to signal the overrun. */
+			return -_NLE_NM_NOBUFS;
+		}
+		return -nl_syserr2nlerr (errsv);
+	}
+
+	if (NM_FLAGS_HAS (msg.msg_flags, MSG_TRUNC))
+		return -NLE_MSG_TRUNC;
+
+	if (msg.msg_namelen != sizeof (struct sockaddr_nl))
+		return -NLE_NOADDR;
+
+	for (cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg)) {
+		if (   cmsg->cmsg_level == SOL_SOCKET
+		    && cmsg->cmsg_type == SCM_CREDENTIALS) {
+			memcpy (out_creds, CMSG_DATA (cmsg), sizeof (*out_creds));
+			*out_creds_has = TRUE;
+			break;
+		}
+	}
+
+	return n;
+}
+
 /* copied from libnl3's recvmsgs() */
 static int
-event_handler_recvmsgs (NMPlatform *platform, gboolean handle_events)
+event_handler_recvmsgs (NMPlatform *platform, struct nl_sock *sk, gboolean handle_events)
 {
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
-	struct nl_sock *sk = priv->nlh;
+	const gboolean is_route_events = (sk == priv->nlh_route_events);
 	int n, err = 0, multipart = 0, interrupted = 0;
 	struct nlmsghdr *hdr;
 	WaitForNlResponseResult seq_result;
-
-	/*
-	nla is passed on to not only to nl_recv() but may also be passed
-	to a function pointer provided by the caller which may or may not
-	initialize the variable. Thomas Graf.
-	*/
-	struct sockaddr_nl nla = {0};
-	nm_auto_free struct ucred *creds = NULL;
-	nm_auto_free unsigned char *buf = NULL;
+	struct sockaddr_nl nla = { 0 };
+	struct ucred creds;
+	gboolean creds_has;
+	unsigned char *buf;
+	gsize buf_len;
+	nm_auto_free unsigned char *buf_heap = NULL;
+
+	/* we receive into the same buffer every time. Only if we are called
+	 * recursively while processing the messages (e.g. from a signal handler),
+	 * we must not overwrite it. */
+	if (priv->recv_buf.in_use) {
+		buf_len = priv->recv_buf.len;
+		buf = buf_heap = malloc (buf_len);
+	} else {
+		buf_len = priv->recv_buf.len;
+		buf = priv->recv_buf.data;
+		priv->recv_buf.in_use = TRUE;
+	}
 
 continue_reading:
-	g_clear_pointer (&buf, free);
-	g_clear_pointer (&creds, free);
-	errno = 0;
-	n = nl_recv (sk, &nla, &buf, &creds);
-
-	if (n <= 0) {
-		/* workaround libnl3 <= 3.2.15 returning danling pointers in case nl_recv()
-		 * fails. Fixed by libnl3 69468517d0de1675d80f24661ff57a5dbac7275c. */
-		buf = NULL;
-		creds = NULL;
-	}
-
-	switch (n) {
-	case 0:
-		/* Work around a libnl bug fixed in 3.2.22 (375a6294) */
-		if (errno == EAGAIN) {
-			/* EAGAIN is equal to EWOULDBLOCK. If it would not be, we'd have to
-			 * workaround libnl3 mapping EWOULDBLOCK to -NLE_FAILURE. */
-			G_STATIC_ASSERT (EAGAIN == EWOULDBLOCK);
-			n = -NLE_AGAIN;
-		}
-		break;
-	case -NLE_MSG_TRUNC: {
-		int buf_size;
+	n = _nl_recv (sk, buf, buf_len, &nla, &creds, &creds_has);
 
+	if (n == -NLE_MSG_TRUNC) {
 		/* the message receive buffer was too small. We lost one message, which
 		 * is unfortunate. Try to double the buffer size for the next time. */
-		buf_size = nl_socket_get_msg_buf_size (sk);
-		if (buf_size < 512*1024) {
-			buf_size *= 2;
-			_LOGT ("netlink: recvmsg: increase message buffer size for recvmsg() to %d bytes", buf_size);
-			if (nl_socket_set_msg_buf_size (sk, buf_size) < 0)
-				nm_assert_not_reached ();
+		if (   !buf_heap
+		    && priv->recv_buf.len < 512*1024) {
+			priv->recv_buf.len *= 2;
+			priv->recv_buf.data = g_realloc (priv->recv_buf.data, priv->recv_buf.len);
+			buf = priv->recv_buf.data;
+			buf_len = priv->recv_buf.len;
+			_LOGT ("netlink: recvmsg: increase message buffer size for recvmsg() to %zu bytes", buf_len);
 			if (!handle_events)
 				goto continue_reading;
 		}
 		n = -_NLE_MSG_TRUNC;
-		break;
-	}
-	case -NLE_NOMEM:
-		if (errno == ENOBUFS) {
-			/* we are very much interested in a overrun of the receive buffer.
-			 * nl_recv() maps all kinds of errors to NLE_NOMEM, so check also
-			 * for errno explicitly. And if so, hack our own return code to signal
-			 * the overrun. */
-			n = -_NLE_NM_NOBUFS;
-		}
-		break;
 	}
 
-	if (n <= 0)
-		return n;
+	if (n <= 0) {
+		err = n;
+		goto out_release;
+	}
 
 	hdr = (struct nlmsghdr *) buf;
 	while (nlmsg_ok (hdr, n)) {
-		nm_auto_nlmsg struct nl_msg *msg = NULL;
 		gboolean abort_parsing = FALSE;
 		gboolean process_valid_msg = FALSE;
 		guint32 seq_number;
 		char buf_nlmsghdr[400];
 
-		msg = nlmsg_convert (hdr);
-		if (!msg) {
-			err = -NLE_NOMEM;
-			goto out;
-		}
-
-		nlmsg_set_proto (msg, NETLINK_ROUTE);
-		nlmsg_set_src (msg, &nla);
-
-		if (!creds || creds->pid) {
-			if (creds)
-				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds->pid);
+		if (!creds_has || creds.pid) {
+			if (creds_has)
+				_LOGT ("netlink: recvmsg: received non-kernel message (pid %d)", creds.pid);
 			else
 				_LOGT ("netlink: recvmsg: received message without credentials");
 			err = 0;
@@ -6206,9 +7495,6 @@ continue_reading:
 		_LOGt ("netlink: recvmsg: new message %s",
 		       _nl_nlmsghdr_to_str (hdr, buf_nlmsghdr, sizeof (buf_nlmsghdr)));
 
-		if (creds)
-			nlmsg_set_creds (msg, creds);
-
 		if (hdr->nlmsg_flags & NLM_F_MULTI)
 			multipart = 1;
 
@@ -6264,14 +7550,17 @@ continue_reading:
 				_LOGD ("netlink: recvmsg: error message from kernel: %s (%d) for request %d",
 				       strerror (errsv),
 				       errsv,
-				       nlmsg_hdr (msg)->nlmsg_seq);
+				       hdr->nlmsg_seq);
 				seq_result = -errsv;
 			} else
 				seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		} else
 			process_valid_msg = TRUE;
 
-		seq_number = nlmsg_hdr (msg)->nlmsg_seq;
+		/* notifications about changes that we requested carry the sequence number
+		 * of our request. But the response to requests is only received on @nlh,
+		 * so ignore sequence numbers on the route event socket. */
+		seq_number = is_route_events ? 0 : hdr->nlmsg_seq;
 
 		/* check whether the seq number is different from before, and
 		 * whether the previous number (@nlh_seq_last_seen) is a pending
@@ -6287,7 +7576,7 @@ continue_reading:
 			 * get along with broken kernels. NL_SKIP has no
 			 * effect on this.  */
 
-			event_valid_msg (platform, msg, handle_events);
+			event_valid_msg (platform, hdr, !is_route_events, handle_events);
 
 			seq_result = WAIT_FOR_NL_RESPONSE_RESULT_RESPONSE_OK;
 		}
@@ -6312,16 +7601,113 @@ stop:
 		 * Repeat reading. */
 		goto continue_reading;
 	}
-out:
 	if (interrupted)
 		err = -NLE_DUMP_INTR;
+out_release:
+	if (!buf_heap)
+		priv->recv_buf.in_use = FALSE;
 	return err;
 }
 
 /*****************************************************************************/
 
+static void
+resync_schedule (NMPlatform *platform, DelayedActionType types)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+
+	nm_assert (types);
+	nm_assert (!NM_FLAGS_ANY (types, ~DELAYED_ACTION_TYPE_REFRESH_ALL));
+
+	if (!priv->resync.types)
+		priv->resync.start_ns = nm_utils_get_monotonic_timestamp_ns ();
+	priv->resync.types |= types;
+	priv->resync.stats.n_overflows++;
+
+	delayed_action_schedule (platform, types, NULL);
+}
+
+static void
+resync_check_complete (NMPlatform *platform)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType iflags;
+	gint64 duration_ns;
+
+	if (!priv->resync.types)
+		return;
+
+	FOR_EACH_DELAYED_ACTION (iflags, priv->resync.types) {
+		if (delayed_action_refresh_all_in_progress (platform, iflags))
+			return;
+	}
+
+	duration_ns = nm_utils_get_monotonic_timestamp_ns () - priv->resync.start_ns;
+	priv->resync.stats.n_resyncs++;
+	priv->resync.stats.duration_last_ns = duration_ns;
+	priv->resync.stats.duration_total_ns += duration_ns;
+	if (NM_FLAGS_ANY (priv->resync.types, DELAYED_ACTION_TYPE_REFRESH_ALL & ~DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES & ~DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES))
+		priv->resync.stats.n_resyncs_full++;
+
+	_LOGD ("netlink: resync: completed in %"G_GINT64_FORMAT" msec (%"G_GUINT64_FORMAT" resyncs, %"G_GUINT64_FORMAT" overflows)",
+	       duration_ns / (NM_UTILS_NS_PER_SECOND / 1000),
+	       priv->resync.stats.n_resyncs,
+	       priv->resync.stats.n_overflows);
+	priv->resync.types = DELAYED_ACTION_TYPE_NONE;
+}
+
+static void
+event_handler_read_netlink_failed (NMPlatform *platform, struct nl_sock *sk, int nle)
+{
+	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	DelayedActionType types, iflags;
+	const char *reason;
+
+	switch (nle) {
+	case -NLE_DUMP_INTR:
+		_LOGD ("netlink: read: uncritical failure to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
+		return;
+	case -_NLE_MSG_TRUNC:
+		reason = "message truncated";
+		break;
+	case -_NLE_NM_NOBUFS:
+		reason = "too many netlink events";
+		break;
+	default:
+		_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
+		return;
+	}
+
+	event_handler_recvmsgs (platform, sk, FALSE);
+
+	if (sk == priv->nlh_route_events) {
+		/* only route events were lost. The responses to our requests
+		 * are received on the other socket and are not affected. */
+		_LOGI ("netlink: read: %s. Need to resynchronize routes", reason);
+		resync_schedule (platform,
+		                 DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
+		                 DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES);
+		return;
+	}
+
+	/* we lost link and address events, but also the responses to pending
+	 * requests. That includes the replies to route dumps, so those must
+	 * be repeated too. */
+	types =   DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS
+	        | DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES
+	        | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES;
+	FOR_EACH_DELAYED_ACTION (iflags, DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES | DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES) {
+		if (priv->delayed_action.refresh_all_in_progess[delayed_action_refresh_all_to_idx (iflags)] > 0)
+			types |= iflags;
+	}
+
+	_LOGI ("netlink: read: %s. Need to resynchronize platform cache", reason);
+	delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
+	resync_schedule (platform, types);
+}
+
 static gboolean
-event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
+_event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 {
 	nm_auto_pop_netns NMPNetns *netns = NULL;
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
@@ -6343,40 +7729,24 @@ event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
 
 		while (TRUE) {
 
-			nle = event_handler_recvmsgs (platform, TRUE);
+			nle = event_handler_recvmsgs (platform, priv->nlh, TRUE);
+			if (nle == -NLE_AGAIN)
+				break;
+			if (nle < 0)
+				event_handler_read_netlink_failed (platform, priv->nlh, nle);
+			any = TRUE;
+		}
+
+		/* the kernel queues the notifications about a change before the ACK
+		 * of the request. After reading the ACKs, also read the pending route
+		 * events, so that the cache reflects our requests. */
+		while (TRUE) {
 
+			nle = event_handler_recvmsgs (platform, priv->nlh_route_events, TRUE);
+			if (nle == -NLE_AGAIN)
+				break;
 			if (nle < 0)
-				switch (nle) {
-				case -NLE_AGAIN:
-					goto after_read;
-				case -NLE_DUMP_INTR:
-					_LOGD ("netlink: read: uncritical failure to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
-					break;
-				case -_NLE_MSG_TRUNC:
-				case -_NLE_NM_NOBUFS:
-					_LOGI ("netlink: read: %s. Need to resynchronize platform cache",
-					       ({
-					            const char *_reason = "unknown";
-					            switch (nle) {
-					            case -_NLE_MSG_TRUNC: _reason = "message truncated";       break;
-					            case -_NLE_NM_NOBUFS: _reason = "too many netlink events"; break;
-					            }
-					            _reason;
-					       }));
-					event_handler_recvmsgs (platform, FALSE);
-					delayed_action_wait_for_nl_response_complete_all (platform, WAIT_FOR_NL_RESPONSE_RESULT_FAILED_RESYNC);
-					delayed_action_schedule (platform,
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_LINKS |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ADDRESSES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP4_ROUTES |
-					                         DELAYED_ACTION_TYPE_REFRESH_ALL_IP6_ROUTES,
-					                         NULL);
-					break;
-				default:
-					_LOGE ("netlink: read: failed to retrieve incoming events: %s (%d)", nl_geterror (nle), nle);
-					break;
-			}
+				event_handler_read_netlink_failed (platform, priv->nlh_route_events, nle);
 			any = TRUE;
 		}
 
@@ -6441,6 +7811,68 @@ after_read:
 	}
 }
 
+static gboolean
+event_handler_read_netlink (NMPlatform *platform, gboolean wait_for_acks)
+{
+	gboolean any;
+
+	/* all changes from one read cycle are emitted as one batch. */
+	nm_platform_changes_batch_begin (platform);
+	any = _event_handler_read_netlink (platform, wait_for_acks);
+	nm_platform_changes_batch_end (platform);
+	return any;
+}
+
+/*****************************************************************************/
+
+/**
+ * _nmtst_linux_platform_process_netlink_msgs:
+ * @platform: the #NMLinuxPlatform instance
+ * @buf: a buffer of netlink messages, as received from the kernel.
+ * @len: the length of @buf
+ *
+ * Process the messages like events from the netlink socket. This
+ * is only for testing and benchmarking.
+ */
+void
+_nmtst_linux_platform_process_netlink_msgs (NMPlatform *platform, const void *buf, gsize len)
+{
+	struct nlmsghdr *hdr = (struct nlmsghdr *) buf;
+	int n = len;
+
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+
+	while (nlmsg_ok (hdr, n)) {
+		if (hdr->nlmsg_type >= NLMSG_MIN_TYPE)
+			event_valid_msg (platform, hdr, TRUE, TRUE);
+		hdr = nlmsg_next (hdr, &n);
+	}
+	delayed_action_handle_all (platform, FALSE);
+}
+
+/**
+ * _nmtst_linux_platform_netlink_overflow:
+ * @platform: the #NMLinuxPlatform instance
+ * @route_events: whether the socket for route events overflowed,
+ *   or the main socket.
+ *
+ * Handle an overflow of a netlink socket, as if reading from it failed
+ * with ENOBUFS, and resynchronize the cache. This is only for testing.
+ */
+void
+_nmtst_linux_platform_netlink_overflow (NMPlatform *platform, gboolean route_events)
+{
+	NMLinuxPlatformPrivate *priv;
+
+	g_return_if_fail (NM_IS_LINUX_PLATFORM (platform));
+
+	priv = NM_LINUX_PLATFORM_GET_PRIVATE (platform);
+	event_handler_read_netlink_failed (platform,
+	                                   route_events ? priv->nlh_route_events : priv->nlh,
+	                                   -_NLE_NM_NOBUFS);
+	delayed_action_handle_all (platform, FALSE);
+}
+
 /*****************************************************************************/
 
 static void
@@ -6570,10 +8002,16 @@ nm_linux_platform_init (NMLinuxPlatform *self)
 	NMLinuxPlatformPrivate *priv = NM_LINUX_PLATFORM_GET_PRIVATE (self);
 
 	priv->nlh_seq_next = 1;
+	priv->recv_buf.len = 32 * 1024;
+	priv->recv_buf.data = g_malloc (priv->recv_buf.len);
 	priv->delayed_action.list_master_connected = g_ptr_array_new ();
 	priv->delayed_action.list_refresh_link = g_ptr_array_new ();
+	priv->delayed_action.list_refresh_ifindex = g_array_new (FALSE, FALSE, sizeof (DelayedActionRefreshIfindexData));
+	priv->pruning_ifindex = g_ptr_array_new_with_free_func (_refresh_ifindex_prune_data_free);
 	priv->delayed_action.list_wait_for_nl_response = g_array_new (FALSE, TRUE, sizeof (DelayedActionWaitForNlResponseData));
 	priv->wifi_data = g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) wifi_utils_deinit);
+	priv->ethtool_infos = g_hash_table_new_full (NULL, NULL, NULL, _ethtool_info_free);
+	nmp_nl_builder_init (&priv->nl_builder, 0);
 }
 
 static void
@@ -6619,20 +8057,47 @@ constructed (GObject *_object)
 	nle = nl_socket_set_buffer_size (priv->nlh, 8*1024*1024, 0);
 	g_assert (!nle);
 
-	/* explicitly set the msg buffer size and disable MSG_PEEK.
-	 * If we later encounter NLE_MSG_TRUNC, we will adjust the buffer size. */
-	nl_socket_disable_msg_peek (priv->nlh);
-	nle = nl_socket_set_msg_buf_size (priv->nlh, 32 * 1024);
-	g_assert (!nle);
+	/* with strict checking, kernel validates our requests and honors the
+	 * filters in dump requests, so that we can refresh the addresses and routes
+	 * of a single interface. Added in kernel 4.20. */
+	{
+		int val = 1;
+
+		priv->nlh_strict_check = (setsockopt (nl_socket_get_fd (priv->nlh),
+		                                      SOL_NETLINK,
+		                                      NETLINK_GET_STRICT_CHK,
+		                                      &val,
+		                                      sizeof (val)) == 0);
+		_LOGD ("kernel-support: NETLINK_GET_STRICT_CHK: %s",
+		       priv->nlh_strict_check ? "detected" : "not detected");
+	}
 
 	nle = nl_socket_add_memberships (priv->nlh,
 	                                 RTNLGRP_LINK,
 	                                 RTNLGRP_IPV4_IFADDR, RTNLGRP_IPV6_IFADDR,
-	                                 RTNLGRP_IPV4_ROUTE,  RTNLGRP_IPV6_ROUTE,
 	                                 0);
 	g_assert (!nle);
 	_LOGD ("Netlink socket for events established: port=%u, fd=%d", nl_socket_get_local_port (priv->nlh), nl_socket_get_fd (priv->nlh));
 
+	/* the socket for route events is only used for receiving. */
+	priv->nlh_route_events = nl_socket_alloc ();
+	g_assert (priv->nlh_route_events);
+
+	nle = nl_connect (priv->nlh_route_events, NETLINK_ROUTE);
+	g_assert (!nle);
+	nle = nl_socket_set_passcred (priv->nlh_route_events, 1);
+	g_assert (!nle);
+	nle = nl_socket_set_nonblocking (priv->nlh_route_events);
+	g_assert (!nle);
+	nle = nl_socket_set_buffer_size (priv->nlh_route_events, 8*1024*1024, 0);
+	g_assert (!nle);
+
+	nle = nl_socket_add_memberships (priv->nlh_route_events,
+	                                 RTNLGRP_IPV4_ROUTE, RTNLGRP_IPV6_ROUTE,
+	                                 0);
+	g_assert (!nle);
+	_LOGD ("Netlink socket for route events established: port=%u, fd=%d", nl_socket_get_local_port (priv->nlh_route_events), nl_socket_get_fd (priv->nlh_route_events));
+
 	priv->event_channel = g_io_channel_unix_new (nl_socket_get_fd (priv->nlh));
 	g_io_channel_set_encoding (priv->event_channel, NULL, NULL);
 	g_io_channel_set_close_on_unref (priv->event_channel, TRUE);
@@ -6645,6 +8110,21 @@ constructed (GObject *_object)
 	                                (EVENT_CONDITIONS | ERROR_CONDITIONS | DISCONNECT_CONDITIONS),
 	                                 event_handler, platform);
 
+	priv->event_channel_route_events = g_io_channel_unix_new (nl_socket_get_fd (priv->nlh_route_events));
+	g_io_channel_set_encoding (priv->event_channel_route_events, NULL, NULL);
+	g_io_channel_set_close_on_unref (priv->event_channel_route_events, TRUE);
+
+	channel_flags = g_io_channel_get_flags (priv->event_channel_route_events);
+	status = g_io_channel_set_flags (priv->event_channel_route_events,
+	                                 channel_flags | G_IO_FLAG_NONBLOCK, NULL);
+	g_assert (status);
+
+	/* route events have a lower priority than link and address events. */
+	priv->event_id_route_events = g_io_add_watch_full (priv->event_channel_route_events,
+	                                                   G_PRIORITY_LOW,
+	                                                   (EVENT_CONDITIONS | ERROR_CONDITIONS | DISCONNECT_CONDITIONS),
+	                                                   event_handler, platform, NULL);
+
 	/* complete construction of the GObject instance before populating the cache. */
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->constructed (_object);
 
@@ -6701,6 +8181,8 @@ dispose (GObject *object)
 	priv->delayed_action.flags = DELAYED_ACTION_TYPE_NONE;
 	g_ptr_array_set_size (priv->delayed_action.list_master_connected, 0);
 	g_ptr_array_set_size (priv->delayed_action.list_refresh_link, 0);
+	g_array_set_size (priv->delayed_action.list_refresh_ifindex, 0);
+	g_ptr_array_set_size (priv->pruning_ifindex, 0);
 
 	G_OBJECT_CLASS (nm_linux_platform_parent_class)->dispose (object);
 }
@@ -6712,13 +8194,24 @@ finalize (GObject *object)
 
 	g_ptr_array_unref (priv->delayed_action.list_master_connected);
 	g_ptr_array_unref (priv->delayed_action.list_refresh_link);
+	g_array_unref (priv->delayed_action.list_refresh_ifindex);
 	g_array_unref (priv->delayed_action.list_wait_for_nl_response);
+	g_ptr_array_unref (priv->pruning_ifindex);
 
 	g_source_remove (priv->event_id);
 	g_io_channel_unref (priv->event_channel);
 	nl_socket_free (priv->nlh);
 
+	g_source_remove (priv->event_id_route_events);
+	g_io_channel_unref (priv->event_channel_route_events);
+	nl_socket_free (priv->nlh_route_events);
+
+	g_free (priv->recv_buf.data);
+
 	g_hash_table_unref (priv->wifi_data);
+	g_hash_table_unref (priv->ethtool_infos);
+
+	nmp_nl_builder_clear (&priv->nl_builder);
 
 	if (priv->sysctl_get_prev_values) {
 		sysctl_clear_cache_list = g_slist_remove (sysctl_clear_cache_list, object);
@@ -6742,11 +8235,13 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 
 	platform_class->sysctl_set = sysctl_set;
 	platform_class->sysctl_get = sysctl_get;
+	platform_class->sysctl_ifdir_open = sysctl_ifdir_open;
 
 	platform_class->link_add = link_add;
 	platform_class->link_delete = link_delete;
 
 	platform_class->link_refresh = link_refresh;
+	platform_class->link_stats_refresh = link_stats_refresh;
 
 	platform_class->link_set_netns = link_set_netns;
 
@@ -6818,6 +8313,7 @@ nm_linux_platform_class_init (NMLinuxPlatformClass *klass)
 
 	platform_class->ip_route_add = ip_route_add;
 	platform_class->ip_route_delete = ip_route_delete;
+	platform_class->ip_batch = ip_batch;
 	platform_class->ip_route_get = ip_route_get;
 
 	platform_class->check_support_kernel_extended_ifa_flags = check_support_kernel_extended_ifa_flags;
@@ -35,8 +35,34 @@ typedef struct _NMLinuxPlatformClass NMLinuxPlatformClass;
 
 GType nm_linux_platform_get_type (void);
 
+typedef struct {
+	/* how often a netlink socket overflowed and a resync was started. */
+	guint64 n_overflows;
+
+	/* how many resyncs completed, and how many of them could not
+	 * be restricted to the routes. */
+	guint64 n_resyncs;
+	guint64 n_resyncs_full;
+
+	gint64 duration_last_ns;
+	gint64 duration_total_ns;
+} NMLinuxPlatformResyncStats;
+
+void nm_linux_platform_get_resync_stats (NMPlatform *self, NMLinuxPlatformResyncStats *out_stats);
+
+typedef struct {
+	/* the number of ethtool and MII requests that were sent, and how
+	 * many requests were answered from the cache instead. */
+	guint64 n_requests;
+	guint64 n_cached;
+} NMLinuxPlatformEthtoolStats;
+
+void nm_linux_platform_get_ethtool_stats (NMPlatform *self, NMLinuxPlatformEthtoolStats *out_stats);
+
 NMPlatform *nm_linux_platform_new (gboolean log_with_ptr, gboolean netns_support);
 
 void nm_linux_platform_setup (void);
+void nm_linux_platform_setup_full (const char *ignore_route_tables,
+                                   const char *ignore_route_protocols);
 
 #endif /* __NETWORKMANAGER_LINUX_PLATFORM_H__ */
@@ -39,4 +39,14 @@ void nm_platform_cache_update_emit_signal (NMPlatform *platform,
                                            const NMPObject *obj_old,
                                            const NMPObject *obj_new);
 
+NMPlatformSysctlStats *_nm_platform_sysctl_stats (NMPlatform *self);
+
+int _nm_platform_link_stats_ifindex_cmp (gconstpointer a, gconstpointer b);
+
+/*****************************************************************************/
+
+/* only for tests and benchmarks. Implemented by NMLinuxPlatform. */
+void _nmtst_linux_platform_process_netlink_msgs (NMPlatform *platform, const void *buf, gsize len);
+void _nmtst_linux_platform_netlink_overflow (NMPlatform *platform, gboolean route_events);
+
 #endif /* __NM_PLATFORM_PRIVATE_H__ */
@@ -38,6 +38,7 @@
 #include "nm-setting-wired.h"
 
 #include "nm-core-utils.h"
+#include "nmp-netns.h"
 
 /******************************************************************
  * utils
@@ -63,6 +64,24 @@ nmp_utils_if_nametoindex (const char *ifname)
 	return if_nametoindex (ifname);
 }
 
+/* Returns a socket for ioctl() in the current network namespace. The socket
+ * is kept open and must not be closed by the caller. */
+static int
+_ioctl_socket_get (void)
+{
+	static int fd_global = -1;
+	NMPNetns *netns;
+
+	netns = nmp_netns_get_current ();
+	if (netns)
+		return nmp_netns_get_fd_ioctl (netns);
+
+	/* without support for namespaces, there is only one. */
+	if (fd_global < 0)
+		fd_global = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	return fd_global;
+}
+
 /******************************************************************
  * ethtool
  ******************************************************************/
@@ -123,14 +142,14 @@ ethtool_get (int ifindex, gpointer edata)
 	}
 
 	{
-		nm_auto_close int fd = -1;
+		int fd;
 		struct ifreq ifr = {
 			.ifr_data = edata,
 		};
 
 		memcpy (ifr.ifr_name, ifname, sizeof (ifname));
 
-		fd = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+		fd = _ioctl_socket_get ();
 		if (fd < 0) {
 			nm_log_trace (LOGD_PLATFORM, "ethtool[%d]: %s, %s: failed creating socket for ioctl: %s",
 			              ifindex,
@@ -273,22 +292,37 @@ nmp_utils_ethtool_supports_carrier_detect (int ifindex)
 	return ethtool_get (ifindex, &edata);
 }
 
+/**
+ * nmp_utils_ethtool_get_feature_index:
+ * @ifindex: the interface
+ * @feature: the name of the feature, like "vlan-challenged"
+ *
+ * The index of a feature in the ETH_SS_FEATURES string set only
+ * depends on the driver. Callers can cache it for as long as the
+ * interface exists and pass it to nmp_utils_ethtool_get_feature_active().
+ *
+ * Returns: the index or -1.
+ */
+int
+nmp_utils_ethtool_get_feature_index (int ifindex, const char *feature)
+{
+	g_return_val_if_fail (ifindex > 0, -1);
+	g_return_val_if_fail (feature, -1);
+
+	return ethtool_get_stringset_index (ifindex, ETH_SS_FEATURES, feature);
+}
+
 gboolean
-nmp_utils_ethtool_supports_vlans (int ifindex)
+nmp_utils_ethtool_get_feature_active (int ifindex, int feature_idx, gboolean *out_active)
 {
 	gs_free struct ethtool_gfeatures *features = NULL;
-	int idx, block, bit, size;
+	int block, bit, size;
 
 	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (feature_idx >= 0, FALSE);
 
-	idx = ethtool_get_stringset_index (ifindex, ETH_SS_FEATURES, "vlan-challenged");
-	if (idx == -1) {
-		nm_log_dbg (LOGD_PLATFORM, "ethtool: vlan-challenged ethtool feature does not exist for %d?", ifindex);
-		return FALSE;
-	}
-
-	block = idx /  32;
-	bit = idx % 32;
+	block = feature_idx /  32;
+	bit = feature_idx % 32;
 	size = block + 1;
 
 	features = g_malloc0 (sizeof (*features) + size * sizeof (struct ethtool_get_features_block));
@@ -298,7 +332,28 @@ nmp_utils_ethtool_supports_vlans (int ifindex)
 	if (!ethtool_get (ifindex, features))
 		return FALSE;
 
-	return !(features->features[block].active & (1 << bit));
+	NM_SET_OUT (out_active, !!(features->features[block].active & (1 << bit)));
+	return TRUE;
+}
+
+gboolean
+nmp_utils_ethtool_supports_vlans (int ifindex)
+{
+	int idx;
+	gboolean vlan_challenged;
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+
+	idx = nmp_utils_ethtool_get_feature_index (ifindex, "vlan-challenged");
+	if (idx == -1) {
+		nm_log_dbg (LOGD_PLATFORM, "ethtool: vlan-challenged ethtool feature does not exist for %d?", ifindex);
+		return FALSE;
+	}
+
+	if (!nmp_utils_ethtool_get_feature_active (ifindex, idx, &vlan_challenged))
+		return FALSE;
+
+	return !vlan_challenged;
 }
 
 int
@@ -478,7 +533,7 @@ gboolean
 nmp_utils_mii_supports_carrier_detect (int ifindex)
 {
 	char ifname[IFNAMSIZ];
-	nm_auto_close int fd = -1;
+	int fd;
 	struct ifreq ifr;
 	struct mii_ioctl_data *mii;
 
@@ -489,7 +544,7 @@ nmp_utils_mii_supports_carrier_detect (int ifindex)
 		return FALSE;
 	}
 
-	fd = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	fd = _ioctl_socket_get ();
 	if (fd < 0) {
 		nm_log_trace (LOGD_PLATFORM, "mii[%d,%s]: carrier-detect no: couldn't open control socket: %s", ifindex, ifname, g_strerror (errno));
 		return FALSE;
@@ -633,6 +688,62 @@ nmp_utils_ip_config_source_coerce_from_rtprot (NMIPConfigSource source)
 	}
 }
 
+/**
+ * nmp_utils_rtprot_from_string:
+ * @str: the name or the number of a route protocol
+ *
+ * Parses route protocols like rtm_protocol. Beside numbers, it accepts
+ * the names from iproute2's rt_protos file.
+ *
+ * Returns: the route protocol, or -1 if @str is not valid.
+ */
+int
+nmp_utils_rtprot_from_string (const char *str)
+{
+	static const struct {
+		const char *name;
+		guint8 rtprot;
+	} names[] = {
+		{ "unspec",      RTPROT_UNSPEC },
+		{ "redirect",    RTPROT_REDIRECT },
+		{ "kernel",      RTPROT_KERNEL },
+		{ "boot",        RTPROT_BOOT },
+		{ "static",      RTPROT_STATIC },
+		{ "gated",       8 },
+		{ "ra",          RTPROT_RA },
+		{ "mrt",         10 },
+		{ "zebra",       11 },
+		{ "bird",        12 },
+		{ "dnrouted",    13 },
+		{ "xorp",        14 },
+		{ "ntk",         15 },
+		{ "dhcp",        RTPROT_DHCP },
+		{ "mrouted",     17 },
+		{ "keepalived",  18 },
+		{ "babel",       42 },
+		{ "bgp",         186 },
+		{ "isis",        187 },
+		{ "ospf",        188 },
+		{ "rip",         189 },
+		{ "eigrp",       192 },
+	};
+	gint64 rtprot;
+	guint i;
+
+	if (!str || !str[0])
+		return -1;
+
+	rtprot = _nm_utils_ascii_str_to_int64 (str, 0, 0, 0xFF, -1);
+	if (rtprot >= 0)
+		return rtprot;
+
+	for (i = 0; i < G_N_ELEMENTS (names); i++) {
+		if (g_ascii_strcasecmp (str, names[i].name) == 0)
+			return names[i].rtprot;
+	}
+	return -1;
+}
+
 const char *
 nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize len)
 {
@@ -28,6 +28,8 @@
 const char *nmp_utils_ethtool_get_driver (int ifindex);
 gboolean nmp_utils_ethtool_supports_carrier_detect (int ifindex);
 gboolean nmp_utils_ethtool_supports_vlans (int ifindex);
+int nmp_utils_ethtool_get_feature_index (int ifindex, const char *feature);
+gboolean nmp_utils_ethtool_get_feature_active (int ifindex, int feature_idx, gboolean *out_active);
 int nmp_utils_ethtool_get_peer_ifindex (int ifindex);
 gboolean nmp_utils_ethtool_get_wake_on_lan (int ifindex);
 gboolean nmp_utils_ethtool_set_wake_on_lan (int ifindex, NMSettingWiredWakeOnLan wol,
@@ -74,6 +76,8 @@ NMIPConfigSource nmp_utils_ip_config_source_coerce_from_rtprot (NMIPConfigSource
 NMIPConfigSource nmp_utils_ip_config_source_round_trip_rtprot  (NMIPConfigSource source) _nm_const;
 const char *     nmp_utils_ip_config_source_to_string (NMIPConfigSource source, char *buf, gsize len);
 
+int nmp_utils_rtprot_from_string (const char *str);
+
 const char *nmp_utils_if_indextoname (int ifindex, char *out_ifname/*IFNAMSIZ*/);
 int nmp_utils_if_nametoindex (const char *ifname);
 
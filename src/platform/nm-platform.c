@@ -38,6 +38,7 @@
 #include "nm-core-internal.h"
 #include "nm-utils/nm-dedup-multi.h"
 #include "nm-utils/nm-udev-utils.h"
+#include "nm-utils/c-list.h"
 
 #include "nm-core-utils.h"
 #include "nm-platform-utils.h"
@@ -85,6 +86,8 @@ enum {
 	PROP_NETNS_SUPPORT,
 	PROP_USE_UDEV,
 	PROP_LOG_WITH_PTR,
+	PROP_IGNORE_ROUTE_TABLES,
+	PROP_IGNORE_ROUTE_PROTOCOLS,
 	LAST_PROP,
 };
 
@@ -100,6 +103,30 @@ typedef struct _NMPlatformPrivate {
 	GHashTable *ip4_dev_route_blacklist_hash;
 	NMDedupMultiIndex *multi_idx;
 	NMPCache *cache;
+
+	/* only set during construction. */
+	char *ignore_route_tables;
+	char *ignore_route_protocols;
+
+	NMPlatformIPRouteFilter *ip_route_filter;
+
+	/* the pending changes for NM_PLATFORM_SIGNAL_CHANGES_BATCH, in the order
+	 * in which they happened. Only collected while somebody is subscribed. */
+	GArray *changes_batch;
+	guint changes_batch_depth;
+	bool changes_batch_emitting:1;
+
+	/* SubscriptionHead by (obj_type, ifindex), for nm_platform_object_subscribe(). */
+	GHashTable *subscriptions;
+	guint subscriptions_dispatching;
+	bool subscriptions_has_dead:1;
+
+	/* LinkStatsPoller by refresh-rate, for nm_platform_link_stats_subscribe(). */
+	GHashTable *link_stats_pollers;
+
+	/* SysctlIfdirData by ifindex, for nm_platform_sysctl_ifdir_set(). */
+	GHashTable *sysctl_ifdirs;
+	NMPlatformSysctlStats sysctl_stats;
 } NMPlatformPrivate;
 
 G_DEFINE_TYPE (NMPlatform, nm_platform, G_TYPE_OBJECT)
@@ -124,6 +151,19 @@ nm_platform_get_log_with_ptr (NMPlatform *self)
 	return NM_PLATFORM_GET_PRIVATE (self)->log_with_ptr;
 }
 
+/**
+ * nm_platform_get_ip_route_filter:
+ * @self: the #NMPlatform instance
+ *
+ * Returns: the filter for routes that are to be ignored, or %NULL
+ *   if the platform does not ignore any routes.
+ */
+const NMPlatformIPRouteFilter *
+nm_platform_get_ip_route_filter (NMPlatform *self)
+{
+	return NM_PLATFORM_GET_PRIVATE (self)->ip_route_filter;
+}
+
 /*****************************************************************************/
 
 guint
@@ -131,6 +171,7 @@ _nm_platform_signal_id_get (NMPlatformSignalIdType signal_type)
 {
 	nm_assert (   signal_type > 0
 	           && signal_type != NM_PLATFORM_SIGNAL_ID_NONE
+	           && signal_type != NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH
 	           && signal_type < _NM_PLATFORM_SIGNAL_ID_LAST);
 
 	return signals[signal_type];
@@ -382,6 +423,8 @@ nm_platform_sysctl_open_netdir (NMPlatform *self, int ifindex, char *out_ifname)
 	return nmp_utils_sysctl_open_netdir (ifindex, ifname_guess, out_ifname);
 }
 
+static void _sysctl_ifdir_shadow_invalidate_path (NMPlatform *self, const char *path);
+
 /**
  * nm_platform_sysctl_set:
  * @self: platform instance
@@ -405,6 +448,9 @@ nm_platform_sysctl_set (NMPlatform *self, const char *pathid, int dirfd, const c
 	g_return_val_if_fail (path, FALSE);
 	g_return_val_if_fail (value, FALSE);
 
+	if (dirfd < 0)
+		_sysctl_ifdir_shadow_invalidate_path (self, path);
+
 	return klass->sysctl_set (self, pathid, dirfd, path, value);
 }
 
@@ -526,6 +572,481 @@ nm_platform_sysctl_get_int_checked (NMPlatform *self, const char *pathid, int di
 
 /*****************************************************************************/
 
+#define SYSCTL_IFDIR_FD_UNSET   (-1)
+#define SYSCTL_IFDIR_FD_FAILED  (-2)
+
+typedef struct {
+	int ifindex;
+	char ifname[IFNAMSIZ];
+	guint32 mtu;
+
+	/* the directory file descriptors, or one of SYSCTL_IFDIR_FD_UNSET
+	 * and SYSCTL_IFDIR_FD_FAILED. */
+	int dirfds[_NMP_SYSCTL_IFDIR_NUM];
+
+	/* the values that we last wrote (or read), by property name. */
+	GHashTable *shadow[_NMP_SYSCTL_IFDIR_NUM];
+} SysctlIfdirData;
+
+static const struct {
+	const char *path;
+	const char *pathid_prefix;
+} sysctl_ifdir_infos[_NMP_SYSCTL_IFDIR_NUM] = {
+	[NMP_SYSCTL_IFDIR_IP4_CONF] = { "/proc/sys/net/ipv4/conf", "ipv4:" },
+	[NMP_SYSCTL_IFDIR_IP6_CONF] = { "/proc/sys/net/ipv6/conf", "ipv6:" },
+	[NMP_SYSCTL_IFDIR_NET]      = { "/sys/class/net",          "net:"  },
+};
+
+static void
+_sysctl_ifdir_data_reset (SysctlIfdirData *data, NMPSysctlIfdir ifdir)
+{
+	/* forget the directory and the values in it, for example because it
+	 * was removed and possibly re-created by kernel. */
+	if (data->dirfds[ifdir] >= 0)
+		close (data->dirfds[ifdir]);
+	data->dirfds[ifdir] = SYSCTL_IFDIR_FD_UNSET;
+	if (data->shadow[ifdir])
+		g_hash_table_remove_all (data->shadow[ifdir]);
+}
+
+static void
+_sysctl_ifdir_data_free (gpointer ptr)
+{
+	SysctlIfdirData *data = ptr;
+	guint i;
+
+	for (i = 0; i < _NMP_SYSCTL_IFDIR_NUM; i++) {
+		if (data->dirfds[i] >= 0)
+			close (data->dirfds[i]);
+		if (data->shadow[i])
+			g_hash_table_unref (data->shadow[i]);
+	}
+	g_slice_free (SysctlIfdirData, data);
+}
+
+static SysctlIfdirData *
+_sysctl_ifdir_data_get (NMPlatform *self, int ifindex)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	SysctlIfdirData *data;
+	const NMPlatformLink *link;
+	guint i;
+
+	if (!priv->sysctl_ifdirs)
+		priv->sysctl_ifdirs = g_hash_table_new_full (g_int_hash, g_int_equal, NULL, _sysctl_ifdir_data_free);
+	else {
+		data = g_hash_table_lookup (priv->sysctl_ifdirs, &ifindex);
+		if (data)
+			return data;
+	}
+
+	/* the entry is dropped when the link gets removed or renamed. Hence,
+	 * only create it for links that are in the platform cache. */
+	link = nm_platform_link_get (self, ifindex);
+	if (!link)
+		return NULL;
+
+	data = g_slice_new0 (SysctlIfdirData);
+	data->ifindex = ifindex;
+	data->mtu = link->mtu;
+	g_strlcpy (data->ifname, link->name, sizeof (data->ifname));
+	for (i = 0; i < _NMP_SYSCTL_IFDIR_NUM; i++)
+		data->dirfds[i] = SYSCTL_IFDIR_FD_UNSET;
+	g_hash_table_add (priv->sysctl_ifdirs, data);
+	return data;
+}
+
+static int
+_sysctl_ifdir_data_get_dirfd (NMPlatform *self, SysctlIfdirData *data, NMPSysctlIfdir ifdir)
+{
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (self);
+	int fd;
+
+	if (data->dirfds[ifdir] != SYSCTL_IFDIR_FD_UNSET)
+		return data->dirfds[ifdir];
+
+	fd = klass->sysctl_ifdir_open
+	     ? klass->sysctl_ifdir_open (self, data->ifindex, data->ifname, ifdir)
+	     : -1;
+	if (fd < 0) {
+		/* fall back to the absolute path. */
+		data->dirfds[ifdir] = SYSCTL_IFDIR_FD_FAILED;
+		return -1;
+	}
+
+	NM_PLATFORM_GET_PRIVATE (self)->sysctl_stats.n_ifdir_opened++;
+	data->dirfds[ifdir] = fd;
+	return fd;
+}
+
+static void
+_sysctl_ifdir_notify_link (NMPlatform *self, NMPCacheOpsType cache_op, const NMPlatformLink *link)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	SysctlIfdirData *data;
+
+	data = g_hash_table_lookup (priv->sysctl_ifdirs, &link->ifindex);
+	if (!data)
+		return;
+
+	/* the directories under /proc/sys get re-created when the link is
+	 * renamed. Also, we cannot know what the values of the new link
+	 * are. */
+	if (   cache_op == NMP_CACHE_OPS_REMOVED
+	    || !nm_streq (data->ifname, link->name)) {
+		g_hash_table_remove (priv->sysctl_ifdirs, &link->ifindex);
+		return;
+	}
+
+	/* the kernel resets the IPv6 MTU when the MTU of the link changes.
+	 * Also, an MTU below the IPv6 minimum removes the IPv6 configuration
+	 * of the link altogether, and raising it again re-creates the directory
+	 * with default values. */
+	if (data->mtu != link->mtu) {
+		guint i;
+
+		data->mtu = link->mtu;
+		for (i = 0; i < _NMP_SYSCTL_IFDIR_NUM; i++) {
+			if (i == NMP_SYSCTL_IFDIR_IP6_CONF)
+				_sysctl_ifdir_data_reset (data, i);
+			else if (data->shadow[i])
+				g_hash_table_remove (data->shadow[i], "mtu");
+		}
+	}
+}
+
+static void
+_sysctl_ifdir_shadow_invalidate_path (NMPlatform *self, const char *path)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	GHashTableIter iter;
+	SysctlIfdirData *data;
+	const char *ifname;
+	const char *property;
+	gsize ifname_len;
+	guint i;
+
+	if (   !priv->sysctl_ifdirs
+	    || g_hash_table_size (priv->sysctl_ifdirs) == 0)
+		return;
+
+	for (i = 0; i < _NMP_SYSCTL_IFDIR_NUM; i++) {
+		ifname = g_str_has_prefix (path, sysctl_ifdir_infos[i].path)
+		         ? &path[strlen (sysctl_ifdir_infos[i].path)]
+		         : NULL;
+		if (ifname && ifname[0] == '/')
+			break;
+	}
+	if (i == _NMP_SYSCTL_IFDIR_NUM)
+		return;
+
+	ifname++;
+	property = strchr (ifname, '/');
+	if (!property)
+		return;
+	ifname_len = property - ifname;
+	property++;
+
+	/* somebody writes a per-interface value without going through
+	 * nm_platform_sysctl_ifdir_set(). Forget what we know about it. */
+	g_hash_table_iter_init (&iter, priv->sysctl_ifdirs);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &data, NULL)) {
+		if (   data->shadow[i]
+		    && strncmp (data->ifname, ifname, ifname_len) == 0
+		    && data->ifname[ifname_len] == '\0')
+			g_hash_table_remove (data->shadow[i], property);
+	}
+}
+
+static gboolean
+_sysctl_ifdir_set (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property, const char *value)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (self);
+	SysctlIfdirData *data;
+	const char *value_old;
+	gboolean success;
+	gboolean retried = FALSE;
+	int dirfd;
+	int errsv;
+
+	data = _sysctl_ifdir_data_get (self, ifindex);
+	if (!data) {
+		errno = ENODEV;
+		return FALSE;
+	}
+
+	priv->sysctl_stats.n_ifdir_set++;
+
+	if (data->shadow[ifdir]) {
+		value_old = g_hash_table_lookup (data->shadow[ifdir], property);
+		if (nm_streq0 (value_old, value)) {
+			priv->sysctl_stats.n_ifdir_set_skipped++;
+			return TRUE;
+		}
+	}
+
+again:
+	dirfd = _sysctl_ifdir_data_get_dirfd (self, data, ifdir);
+	if (dirfd >= 0) {
+		success = klass->sysctl_set (self,
+		                             nm_sprintf_bufa (256, "%s%s/%s/%s",
+		                                              sysctl_ifdir_infos[ifdir].pathid_prefix,
+		                                              sysctl_ifdir_infos[ifdir].path,
+		                                              data->ifname,
+		                                              property),
+		                             dirfd,
+		                             property,
+		                             value);
+	} else {
+		success = klass->sysctl_set (self,
+		                             NMP_SYSCTL_PATHID_ABSOLUTE (nm_sprintf_bufa (256, "%s/%s/%s",
+		                                                                          sysctl_ifdir_infos[ifdir].path,
+		                                                                          data->ifname,
+		                                                                          property)),
+		                             value);
+	}
+	errsv = errno;
+
+	if (   !success
+	    && NM_IN_SET (errsv, ENOENT, ENODEV)) {
+		/* the directory is gone. If we had it open, it might have been
+		 * re-created meanwhile. Retry once with a new one. */
+		_sysctl_ifdir_data_reset (data, ifdir);
+		if (dirfd >= 0 && !retried) {
+			retried = TRUE;
+			goto again;
+		}
+	}
+
+	if (success) {
+		if (!data->shadow[ifdir])
+			data->shadow[ifdir] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_insert (data->shadow[ifdir], g_strdup (property), g_strdup (value));
+	} else if (data->shadow[ifdir])
+		g_hash_table_remove (data->shadow[ifdir], property);
+
+	errno = errsv;
+	return success;
+}
+
+/**
+ * nm_platform_sysctl_ifdir_set:
+ * @self: platform instance
+ * @ifindex: the interface index
+ * @ifdir: the per-interface directory
+ * @property: the name of the value in the directory
+ * @value: the value to write
+ *
+ * Like nm_platform_sysctl_set(), for a value in a per-interface directory.
+ * The directory is opened once and kept open until the link gets
+ * renamed or removed, or until it turns out to be gone.
+ *
+ * The platform remembers the values it wrote. Writing the same value again
+ * is skipped, for as long as nobody else writes it with nm_platform_sysctl_set().
+ * Changes by other processes are not noticed, until the remembered values
+ * are dropped with nm_platform_sysctl_ifdir_invalidate().
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_sysctl_ifdir_set (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property, const char *value)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (ifdir >= 0 && ifdir < _NMP_SYSCTL_IFDIR_NUM, FALSE);
+	g_return_val_if_fail (property && property[0] != '/', FALSE);
+	g_return_val_if_fail (value, FALSE);
+
+	return _sysctl_ifdir_set (self, ifindex, ifdir, property, value);
+}
+
+/**
+ * nm_platform_sysctl_ifdir_set_batch:
+ * @self: platform instance
+ * @ifindex: the interface index
+ * @ifdir: the per-interface directory
+ * @entries: the properties and values to set, in order
+ * @n_entries: the number of @entries
+ *
+ * Applies several values with nm_platform_sysctl_ifdir_set(). All entries
+ * are tried, even if setting one of them fails.
+ *
+ * Returns: %TRUE if all values were set.
+ */
+gboolean
+nm_platform_sysctl_ifdir_set_batch (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const NMPlatformSysctlEntry *entries, guint n_entries)
+{
+	gboolean success = TRUE;
+	guint i;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	g_return_val_if_fail (ifindex > 0, FALSE);
+	g_return_val_if_fail (ifdir >= 0 && ifdir < _NMP_SYSCTL_IFDIR_NUM, FALSE);
+	g_return_val_if_fail (entries || n_entries == 0, FALSE);
+
+	for (i = 0; i < n_entries; i++) {
+		g_return_val_if_fail (entries[i].property && entries[i].property[0] != '/', FALSE);
+		g_return_val_if_fail (entries[i].value, FALSE);
+
+		if (!_sysctl_ifdir_set (self, ifindex, ifdir, entries[i].property, entries[i].value))
+			success = FALSE;
+	}
+	return success;
+}
+
+/**
+ * nm_platform_sysctl_ifdir_get:
+ * @self: platform instance
+ * @ifindex: the interface index
+ * @ifdir: the per-interface directory
+ * @property: the name of the value in the directory
+ *
+ * Like nm_platform_sysctl_get(), for a value in a per-interface directory.
+ * The read value also updates what nm_platform_sysctl_ifdir_set() assumes
+ * to be set.
+ *
+ * Returns: (transfer full): the value or %NULL.
+ */
+char *
+nm_platform_sysctl_ifdir_get (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property)
+{
+	SysctlIfdirData *data;
+	char *value;
+	gboolean retried = FALSE;
+	int dirfd;
+	int errsv;
+
+	_CHECK_SELF (self, klass, NULL);
+
+	g_return_val_if_fail (ifindex > 0, NULL);
+	g_return_val_if_fail (ifdir >= 0 && ifdir < _NMP_SYSCTL_IFDIR_NUM, NULL);
+	g_return_val_if_fail (property && property[0] != '/', NULL);
+
+	data = _sysctl_ifdir_data_get (self, ifindex);
+	if (!data) {
+		errno = ENODEV;
+		return NULL;
+	}
+
+again:
+	dirfd = _sysctl_ifdir_data_get_dirfd (self, data, ifdir);
+	if (dirfd >= 0) {
+		value = klass->sysctl_get (self,
+		                           nm_sprintf_bufa (256, "%s%s/%s/%s",
+		                                            sysctl_ifdir_infos[ifdir].pathid_prefix,
+		                                            sysctl_ifdir_infos[ifdir].path,
+		                                            data->ifname,
+		                                            property),
+		                           dirfd,
+		                           property);
+	} else {
+		value = klass->sysctl_get (self,
+		                           NMP_SYSCTL_PATHID_ABSOLUTE (nm_sprintf_bufa (256, "%s/%s/%s",
+		                                                                        sysctl_ifdir_infos[ifdir].path,
+		                                                                        data->ifname,
+		                                                                        property)));
+	}
+	errsv = errno;
+
+	if (   !value
+	    && NM_IN_SET (errsv, ENOENT, ENODEV)) {
+		_sysctl_ifdir_data_reset (data, ifdir);
+		if (dirfd >= 0 && !retried) {
+			retried = TRUE;
+			goto again;
+		}
+	}
+
+	if (value) {
+		if (!data->shadow[ifdir])
+			data->shadow[ifdir] = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+		g_hash_table_insert (data->shadow[ifdir], g_strdup (property), g_strdup (value));
+	} else if (data->shadow[ifdir])
+		g_hash_table_remove (data->shadow[ifdir], property);
+
+	errno = errsv;
+	return value;
+}
+
+/**
+ * nm_platform_sysctl_ifdir_invalidate:
+ * @self: platform instance
+ * @ifindex: the interface index
+ *
+ * Forget the values that nm_platform_sysctl_ifdir_set() remembers for
+ * @ifindex, so that the next call writes them for sure. This restores
+ * values that somebody else changed meanwhile. The directories are
+ * kept open.
+ */
+void
+nm_platform_sysctl_ifdir_invalidate (NMPlatform *self, int ifindex)
+{
+	NMPlatformPrivate *priv;
+	SysctlIfdirData *data;
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (ifindex > 0);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+	if (!priv->sysctl_ifdirs)
+		return;
+
+	data = g_hash_table_lookup (priv->sysctl_ifdirs, &ifindex);
+	if (!data)
+		return;
+
+	for (i = 0; i < _NMP_SYSCTL_IFDIR_NUM; i++) {
+		if (data->shadow[i])
+			g_hash_table_remove_all (data->shadow[i]);
+	}
+}
+
+gint64
+nm_platform_sysctl_ifdir_get_int_checked (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property, guint base, gint64 min, gint64 max, gint64 fallback)
+{
+	gs_free char *value = NULL;
+
+	value = nm_platform_sysctl_ifdir_get (self, ifindex, ifdir, property);
+	if (!value) {
+		errno = EINVAL;
+		return fallback;
+	}
+
+	return _nm_utils_ascii_str_to_int64 (value, base, min, max, fallback);
+}
+
+/**
+ * nm_platform_sysctl_get_stats:
+ * @self: platform instance
+ * @out_stats: (out): the counters
+ *
+ * Returns counters about reading and writing sysctl values.
+ */
+void
+nm_platform_sysctl_get_stats (NMPlatform *self, NMPlatformSysctlStats *out_stats)
+{
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (out_stats);
+
+	*out_stats = NM_PLATFORM_GET_PRIVATE (self)->sysctl_stats;
+}
+
+NMPlatformSysctlStats *
+_nm_platform_sysctl_stats (NMPlatform *self)
+{
+	nm_assert (NM_IS_PLATFORM (self));
+
+	return &NM_PLATFORM_GET_PRIVATE (self)->sysctl_stats;
+}
+
+/*****************************************************************************/
+
 static int
 _link_get_all_presort (gconstpointer  p_a,
                        gconstpointer  p_b,
@@ -1131,41 +1652,195 @@ nm_platform_link_refresh (NMPlatform *self, int ifindex)
 	return TRUE;
 }
 
-static guint
-_link_get_flags (NMPlatform *self, int ifindex)
+typedef struct {
+	NMPlatform *self;
+	guint refresh_rate_ms;
+	guint timeout_id;
+
+	/* ifindex to the number of subscriptions. */
+	GHashTable *ifindexes;
+} LinkStatsPoller;
+
+static void
+_link_stats_poller_free (gpointer ptr)
 {
-	const NMPlatformLink *pllink;
+	LinkStatsPoller *poller = ptr;
 
-	pllink = nm_platform_link_get (self, ifindex);
-	return pllink ? pllink->n_ifi_flags : IFF_NOARP;
+	nm_clear_g_source (&poller->timeout_id);
+	g_hash_table_unref (poller->ifindexes);
+	g_slice_free (LinkStatsPoller, poller);
 }
 
-/**
- * nm_platform_link_is_up:
- * @self: platform instance
- * @ifindex: Interface index
- *
- * Check if the interface is up.
- */
-gboolean
-nm_platform_link_is_up (NMPlatform *self, int ifindex)
+/* compares two ifindexes of the sorted array that link_stats_refresh()
+ * gets, for qsort() and bsearch(). */
+int
+_nm_platform_link_stats_ifindex_cmp (gconstpointer a, gconstpointer b)
 {
-	_CHECK_SELF (self, klass, FALSE);
+	int ifindex_a = *((const int *) a);
+	int ifindex_b = *((const int *) b);
 
-	return NM_FLAGS_HAS (_link_get_flags (self, ifindex), IFF_UP);
+	return ifindex_a < ifindex_b ? -1 : (ifindex_a > ifindex_b ? 1 : 0);
+}
+
+static gboolean
+_link_stats_poller_timeout_cb (gpointer user_data)
+{
+	LinkStatsPoller *poller = user_data;
+	NMPlatform *self = poller->self;
+	NMPlatformClass *klass = NM_PLATFORM_GET_CLASS (self);
+	gs_free int *ifindexes = NULL;
+	GHashTableIter iter;
+	gpointer ifindex_p;
+	guint n_ifindexes;
+	guint i;
+
+	n_ifindexes = g_hash_table_size (poller->ifindexes);
+	nm_assert (n_ifindexes > 0);
+
+	ifindexes = g_new (int, n_ifindexes);
+	i = 0;
+	g_hash_table_iter_init (&iter, poller->ifindexes);
+	while (g_hash_table_iter_next (&iter, &ifindex_p, NULL))
+		ifindexes[i++] = GPOINTER_TO_INT (ifindex_p);
+	qsort (ifindexes, n_ifindexes, sizeof (int), _nm_platform_link_stats_ifindex_cmp);
+
+	_LOGT ("link: stats: refresh %u links (every %u ms)", n_ifindexes, poller->refresh_rate_ms);
+
+	/* the poller might be destroyed while refreshing, don't touch it
+	 * afterwards. */
+	if (klass->link_stats_refresh)
+		klass->link_stats_refresh (self, ifindexes, n_ifindexes);
+	else {
+		for (i = 0; i < n_ifindexes; i++)
+			nm_platform_link_refresh (self, ifindexes[i]);
+	}
+
+	return G_SOURCE_CONTINUE;
 }
 
 /**
- * nm_platform_link_is_connected:
+ * nm_platform_link_stats_subscribe:
  * @self: platform instance
  * @ifindex: Interface index
+ * @refresh_rate_ms: the refresh interval in milliseconds
  *
- * Check if the interface is connected.
+ * Refresh the statistics counters of the link periodically, until
+ * the subscription is removed with nm_platform_link_stats_unsubscribe().
+ * Links that are subscribed with the same @refresh_rate_ms get refreshed
+ * together, with one request for all links if the platform supports it.
+ * Subscriptions are counted, subscribing the same link twice requires
+ * two unsubscribes.
+ *
+ * The link objects in the cache are only updated, if the counters
+ * actually changed.
  */
-gboolean
-nm_platform_link_is_connected (NMPlatform *self, int ifindex)
+void
+nm_platform_link_stats_subscribe (NMPlatform *self, int ifindex, guint refresh_rate_ms)
 {
-	const NMPlatformLink *pllink;
+	NMPlatformPrivate *priv;
+	LinkStatsPoller *poller;
+	guint n;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	g_return_if_fail (ifindex > 0);
+	g_return_if_fail (refresh_rate_ms > 0);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (!priv->link_stats_pollers) {
+		priv->link_stats_pollers = g_hash_table_new_full (g_direct_hash,
+		                                                  g_direct_equal,
+		                                                  NULL,
+		                                                  _link_stats_poller_free);
+	}
+
+	poller = g_hash_table_lookup (priv->link_stats_pollers, GUINT_TO_POINTER (refresh_rate_ms));
+	if (!poller) {
+		poller = g_slice_new (LinkStatsPoller);
+		poller->self = self;
+		poller->refresh_rate_ms = refresh_rate_ms;
+		poller->ifindexes = g_hash_table_new (g_direct_hash, g_direct_equal);
+		poller->timeout_id = g_timeout_add (refresh_rate_ms, _link_stats_poller_timeout_cb, poller);
+		g_hash_table_insert (priv->link_stats_pollers, GUINT_TO_POINTER (refresh_rate_ms), poller);
+	}
+
+	n = GPOINTER_TO_UINT (g_hash_table_lookup (poller->ifindexes, GINT_TO_POINTER (ifindex)));
+	g_hash_table_insert (poller->ifindexes, GINT_TO_POINTER (ifindex), GUINT_TO_POINTER (n + 1));
+}
+
+/**
+ * nm_platform_link_stats_unsubscribe:
+ * @self: platform instance
+ * @ifindex: Interface index
+ * @refresh_rate_ms: the refresh interval in milliseconds
+ *
+ * Drops one subscription that was added with nm_platform_link_stats_subscribe().
+ */
+void
+nm_platform_link_stats_unsubscribe (NMPlatform *self, int ifindex, guint refresh_rate_ms)
+{
+	NMPlatformPrivate *priv;
+	LinkStatsPoller *poller = NULL;
+	guint n;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (priv->link_stats_pollers)
+		poller = g_hash_table_lookup (priv->link_stats_pollers, GUINT_TO_POINTER (refresh_rate_ms));
+
+	n = poller
+	    ? GPOINTER_TO_UINT (g_hash_table_lookup (poller->ifindexes, GINT_TO_POINTER (ifindex)))
+	    : 0;
+	g_return_if_fail (n > 0);
+
+	if (n > 1) {
+		g_hash_table_insert (poller->ifindexes, GINT_TO_POINTER (ifindex), GUINT_TO_POINTER (n - 1));
+		return;
+	}
+
+	g_hash_table_remove (poller->ifindexes, GINT_TO_POINTER (ifindex));
+	if (g_hash_table_size (poller->ifindexes) == 0)
+		g_hash_table_remove (priv->link_stats_pollers, GUINT_TO_POINTER (refresh_rate_ms));
+}
+
+static guint
+_link_get_flags (NMPlatform *self, int ifindex)
+{
+	const NMPlatformLink *pllink;
+
+	pllink = nm_platform_link_get (self, ifindex);
+	return pllink ? pllink->n_ifi_flags : IFF_NOARP;
+}
+
+/**
+ * nm_platform_link_is_up:
+ * @self: platform instance
+ * @ifindex: Interface index
+ *
+ * Check if the interface is up.
+ */
+gboolean
+nm_platform_link_is_up (NMPlatform *self, int ifindex)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	return NM_FLAGS_HAS (_link_get_flags (self, ifindex), IFF_UP);
+}
+
+/**
+ * nm_platform_link_is_connected:
+ * @self: platform instance
+ * @ifindex: Interface index
+ *
+ * Check if the interface is connected.
+ */
+gboolean
+nm_platform_link_is_connected (NMPlatform *self, int ifindex)
+{
+	const NMPlatformLink *pllink;
 
 	_CHECK_SELF (self, klass, FALSE);
 
@@ -2898,6 +3573,35 @@ nm_platform_lookup (NMPlatform *self,
 	                         lookup);
 }
 
+/**
+ * nm_platform_get_cache_generation:
+ * @self: the #NMPlatform instance
+ *
+ * Returns: a counter that changes whenever the platform cache changes.
+ *   The lists returned by nm_platform_lookup() can be iterated without
+ *   copying them, as long as the generation stays the same.
+ */
+guint64
+nm_platform_get_cache_generation (NMPlatform *self)
+{
+	return nmp_cache_get_generation (nm_platform_get_cache (self));
+}
+
+/**
+ * nm_platform_get_addrroute_generation:
+ * @self: the #NMPlatform instance
+ * @ifindex: the interface
+ *
+ * Returns: a counter that changes whenever an address or route of
+ *   @ifindex changes in the platform cache, be it by ourself or by
+ *   somebody else.
+ */
+guint64
+nm_platform_get_addrroute_generation (NMPlatform *self, int ifindex)
+{
+	return nmp_cache_get_addrroute_generation (nm_platform_get_cache (self), ifindex);
+}
+
 gboolean
 nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel (const NMPObject *obj,
                                                              gpointer user_data)
@@ -3269,6 +3973,36 @@ ip4_addr_subnets_is_secondary (const NMPObject *address,
 	return FALSE;
 }
 
+static void
+_ip_batch_op_clear (gpointer data)
+{
+	nmp_object_unref (((NMPlatformIPBatchOp *) data)->obj);
+}
+
+static NMPlatformIPBatchOp *
+_ip_batch_ops_append (GArray **p_ops,
+                      guint reserved_size,
+                      const NMPObject *obj,
+                      gboolean is_delete,
+                      NMPNlmFlags flags)
+{
+	NMPlatformIPBatchOp *op;
+
+	if (!*p_ops) {
+		*p_ops = g_array_sized_new (FALSE, FALSE, sizeof (NMPlatformIPBatchOp), reserved_size);
+		g_array_set_clear_func (*p_ops, _ip_batch_op_clear);
+	}
+
+	g_array_set_size (*p_ops, (*p_ops)->len + 1);
+	op = &g_array_index (*p_ops, NMPlatformIPBatchOp, (*p_ops)->len - 1);
+	*op = (NMPlatformIPBatchOp) {
+		.obj = nmp_object_ref (obj),
+		.flags = flags,
+		.is_delete = is_delete,
+	};
+	return op;
+}
+
 /**
  * nm_platform_ip4_address_sync:
  * @self: platform instance
@@ -3299,7 +4033,9 @@ nm_platform_ip4_address_sync (NMPlatform *self,
 	GHashTable *plat_subnets = NULL;
 	GHashTable *known_subnets = NULL;
 	gs_unref_hashtable GHashTable *known_addresses_idx = NULL;
+	gs_unref_array GArray *ops = NULL;
 	guint i, j, len;
+	guint n_deletes;
 	NMPLookup lookup;
 	guint32 lifetime, preferred;
 	guint32 ifa_flags;
@@ -3382,10 +4118,7 @@ delete_and_next:
 			}
 		}
 
-		nm_platform_ip4_address_delete (self, ifindex,
-		                                plat_address->address,
-		                                plat_address->plen,
-		                                plat_address->peer_address);
+		_ip_batch_ops_append (&ops, len, plat_obj, TRUE, 0);
 
 		if (   !ip4_addr_subnets_is_secondary (plat_obj, plat_subnets, plat_addresses, &addr_list)
 		    && addr_list) {
@@ -3402,13 +4135,7 @@ delete_and_next:
 				nm_assert (o);
 
 				if (*o) {
-					const NMPlatformIP4Address *a;
-
-					a = NMP_OBJECT_CAST_IP4_ADDRESS (*o);
-					nm_platform_ip4_address_delete (self, ifindex,
-					                                a->address,
-					                                a->plen,
-					                                a->peer_address);
+					_ip_batch_ops_append (&ops, len, *o, TRUE, 0);
 					nmp_object_unref (*o);
 					*o = NULL;
 				}
@@ -3418,16 +4145,22 @@ delete_and_next:
 	ip4_addr_subnets_destroy_index (plat_subnets, plat_addresses);
 	ip4_addr_subnets_destroy_index (known_subnets, known_addresses);
 
-	if (!known_addresses)
+	if (!known_addresses) {
+		if (ops)
+			nm_platform_ip_batch (self, (NMPlatformIPBatchOp *) ops->data, ops->len);
 		return TRUE;
+	}
 
 	ifa_flags =   nm_platform_check_support_kernel_extended_ifa_flags (self)
 	            ? IFA_F_NOPREFIXROUTE
 	            : 0;
 
-	/* Add missing addresses */
+	/* Add missing addresses. The additions are sent in the same batch right
+	 * after the deletions, kernel handles them in order. */
+	n_deletes = ops ? ops->len : 0;
 	for (i = 0; i < known_addresses->len; i++) {
 		const NMPObject *o;
+		NMPlatformIPBatchOp *op;
 
 		o = known_addresses->pdata[i];
 		if (!o)
@@ -3436,19 +4169,39 @@ delete_and_next:
 		known_address = NMP_OBJECT_CAST_IP4_ADDRESS (o);
 
 		if (!nm_utils_lifetime_get (known_address->timestamp, known_address->lifetime, known_address->preferred,
-		                            now, &lifetime, &preferred))
-			goto delete_and_next2;
-
-		if (!nm_platform_ip4_address_add (self, ifindex, known_address->address, known_address->plen,
-		                                  known_address->peer_address, lifetime, preferred,
-		                                  ifa_flags,
-		                                  known_address->label))
-			goto delete_and_next2;
-
-		continue;
-delete_and_next2:
-		nmp_object_unref (o);
-		known_addresses->pdata[i] = NULL;
+		                            now, &lifetime, &preferred)) {
+			nmp_object_unref (o);
+			known_addresses->pdata[i] = NULL;
+			continue;
+		}
+
+		op = _ip_batch_ops_append (&ops, n_deletes + known_addresses->len, o, FALSE, 0);
+		op->lifetime = lifetime;
+		op->preferred = preferred;
+		op->ifa_flags = ifa_flags;
+	}
+
+	if (!ops)
+		return TRUE;
+
+	nm_platform_ip_batch (self, (NMPlatformIPBatchOp *) ops->data, ops->len);
+
+	/* drop the addresses that we failed to add. */
+	j = n_deletes;
+	for (i = 0; i < known_addresses->len; i++) {
+		const NMPObject *o;
+
+		o = known_addresses->pdata[i];
+		if (!o)
+			continue;
+
+		nm_assert (j < ops->len);
+		nm_assert (g_array_index (ops, NMPlatformIPBatchOp, j).obj == o);
+
+		if (g_array_index (ops, NMPlatformIPBatchOp, j++).result != NM_PLATFORM_ERROR_SUCCESS) {
+			nmp_object_unref (o);
+			known_addresses->pdata[i] = NULL;
+		}
 	}
 
 	return TRUE;
@@ -3475,10 +4228,12 @@ nm_platform_ip6_address_sync (NMPlatform *self,
                               gboolean keep_link_local)
 {
 	gs_unref_ptrarray GPtrArray *plat_addresses = NULL;
+	gs_unref_array GArray *ops = NULL;
 	NMPlatformIP6Address *address;
 	gint32 now = nm_utils_get_monotonic_timestamp_s ();
 	guint i;
 	NMPLookup lookup;
+	gboolean success = TRUE;
 
 	/* Delete unknown addresses */
 	plat_addresses = nm_platform_lookup_clone (self,
@@ -3495,16 +4250,19 @@ nm_platform_ip6_address_sync (NMPlatform *self,
 				continue;
 
 			if (!array_contains_ip6_address (known_addresses, address, now))
-				nm_platform_ip6_address_delete (self, ifindex, address->address, address->plen);
+				_ip_batch_ops_append (&ops, plat_addresses->len, plat_addresses->pdata[i], TRUE, 0);
 		}
 	}
 
 	if (!known_addresses)
-		return TRUE;
+		goto out;
 
-	/* Add missing addresses */
+	/* Add missing addresses. Kernel prefers the addresses added last, hence
+	 * the order of @known_addresses matters. The requests of a batch are
+	 * processed by kernel in the order we send them, so this is preserved. */
 	for (i = 0; i < known_addresses->len; i++) {
 		const NMPlatformIP6Address *known_address = NMP_OBJECT_CAST_IP6_ADDRESS (known_addresses->pdata[i]);
+		NMPlatformIPBatchOp *op;
 		guint32 lifetime, preferred;
 
 		if (NM_FLAGS_HAS (known_address->n_ifa_flags, IFA_F_TEMPORARY)) {
@@ -3516,13 +4274,26 @@ nm_platform_ip6_address_sync (NMPlatform *self,
 		                            now, &lifetime, &preferred))
 			continue;
 
-		if (!nm_platform_ip6_address_add (self, ifindex, known_address->address,
-		                                  known_address->plen, known_address->peer_address,
-		                                  lifetime, preferred, known_address->n_ifa_flags))
-			return FALSE;
+		op = _ip_batch_ops_append (&ops, known_addresses->len, known_addresses->pdata[i], FALSE, 0);
+		op->lifetime = lifetime;
+		op->preferred = preferred;
+		op->ifa_flags = known_address->n_ifa_flags;
 	}
 
-	return TRUE;
+out:
+	if (!ops)
+		return TRUE;
+
+	nm_platform_ip_batch (self, (NMPlatformIPBatchOp *) ops->data, ops->len);
+
+	for (i = 0; i < ops->len; i++) {
+		const NMPlatformIPBatchOp *op = &g_array_index (ops, NMPlatformIPBatchOp, i);
+
+		if (   !op->is_delete
+		    && op->result != NM_PLATFORM_ERROR_SUCCESS)
+			success = FALSE;
+	}
+	return success;
 }
 
 gboolean
@@ -3547,6 +4318,149 @@ nm_platform_ip_address_flush (NMPlatform *self,
 
 /*****************************************************************************/
 
+static gboolean
+_ip_route_may_delete (NMPlatform *self,
+                      const NMPObject *plat_o,
+                      NMPObjectPredicateFunc kernel_delete_predicate,
+                      gpointer kernel_delete_userdata)
+{
+	if (   kernel_delete_predicate
+	    && !kernel_delete_predicate (plat_o, kernel_delete_userdata))
+		return FALSE;
+
+	if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (NMP_OBJECT_CAST_IP_ROUTE (plat_o))) {
+		/* don't delete default routes. */
+		return FALSE;
+	}
+
+	if (nm_platform_ip_route_is_ignored (self, NMP_OBJECT_CAST_IP_ROUTE (plat_o))) {
+		/* ignored routes are not ours to manage. */
+		return FALSE;
+	}
+
+	return TRUE;
+}
+
+/* add the routes of @routes that are not yet in platform. Device routes
+ * are added before gateway routes. */
+static gboolean
+_ip_route_add_missing (NMPlatform *self,
+                       const NMPlatformVTableRoute *vt,
+                       GPtrArray *routes)
+{
+	const NMPObject *conf_o;
+	const NMDedupMultiEntry *plat_entry;
+	guint i;
+	int i_type;
+	gboolean success = TRUE;
+	char sbuf1[sizeof (_nm_utils_to_string_buffer)];
+	char sbuf2[sizeof (_nm_utils_to_string_buffer)];
+	char sbuf_err[60];
+	gs_unref_array GArray *ops = NULL;
+
+	for (i_type = 0; i_type < 2; i_type++) {
+		for (i = 0; i < routes->len; i++) {
+			conf_o = routes->pdata[i];
+
+#define VTABLE_IS_DEVICE_ROUTE(vt, o) (vt->is_ip4 \
+                                         ? (NMP_OBJECT_CAST_IP4_ROUTE (o)->gateway == 0) \
+                                         : IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (o)->gateway) )
+
+			if (   (i_type == 0 && !VTABLE_IS_DEVICE_ROUTE (vt, conf_o))
+			    || (i_type == 1 &&  VTABLE_IS_DEVICE_ROUTE (vt, conf_o))) {
+				/* we add routes in two runs over @i_type.
+				 *
+				 * First device routes, then gateway routes. */
+				continue;
+			}
+
+			plat_entry = nm_platform_lookup_entry (self,
+			                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+			                                       conf_o);
+			if (plat_entry) {
+				/* we alreay have a route with the same ID in the platform cache.
+				 * Skip adding it again. It should be identical already, otherwise we
+				 * would have deleted above. */
+				if (_LOGD_ENABLED ()) {
+					if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+					                   NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
+					                   NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
+						_LOGD ("route-sync: skip adding route %s due to existing (different!) route %s",
+						       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+						       nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
+					}
+				}
+				continue;
+			}
+
+			_ip_batch_ops_append (&ops, routes->len, conf_o, FALSE,
+			                        NMP_NLM_FLAG_APPEND
+			                      | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE);
+		}
+	}
+
+	if (!ops || ops->len == 0)
+		return success;
+
+	/* Add all routes in one batch, device routes first. Kernel still handles the
+	 * requests in order, so gateway routes find their device routes already
+	 * configured. */
+	nm_platform_ip_batch (self, (NMPlatformIPBatchOp *) ops->data, ops->len);
+
+	for (i = 0; i < ops->len; i++) {
+		const NMPlatformIPBatchOp *op = &g_array_index (ops, NMPlatformIPBatchOp, i);
+		NMPlatformError plerr = op->result;
+
+		if (plerr == NM_PLATFORM_ERROR_SUCCESS)
+			continue;
+
+		conf_o = op->obj;
+
+		if (-((int) plerr) == EEXIST) {
+			/* Don't fail for EEXIST. It's not clear that the existing route
+			 * is identical to the one that we were about to add. However,
+			 * above we should have deleted conflicting (non-identical) routes. */
+			if (_LOGD_ENABLED ()) {
+				plat_entry = nm_platform_lookup_entry (self,
+				                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+				                                       conf_o);
+				if (!plat_entry) {
+					_LOGD ("route-sync: adding route %s failed with EEXIST, however we cannot find such a route",
+					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)));
+				} else if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+				                          NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
+				                          NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
+					_LOGD ("route-sync: adding route %s failed due to existing (different!) route %s",
+					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+					       nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
+				}
+			}
+		} else if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
+			_LOGD ("route-sync: ignore failure to add IPv%c route: %s: %s",
+			       vt->is_ip4 ? '4' : '6',
+			       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+			       nm_platform_error_to_string (plerr, sbuf_err, sizeof (sbuf_err)));
+		} else {
+			const char *reason = "";
+
+			if (   -((int) plerr) == ENETUNREACH
+			    && (  vt->is_ip4
+			        ? !!NMP_OBJECT_CAST_IP4_ROUTE (conf_o)->gateway
+			        : !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (conf_o)->gateway)))
+				reason = "; is the gateway directly reachable?";
+
+			_LOGW ("route-sync: failure to add IPv%c route: %s: %s%s",
+			       vt->is_ip4 ? '4' : '6',
+			       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
+			       nm_platform_error_to_string (plerr, sbuf_err, sizeof (sbuf_err)),
+			       reason);
+			success = FALSE;
+		}
+	}
+
+	return success;
+}
+
 /**
  * nm_platform_ip_route_sync:
  * @self: the #NMPlatform instance.
@@ -3554,6 +4468,11 @@ nm_platform_ip_address_flush (NMPlatform *self,
  * @ifindex: the @ifindex for which the routes are to be added.
  * @routes: (allow-none): a list of routes to configure. Must contain
  *   NMPObject instances of routes, according to @addr_family.
+ * @routes_keep_predicate: (allow-none): if not %NULL, it is called for
+ *   each route in platform and returns whether the route is identical
+ *   (semantically) to one of @routes. This lets the caller answer from
+ *   its own index. Otherwise, a temporary index of @routes is created.
+ * @routes_keep_userdata: user data for @routes_keep_predicate.
  * @kernel_delete_predicate: (allow-none): if not %NULL, previously
  *   existing routes already configured will only be deleted if the
  *   predicate returns TRUE. This allows to preserve/ignore some
@@ -3568,21 +4487,20 @@ nm_platform_ip_route_sync (NMPlatform *self,
                            int addr_family,
                            int ifindex,
                            GPtrArray *routes,
+                           NMPObjectPredicateFunc routes_keep_predicate,
+                           gpointer routes_keep_userdata,
                            NMPObjectPredicateFunc kernel_delete_predicate,
                            gpointer kernel_delete_userdata)
 {
 	const NMPlatformVTableRoute *vt;
-	gs_unref_ptrarray GPtrArray *plat_routes = NULL;
+	const NMDedupMultiHeadEntry *plat_head;
 	gs_unref_hashtable GHashTable *routes_idx = NULL;
+	NMPCacheLiveIter iter;
 	const NMPObject *plat_o;
 	const NMPObject *conf_o;
-	const NMDedupMultiEntry *plat_entry;
 	guint i;
-	int i_type;
 	gboolean success = TRUE;
-	char sbuf1[sizeof (_nm_utils_to_string_buffer)];
-	char sbuf2[sizeof (_nm_utils_to_string_buffer)];
-	char sbuf_err[60];
+	gs_unref_array GArray *ops = NULL;
 
 	nm_assert (NM_IS_PLATFORM (self));
 	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
@@ -3592,16 +4510,20 @@ nm_platform_ip_route_sync (NMPlatform *self,
 	     ? &nm_platform_vtable_route_v4
 	     : &nm_platform_vtable_route_v6;
 
-	plat_routes = nm_platform_lookup_addrroute_clone (self,
-	                                                  vt->obj_type,
-	                                                  ifindex,
-	                                                  kernel_delete_predicate,
-	                                                  kernel_delete_userdata);
-	/* first delete routes which are in platform (@plat_routes), but not to configure (@routes/@routes_idx). */
-	if (plat_routes) {
+	plat_head = nm_platform_lookup_addrroute (self,
+	                                          vt->obj_type,
+	                                          ifindex);
+
+	/* first delete routes which are in platform (@plat_head), but not to configure (@routes/@routes_idx).
+	 *
+	 * The list of the cache is iterated directly. That is fine, because the deletions
+	 * are only collected in @ops and the cache does not change meanwhile. */
+	if (plat_head) {
 
 		/* create a lookup index. */
-		if (routes && routes->len > 0) {
+		if (   !routes_keep_predicate
+		    && routes
+		    && routes->len > 0) {
 			routes_idx = g_hash_table_new ((GHashFunc) nmp_object_id_hash,
 			                               (GEqualFunc) nmp_object_id_equal);
 			for (i = 0; i < routes->len; i++) {
@@ -3612,120 +4534,184 @@ nm_platform_ip_route_sync (NMPlatform *self,
 			}
 		}
 
-		for (i = 0; i < plat_routes->len; i++) {
-			plat_o = plat_routes->pdata[i];
-
-			if (NM_PLATFORM_IP_ROUTE_IS_DEFAULT (NMP_OBJECT_CAST_IP_ROUTE (plat_o))) {
-				/* don't delete default routes. */
+		nmp_cache_live_iter_for_each (&iter, nm_platform_get_cache (self), plat_head, &plat_o) {
+			if (!_ip_route_may_delete (self, plat_o, kernel_delete_predicate, kernel_delete_userdata))
 				continue;
-			}
 
-			if (   routes_idx
-			    && (conf_o = g_hash_table_lookup (routes_idx, plat_o))
-			    && vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
-			                      NMP_OBJECT_CAST_IPX_ROUTE (plat_o),
-			                      NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0) {
+			if (routes_keep_predicate) {
+				if (routes_keep_predicate (plat_o, routes_keep_userdata)) {
+					/* the route in platform is identical to the one we want to add.
+					 * Keep it. */
+					continue;
+				}
+			} else if (   routes_idx
+			           && (conf_o = g_hash_table_lookup (routes_idx, plat_o))
+			           && vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+			                             NMP_OBJECT_CAST_IPX_ROUTE (plat_o),
+			                             NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) == 0) {
 				/* the route in platform is identical to the one we want to add.
 				 * Keep it. */
 				continue;
 			}
 
-			if (!nm_platform_ip_route_delete (self, plat_o)) {
-				/* ignore error... */
-			}
+			_ip_batch_ops_append (&ops, plat_head->len, plat_o, TRUE, 0);
+		}
+
+		/* send all deletions at once. We ignore errors... */
+		if (ops && ops->len > 0) {
+			nm_platform_ip_batch (self, (NMPlatformIPBatchOp *) ops->data, ops->len);
+			g_array_set_size (ops, 0);
 		}
 	}
 
 	if (!routes)
 		return success;
 
-	for (i_type = 0; i_type < 2; i_type++) {
-		for (i = 0; i < routes->len; i++) {
-			NMPlatformError plerr;
+	return _ip_route_add_missing (self, vt, routes);
+}
 
-			conf_o = routes->pdata[i];
+/**
+ * nm_platform_ip_route_sync_delta:
+ * @self: the #NMPlatform instance.
+ * @addr_family: AF_INET or AF_INET6.
+ * @ifindex: the interface of the routes.
+ * @routes_del: (allow-none): routes that were configured previously and
+ *   are to be removed.
+ * @routes_add: (allow-none): routes that are to be added.
+ * @kernel_delete_predicate: (allow-none): like for nm_platform_ip_route_sync().
+ * @kernel_delete_userdata: user data for @kernel_delete_predicate.
+ *
+ * Like nm_platform_ip_route_sync(), but only applies the given changes
+ * instead of comparing all routes of @ifindex. The caller must know that
+ * the routes in platform are those that it configured last, for example
+ * because nm_platform_get_addrroute_generation() did not change since.
+ *
+ * Routes of @routes_del that are also in @routes_add with the same ID
+ * are replaced.
+ *
+ * Returns: %TRUE on success.
+ */
+gboolean
+nm_platform_ip_route_sync_delta (NMPlatform *self,
+                                 int addr_family,
+                                 int ifindex,
+                                 const GPtrArray *routes_del,
+                                 GPtrArray *routes_add,
+                                 NMPObjectPredicateFunc kernel_delete_predicate,
+                                 gpointer kernel_delete_userdata)
+{
+	const NMPlatformVTableRoute *vt;
+	const NMDedupMultiEntry *plat_entry;
+	gs_unref_array GArray *ops = NULL;
+	guint i;
 
-#define VTABLE_IS_DEVICE_ROUTE(vt, o) (vt->is_ip4 \
-                                         ? (NMP_OBJECT_CAST_IP4_ROUTE (o)->gateway == 0) \
-                                         : IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (o)->gateway) )
+	nm_assert (NM_IS_PLATFORM (self));
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+	nm_assert (ifindex > 0);
 
-			if (   (i_type == 0 && !VTABLE_IS_DEVICE_ROUTE (vt, conf_o))
-			    || (i_type == 1 &&  VTABLE_IS_DEVICE_ROUTE (vt, conf_o))) {
-				/* we add routes in two runs over @i_type.
-				 *
-				 * First device routes, then gateway routes. */
-				continue;
-			}
+	vt = addr_family == AF_INET
+	     ? &nm_platform_vtable_route_v4
+	     : &nm_platform_vtable_route_v6;
+
+	if (routes_del) {
+		for (i = 0; i < routes_del->len; i++) {
+			const NMPObject *conf_o = routes_del->pdata[i];
+
+			nm_assert (NMP_OBJECT_GET_TYPE (conf_o) == vt->obj_type);
+			nm_assert (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->ifindex == ifindex);
 
 			plat_entry = nm_platform_lookup_entry (self,
 			                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
 			                                       conf_o);
-			if (plat_entry) {
-				/* we alreay have a route with the same ID in the platform cache.
-				 * Skip adding it again. It should be identical already, otherwise we
-				 * would have deleted above. */
-				if (_LOGD_ENABLED ()) {
-					if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
-					                   NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
-					                   NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
-						_LOGD ("route-sync: skip adding route %s due to existing (different!) route %s",
-						       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-						       nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
-					}
-				}
+			if (!plat_entry) {
+				/* already gone. */
 				continue;
 			}
 
-			plerr = nm_platform_ip_route_add (self,
-			                                    NMP_NLM_FLAG_APPEND
-			                                  | NMP_NLM_FLAG_SUPPRESS_NETLINK_FAILURE,
-			                                  conf_o);
-			if (plerr != NM_PLATFORM_ERROR_SUCCESS) {
-				if (-((int) plerr) == EEXIST) {
-					/* Don't fail for EEXIST. It's not clear that the existing route
-					 * is identical to the one that we were about to add. However,
-					 * above we should have deleted conflicting (non-identical) routes. */
-					if (_LOGD_ENABLED ()) {
-						plat_entry = nm_platform_lookup_entry (self,
-						                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
-						                                       conf_o);
-						if (!plat_entry) {
-							_LOGD ("route-sync: adding route %s failed with EEXIST, however we cannot find such a route",
-							       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)));
-						} else if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
-						                          NMP_OBJECT_CAST_IPX_ROUTE (plat_entry->obj),
-						                          NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0) {
-							_LOGD ("route-sync: adding route %s failed due to existing (different!) route %s",
-							       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-							       nmp_object_to_string (plat_entry->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf2, sizeof (sbuf2)));
-						}
-					}
-				} else if (NMP_OBJECT_CAST_IP_ROUTE (conf_o)->rt_source < NM_IP_CONFIG_SOURCE_USER) {
-					_LOGD ("route-sync: ignore failure to add IPv%c route: %s: %s",
-					       vt->is_ip4 ? '4' : '6',
-					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					       nm_platform_error_to_string (plerr, sbuf_err, sizeof (sbuf_err)));
-				} else {
-					const char *reason = "";
+			if (!_ip_route_may_delete (self, plat_entry->obj, kernel_delete_predicate, kernel_delete_userdata))
+				continue;
 
-					if (   -((int) plerr) == ENETUNREACH
-					    && (  vt->is_ip4
-					        ? !!NMP_OBJECT_CAST_IP4_ROUTE (conf_o)->gateway
-					        : !IN6_IS_ADDR_UNSPECIFIED (&NMP_OBJECT_CAST_IP6_ROUTE (conf_o)->gateway)))
-						reason = "; is the gateway directly reachable?";
+			_ip_batch_ops_append (&ops, routes_del->len, plat_entry->obj, TRUE, 0);
+		}
 
-					_LOGW ("route-sync: failure to add IPv%c route: %s: %s%s",
-					       vt->is_ip4 ? '4' : '6',
-					       nmp_object_to_string (conf_o, NMP_OBJECT_TO_STRING_PUBLIC, sbuf1, sizeof (sbuf1)),
-					       nm_platform_error_to_string (plerr, sbuf_err, sizeof (sbuf_err)),
-					       reason);
-					success = FALSE;
-				}
-			}
+		/* send all deletions at once. We ignore errors... */
+		if (ops)
+			nm_platform_ip_batch (self, (NMPlatformIPBatchOp *) ops->data, ops->len);
+	}
+
+	if (   !routes_add
+	    || routes_add->len == 0)
+		return TRUE;
+
+	return _ip_route_add_missing (self, vt, routes_add);
+}
+
+/**
+ * nm_platform_ip_route_is_synced:
+ * @self: the #NMPlatform instance.
+ * @addr_family: AF_INET or AF_INET6.
+ * @ifindex: the @ifindex for which the routes are checked.
+ * @routes_idx: (allow-none): the routes that were configured, as a hash
+ *   table whose keys are the route objects, compared by their ID.
+ * @kernel_delete_predicate: (allow-none): like for nm_platform_ip_route_sync().
+ * @kernel_delete_userdata: user data for @kernel_delete_predicate.
+ *
+ * Returns: %TRUE, if the platform cache has exactly the routes of @routes_idx
+ *   on @ifindex. That is, if all of them are there and identical, and there
+ *   are no other routes that nm_platform_ip_route_sync() would delete. This
+ *   is not the case, if adding a route failed or if somebody else changed
+ *   the routes meanwhile.
+ *
+ * This is a single pass over the routes of @ifindex in the cache. It does
+ * not allocate and is only done once per commit after the changes were
+ * applied, so it is linear like the route diff and the address check
+ * that precede it. Checking only the changed entries would not detect
+ * routes that somebody else added in the meantime.
+ */
+gboolean
+nm_platform_ip_route_is_synced (NMPlatform *self,
+                                int addr_family,
+                                int ifindex,
+                                GHashTable *routes_idx,
+                                NMPObjectPredicateFunc kernel_delete_predicate,
+                                gpointer kernel_delete_userdata)
+{
+	const NMPlatformVTableRoute *vt;
+	const NMDedupMultiHeadEntry *plat_head;
+	NMDedupMultiIter iter;
+	const NMPObject *plat_o;
+	const NMPObject *conf_o;
+	guint n_found = 0;
+
+	nm_assert (NM_IS_PLATFORM (self));
+	nm_assert (NM_IN_SET (addr_family, AF_INET, AF_INET6));
+	nm_assert (ifindex > 0);
+
+	vt = addr_family == AF_INET
+	     ? &nm_platform_vtable_route_v4
+	     : &nm_platform_vtable_route_v6;
+
+	plat_head = nm_platform_lookup_addrroute (self,
+	                                          vt->obj_type,
+	                                          ifindex);
+	nmp_cache_iter_for_each (&iter, plat_head, &plat_o) {
+		if (   routes_idx
+		    && g_hash_table_lookup_extended (routes_idx, plat_o, (gpointer *) &conf_o, NULL)) {
+			if (vt->route_cmp (NMP_OBJECT_CAST_IPX_ROUTE (conf_o),
+			                   NMP_OBJECT_CAST_IPX_ROUTE (plat_o),
+			                   NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY) != 0)
+				return FALSE;
+			n_found++;
+			continue;
+		}
+
+		if (_ip_route_may_delete (self, plat_o, kernel_delete_predicate, kernel_delete_userdata)) {
+			/* a route that we would delete. */
+			return FALSE;
 		}
 	}
 
-	return success;
+	return n_found == (routes_idx ? g_hash_table_size (routes_idx) : 0u);
 }
 
 gboolean
@@ -3742,9 +4728,9 @@ nm_platform_ip_route_flush (NMPlatform *self,
 	                                   AF_INET6));
 
 	if (NM_IN_SET (addr_family, AF_UNSPEC, AF_INET))
-		success &= nm_platform_ip_route_sync (self, AF_INET,  ifindex, NULL, NULL, NULL);
+		success &= nm_platform_ip_route_sync (self, AF_INET,  ifindex, NULL, NULL, NULL, NULL, NULL);
 	if (NM_IN_SET (addr_family, AF_UNSPEC, AF_INET6))
-		success &= nm_platform_ip_route_sync (self, AF_INET6, ifindex, NULL, NULL, NULL);
+		success &= nm_platform_ip_route_sync (self, AF_INET6, ifindex, NULL, NULL, NULL, NULL, NULL);
 	return success;
 }
 
@@ -3850,36 +4836,187 @@ nm_platform_ip_route_add (NMPlatform *self,
 	return _ip_route_add (self, flags, addr_family, NMP_OBJECT_CAST_IP_ROUTE (route));
 }
 
-NMPlatformError
-nm_platform_ip4_route_add (NMPlatform *self,
-                           NMPNlmFlags flags,
-                           const NMPlatformIP4Route *route)
-{
-	return _ip_route_add (self, flags, AF_INET, route);
-}
+NMPlatformError
+nm_platform_ip4_route_add (NMPlatform *self,
+                           NMPNlmFlags flags,
+                           const NMPlatformIP4Route *route)
+{
+	return _ip_route_add (self, flags, AF_INET, route);
+}
+
+NMPlatformError
+nm_platform_ip6_route_add (NMPlatform *self,
+                           NMPNlmFlags flags,
+                           const NMPlatformIP6Route *route)
+{
+	return _ip_route_add (self, flags, AF_INET6, route);
+}
+
+gboolean
+nm_platform_ip_route_delete (NMPlatform *self,
+                             const NMPObject *obj)
+{
+	_CHECK_SELF (self, klass, FALSE);
+
+	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                                 NMP_OBJECT_TYPE_IP6_ROUTE));
+
+	_LOGD ("route: delete     IPv%c route %s",
+	       NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_IP4_ROUTE ? '4' : '6',
+	       nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
+
+	return klass->ip_route_delete (self, obj);
+}
+
+/**
+ * nm_platform_ip_route_is_ignored:
+ * @self: the #NMPlatform instance
+ * @route: the route to check
+ *
+ * Returns: %TRUE, if @route is in a table or of a protocol that is
+ *   configured to be ignored by the platform.
+ */
+gboolean
+nm_platform_ip_route_is_ignored (NMPlatform *self, const NMPlatformIPRoute *route)
+{
+	const NMPlatformIPRouteFilter *filter;
+
+	_CHECK_SELF (self, klass, FALSE);
+
+	filter = NM_PLATFORM_GET_PRIVATE (self)->ip_route_filter;
+	if (!filter)
+		return FALSE;
+
+	return    nm_platform_ip_route_filter_ignores_table (filter, nm_platform_route_table_coerce (route->table_coerced))
+	       || nm_platform_ip_route_filter_ignores_protocol (filter, nmp_utils_ip_config_source_coerce_to_rtprot (route->rt_source));
+}
+
+/**
+ * nm_platform_ip_batch:
+ * @self: the #NMPlatform instance
+ * @ops: the requests to perform, in order.
+ * @n_ops: the number of requests in @ops.
+ *
+ * Performs the requests in @ops. Contrary to adding and deleting the
+ * addresses and routes one by one, the platform implementation
+ * may pipeline the requests, that is, send several of them before waiting for
+ * the responses from kernel. The requests are still processed by kernel in
+ * the order given. The outcome of every request is returned in its
+ * @result field.
+ */
+void
+nm_platform_ip_batch (NMPlatform *self,
+                      NMPlatformIPBatchOp *ops,
+                      guint n_ops)
+{
+	char sbuf[sizeof (_nm_utils_to_string_buffer)];
+	guint i;
+
+	_CHECK_SELF_VOID (self, klass);
+
+	nm_assert (ops || n_ops == 0);
+
+	if (n_ops == 0)
+		return;
+
+	if (!klass->ip_batch) {
+		/* the platform can't pipeline the requests. Perform them one by one,
+		 * via the public functions that validate and log them. */
+		for (i = 0; i < n_ops; i++) {
+			NMPlatformIPBatchOp *op = &ops[i];
+			const NMPObject *obj = op->obj;
+			gboolean success;
+
+			switch (NMP_OBJECT_GET_TYPE (obj)) {
+			case NMP_OBJECT_TYPE_IP4_ADDRESS:
+				if (op->is_delete) {
+					success = nm_platform_ip4_address_delete (self,
+					                                          obj->ip4_address.ifindex,
+					                                          obj->ip4_address.address,
+					                                          obj->ip4_address.plen,
+					                                          obj->ip4_address.peer_address);
+				} else {
+					success = nm_platform_ip4_address_add (self,
+					                                       obj->ip4_address.ifindex,
+					                                       obj->ip4_address.address,
+					                                       obj->ip4_address.plen,
+					                                       obj->ip4_address.peer_address,
+					                                       op->lifetime,
+					                                       op->preferred,
+					                                       op->ifa_flags,
+					                                       obj->ip4_address.label);
+				}
+				break;
+			case NMP_OBJECT_TYPE_IP6_ADDRESS:
+				if (op->is_delete) {
+					success = nm_platform_ip6_address_delete (self,
+					                                          obj->ip6_address.ifindex,
+					                                          obj->ip6_address.address,
+					                                          obj->ip6_address.plen);
+				} else {
+					success = nm_platform_ip6_address_add (self,
+					                                       obj->ip6_address.ifindex,
+					                                       obj->ip6_address.address,
+					                                       obj->ip6_address.plen,
+					                                       obj->ip6_address.peer_address,
+					                                       op->lifetime,
+					                                       op->preferred,
+					                                       op->ifa_flags);
+				}
+				break;
+			case NMP_OBJECT_TYPE_IP4_ROUTE:
+			case NMP_OBJECT_TYPE_IP6_ROUTE:
+				if (op->is_delete)
+					success = nm_platform_ip_route_delete (self, obj);
+				else {
+					op->result = nm_platform_ip_route_add (self, op->flags, obj);
+					continue;
+				}
+				break;
+			default:
+				nm_assert_not_reached ();
+				success = FALSE;
+				break;
+			}
+
+			op->result =   success
+			             ? NM_PLATFORM_ERROR_SUCCESS
+			             : NM_PLATFORM_ERROR_UNSPECIFIED;
+		}
+		return;
+	}
 
-NMPlatformError
-nm_platform_ip6_route_add (NMPlatform *self,
-                           NMPNlmFlags flags,
-                           const NMPlatformIP6Route *route)
-{
-	return _ip_route_add (self, flags, AF_INET6, route);
-}
+	for (i = 0; i < n_ops; i++) {
+		NMPlatformIPBatchOp *op = &ops[i];
 
-gboolean
-nm_platform_ip_route_delete (NMPlatform *self,
-                             const NMPObject *obj)
-{
-	_CHECK_SELF (self, klass, FALSE);
+		op->result = NM_PLATFORM_ERROR_UNSPECIFIED;
 
-	nm_assert (NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ROUTE,
-	                                                 NMP_OBJECT_TYPE_IP6_ROUTE));
+		if (!_LOGD_ENABLED ())
+			continue;
 
-	_LOGD ("route: delete     IPv%c route %s",
-	       NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_IP4_ROUTE ? '4' : '6',
-	       nmp_object_to_string (obj, NMP_OBJECT_TO_STRING_PUBLIC, NULL, 0));
+		switch (NMP_OBJECT_GET_TYPE (op->obj)) {
+		case NMP_OBJECT_TYPE_IP4_ADDRESS:
+		case NMP_OBJECT_TYPE_IP6_ADDRESS:
+			_LOGD ("address: %s IPv%c address: %s",
+			       op->is_delete ? "deleting" : "adding or updating",
+			       NMP_OBJECT_GET_TYPE (op->obj) == NMP_OBJECT_TYPE_IP4_ADDRESS ? '4' : '6',
+			       nmp_object_to_string (op->obj, NMP_OBJECT_TO_STRING_ID, sbuf, sizeof (sbuf)));
+			break;
+		case NMP_OBJECT_TYPE_IP4_ROUTE:
+		case NMP_OBJECT_TYPE_IP6_ROUTE:
+			_LOGD ("route: %-10s IPv%c route: %s",
+			       op->is_delete
+			         ? "delete"
+			         : _nmp_nlm_flag_to_string (op->flags & NMP_NLM_FLAG_FMASK),
+			       NMP_OBJECT_GET_TYPE (op->obj) == NMP_OBJECT_TYPE_IP4_ROUTE ? '4' : '6',
+			       nmp_object_to_string (op->obj, NMP_OBJECT_TO_STRING_PUBLIC, sbuf, sizeof (sbuf)));
+			break;
+		default:
+			nm_assert_not_reached ();
+		}
+	}
 
-	return klass->ip_route_delete (self, obj);
+	klass->ip_batch (self, ops, n_ops);
 }
 
 /*****************************************************************************/
@@ -5786,6 +6923,364 @@ log_ip6_route (NMPlatform *self, NMPObjectType obj_type, int ifindex, NMPlatform
 
 /*****************************************************************************/
 
+#define _change_get_obj_type(c) NMP_OBJECT_GET_TYPE ((c)->obj_new ?: (c)->obj_old)
+
+static void
+_changes_batch_free (GArray *changes)
+{
+	guint i;
+
+	for (i = 0; i < changes->len; i++) {
+		const NMPlatformChange *c = &g_array_index (changes, NMPlatformChange, i);
+
+		nmp_object_unref (c->obj_old);
+		nmp_object_unref (c->obj_new);
+	}
+	g_array_free (changes, TRUE);
+}
+
+static void
+_changes_batch_emit (NMPlatform *self)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	GArray *changes;
+
+	/* the handlers might cause more changes. They are queued and emitted
+	 * by the outer call after the pending ones, to keep the order. */
+	if (priv->changes_batch_emitting)
+		return;
+	priv->changes_batch_emitting = TRUE;
+
+	while ((changes = g_steal_pointer (&priv->changes_batch))) {
+		guint start, end;
+
+		/* emit each run of changes of the same object type at once. The
+		 * runs are emitted in order, so that a link is announced before
+		 * the addresses and routes that were added after it. */
+		for (start = 0; start < changes->len; start = end) {
+			const NMPlatformChange *c = &g_array_index (changes, NMPlatformChange, start);
+			NMPObjectType obj_type = _change_get_obj_type (c);
+
+			for (end = start + 1; end < changes->len; end++) {
+				if (_change_get_obj_type (&g_array_index (changes, NMPlatformChange, end)) != obj_type)
+					break;
+			}
+
+			_LOGt ("emit signal %s: %u changes",
+			       NM_PLATFORM_SIGNAL_CHANGES_BATCH,
+			       end - start);
+			g_signal_emit (self,
+			               signals[NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH],
+			               0,
+			               (int) obj_type,
+			               c,
+			               end - start);
+		}
+		_changes_batch_free (changes);
+	}
+
+	priv->changes_batch_emitting = FALSE;
+}
+
+static void
+_changes_batch_add (NMPlatform *self,
+                    NMPCacheOpsType cache_op,
+                    const NMPObject *obj_old,
+                    const NMPObject *obj_new)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	GArray **p_changes = &priv->changes_batch;
+	NMPlatformChange *c;
+
+	if (!*p_changes)
+		*p_changes = g_array_new (FALSE, FALSE, sizeof (NMPlatformChange));
+
+	g_array_set_size (*p_changes, (*p_changes)->len + 1);
+	c = &g_array_index (*p_changes, NMPlatformChange, (*p_changes)->len - 1);
+	c->change_type = (NMPlatformSignalChangeType) cache_op;
+	c->obj_old = cache_op != NMP_CACHE_OPS_ADDED ? nmp_object_ref (obj_old) : NULL;
+	c->obj_new = cache_op != NMP_CACHE_OPS_REMOVED ? nmp_object_ref (obj_new) : NULL;
+
+	if (priv->changes_batch_depth == 0)
+		_changes_batch_emit (self);
+}
+
+/**
+ * nm_platform_changes_batch_begin:
+ * @self: the #NMPlatform instance
+ *
+ * Delay %NM_PLATFORM_SIGNAL_CHANGES_BATCH until the matching
+ * nm_platform_changes_batch_end(). Calls can be nested. Outside of
+ * a batch, each change is emitted on its own.
+ */
+void
+nm_platform_changes_batch_begin (NMPlatform *self)
+{
+	g_return_if_fail (NM_IS_PLATFORM (self));
+
+	NM_PLATFORM_GET_PRIVATE (self)->changes_batch_depth++;
+}
+
+void
+nm_platform_changes_batch_end (NMPlatform *self)
+{
+	NMPlatformPrivate *priv;
+
+	g_return_if_fail (NM_IS_PLATFORM (self));
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	g_return_if_fail (priv->changes_batch_depth > 0);
+
+	if (--priv->changes_batch_depth == 0)
+		_changes_batch_emit (self);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	NMPObjectType obj_type;
+	int ifindex;
+	CList lst_subscriptions_head;
+} SubscriptionHead;
+
+typedef struct {
+	CList lst_subscriptions;
+
+	/* %NULL, if the subscription was removed during dispatching. */
+	NMPlatformObjectChangedFunc callback;
+	gpointer user_data;
+} Subscription;
+
+static guint
+_subscription_head_hash (gconstpointer ptr)
+{
+	const SubscriptionHead *head = ptr;
+	guint h = 1160469241;
+
+	h = NM_HASH_COMBINE (h, head->obj_type);
+	h = NM_HASH_COMBINE (h, head->ifindex);
+	return h;
+}
+
+static gboolean
+_subscription_head_equal (gconstpointer a, gconstpointer b)
+{
+	const SubscriptionHead *head_a = a;
+	const SubscriptionHead *head_b = b;
+
+	return    head_a->obj_type == head_b->obj_type
+	       && head_a->ifindex == head_b->ifindex;
+}
+
+static void
+_subscription_head_free (gpointer ptr)
+{
+	SubscriptionHead *head = ptr;
+	Subscription *sub, *sub_safe;
+
+	c_list_for_each_entry_safe (sub, sub_safe, &head->lst_subscriptions_head, lst_subscriptions) {
+		c_list_unlink (&sub->lst_subscriptions);
+		g_slice_free (Subscription, sub);
+	}
+	g_slice_free (SubscriptionHead, head);
+}
+
+static void
+_subscriptions_gc (NMPlatform *self)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	GHashTableIter iter;
+	SubscriptionHead *head;
+	Subscription *sub, *sub_safe;
+
+	nm_assert (priv->subscriptions_dispatching == 0);
+
+	if (!priv->subscriptions_has_dead)
+		return;
+	priv->subscriptions_has_dead = FALSE;
+
+	g_hash_table_iter_init (&iter, priv->subscriptions);
+	while (g_hash_table_iter_next (&iter, (gpointer *) &head, NULL)) {
+		c_list_for_each_entry_safe (sub, sub_safe, &head->lst_subscriptions_head, lst_subscriptions) {
+			if (!sub->callback) {
+				c_list_unlink (&sub->lst_subscriptions);
+				g_slice_free (Subscription, sub);
+			}
+		}
+		if (c_list_is_empty (&head->lst_subscriptions_head))
+			g_hash_table_iter_remove (&iter);
+	}
+}
+
+static void
+_subscriptions_dispatch_one (NMPlatform *self,
+                             NMPObjectType obj_type,
+                             int ifindex,
+                             const NMPObject *obj,
+                             NMPlatformSignalChangeType change_type)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	const SubscriptionHead needle = {
+		.obj_type = obj_type,
+		.ifindex = ifindex,
+	};
+	SubscriptionHead *head;
+	Subscription *sub;
+
+	head = g_hash_table_lookup (priv->subscriptions, &needle);
+	if (!head)
+		return;
+
+	/* subscriptions removed by a callback are only marked as dead,
+	 * so it's safe to continue iterating. */
+	c_list_for_each_entry (sub, &head->lst_subscriptions_head, lst_subscriptions) {
+		if (sub->callback)
+			sub->callback (self, obj, change_type, sub->user_data);
+	}
+}
+
+static void
+_subscriptions_dispatch (NMPlatform *self,
+                         const NMPObject *obj,
+                         NMPlatformSignalChangeType change_type)
+{
+	NMPlatformPrivate *priv = NM_PLATFORM_GET_PRIVATE (self);
+	NMPObjectType obj_type = NMP_OBJECT_GET_TYPE (obj);
+
+	if (   !priv->subscriptions
+	    || g_hash_table_size (priv->subscriptions) == 0)
+		return;
+
+	priv->subscriptions_dispatching++;
+	if (obj->object.ifindex > 0)
+		_subscriptions_dispatch_one (self, obj_type, obj->object.ifindex, obj, change_type);
+	_subscriptions_dispatch_one (self, obj_type, 0, obj, change_type);
+	if (--priv->subscriptions_dispatching == 0)
+		_subscriptions_gc (self);
+}
+
+/**
+ * nm_platform_object_subscribe:
+ * @self: the #NMPlatform instance
+ * @obj_type: the object type, for example %NMP_OBJECT_TYPE_LINK
+ * @ifindex: only get notified about objects with this ifindex,
+ *   or 0 for all objects of @obj_type.
+ * @callback: the callback to invoke
+ * @user_data: user data for @callback
+ *
+ * Like connecting to the per-object-type signals, but the callback only
+ * gets invoked for objects with the requested @ifindex. The lookup of the
+ * subscribers happens by @ifindex, so unlike with a signal handler that
+ * filters by ifindex, the cost of a change does not grow with the number of
+ * subscribers for other interfaces.
+ */
+void
+nm_platform_object_subscribe (NMPlatform *self,
+                              NMPObjectType obj_type,
+                              int ifindex,
+                              NMPlatformObjectChangedFunc callback,
+                              gpointer user_data)
+{
+	NMPlatformPrivate *priv;
+	const SubscriptionHead needle = {
+		.obj_type = obj_type,
+		.ifindex = ifindex,
+	};
+	SubscriptionHead *head;
+	Subscription *sub;
+
+	g_return_if_fail (NM_IS_PLATFORM (self));
+	g_return_if_fail (nmp_class_from_type (obj_type));
+	g_return_if_fail (ifindex >= 0);
+	g_return_if_fail (callback);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (!priv->subscriptions) {
+		priv->subscriptions = g_hash_table_new_full (_subscription_head_hash,
+		                                             _subscription_head_equal,
+		                                             _subscription_head_free,
+		                                             NULL);
+	}
+
+	head = g_hash_table_lookup (priv->subscriptions, &needle);
+	if (!head) {
+		head = g_slice_new (SubscriptionHead);
+		*head = needle;
+		c_list_init (&head->lst_subscriptions_head);
+		g_hash_table_add (priv->subscriptions, head);
+	}
+
+	sub = g_slice_new (Subscription);
+	sub->callback = callback;
+	sub->user_data = user_data;
+	c_list_link_tail (&head->lst_subscriptions_head, &sub->lst_subscriptions);
+}
+
+/**
+ * nm_platform_object_unsubscribe:
+ * @self: the #NMPlatform instance
+ * @obj_type: the object type
+ * @ifindex: the ifindex
+ * @callback: the callback
+ * @user_data: the user data
+ *
+ * Removes one subscription that was added with nm_platform_object_subscribe()
+ * with the same arguments.
+ *
+ * Returns: %TRUE, if a subscription was removed.
+ */
+gboolean
+nm_platform_object_unsubscribe (NMPlatform *self,
+                                NMPObjectType obj_type,
+                                int ifindex,
+                                NMPlatformObjectChangedFunc callback,
+                                gpointer user_data)
+{
+	NMPlatformPrivate *priv;
+	const SubscriptionHead needle = {
+		.obj_type = obj_type,
+		.ifindex = ifindex,
+	};
+	SubscriptionHead *head;
+	Subscription *sub;
+
+	g_return_val_if_fail (NM_IS_PLATFORM (self), FALSE);
+	g_return_val_if_fail (callback, FALSE);
+
+	priv = NM_PLATFORM_GET_PRIVATE (self);
+
+	if (!priv->subscriptions)
+		return FALSE;
+
+	head = g_hash_table_lookup (priv->subscriptions, &needle);
+	if (!head)
+		return FALSE;
+
+	c_list_for_each_entry (sub, &head->lst_subscriptions_head, lst_subscriptions) {
+		if (   sub->callback == callback
+		    && sub->user_data == user_data)
+			break;
+	}
+	if (&sub->lst_subscriptions == &head->lst_subscriptions_head)
+		return FALSE;
+
+	if (priv->subscriptions_dispatching > 0) {
+		sub->callback = NULL;
+		priv->subscriptions_has_dead = TRUE;
+		return TRUE;
+	}
+
+	c_list_unlink (&sub->lst_subscriptions);
+	g_slice_free (Subscription, sub);
+	if (c_list_is_empty (&head->lst_subscriptions_head))
+		g_hash_table_remove (priv->subscriptions, head);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
 void
 nm_platform_cache_update_emit_signal (NMPlatform *self,
                                       NMPCacheOpsType cache_op,
@@ -5829,8 +7324,14 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 			o = obj_new;
 		break;
 	case NMP_CACHE_OPS_REMOVED:
-		if (!nmp_object_is_visible (obj_old))
+		if (!nmp_object_is_visible (obj_old)) {
+			/* we don't emit signals for invisible objects, but still forget
+			 * the sysctl directories of a removed link. */
+			if (   NMP_OBJECT_GET_TYPE (obj_old) == NMP_OBJECT_TYPE_LINK
+			    && NM_PLATFORM_GET_PRIVATE (self)->sysctl_ifdirs)
+				_sysctl_ifdir_notify_link (self, cache_op, NMP_OBJECT_CAST_LINK (obj_old));
 			return;
+		}
 		o = obj_old;
 		break;
 	default:
@@ -5840,6 +7341,10 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 
 	klass = NMP_OBJECT_GET_CLASS (o);
 
+	if (   klass->obj_type == NMP_OBJECT_TYPE_LINK
+	    && NM_PLATFORM_GET_PRIVATE (self)->sysctl_ifdirs)
+		_sysctl_ifdir_notify_link (self, cache_op, NMP_OBJECT_CAST_LINK (o));
+
 	if (   klass->obj_type == NMP_OBJECT_TYPE_IP4_ROUTE
 	    && NM_PLATFORM_GET_PRIVATE (self)->ip4_dev_route_blacklist_gc_timeout_id
 	    && NM_IN_SET (cache_op, NMP_CACHE_OPS_ADDED, NMP_CACHE_OPS_UPDATED))
@@ -5858,7 +7363,15 @@ nm_platform_cache_update_emit_signal (NMPlatform *self,
 	               o->object.ifindex,
 	               &o->object,
 	               (int) cache_op);
+	_subscriptions_dispatch (self, o, (NMPlatformSignalChangeType) cache_op);
 	nmp_object_unref (o);
+
+	if (g_signal_has_handler_pending (self, signals[NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH], 0, FALSE)) {
+		_changes_batch_add (self,
+		                    cache_op,
+		                    cache_op == NMP_CACHE_OPS_REMOVED ? o : obj_old,
+		                    cache_op == NMP_CACHE_OPS_ADDED ? o : obj_new);
+	}
 }
 
 /*****************************************************************************/
@@ -5924,6 +7437,138 @@ const NMPlatformVTableRoute nm_platform_vtable_route_v6 = {
 
 /*****************************************************************************/
 
+static gboolean
+_ip_route_filter_parse_table (const char *str, guint32 *out_from, guint32 *out_to)
+{
+	gs_free char *str_from = NULL;
+	const char *str_to;
+	gint64 from, to;
+
+	if (nm_streq (str, "default"))
+		from = to = 253;
+	else if (nm_streq (str, "main"))
+		from = to = 254;
+	else if (nm_streq (str, "local"))
+		from = to = 255;
+	else {
+		str_to = strchr (str, '-');
+		if (str_to) {
+			str_from = g_strndup (str, str_to - str);
+			str = str_from;
+			str_to++;
+		}
+		from = _nm_utils_ascii_str_to_int64 (str, 10, 1, G_MAXUINT32, -1);
+		to = str_to
+		     ? _nm_utils_ascii_str_to_int64 (str_to, 10, 1, G_MAXUINT32, -1)
+		     : from;
+		if (from < 0 || to < from)
+			return FALSE;
+	}
+
+	*out_from = from;
+	*out_to = to;
+	return TRUE;
+}
+
+static int
+_ip_route_filter_range_cmp (gconstpointer a, gconstpointer b)
+{
+	const NMPlatformIPRouteTableRange *r_a = a;
+	const NMPlatformIPRouteTableRange *r_b = b;
+
+	if (r_a->from != r_b->from)
+		return r_a->from < r_b->from ? -1 : 1;
+	return 0;
+}
+
+static void
+_ip_route_filter_free (NMPlatformIPRouteFilter *filter)
+{
+	if (filter) {
+		g_free (filter->table_ranges);
+		g_free (filter);
+	}
+}
+
+/* Parse the values of NM_PLATFORM_IGNORE_ROUTE_TABLES and NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS.
+ * Tables are numbers, ranges like "1000-2000" or "default", "main" and "local".
+ * Protocols are numbers or names like "bird" and "zebra". Invalid entries are
+ * ignored with a warning. Returns %NULL if nothing is to be ignored. */
+static NMPlatformIPRouteFilter *
+_ip_route_filter_new (NMPlatform *self, const char *tables, const char *protocols)
+{
+	NMPlatformIPRouteFilter *filter;
+	gs_unref_array GArray *ranges = NULL;
+	gboolean any = FALSE;
+	char **iter;
+
+	filter = g_new0 (NMPlatformIPRouteFilter, 1);
+
+	if (tables) {
+		gs_strfreev char **strv = g_strsplit_set (tables, " \t,;", 0);
+
+		for (iter = strv; *iter; iter++) {
+			guint32 from, to, t;
+
+			if (!(*iter)[0])
+				continue;
+			if (!_ip_route_filter_parse_table (*iter, &from, &to)) {
+				_LOGW ("ignore invalid route table \"%s\" in %s", *iter, NM_PLATFORM_IGNORE_ROUTE_TABLES);
+				continue;
+			}
+
+			for (t = from; t <= to && t < 256; t++)
+				filter->tables[t / 32] |= (1u << (t % 32));
+			if (to >= 256) {
+				NMPlatformIPRouteTableRange r = {
+					.from = MAX (from, 256u),
+					.to = to,
+				};
+
+				if (!ranges)
+					ranges = g_array_new (FALSE, FALSE, sizeof (NMPlatformIPRouteTableRange));
+				g_array_append_val (ranges, r);
+			}
+			any = TRUE;
+		}
+	}
+
+	if (protocols) {
+		gs_strfreev char **strv = g_strsplit_set (protocols, " \t,;", 0);
+
+		for (iter = strv; *iter; iter++) {
+			int rtprot;
+
+			if (!(*iter)[0])
+				continue;
+			rtprot = nmp_utils_rtprot_from_string (*iter);
+			if (rtprot < 0) {
+				_LOGW ("ignore invalid route protocol \"%s\" in %s", *iter, NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS);
+				continue;
+			}
+			filter->protocols[rtprot / 32] |= (1u << (rtprot % 32));
+			any = TRUE;
+		}
+	}
+
+	if (!any) {
+		_ip_route_filter_free (filter);
+		return NULL;
+	}
+
+	if (ranges) {
+		g_array_sort (ranges, _ip_route_filter_range_cmp);
+		filter->n_table_ranges = ranges->len;
+		filter->table_ranges = (NMPlatformIPRouteTableRange *) g_array_free (g_steal_pointer (&ranges), FALSE);
+	}
+
+	_LOGI ("ignore routes in tables \"%s\" and of protocols \"%s\"",
+	       tables ?: "", protocols ?: "");
+	return filter;
+}
+
+/*****************************************************************************/
+
 static void
 set_property (GObject *object, guint prop_id,
               const GValue *value, GParamSpec *pspec)
@@ -5950,6 +7595,14 @@ set_property (GObject *object, guint prop_id,
 		/* construct-only */
 		priv->log_with_ptr = g_value_get_boolean (value);
 		break;
+	case PROP_IGNORE_ROUTE_TABLES:
+		/* construct-only */
+		priv->ignore_route_tables = g_value_dup_string (value);
+		break;
+	case PROP_IGNORE_ROUTE_PROTOCOLS:
+		/* construct-only */
+		priv->ignore_route_protocols = g_value_dup_string (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -5981,6 +7634,12 @@ constructor (GType type,
 
 	priv->cache = nmp_cache_new (nm_platform_get_multi_idx (self),
 	                             priv->use_udev);
+
+	priv->ip_route_filter = _ip_route_filter_new (self,
+	                                              priv->ignore_route_tables,
+	                                              priv->ignore_route_protocols);
+	nm_clear_g_free (&priv->ignore_route_tables);
+	nm_clear_g_free (&priv->ignore_route_protocols);
 	return object;
 }
 
@@ -5993,9 +7652,14 @@ finalize (GObject *object)
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_check_id);
 	nm_clear_g_source (&priv->ip4_dev_route_blacklist_gc_timeout_id);
 	g_clear_pointer (&priv->ip4_dev_route_blacklist_hash, g_hash_table_unref);
+	g_clear_pointer (&priv->subscriptions, g_hash_table_unref);
+	g_clear_pointer (&priv->link_stats_pollers, g_hash_table_unref);
+	g_clear_pointer (&priv->sysctl_ifdirs, g_hash_table_unref);
+	g_clear_pointer (&priv->changes_batch, _changes_batch_free);
 	g_clear_object (&self->_netns);
 	nm_dedup_multi_index_unref (priv->multi_idx);
 	nmp_cache_free (priv->cache);
+	_ip_route_filter_free (priv->ip_route_filter);
 }
 
 static void
@@ -6035,6 +7699,22 @@ nm_platform_class_init (NMPlatformClass *platform_class)
 	                           G_PARAM_CONSTRUCT_ONLY |
 	                           G_PARAM_STATIC_STRINGS));
 
+	g_object_class_install_property
+	 (object_class, PROP_IGNORE_ROUTE_TABLES,
+	     g_param_spec_string (NM_PLATFORM_IGNORE_ROUTE_TABLES, "", "",
+	                          NULL,
+	                          G_PARAM_WRITABLE |
+	                          G_PARAM_CONSTRUCT_ONLY |
+	                          G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property
+	 (object_class, PROP_IGNORE_ROUTE_PROTOCOLS,
+	     g_param_spec_string (NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS, "", "",
+	                          NULL,
+	                          G_PARAM_WRITABLE |
+	                          G_PARAM_CONSTRUCT_ONLY |
+	                          G_PARAM_STATIC_STRINGS));
+
 #define SIGNAL(signal, signal_id, method) \
 	G_STMT_START { \
 		signals[signal] = \
@@ -6057,4 +7737,15 @@ nm_platform_class_init (NMPlatformClass *platform_class)
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP6_ADDRESS, NM_PLATFORM_SIGNAL_IP6_ADDRESS_CHANGED, log_ip6_address);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,   NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED,   log_ip4_route);
 	SIGNAL (NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,   NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED,   log_ip6_route);
+
+	signals[NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH] =
+	    g_signal_new (NM_PLATFORM_SIGNAL_CHANGES_BATCH,
+	                  G_OBJECT_CLASS_TYPE (object_class),
+	                  G_SIGNAL_RUN_FIRST,
+	                  0, NULL, NULL, NULL,
+	                  G_TYPE_NONE, 3,
+	                  G_TYPE_INT,     /* (int) NMPObjectType */
+	                  G_TYPE_POINTER, /* const NMPlatformChange * */
+	                  G_TYPE_UINT     /* n_changes */
+	                  );
 }
@@ -47,6 +47,8 @@
 #define NM_PLATFORM_NETNS_SUPPORT      "netns-support"
 #define NM_PLATFORM_USE_UDEV           "use-udev"
 #define NM_PLATFORM_LOG_WITH_PTR       "log-with-ptr"
+#define NM_PLATFORM_IGNORE_ROUTE_TABLES    "ignore-route-tables"
+#define NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS "ignore-route-protocols"
 
 /*****************************************************************************/
 
@@ -237,6 +239,7 @@ typedef enum { /*< skip >*/
 	NM_PLATFORM_SIGNAL_ID_IP6_ADDRESS,
 	NM_PLATFORM_SIGNAL_ID_IP4_ROUTE,
 	NM_PLATFORM_SIGNAL_ID_IP6_ROUTE,
+	NM_PLATFORM_SIGNAL_ID_CHANGES_BATCH,
 	_NM_PLATFORM_SIGNAL_ID_LAST,
 } NMPlatformSignalIdType;
 
@@ -249,6 +252,15 @@ typedef enum {
 	NM_PLATFORM_SIGNAL_REMOVED,
 } NMPlatformSignalChangeType;
 
+typedef struct {
+	NMPlatformSignalChangeType change_type;
+
+	/* @obj_old is %NULL for %NM_PLATFORM_SIGNAL_ADDED, @obj_new is %NULL
+	 * for %NM_PLATFORM_SIGNAL_REMOVED. */
+	const NMPObject *obj_old;
+	const NMPObject *obj_new;
+} NMPlatformChange;
+
 struct _NMPlatformObject {
 	__NMPlatformObject_COMMON;
 };
@@ -661,6 +673,30 @@ typedef enum {
 	NM_PLATFORM_LINK_DUPLEX_FULL,
 } NMPlatformLinkDuplexType;
 
+/* One request of a batch passed to nm_platform_ip_batch(). All requests of a
+ * batch are sent to kernel back-to-back and their acknowledgements are
+ * collected afterwards, instead of waiting for a response after each request. */
+typedef struct {
+	/* the address or route to add or delete. The object must stay alive
+	 * until the batch completes. */
+	const NMPObject *obj;
+
+	/* only for route additions, the flags for RTM_NEWROUTE. */
+	NMPNlmFlags flags;
+
+	/* only for address additions. The lifetimes are relative to now,
+	 * the @obj's own lifetime, preferred and n_ifa_flags fields are ignored. */
+	guint32 lifetime;
+	guint32 preferred;
+	guint32 ifa_flags;
+
+	bool is_delete:1;
+
+	/* output argument, set by nm_platform_ip_batch(). For deletions,
+	 * an object that is already gone counts as success. */
+	NMPlatformError result;
+} NMPlatformIPBatchOp;
+
 /*****************************************************************************/
 
 struct _NMPlatformPrivate;
@@ -671,11 +707,38 @@ struct _NMPlatform {
 	struct _NMPlatformPrivate *_priv;
 };
 
+/* the per-interface directories for nm_platform_sysctl_ifdir_set(). */
+typedef enum {
+	NMP_SYSCTL_IFDIR_IP4_CONF,      /* /proc/sys/net/ipv4/conf/$IFNAME */
+	NMP_SYSCTL_IFDIR_IP6_CONF,      /* /proc/sys/net/ipv6/conf/$IFNAME */
+	NMP_SYSCTL_IFDIR_NET,           /* /sys/class/net/$IFNAME */
+	_NMP_SYSCTL_IFDIR_NUM,
+} NMPSysctlIfdir;
+
+typedef struct {
+	const char *property;
+	const char *value;
+} NMPlatformSysctlEntry;
+
+typedef struct {
+	/* the number of values set with nm_platform_sysctl_ifdir_set(), and
+	 * how many of them were skipped because the value was already set. */
+	guint64 n_ifdir_set;
+	guint64 n_ifdir_set_skipped;
+
+	/* the number of per-interface directories that were opened. */
+	guint64 n_ifdir_opened;
+
+	/* the number of system calls for reading and writing sysctl values. */
+	guint64 n_syscalls;
+} NMPlatformSysctlStats;
+
 typedef struct {
 	GObjectClass parent;
 
 	gboolean (*sysctl_set) (NMPlatform *, const char *pathid, int dirfd, const char *path, const char *value);
 	char * (*sysctl_get) (NMPlatform *, const char *pathid, int dirfd, const char *path);
+	int (*sysctl_ifdir_open) (NMPlatform *, int ifindex, const char *ifname, NMPSysctlIfdir ifdir);
 
 	gboolean (*link_add) (NMPlatform *,
 	                      const char *name,
@@ -687,6 +750,7 @@ typedef struct {
 	gboolean (*link_delete) (NMPlatform *, int ifindex);
 
 	gboolean (*link_refresh) (NMPlatform *, int ifindex);
+	void (*link_stats_refresh) (NMPlatform *, const int *ifindexes, guint n_ifindexes);
 
 	gboolean (*link_set_netns) (NMPlatform *, int ifindex, int netns_fd);
 
@@ -820,6 +884,10 @@ typedef struct {
 	                                 const NMPlatformIPRoute *route);
 	gboolean (*ip_route_delete) (NMPlatform *, const NMPObject *obj);
 
+	/* optional. If unset, the requests are performed one by one via
+	 * the ip4/ip6_address_add/delete and ip_route_add/delete functions. */
+	void (*ip_batch) (NMPlatform *, NMPlatformIPBatchOp *ops, guint n_ops);
+
 	NMPlatformError (*ip_route_get) (NMPlatform *self,
 	                                 int addr_family,
 	                                 gconstpointer address,
@@ -846,8 +914,47 @@ typedef struct {
 #define NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED "ip4-route-changed"
 #define NM_PLATFORM_SIGNAL_IP6_ROUTE_CHANGED "ip6-route-changed"
 
+/* "changes-batch" is an alternative to the signals above. It is emitted after
+ * the platform finished processing a batch of changes, for example after
+ * reading from the netlink socket. All changes of one emission have the
+ * same object type. The batch is split into runs of consecutive changes of
+ * the same type, and the runs are emitted in order. So, the order across
+ * types is kept too, for example a new link is announced before its routes.
+ *
+ *   void (*changes_batch) (NMPlatform *platform,
+ *                          int obj_type,
+ *                          const NMPlatformChange *changes,
+ *                          guint n_changes,
+ *                          gpointer user_data);
+ *
+ * The changes are in the order in which they happened, and the same object
+ * may be listed multiple times. The objects are only valid during the
+ * signal handler. */
+#define NM_PLATFORM_SIGNAL_CHANGES_BATCH "changes-batch"
+
 const char *nm_platform_signal_change_type_to_string (NMPlatformSignalChangeType change_type);
 
+void nm_platform_changes_batch_begin (NMPlatform *self);
+void nm_platform_changes_batch_end (NMPlatform *self);
+
+/* @obj is the object that was added, changed or removed. For removal, it is
+ * the object as it was before. */
+typedef void (*NMPlatformObjectChangedFunc) (NMPlatform *platform,
+                                             const NMPObject *obj,
+                                             NMPlatformSignalChangeType change_type,
+                                             gpointer user_data);
+
+void nm_platform_object_subscribe (NMPlatform *self,
+                                   NMPObjectType obj_type,
+                                   int ifindex,
+                                   NMPlatformObjectChangedFunc callback,
+                                   gpointer user_data);
+gboolean nm_platform_object_unsubscribe (NMPlatform *self,
+                                         NMPObjectType obj_type,
+                                         int ifindex,
+                                         NMPlatformObjectChangedFunc callback,
+                                         gpointer user_data);
+
 /*****************************************************************************/
 
 GType nm_platform_get_type (void);
@@ -880,6 +987,49 @@ nm_platform_route_table_coerce (guint32 table)
 	}
 }
 
+typedef struct {
+	guint32 from;
+	guint32 to;
+} NMPlatformIPRouteTableRange;
+
+/* Routes that the platform ignores entirely. They are not put into the cache
+ * and nm_platform_ip_route_sync() never deletes them. See
+ * NM_PLATFORM_IGNORE_ROUTE_TABLES and NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS. */
+typedef struct {
+	/* bitmaps of the ignored tables below 256 and of the ignored
+	 * route protocols (rtm_protocol). */
+	guint32 tables[256 / 32];
+	guint32 protocols[256 / 32];
+
+	/* ignored tables from 256 on, sorted by their start. */
+	guint n_table_ranges;
+	NMPlatformIPRouteTableRange *table_ranges;
+} NMPlatformIPRouteFilter;
+
+static inline gboolean
+nm_platform_ip_route_filter_ignores_protocol (const NMPlatformIPRouteFilter *filter, guint8 protocol)
+{
+	return NM_FLAGS_ANY (filter->protocols[protocol / 32], 1u << (protocol % 32));
+}
+
+/* @table is the uncoerced table, like RTA_TABLE. */
+static inline gboolean
+nm_platform_ip_route_filter_ignores_table (const NMPlatformIPRouteFilter *filter, guint32 table)
+{
+	guint i;
+
+	if (table < 256)
+		return NM_FLAGS_ANY (filter->tables[table / 32], 1u << (table % 32));
+
+	for (i = 0; i < filter->n_table_ranges; i++) {
+		if (table < filter->table_ranges[i].from)
+			break;
+		if (table <= filter->table_ranges[i].to)
+			return TRUE;
+	}
+	return FALSE;
+}
+
 /**
  * nm_platform_route_scope_inv:
  * @scope: the route scope, either its original value, or its inverse.
@@ -899,6 +1049,7 @@ _nm_platform_uint8_inv (guint8 scope)
 
 gboolean nm_platform_get_use_udev (NMPlatform *self);
 gboolean nm_platform_get_log_with_ptr (NMPlatform *self);
+const NMPlatformIPRouteFilter *nm_platform_get_ip_route_filter (NMPlatform *self);
 
 NMPNetns *nm_platform_netns_get (NMPlatform *self);
 gboolean nm_platform_netns_push (NMPlatform *platform, NMPNetns **netns);
@@ -930,6 +1081,14 @@ char *nm_platform_sysctl_get (NMPlatform *self, const char *pathid, int dirfd, c
 gint32 nm_platform_sysctl_get_int32 (NMPlatform *self, const char *pathid, int dirfd, const char *path, gint32 fallback);
 gint64 nm_platform_sysctl_get_int_checked (NMPlatform *self, const char *pathid, int dirfd, const char *path, guint base, gint64 min, gint64 max, gint64 fallback);
 
+gboolean nm_platform_sysctl_ifdir_set (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property, const char *value);
+gboolean nm_platform_sysctl_ifdir_set_batch (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const NMPlatformSysctlEntry *entries, guint n_entries);
+char *nm_platform_sysctl_ifdir_get (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property);
+gint64 nm_platform_sysctl_ifdir_get_int_checked (NMPlatform *self, int ifindex, NMPSysctlIfdir ifdir, const char *property, guint base, gint64 min, gint64 max, gint64 fallback);
+void nm_platform_sysctl_ifdir_invalidate (NMPlatform *self, int ifindex);
+
+void nm_platform_sysctl_get_stats (NMPlatform *self, NMPlatformSysctlStats *out_stats);
+
 gboolean nm_platform_sysctl_set_ip6_hop_limit_safe (NMPlatform *self, const char *iface, int value);
 
 const char *nm_platform_if_indextoname (NMPlatform *self, int ifindex, char *out_ifname/* of size IFNAMSIZ */);
@@ -958,6 +1117,9 @@ struct _NMPLookup;
 const struct _NMDedupMultiHeadEntry *nm_platform_lookup (NMPlatform *platform,
                                                          const struct _NMPLookup *lookup);
 
+guint64 nm_platform_get_cache_generation (NMPlatform *self);
+guint64 nm_platform_get_addrroute_generation (NMPlatform *self, int ifindex);
+
 gboolean nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel (const NMPObject *obj,
                                                                       gpointer user_data);
 gboolean nm_platform_lookup_predicate_routes_skip_rtprot_kernel (const NMPObject *obj,
@@ -988,6 +1150,8 @@ gboolean nm_platform_link_supports_slaves (NMPlatform *self, int ifindex);
 const char *nm_platform_link_get_type_name (NMPlatform *self, int ifindex);
 
 gboolean nm_platform_link_refresh (NMPlatform *self, int ifindex);
+void nm_platform_link_stats_subscribe (NMPlatform *self, int ifindex, guint refresh_rate_ms);
+void nm_platform_link_stats_unsubscribe (NMPlatform *self, int ifindex, guint refresh_rate_ms);
 void nm_platform_process_events (NMPlatform *self);
 
 gboolean nm_platform_link_set_up (NMPlatform *self, int ifindex, gboolean *out_no_firmware);
@@ -1173,12 +1337,33 @@ NMPlatformError nm_platform_ip6_route_add (NMPlatform *self, NMPNlmFlags flags,
 
 gboolean nm_platform_ip_route_delete (NMPlatform *self, const NMPObject *route);
 
+gboolean nm_platform_ip_route_is_ignored (NMPlatform *self, const NMPlatformIPRoute *route);
+
+void nm_platform_ip_batch (NMPlatform *self,
+                           NMPlatformIPBatchOp *ops,
+                           guint n_ops);
+
 gboolean nm_platform_ip_route_sync (NMPlatform *self,
                                     int addr_family,
                                     int ifindex,
                                     GPtrArray *routes,
+                                    NMPObjectPredicateFunc routes_keep_predicate,
+                                    gpointer routes_keep_userdata,
                                     NMPObjectPredicateFunc kernel_delete_predicate,
                                     gpointer kernel_delete_userdata);
+gboolean nm_platform_ip_route_sync_delta (NMPlatform *self,
+                                          int addr_family,
+                                          int ifindex,
+                                          const GPtrArray *routes_del,
+                                          GPtrArray *routes_add,
+                                          NMPObjectPredicateFunc kernel_delete_predicate,
+                                          gpointer kernel_delete_userdata);
+gboolean nm_platform_ip_route_is_synced (NMPlatform *self,
+                                         int addr_family,
+                                         int ifindex,
+                                         GHashTable *routes_idx,
+                                         NMPObjectPredicateFunc kernel_delete_predicate,
+                                         gpointer kernel_delete_userdata);
 gboolean nm_platform_ip_route_flush (NMPlatform *self,
                                      int addr_family,
                                      int ifindex);
@@ -24,6 +24,7 @@
 #include <fcntl.h>
 #include <errno.h>
 #include <sys/mount.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 
@@ -93,6 +94,9 @@ NM_GOBJECT_PROPERTIES_DEFINE_BASE (
 typedef struct {
 	int fd_net;
 	int fd_mnt;
+
+	/* a socket in the network namespace, for ioctl(). */
+	int fd_ioctl;
 } NMPNetnsPrivate;
 
 struct _NMPNetns {
@@ -416,6 +420,33 @@ nmp_netns_get_fd_mnt (NMPNetns *self)
 	return NMP_NETNS_GET_PRIVATE (self)->fd_mnt;
 }
 
+/**
+ * nmp_netns_get_fd_ioctl:
+ * @self: the netns instance, which must be the current one.
+ *
+ * Returns: an AF_INET datagram socket in the network namespace of @self,
+ *   for issuing ioctl() requests like SIOCETHTOOL. The socket is created
+ *   on first use and stays open until @self is destroyed. On failure,
+ *   -1 is returned and errno is set.
+ */
+int
+nmp_netns_get_fd_ioctl (NMPNetns *self)
+{
+	NMPNetnsPrivate *priv;
+
+	g_return_val_if_fail (NMP_IS_NETNS (self), -1);
+
+	priv = NMP_NETNS_GET_PRIVATE (self);
+
+	if (priv->fd_ioctl < 0) {
+		/* the socket belongs to the namespace in which it gets created. */
+		nm_assert (nmp_netns_get_current () == self);
+
+		priv->fd_ioctl = socket (PF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	}
+	return priv->fd_ioctl;
+}
+
 /*****************************************************************************/
 
 static gboolean
@@ -694,6 +725,7 @@ set_property (GObject *object, guint prop_id,
 static void
 nmp_netns_init (NMPNetns *self)
 {
+	NMP_NETNS_GET_PRIVATE (self)->fd_ioctl = -1;
 }
 
 static void
@@ -712,6 +744,11 @@ dispose (GObject *object)
 		priv->fd_mnt = 0;
 	}
 
+	if (priv->fd_ioctl >= 0) {
+		close (priv->fd_ioctl);
+		priv->fd_ioctl = -1;
+	}
+
 	G_OBJECT_CLASS (nmp_netns_parent_class)->dispose (object);
 }
 
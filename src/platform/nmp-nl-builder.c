@@ -0,0 +1,300 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* nmp-nl-builder.c - Build netlink requests into a reusable buffer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nmp-nl-builder.h"
+
+#include <string.h>
+#include <netlink/errno.h>
+
+/*****************************************************************************/
+
+void
+nmp_nl_builder_init (NMPNlBuilder *builder, gsize initial_size)
+{
+	nm_assert (builder);
+
+	*builder = (NMPNlBuilder) {
+		.buf = initial_size > 0 ? g_malloc (initial_size) : NULL,
+		.allocated = initial_size,
+		.msg_offset = G_MAXSIZE,
+	};
+}
+
+/**
+ * nmp_nl_builder_init_static:
+ * @builder: the builder to initialize
+ * @buf: the buffer to use, for example on the stack
+ * @buf_len: the size of @buf
+ *
+ * Initialize @builder to build into @buf. Only if the messages don't
+ * fit into @buf, a buffer on the heap is allocated. Note that @builder
+ * still must be cleared with nmp_nl_builder_clear().
+ */
+void
+nmp_nl_builder_init_static (NMPNlBuilder *builder, gpointer buf, gsize buf_len)
+{
+	nm_assert (builder);
+	nm_assert (buf || buf_len == 0);
+
+	*builder = (NMPNlBuilder) {
+		.buf = buf,
+		.allocated = buf_len,
+		.msg_offset = G_MAXSIZE,
+		.buf_static = TRUE,
+	};
+}
+
+void
+nmp_nl_builder_clear (NMPNlBuilder *builder)
+{
+	nm_assert (builder);
+
+	if (!builder->buf_static)
+		g_free (builder->buf);
+	builder->buf = NULL;
+	builder->len = 0;
+	builder->allocated = 0;
+	builder->n_msgs = 0;
+	builder->msg_offset = G_MAXSIZE;
+	builder->buf_static = FALSE;
+}
+
+/**
+ * nmp_nl_builder_reset:
+ * @builder: the builder
+ *
+ * Drop all messages, but keep the buffer for reuse.
+ */
+void
+nmp_nl_builder_reset (NMPNlBuilder *builder)
+{
+	nm_assert (builder);
+
+	builder->len = 0;
+	builder->n_msgs = 0;
+	builder->msg_offset = G_MAXSIZE;
+}
+
+static void
+_reserve (NMPNlBuilder *builder, gsize len)
+{
+	gsize allocated;
+
+	if (G_LIKELY (builder->len + len <= builder->allocated))
+		return;
+
+	allocated = MAX (MAX (builder->allocated * 2, builder->len + len), (gsize) 256);
+	if (builder->buf_static) {
+		guint8 *buf;
+
+		buf = g_malloc (allocated);
+		if (builder->len > 0)
+			memcpy (buf, builder->buf, builder->len);
+		builder->buf = buf;
+		builder->buf_static = FALSE;
+	} else
+		builder->buf = g_realloc (builder->buf, allocated);
+	builder->allocated = allocated;
+}
+
+/*****************************************************************************/
+
+/**
+ * nmp_nl_builder_msg_begin:
+ * @builder: the builder
+ * @nlmsg_type: the netlink message type
+ * @nlmsg_flags: the netlink message flags
+ * @family_hdr: the family specific header (for example a struct rtmsg)
+ * @family_hdr_len: the size of @family_hdr
+ * @attrs_len: the size of all attributes that will be added to the
+ *   message. Use NMP_NL_BUILDER_ATTR_SIZE() to calculate it.
+ *
+ * Start a new message and reserve the space for it. Complete the message
+ * with nmp_nl_builder_msg_end(), after adding the attributes.
+ *
+ * The sequence number and port ID are left zero. They are set by whoever
+ * sends the message.
+ *
+ * Returns: the header of the new message. The pointer is only valid until
+ *   the next message is started.
+ */
+struct nlmsghdr *
+nmp_nl_builder_msg_begin (NMPNlBuilder *builder,
+                          guint16 nlmsg_type,
+                          guint16 nlmsg_flags,
+                          gconstpointer family_hdr,
+                          gsize family_hdr_len,
+                          gsize attrs_len)
+{
+	struct nlmsghdr *nlhdr;
+	gsize msg_len;
+
+	nm_assert (builder);
+	nm_assert (builder->msg_offset == G_MAXSIZE);
+	nm_assert (builder->len == NLMSG_ALIGN (builder->len));
+	nm_assert (family_hdr || family_hdr_len == 0);
+	nm_assert (attrs_len == NLA_ALIGN (attrs_len));
+
+	msg_len = NLMSG_HDRLEN + NLMSG_ALIGN (family_hdr_len) + attrs_len;
+
+	_reserve (builder, msg_len);
+
+	builder->msg_offset = builder->len;
+	builder->msg_reserved_end = builder->len + msg_len;
+
+	nlhdr = (struct nlmsghdr *) &builder->buf[builder->len];
+	*nlhdr = (struct nlmsghdr) {
+		.nlmsg_len = NLMSG_HDRLEN,
+		.nlmsg_type = nlmsg_type,
+		.nlmsg_flags = nlmsg_flags,
+	};
+	builder->len += NLMSG_HDRLEN;
+
+	if (family_hdr_len > 0) {
+		memcpy (&builder->buf[builder->len], family_hdr, family_hdr_len);
+		memset (&builder->buf[builder->len + family_hdr_len], 0, NLMSG_ALIGN (family_hdr_len) - family_hdr_len);
+		builder->len += NLMSG_ALIGN (family_hdr_len);
+	}
+
+	return nlhdr;
+}
+
+void
+nmp_nl_builder_msg_end (NMPNlBuilder *builder)
+{
+	struct nlmsghdr *nlhdr;
+
+	nm_assert (builder);
+	nm_assert (builder->msg_offset != G_MAXSIZE);
+
+	/* the caller must announce the exact size in nmp_nl_builder_msg_begin(). */
+	nm_assert (builder->len == builder->msg_reserved_end);
+
+	nlhdr = (struct nlmsghdr *) &builder->buf[builder->msg_offset];
+	nlhdr->nlmsg_len = builder->len - builder->msg_offset;
+
+	builder->msg_offset = G_MAXSIZE;
+	builder->n_msgs++;
+}
+
+/**
+ * nmp_nl_builder_msg_cancel:
+ * @builder: the builder
+ *
+ * Drop the message that was started with nmp_nl_builder_msg_begin(),
+ * for example because an attribute didn't fit. The completed messages
+ * are kept.
+ */
+void
+nmp_nl_builder_msg_cancel (NMPNlBuilder *builder)
+{
+	nm_assert (builder);
+	nm_assert (builder->msg_offset != G_MAXSIZE);
+
+	builder->len = builder->msg_offset;
+	builder->msg_offset = G_MAXSIZE;
+}
+
+/*****************************************************************************/
+
+/**
+ * nmp_nl_builder_put:
+ * @builder: the builder
+ * @attrtype: the attribute type
+ * @data: the payload of the attribute
+ * @data_len: the length of @data
+ *
+ * Append an attribute to the current message.
+ *
+ * Returns: 0 on success, or -NLE_NOMEM if the attribute doesn't fit
+ *   into the space reserved by nmp_nl_builder_msg_begin(). In that case,
+ *   the message is left unchanged.
+ */
+int
+nmp_nl_builder_put (NMPNlBuilder *builder,
+                    guint16 attrtype,
+                    gconstpointer data,
+                    gsize data_len)
+{
+	struct nlattr *nla;
+	gsize attr_len;
+
+	nm_assert (builder);
+	nm_assert (builder->msg_offset != G_MAXSIZE);
+	nm_assert (builder->len <= builder->msg_reserved_end);
+	nm_assert (data || data_len == 0);
+
+	if (data_len > G_MAXUINT16 - NLA_HDRLEN)
+		return -NLE_NOMEM;
+	attr_len = NMP_NL_BUILDER_ATTR_SIZE (data_len);
+	if (attr_len > builder->msg_reserved_end - builder->len)
+		return -NLE_NOMEM;
+
+	nla = (struct nlattr *) &builder->buf[builder->len];
+	nla->nla_type = attrtype;
+	nla->nla_len = NLA_HDRLEN + data_len;
+	if (data_len > 0)
+		memcpy (&builder->buf[builder->len + NLA_HDRLEN], data, data_len);
+	if (attr_len > NLA_HDRLEN + data_len)
+		memset (&builder->buf[builder->len + NLA_HDRLEN + data_len], 0, attr_len - (NLA_HDRLEN + data_len));
+	builder->len += attr_len;
+	return 0;
+}
+
+/**
+ * nmp_nl_builder_nest_start:
+ * @builder: the builder
+ * @attrtype: the type of the nested attribute
+ *
+ * Start a nested attribute. The attributes added afterwards are
+ * part of the nested attribute, until nmp_nl_builder_nest_end()
+ * is called.
+ *
+ * Returns: the offset of the nested attribute, to be passed
+ *   to nmp_nl_builder_nest_end(), or 0 if the attribute doesn't fit.
+ */
+gsize
+nmp_nl_builder_nest_start (NMPNlBuilder *builder, guint16 attrtype)
+{
+	gsize nest_offset;
+
+	nm_assert (builder);
+
+	nest_offset = builder->len;
+	if (nmp_nl_builder_put (builder, attrtype, NULL, 0) < 0)
+		return 0;
+	return nest_offset;
+}
+
+void
+nmp_nl_builder_nest_end (NMPNlBuilder *builder, gsize nest_offset)
+{
+	struct nlattr *nla;
+
+	nm_assert (builder);
+	nm_assert (builder->msg_offset != G_MAXSIZE);
+	nm_assert (nest_offset > builder->msg_offset);
+	nm_assert (nest_offset + NLA_HDRLEN <= builder->len);
+
+	nla = (struct nlattr *) &builder->buf[nest_offset];
+	nla->nla_len = builder->len - nest_offset;
+}
@@ -0,0 +1,143 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* nmp-nl-builder.h - Build netlink requests into a reusable buffer
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#ifndef __NMP_NL_BUILDER_H__
+#define __NMP_NL_BUILDER_H__
+
+#include <linux/netlink.h>
+
+/*****************************************************************************/
+
+/* NMPNlBuilder appends netlink messages back-to-back into one buffer, so
+ * that several requests can be sent with one sendmsg(). The buffer is kept
+ * when resetting the builder, to be reused for the next requests.
+ *
+ * The caller passes the exact size of the attributes when starting a
+ * message, so that adding the attributes afterwards never reallocates.
+ * Attributes that don't fit into the reserved space are rejected, like
+ * nla_put() does. Then the caller drops the incomplete message with
+ * nmp_nl_builder_msg_cancel(). */
+
+typedef struct {
+	guint8 *buf;
+	gsize len;
+	gsize allocated;
+
+	/* offset of the message that is currently built, or G_MAXSIZE. */
+	gsize msg_offset;
+	gsize msg_reserved_end;
+
+	guint n_msgs;
+
+	/* whether @buf is not owned by the builder, see nmp_nl_builder_init_static(). */
+	bool buf_static:1;
+} NMPNlBuilder;
+
+/* the size that an attribute with a payload of @payload_len takes. */
+#define NMP_NL_BUILDER_ATTR_SIZE(payload_len) NLA_ALIGN (NLA_HDRLEN + (payload_len))
+
+void nmp_nl_builder_init (NMPNlBuilder *builder, gsize initial_size);
+void nmp_nl_builder_init_static (NMPNlBuilder *builder, gpointer buf, gsize buf_len);
+void nmp_nl_builder_clear (NMPNlBuilder *builder);
+void nmp_nl_builder_reset (NMPNlBuilder *builder);
+
+struct nlmsghdr *nmp_nl_builder_msg_begin (NMPNlBuilder *builder,
+                                           guint16 nlmsg_type,
+                                           guint16 nlmsg_flags,
+                                           gconstpointer family_hdr,
+                                           gsize family_hdr_len,
+                                           gsize attrs_len);
+void nmp_nl_builder_msg_end (NMPNlBuilder *builder);
+void nmp_nl_builder_msg_cancel (NMPNlBuilder *builder);
+
+int nmp_nl_builder_put (NMPNlBuilder *builder,
+                        guint16 attrtype,
+                        gconstpointer data,
+                        gsize data_len);
+
+static inline int
+nmp_nl_builder_put_u32 (NMPNlBuilder *builder, guint16 attrtype, guint32 val)
+{
+	return nmp_nl_builder_put (builder, attrtype, &val, sizeof (val));
+}
+
+static inline int
+nmp_nl_builder_put_string (NMPNlBuilder *builder, guint16 attrtype, const char *str)
+{
+	return nmp_nl_builder_put (builder, attrtype, str, strlen (str) + 1);
+}
+
+/* like libnl's NLA_PUT(), jump to nla_put_failure if the attribute
+ * doesn't fit. */
+#define NMP_NL_BUILDER_PUT(builder, attrtype, data, data_len) \
+	G_STMT_START { \
+		if (nmp_nl_builder_put ((builder), (attrtype), (data), (data_len)) < 0) \
+			goto nla_put_failure; \
+	} G_STMT_END
+
+#define NMP_NL_BUILDER_PUT_U32(builder, attrtype, val) \
+	G_STMT_START { \
+		if (nmp_nl_builder_put_u32 ((builder), (attrtype), (val)) < 0) \
+			goto nla_put_failure; \
+	} G_STMT_END
+
+#define NMP_NL_BUILDER_PUT_STRING(builder, attrtype, str) \
+	G_STMT_START { \
+		if (nmp_nl_builder_put_string ((builder), (attrtype), (str)) < 0) \
+			goto nla_put_failure; \
+	} G_STMT_END
+
+gsize nmp_nl_builder_nest_start (NMPNlBuilder *builder, guint16 attrtype);
+void nmp_nl_builder_nest_end (NMPNlBuilder *builder, gsize nest_offset);
+
+static inline guint
+nmp_nl_builder_get_n_msgs (const NMPNlBuilder *builder)
+{
+	return builder->n_msgs;
+}
+
+/* returns the first of the completed messages, which follow each other
+ * in the buffer. @out_len is set to the length of all of them. */
+static inline struct nlmsghdr *
+nmp_nl_builder_get_msgs (const NMPNlBuilder *builder, gsize *out_len)
+{
+	nm_assert (builder->msg_offset == G_MAXSIZE);
+
+	NM_SET_OUT (out_len, builder->len);
+	return builder->n_msgs > 0
+	       ? (struct nlmsghdr *) builder->buf
+	       : NULL;
+}
+
+#define nm_auto_nl_builder nm_auto(nmp_nl_builder_clear)
+
+/* defines a builder @name, that builds into a buffer of @size bytes on the
+ * stack. Only if the messages don't fit, the builder allocates a buffer
+ * on the heap, which is freed when @name goes out of scope. */
+#define NMP_NL_BUILDER_DEFINE_STACK(name, size) \
+	guint32 name##_buf[((size) + 3) / 4]; \
+	nm_auto_nl_builder NMPNlBuilder name = { \
+		.buf = (guint8 *) name##_buf, \
+		.allocated = sizeof (name##_buf), \
+		.msg_offset = G_MAXSIZE, \
+		.buf_static = TRUE, \
+	}
+
+#endif /* __NMP_NL_BUILDER_H__ */
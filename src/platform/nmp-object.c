@@ -80,6 +80,16 @@ struct _NMPCache {
 	DedupMultiIdxType idx_types[NMP_CACHE_ID_TYPE_MAX];
 
 	gboolean use_udev;
+
+	/* incremented whenever an object is added, updated or removed. */
+	guint64 generation;
+
+	/* a counter per ifindex, that changes whenever an address or route
+	 * of that interface is added, updated or removed. It takes the value
+	 * of @generation, so that the counter of an ifindex never returns to
+	 * a previous value, even after the link was removed and the entry
+	 * dropped. */
+	GHashTable *addrroute_generations;
 };
 
 /*****************************************************************************/
@@ -239,6 +249,35 @@ _idx_obj_part (const DedupMultiIdxType *idx_type,
 		}
 		return 1;
 
+	case NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION:
+		obj_type = NMP_OBJECT_GET_TYPE (obj_a);
+		if (   !NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ROUTE,
+		                             NMP_OBJECT_TYPE_IP6_ROUTE)
+		    || obj_a->object.ifindex <= 0)
+			return 0;
+		if (obj_b) {
+			return    obj_type == NMP_OBJECT_GET_TYPE (obj_b)
+			       && obj_b->object.ifindex > 0
+			       && obj_a->ip_route.table_coerced == obj_b->ip_route.table_coerced
+			       && obj_a->ip_route.plen == obj_b->ip_route.plen
+			       && (obj_type == NMP_OBJECT_TYPE_IP4_ROUTE
+			           ? (nm_utils_ip4_address_clear_host_address (obj_a->ip4_route.network, obj_a->ip_route.plen)
+			              == nm_utils_ip4_address_clear_host_address (obj_b->ip4_route.network, obj_b->ip_route.plen))
+			           : nm_utils_ip6_address_same_prefix (&obj_a->ip6_route.network, &obj_b->ip6_route.network, obj_a->ip_route.plen));
+		}
+		if (request_hash) {
+			h = (guint) idx_type->cache_id_type;
+			h = NM_HASH_COMBINE (h, obj_type);
+			h = NM_HASH_COMBINE (h, obj_a->ip_route.table_coerced);
+			h = NM_HASH_COMBINE (h, obj_a->ip_route.plen);
+			if (obj_type == NMP_OBJECT_TYPE_IP4_ROUTE)
+				h = NM_HASH_COMBINE (h, nm_utils_ip4_address_clear_host_address (obj_a->ip4_route.network, obj_a->ip_route.plen));
+			else
+				h = NM_HASH_COMBINE_IN6ADDR_PREFIX (h, &obj_a->ip6_route.network, obj_a->ip_route.plen);
+			return _HASH_NON_ZERO (h);
+		}
+		return 1;
+
 	case NMP_CACHE_ID_TYPE_NONE:
 	case __NMP_CACHE_ID_TYPE_MAX:
 		break;
@@ -347,21 +386,31 @@ _vlan_xgress_qos_mappings_cpy (guint *dst_n_map,
 /*****************************************************************************/
 
 static const char *
-_link_get_driver (struct udev_device *udevice, const char *kind, int ifindex)
+_link_get_driver (struct udev_device *udevice, const char *kind, int ifindex, gboolean use_udev)
 {
 	const char *driver = NULL;
 
 	nm_assert (kind == g_intern_string (kind));
 
 	if (udevice) {
+		/* intern the driver, so that it outlives the udev device and
+		 * NM_CMP_FIELD_STR_INTERNED() can compare it by pointer. */
 		driver = nmp_utils_udev_get_driver (udevice);
 		if (driver)
-			return driver;
+			return g_intern_string (driver);
 	}
 
 	if (kind)
 		return kind;
 
+	/* Without udev device, a link is not yet initialized and nobody cares
+	 * about the driver. Defer the ethtool request until the udev device
+	 * shows up. For veth, macvlan and the like we never get here, because
+	 * they have a kind. */
+	if (   use_udev
+	    && !udevice)
+		return "unknown";
+
 	if (ifindex > 0) {
 		NMPUtilsEthtoolDriverInfo driver_info;
 
@@ -374,8 +423,18 @@ _link_get_driver (struct udev_device *udevice, const char *kind, int ifindex)
 	return "unknown";
 }
 
+/**
+ * _nmp_object_fixup_link_udev_fields:
+ * @obj_new: (inout): the link object to fix up. If %NULL, @obj_orig is
+ *   cloned when it needs an update.
+ * @obj_orig: (allow-none): the link object to fix up, if @obj_new is %NULL.
+ * @obj_prev: (allow-none): the previous version of the link in the cache.
+ *   If it has the same udev device and kind, its driver is reused
+ *   instead of asking udev and ethtool again.
+ * @use_udev: whether the cache uses udev.
+ */
 void
-_nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, gboolean use_udev)
+_nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, const NMPObject *obj_prev, gboolean use_udev)
 {
 	const char *driver = NULL;
 	gboolean initialized = FALSE;
@@ -385,6 +444,7 @@ _nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, gb
 	nm_assert (obj_new);
 	nm_assert (!obj_orig || NMP_OBJECT_GET_TYPE (obj_orig) == NMP_OBJECT_TYPE_LINK);
 	nm_assert (!*obj_new || NMP_OBJECT_GET_TYPE (*obj_new) == NMP_OBJECT_TYPE_LINK);
+	nm_assert (!obj_prev || NMP_OBJECT_GET_TYPE (obj_prev) == NMP_OBJECT_TYPE_LINK);
 
 	obj = *obj_new ?: obj_orig;
 
@@ -393,9 +453,19 @@ _nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, gb
 
 	/* When a link is not in netlink, it's udev fields don't matter. */
 	if (obj->_link.netlink.is_in_netlink) {
-		driver = _link_get_driver (obj->_link.udev.device,
-		                           obj->link.kind,
-		                           obj->link.ifindex);
+		if (   obj_prev
+		    && obj_prev->_link.netlink.is_in_netlink
+		    && obj_prev->link.driver
+		    && obj_prev->link.ifindex == obj->link.ifindex
+		    && obj_prev->_link.udev.device == obj->_link.udev.device
+		    && obj_prev->link.kind == obj->link.kind)
+			driver = obj_prev->link.driver;
+		else {
+			driver = _link_get_driver (obj->_link.udev.device,
+			                           obj->link.kind,
+			                           obj->link.ifindex,
+			                           use_udev);
+		}
 		if (obj->_link.udev.device)
 			initialized = TRUE;
 		else if (!use_udev) {
@@ -469,6 +539,213 @@ _vt_cmd_obj_dispose_lnk_vlan (NMPObject *obj)
 	g_free ((gpointer) obj->_lnk_vlan.egress_qos_map);
 }
 
+/*****************************************************************************/
+
+/* NMPObject instances are allocated from one pool per object type. A pool
+ * carves the objects out of slabs of POOL_SLAB_SIZE bytes, which are aligned to
+ * their size, so that the slab of an object is found by masking its address.
+ * Every slab has a free list of released objects. Slabs that have free
+ * objects are linked in the pool, completely unused slabs are returned to
+ * the system (except one, to avoid thrashing).
+ *
+ * The pools are not thread-safe, like the platform cache itself.
+ *
+ * When running with G_SLICE=always-malloc (like under valgrind), the pools
+ * are bypassed and every object is allocated individually. */
+
+#define POOL_SLAB_SIZE     ((gsize) (64 * 1024))
+#define POOL_ALIGN         ((gsize) 16)
+#define POOL_ALIGN_UP(s)   (((s) + POOL_ALIGN - 1) & ~(POOL_ALIGN - 1))
+
+typedef struct _NMPObjectPoolSlab NMPObjectPoolSlab;
+
+typedef struct {
+	/* slabs that have unused objects. */
+	NMPObjectPoolSlab *slabs_partial;
+
+	/* one completely unused slab is kept around. */
+	NMPObjectPoolSlab *slab_unused;
+
+	/* the size class of the objects (the object size, aligned) */
+	gsize obj_size;
+	guint n_per_slab;
+
+	NMPObjectPoolStats stats;
+} NMPObjectPool;
+
+struct _NMPObjectPoolSlab {
+	NMPObjectPool *pool;
+	NMPObjectPoolSlab *prev;
+	NMPObjectPoolSlab *next;
+	gpointer free_list;
+	guint n_used;
+
+	/* the objects after @n_carved were never handed out. */
+	guint n_carved;
+};
+
+#define POOL_SLAB_HEADER_SIZE  POOL_ALIGN_UP (sizeof (NMPObjectPoolSlab))
+
+static NMPObjectPool _pools[NMP_OBJECT_TYPE_MAX];
+
+static gboolean
+_pools_enabled (void)
+{
+	static int enabled = -1;
+
+	if (G_UNLIKELY (enabled == -1)) {
+		const char *env = g_getenv ("G_SLICE");
+
+		enabled = !env || !strstr (env, "always-malloc");
+	}
+	return enabled;
+}
+
+static void
+_pool_slab_link (NMPObjectPoolSlab *slab)
+{
+	NMPObjectPool *pool = slab->pool;
+
+	slab->prev = NULL;
+	slab->next = pool->slabs_partial;
+	if (pool->slabs_partial)
+		pool->slabs_partial->prev = slab;
+	pool->slabs_partial = slab;
+}
+
+static void
+_pool_slab_unlink (NMPObjectPoolSlab *slab)
+{
+	NMPObjectPool *pool = slab->pool;
+
+	if (slab->prev)
+		slab->prev->next = slab->next;
+	else {
+		nm_assert (pool->slabs_partial == slab);
+		pool->slabs_partial = slab->next;
+	}
+	if (slab->next)
+		slab->next->prev = slab->prev;
+	slab->prev = NULL;
+	slab->next = NULL;
+}
+
+static gpointer
+_pool_alloc0 (const NMPClass *klass)
+{
+	const gsize size = klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object);
+	NMPObjectPool *pool = &_pools[klass->obj_type - 1];
+	NMPObjectPoolSlab *slab;
+	gpointer obj;
+
+	pool->stats.n_objects++;
+	pool->stats.n_bytes += size;
+
+	if (!_pools_enabled ())
+		return g_slice_alloc0 (size);
+
+	if (G_UNLIKELY (!pool->obj_size)) {
+		pool->obj_size = POOL_ALIGN_UP (size);
+		pool->n_per_slab = (POOL_SLAB_SIZE - POOL_SLAB_HEADER_SIZE) / pool->obj_size;
+		nm_assert (pool->n_per_slab > 1);
+	}
+
+	slab = pool->slabs_partial;
+	if (!slab) {
+		if (pool->slab_unused) {
+			slab = pool->slab_unused;
+			pool->slab_unused = NULL;
+		} else {
+			gpointer mem;
+
+			if (posix_memalign (&mem, POOL_SLAB_SIZE, POOL_SLAB_SIZE) != 0)
+				g_error ("%s: failed to allocate %zu bytes", G_STRLOC, POOL_SLAB_SIZE);
+			slab = mem;
+			slab->pool = pool;
+			slab->free_list = NULL;
+			slab->n_used = 0;
+			slab->n_carved = 0;
+			pool->stats.n_slabs++;
+		}
+		_pool_slab_link (slab);
+	}
+
+	if (slab->free_list) {
+		obj = slab->free_list;
+		slab->free_list = *((gpointer *) obj);
+	} else {
+		nm_assert (slab->n_carved < pool->n_per_slab);
+		obj = &((char *) slab)[POOL_SLAB_HEADER_SIZE + (slab->n_carved++ * pool->obj_size)];
+	}
+
+	if (++slab->n_used == pool->n_per_slab)
+		_pool_slab_unlink (slab);
+
+	memset (obj, 0, size);
+	return obj;
+}
+
+static void
+_pool_free (const NMPClass *klass, gpointer obj)
+{
+	const gsize size = klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object);
+	NMPObjectPool *pool = &_pools[klass->obj_type - 1];
+	NMPObjectPoolSlab *slab;
+
+	nm_assert (pool->stats.n_objects > 0);
+	pool->stats.n_objects--;
+	pool->stats.n_bytes -= size;
+
+	if (!_pools_enabled ()) {
+		g_slice_free1 (size, obj);
+		return;
+	}
+
+	slab = (NMPObjectPoolSlab *) (((guintptr) obj) & ~((guintptr) (POOL_SLAB_SIZE - 1)));
+	nm_assert (slab->pool == pool);
+	nm_assert (slab->n_used > 0);
+
+	if (slab->n_used == pool->n_per_slab)
+		_pool_slab_link (slab);
+
+	*((gpointer *) obj) = slab->free_list;
+	slab->free_list = obj;
+
+	if (--slab->n_used > 0)
+		return;
+
+	_pool_slab_unlink (slab);
+	if (!pool->slab_unused) {
+		slab->free_list = NULL;
+		slab->n_carved = 0;
+		pool->slab_unused = slab;
+	} else {
+		pool->stats.n_slabs--;
+		free (slab);
+	}
+}
+
+/**
+ * nmp_object_pool_get_stats:
+ * @obj_type: the object type
+ * @out_stats: (out): the number of live objects of type @obj_type and
+ *   their size, and the slabs that are allocated for them.
+ */
+void
+nmp_object_pool_get_stats (NMPObjectType obj_type, NMPObjectPoolStats *out_stats)
+{
+	const NMPObjectPool *pool;
+
+	g_return_if_fail (obj_type > NMP_OBJECT_TYPE_UNKNOWN && obj_type <= NMP_OBJECT_TYPE_MAX);
+	g_return_if_fail (out_stats);
+
+	pool = &_pools[obj_type - 1];
+	*out_stats = pool->stats;
+	out_stats->n_bytes_slabs = pool->stats.n_slabs * POOL_SLAB_SIZE;
+}
+
+/*****************************************************************************/
+
 static NMPObject *
 _nmp_object_new_from_class (const NMPClass *klass)
 {
@@ -478,7 +755,7 @@ _nmp_object_new_from_class (const NMPClass *klass)
 	nm_assert (klass->sizeof_data > 0);
 	nm_assert (klass->sizeof_public > 0 && klass->sizeof_public <= klass->sizeof_data);
 
-	obj = g_slice_alloc0 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object));
+	obj = _pool_alloc0 (klass);
 	obj->_class = klass;
 	obj->parent._ref_count = 1;
 	return obj;
@@ -754,6 +1031,9 @@ nmp_object_hash (const NMPObject *obj)
 
 	g_return_val_if_fail (NMP_OBJECT_IS_VALID (obj), 0);
 
+	if (obj->parent._hash_full)
+		return obj->parent._hash_full;
+
 	klass = NMP_OBJECT_GET_CLASS (obj);
 
 	if (klass->cmd_obj_hash)
@@ -876,6 +1156,12 @@ _vt_cmd_obj_cmp_lnk_vlan (const NMPObject *obj1, const NMPObject *obj2)
 gboolean
 nmp_object_equal (const NMPObject *obj1, const NMPObject *obj2)
 {
+	if (obj1 == obj2)
+		return TRUE;
+	if (   obj1
+	    && obj2
+	    && !nm_dedup_multi_obj_hash_maybe_equal (&obj1->parent, &obj2->parent))
+		return FALSE;
 	return nmp_object_cmp (obj1, obj2) == 0;
 }
 
@@ -894,6 +1180,9 @@ nmp_object_copy (NMPObject *dst, const NMPObject *src, gboolean id_only)
 		const NMPClass *klass = NMP_OBJECT_GET_CLASS (dst);
 
 		g_return_if_fail (klass == NMP_OBJECT_GET_CLASS (src));
+		nm_assert (!dst->parent._multi_idx);
+
+		dst->parent._hash_id = 0;
 
 		if (id_only) {
 			if (klass->cmd_plobj_id_copy)
@@ -1064,12 +1353,16 @@ guint
 nmp_object_id_hash (const NMPObject *obj)
 {
 	const NMPClass *klass;
+	guint h;
 
 	if (!obj)
 		return 0;
 
 	g_return_val_if_fail (NMP_OBJECT_IS_VALID (obj), 0);
 
+	if (obj->parent._hash_id)
+		return obj->parent._hash_id;
+
 	klass = NMP_OBJECT_GET_CLASS (obj);
 
 	nm_assert (!klass->cmd_plobj_id_hash == !klass->cmd_plobj_id_cmp);
@@ -1080,7 +1373,13 @@ nmp_object_id_hash (const NMPObject *obj)
 		return g_direct_hash (obj);
 	}
 
-	return klass->cmd_plobj_id_hash (&obj->object);
+	h = klass->cmd_plobj_id_hash (&obj->object);
+
+	/* stack-allocated lookup objects and objects that are not yet interned
+	 * can still change. Only remember the hash of interned ones. */
+	if (obj->parent._multi_idx)
+		((NMPObject *) obj)->parent._hash_id = h;
+	return h;
 }
 
 #define _vt_cmd_plobj_id_hash(type, plat_type, cmd) \
@@ -1210,6 +1509,7 @@ static const guint8 _supported_cache_ids_ipx_route[] = {
 	NMP_CACHE_ID_TYPE_ADDRROUTE_BY_IFINDEX,
 	NMP_CACHE_ID_TYPE_DEFAULT_ROUTES,
 	NMP_CACHE_ID_TYPE_ROUTES_BY_WEAK_ID,
+	NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION,
 	0,
 };
 
@@ -1227,7 +1527,7 @@ _vt_dedup_obj_destroy (NMDedupMultiObj *obj)
 	klass = o->_class;
 	if (klass->cmd_obj_dispose)
 		klass->cmd_obj_dispose (o);
-	g_slice_free1 (klass->sizeof_data + G_STRUCT_OFFSET (NMPObject, object), o);
+	_pool_free (klass, o);
 }
 
 static const NMDedupMultiObj *
@@ -1280,6 +1580,97 @@ nmp_cache_use_udev_get (const NMPCache *cache)
 	return cache->use_udev;
 }
 
+/**
+ * nmp_cache_get_generation:
+ * @cache: the cache
+ *
+ * Returns: a counter that changes whenever the content of the cache
+ *   changes. As long as it stays the same, lists that were looked up
+ *   from the cache stay valid and can be iterated without copying them.
+ */
+guint64
+nmp_cache_get_generation (const NMPCache *cache)
+{
+	nm_assert (cache);
+
+	return cache->generation;
+}
+
+typedef struct {
+	/* the key of the hash table, must be the first field. */
+	int ifindex;
+	guint64 generation;
+} AddrrouteGeneration;
+
+static void
+_addrroute_generation_free (gpointer data)
+{
+	g_slice_free (AddrrouteGeneration, data);
+}
+
+/**
+ * nmp_cache_get_addrroute_generation:
+ * @cache: the cache
+ * @ifindex: the interface
+ *
+ * Returns: a counter that changes whenever an IPv4 or IPv6 address or
+ *   route of @ifindex is added, updated or removed. Contrary to
+ *   nmp_cache_get_generation(), changes of other interfaces and of links
+ *   don't affect it.
+ */
+guint64
+nmp_cache_get_addrroute_generation (const NMPCache *cache, int ifindex)
+{
+	const AddrrouteGeneration *g;
+
+	nm_assert (cache);
+	nm_assert (ifindex > 0);
+
+	if (!cache->addrroute_generations)
+		return 0;
+	g = g_hash_table_lookup (cache->addrroute_generations, &ifindex);
+	return g ? g->generation : 0;
+}
+
+static void
+_addrroute_generation_bump (NMPCache *cache, const NMPObject *obj)
+{
+	AddrrouteGeneration *g;
+
+	if (!NM_IN_SET (NMP_OBJECT_GET_TYPE (obj), NMP_OBJECT_TYPE_IP4_ADDRESS,
+	                                           NMP_OBJECT_TYPE_IP6_ADDRESS,
+	                                           NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                           NMP_OBJECT_TYPE_IP6_ROUTE))
+		return;
+
+	if (obj->object.ifindex <= 0)
+		return;
+
+	if (G_UNLIKELY (!cache->addrroute_generations)) {
+		cache->addrroute_generations = g_hash_table_new_full (g_int_hash, g_int_equal,
+		                                                      _addrroute_generation_free, NULL);
+	}
+
+	g = g_hash_table_lookup (cache->addrroute_generations, &obj->object.ifindex);
+	if (!g) {
+		g = g_slice_new (AddrrouteGeneration);
+		g->ifindex = obj->object.ifindex;
+		g_hash_table_add (cache->addrroute_generations, g);
+	}
+
+	nm_assert (cache->generation > 0);
+	g->generation = cache->generation;
+}
+
+static void
+_addrroute_generation_prune (NMPCache *cache, const NMPObject *obj_old)
+{
+	/* the link is gone, and so are its addresses and routes. */
+	if (   cache->addrroute_generations
+	    && NMP_OBJECT_GET_TYPE (obj_old) == NMP_OBJECT_TYPE_LINK)
+		g_hash_table_remove (cache->addrroute_generations, &obj_old->link.ifindex);
+}
+
 /*****************************************************************************/
 
 gboolean
@@ -1651,6 +2042,32 @@ nmp_lookup_init_ip6_route_by_weak_id (NMPLookup *lookup,
 	return _L (lookup);
 }
 
+const NMPLookup *
+nmp_lookup_init_route_by_destination (NMPLookup *lookup,
+                                      NMPObjectType obj_type,
+                                      guint32 table_coerced,
+                                      gconstpointer network,
+                                      guint8 plen)
+{
+	NMPObject *o;
+
+	nm_assert (lookup);
+	nm_assert (network);
+	nm_assert (NM_IN_SET (obj_type, NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                NMP_OBJECT_TYPE_IP6_ROUTE));
+
+	o = _nmp_object_stackinit_from_type (&lookup->selector_obj, obj_type);
+	o->object.ifindex = 1;
+	o->ip_route.table_coerced = table_coerced;
+	o->ip_route.plen = plen;
+	if (obj_type == NMP_OBJECT_TYPE_IP4_ROUTE)
+		o->ip4_route.network = *((const in_addr_t *) network);
+	else
+		o->ip6_route.network = *((const struct in6_addr *) network);
+	lookup->cache_id_type = NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION;
+	return _L (lookup);
+}
+
 /*****************************************************************************/
 
 GArray *
@@ -1859,6 +2276,14 @@ _idxcache_update (NMPCache *cache,
 	           || (   obj_new->parent.klass == ((const NMPObject *) entry_old->obj)->parent.klass
 	               && !obj_new->parent.klass->obj_full_equal ((NMDedupMultiObj *) obj_new, entry_old->obj)));
 
+	cache->generation++;
+	if (obj_new)
+		_addrroute_generation_bump (cache, obj_new);
+	else {
+		_addrroute_generation_bump (cache, entry_old->obj);
+		_addrroute_generation_prune (cache, entry_old->obj);
+	}
+
 	/* keep a reference to the pre-existing entry */
 	if (entry_old)
 		obj_old = nmp_object_ref (entry_old->obj);
@@ -1988,7 +2413,7 @@ nmp_cache_remove_netlink (NMPCache *cache,
 		obj_new->_link.netlink.is_in_netlink = FALSE;
 
 		_nmp_object_fixup_link_master_connected (&obj_new, NULL, cache);
-		_nmp_object_fixup_link_udev_fields (&obj_new, NULL, cache->use_udev);
+		_nmp_object_fixup_link_udev_fields (&obj_new, NULL, NULL, cache->use_udev);
 
 		_idxcache_update (cache,
 		                  entry_old,
@@ -2068,7 +2493,7 @@ nmp_cache_update_netlink (NMPCache *cache,
 
 		if (NMP_OBJECT_GET_TYPE (obj_hand_over) == NMP_OBJECT_TYPE_LINK) {
 			_nmp_object_fixup_link_master_connected (&obj_hand_over, NULL, cache);
-			_nmp_object_fixup_link_udev_fields (&obj_hand_over, NULL, cache->use_udev);
+			_nmp_object_fixup_link_udev_fields (&obj_hand_over, NULL, NULL, cache->use_udev);
 		}
 
 		_idxcache_update (cache,
@@ -2112,7 +2537,7 @@ nmp_cache_update_netlink (NMPCache *cache,
 			/* Merge the netlink parts with what we have from udev. */
 			udev_device_unref (obj_hand_over->_link.udev.device);
 			obj_hand_over->_link.udev.device = obj_old->_link.udev.device ? udev_device_ref (obj_old->_link.udev.device) : NULL;
-			_nmp_object_fixup_link_udev_fields (&obj_hand_over, NULL, cache->use_udev);
+			_nmp_object_fixup_link_udev_fields (&obj_hand_over, NULL, obj_old, cache->use_udev);
 
 			if (obj_hand_over->_link.netlink.lnk) {
 				nm_auto_nmpobj const NMPObject *lnk_old = obj_hand_over->_link.netlink.lnk;
@@ -2332,7 +2757,7 @@ nmp_cache_update_link_udev (NMPCache *cache,
 		obj_new->link.ifindex = ifindex;
 		obj_new->_link.udev.device = udev_device_ref (udevice);
 
-		_nmp_object_fixup_link_udev_fields (&obj_new, NULL, cache->use_udev);
+		_nmp_object_fixup_link_udev_fields (&obj_new, NULL, NULL, cache->use_udev);
 
 		_idxcache_update (cache,
 		                  NULL,
@@ -2363,7 +2788,7 @@ nmp_cache_update_link_udev (NMPCache *cache,
 		udev_device_unref (obj_new->_link.udev.device);
 		obj_new->_link.udev.device = udevice ? udev_device_ref (udevice) : NULL;
 
-		_nmp_object_fixup_link_udev_fields (&obj_new, NULL, cache->use_udev);
+		_nmp_object_fixup_link_udev_fields (&obj_new, NULL, NULL, cache->use_udev);
 
 		_idxcache_update (cache,
 		                  entry_old,
@@ -2429,6 +2854,34 @@ nmp_cache_dirty_set_all (NMPCache *cache, NMPObjectType obj_type)
 	                                     _nmp_object_stackinit_from_type (&obj_needle, obj_type));
 }
 
+/**
+ * nmp_cache_dirty_set_addrroute:
+ * @cache: the platform cache
+ * @obj_type: the address or route type
+ * @ifindex: the interface index
+ *
+ * Like nmp_cache_dirty_set_all(), but only marks the objects of one
+ * interface. Used before refreshing the addresses or routes of @ifindex
+ * with a filtered dump request, so that the objects that are not part
+ * of the reply can be pruned afterwards.
+ */
+void
+nmp_cache_dirty_set_addrroute (NMPCache *cache,
+                               NMPObjectType obj_type,
+                               int ifindex)
+{
+	NMPLookup lookup;
+	NMDedupMultiIter iter;
+	const NMPObject *obj;
+
+	nm_assert (cache);
+	nm_assert (ifindex > 0);
+
+	nmp_lookup_init_addrroute (&lookup, obj_type, ifindex);
+	nmp_cache_iter_for_each (&iter, nmp_cache_lookup (cache, &lookup), &obj)
+		nm_dedup_multi_entry_set_dirty (_lookup_entry (cache, obj), TRUE);
+}
+
 /*****************************************************************************/
 
 NMPCache *
@@ -2454,6 +2907,9 @@ nmp_cache_free (NMPCache *cache)
 	for (i = NMP_CACHE_ID_TYPE_NONE + 1; i <= NMP_CACHE_ID_TYPE_MAX; i++)
 		nm_dedup_multi_index_remove_idx (cache->multi_idx, _idx_type_get (cache, i));
 
+	if (cache->addrroute_generations)
+		g_hash_table_unref (cache->addrroute_generations);
+
 	nm_dedup_multi_index_unref (cache->multi_idx);
 
 	g_slice_free (NMPCache, cache);
@@ -95,6 +95,9 @@ typedef enum { /*< skip >*/
 	 * cache-resync. */
 	NMP_CACHE_ID_TYPE_ROUTES_BY_WEAK_ID,
 
+	/* all the routes with the same destination, that is table and network/plen. */
+	NMP_CACHE_ID_TYPE_ROUTES_BY_DESTINATION,
+
 	__NMP_CACHE_ID_TYPE_MAX,
 	NMP_CACHE_ID_TYPE_MAX = __NMP_CACHE_ID_TYPE_MAX - 1,
 } NMPCacheIdType;
@@ -230,6 +233,7 @@ struct _NMPObject {
 		NMDedupMultiObj parent;
 		const NMPClass *_class;
 	};
+
 	union {
 		NMPlatformObject        object;
 
@@ -435,6 +439,18 @@ nmp_object_unref (const NMPObject *obj)
 	return NULL;
 }
 
+typedef struct {
+	/* the live objects and their size. */
+	guint64 n_objects;
+	guint64 n_bytes;
+
+	/* the slabs that are allocated for the objects. */
+	guint64 n_slabs;
+	guint64 n_bytes_slabs;
+} NMPObjectPoolStats;
+
+void nmp_object_pool_get_stats (NMPObjectType obj_type, NMPObjectPoolStats *out_stats);
+
 NMPObject *nmp_object_new (NMPObjectType obj_type, const NMPlatformObject *plob);
 NMPObject *nmp_object_new_link (int ifindex);
 
@@ -466,13 +482,19 @@ guint nmp_object_id_hash (const NMPObject *obj);
 static inline gboolean
 nmp_object_id_equal (const NMPObject *obj1, const NMPObject *obj2)
 {
+	if (   obj1
+	    && obj2
+	    && obj1->parent._hash_id
+	    && obj2->parent._hash_id
+	    && obj1->parent._hash_id != obj2->parent._hash_id)
+		return FALSE;
 	return nmp_object_id_cmp (obj1, obj2) == 0;
 }
 
 gboolean nmp_object_is_alive (const NMPObject *obj);
 gboolean nmp_object_is_visible (const NMPObject *obj);
 
-void _nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, gboolean use_udev);
+void _nmp_object_fixup_link_udev_fields (NMPObject **obj_new, NMPObject *obj_orig, const NMPObject *obj_prev, gboolean use_udev);
 
 #define nm_auto_nmpobj __attribute__((cleanup(_nm_auto_nmpobj_cleanup)))
 static inline void
@@ -539,6 +561,12 @@ const NMPLookup *nmp_lookup_init_ip6_route_by_weak_id (NMPLookup *lookup,
                                                        const struct in6_addr *src,
                                                        guint8 src_plen);
 
+const NMPLookup *nmp_lookup_init_route_by_destination (NMPLookup *lookup,
+                                                       NMPObjectType obj_type,
+                                                       guint32 table_coerced,
+                                                       gconstpointer network,
+                                                       guint8 plen);
+
 GArray *nmp_cache_lookup_to_array (const NMDedupMultiHeadEntry *head_entry,
                                    NMPObjectType obj_type,
                                    gboolean visible_only);
@@ -594,6 +622,39 @@ gboolean nmp_cache_link_connected_needs_toggle (const NMPCache *cache, const NMP
 const NMPObject *nmp_cache_link_connected_needs_toggle_by_ifindex (const NMPCache *cache, int master_ifindex, const NMPObject *potential_slave, const NMPObject *ignore_slave);
 
 gboolean nmp_cache_use_udev_get (const NMPCache *cache);
+guint64 nmp_cache_get_generation (const NMPCache *cache);
+guint64 nmp_cache_get_addrroute_generation (const NMPCache *cache, int ifindex);
+
+/* NMPCacheLiveIter iterates over a list of the cache without copying it.
+ * The cache must not change during the iteration. This is checked by
+ * comparing the generation of the cache on each step, also in non-debug
+ * builds. On a change, the iteration stops with a warning instead of
+ * following a list entry that might have been freed. */
+typedef struct {
+	NMDedupMultiIter base;
+	const NMPCache *cache;
+	guint64 generation;
+} NMPCacheLiveIter;
+
+static inline void
+nmp_cache_live_iter_init (NMPCacheLiveIter *iter, const NMPCache *cache, const NMDedupMultiHeadEntry *head)
+{
+	nm_dedup_multi_iter_init (&iter->base, head);
+	iter->cache = cache;
+	iter->generation = nmp_cache_get_generation (cache);
+}
+
+static inline gboolean
+nmp_cache_live_iter_next (NMPCacheLiveIter *iter, const NMPObject **out_obj)
+{
+	g_return_val_if_fail (iter->generation == nmp_cache_get_generation (iter->cache), FALSE);
+	return nmp_cache_iter_next (&iter->base, out_obj);
+}
+
+#define nmp_cache_live_iter_for_each(iter, cache, head, obj) \
+	for (nmp_cache_live_iter_init ((iter), (cache), (head)); \
+	     nmp_cache_live_iter_next ((iter), (obj)); \
+	     )
 
 void ASSERT_nmp_cache_is_consistent (const NMPCache *cache);
 
@@ -630,6 +691,9 @@ NMPCacheOpsType nmp_cache_update_link_master_connected (NMPCache *cache,
                                                         const NMPObject **out_obj_new);
 
 void nmp_cache_dirty_set_all (NMPCache *cache, NMPObjectType obj_type);
+void nmp_cache_dirty_set_addrroute (NMPCache *cache,
+                                    NMPObjectType obj_type,
+                                    int ifindex);
 
 NMPCache *nmp_cache_new (NMDedupMultiIndex *multi_idx, gboolean use_udev);
 void nmp_cache_free (NMPCache *cache);
@@ -0,0 +1,463 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* nmp-prefix-trie.c - Prefix trie for longest prefix match lookups
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#include "nm-default.h"
+
+#include "nmp-prefix-trie.h"
+
+#include <sys/socket.h>
+
+/*****************************************************************************/
+
+/* the key is the table (in network byte order), followed by the address. */
+#define KEY_TABLE_BITS 32
+#define KEY_LEN_MAX    (4 + 16)
+#define KEY_BITS_MAX   (KEY_LEN_MAX * 8)
+
+typedef struct _Node Node;
+
+struct _Node {
+	Node *parent;
+	Node *child[2];
+
+	/* nodes without value are glue nodes. They only exist to branch,
+	 * hence they always have two children. */
+	gpointer value;
+
+	guint8 key_bits;
+	guint8 key[KEY_LEN_MAX];
+};
+
+struct _NMPPrefixTrie {
+	Node *root;
+	guint len;
+	guint8 key_len;
+};
+
+/*****************************************************************************/
+
+static inline guint
+_key_bit (const guint8 *key, guint bit)
+{
+	return (key[bit / 8] >> (7 - (bit % 8))) & 1;
+}
+
+static guint
+_key_common_bits (const guint8 *key_a, const guint8 *key_b, guint max_bits)
+{
+	guint i;
+
+	for (i = 0; i * 8 < max_bits; i++) {
+		guint8 x = key_a[i] ^ key_b[i];
+
+		if (x) {
+			guint n = i * 8 + (__builtin_clz (x) - ((sizeof (unsigned) - 1) * 8));
+
+			return MIN (n, max_bits);
+		}
+	}
+	return max_bits;
+}
+
+static void
+_key_mask (guint8 *key, guint key_len, guint bits)
+{
+	guint i = bits / 8;
+
+	if (i >= key_len)
+		return;
+	if (bits % 8)
+		key[i++] &= (guint8) (0xFF << (8 - (bits % 8)));
+	memset (&key[i], 0, key_len - i);
+}
+
+static guint
+_key_init (const NMPPrefixTrie *trie,
+           guint8 *key,
+           guint32 table,
+           gconstpointer addr,
+           guint8 plen)
+{
+	guint bits;
+
+	nm_assert (addr);
+	nm_assert (plen <= (trie->key_len - 4) * 8);
+
+	table = htonl (table);
+	memcpy (key, &table, 4);
+	memcpy (&key[4], addr, trie->key_len - 4);
+
+	bits = KEY_TABLE_BITS + plen;
+	_key_mask (key, trie->key_len, bits);
+	return bits;
+}
+
+static Node *
+_node_new (const NMPPrefixTrie *trie,
+           const guint8 *key,
+           guint bits,
+           gpointer value,
+           Node *parent)
+{
+	Node *node;
+
+	node = g_slice_new0 (Node);
+	node->parent = parent;
+	node->value = value;
+	node->key_bits = bits;
+	memcpy (node->key, key, trie->key_len);
+	_key_mask (node->key, trie->key_len, bits);
+	return node;
+}
+
+static Node **
+_node_slot (NMPPrefixTrie *trie, Node *node)
+{
+	Node *parent = node->parent;
+
+	if (!parent)
+		return &trie->root;
+	return &parent->child[parent->child[1] == node];
+}
+
+static void
+_node_free_all (Node *node)
+{
+	if (node) {
+		_node_free_all (node->child[0]);
+		_node_free_all (node->child[1]);
+		g_slice_free (Node, node);
+	}
+}
+
+static Node *
+_node_find (const NMPPrefixTrie *trie, const guint8 *key, guint bits)
+{
+	Node *node = trie->root;
+
+	while (node && node->key_bits <= bits) {
+		if (_key_common_bits (node->key, key, node->key_bits) < node->key_bits)
+			return NULL;
+		if (node->key_bits == bits)
+			return node;
+		node = node->child[_key_bit (key, node->key_bits)];
+	}
+	return NULL;
+}
+
+static gboolean
+_node_foreach (const Node *node, NMPPrefixTrieFunc func, gpointer user_data)
+{
+	if (!node)
+		return TRUE;
+	if (   node->value
+	    && !func (node->value, node->key_bits - KEY_TABLE_BITS, user_data))
+		return FALSE;
+	return    _node_foreach (node->child[0], func, user_data)
+	       && _node_foreach (node->child[1], func, user_data);
+}
+
+/*****************************************************************************/
+
+/**
+ * nmp_prefix_trie_set:
+ * @trie: the trie
+ * @table: the route table
+ * @addr: the address, of the size of the address family of @trie
+ * @plen: the prefix length. Host bits of @addr are ignored.
+ * @value: the non-NULL value to set.
+ *
+ * Returns: the previous value of the prefix or %NULL, if the
+ *   prefix was not yet in the trie.
+ */
+gpointer
+nmp_prefix_trie_set (NMPPrefixTrie *trie,
+                     guint32 table,
+                     gconstpointer addr,
+                     guint8 plen,
+                     gpointer value)
+{
+	guint8 key[KEY_LEN_MAX];
+	guint bits;
+	Node **slot;
+	Node *node;
+	Node *parent = NULL;
+	gpointer old;
+
+	g_return_val_if_fail (trie, NULL);
+	g_return_val_if_fail (value, NULL);
+
+	bits = _key_init (trie, key, table, addr, plen);
+
+	slot = &trie->root;
+	while ((node = *slot)) {
+		guint common;
+
+		common = _key_common_bits (node->key, key, MIN (node->key_bits, bits));
+		if (common < node->key_bits) {
+			Node *leaf;
+
+			/* @node is not a prefix of @key. Split the edge. */
+			if (common == bits) {
+				leaf = _node_new (trie, key, bits, value, parent);
+				leaf->child[_key_bit (node->key, bits)] = node;
+				node->parent = leaf;
+				*slot = leaf;
+			} else {
+				Node *glue;
+				guint bit = _key_bit (key, common);
+
+				glue = _node_new (trie, key, common, NULL, parent);
+				leaf = _node_new (trie, key, bits, value, glue);
+				glue->child[bit] = leaf;
+				glue->child[!bit] = node;
+				node->parent = glue;
+				*slot = glue;
+			}
+			trie->len++;
+			return NULL;
+		}
+
+		if (node->key_bits == bits) {
+			old = node->value;
+			node->value = value;
+			if (!old)
+				trie->len++;
+			return old;
+		}
+
+		parent = node;
+		slot = &node->child[_key_bit (key, node->key_bits)];
+	}
+
+	*slot = _node_new (trie, key, bits, value, parent);
+	trie->len++;
+	return NULL;
+}
+
+/**
+ * nmp_prefix_trie_remove:
+ * @trie: the trie
+ * @table: the route table
+ * @addr: the address
+ * @plen: the prefix length
+ *
+ * Returns: the value of the removed prefix or %NULL, if the prefix
+ *   was not in the trie.
+ */
+gpointer
+nmp_prefix_trie_remove (NMPPrefixTrie *trie,
+                        guint32 table,
+                        gconstpointer addr,
+                        guint8 plen)
+{
+	guint8 key[KEY_LEN_MAX];
+	guint bits;
+	Node *node;
+	gpointer old;
+
+	g_return_val_if_fail (trie, NULL);
+
+	bits = _key_init (trie, key, table, addr, plen);
+
+	node = _node_find (trie, key, bits);
+	if (!node || !node->value)
+		return NULL;
+
+	old = node->value;
+	node->value = NULL;
+	trie->len--;
+
+	/* drop nodes that are no longer needed: value-less nodes with
+	 * less than two children. */
+	while (node && !node->value) {
+		Node *parent = node->parent;
+		Node *child;
+
+		if (node->child[0] && node->child[1])
+			break;
+
+		child = node->child[0] ?: node->child[1];
+		*_node_slot (trie, node) = child;
+		g_slice_free (Node, node);
+
+		if (child) {
+			child->parent = parent;
+			break;
+		}
+
+		/* @parent lost a child. It might be a glue node that is no longer
+		 * needed. */
+		node = parent;
+	}
+
+	return old;
+}
+
+gpointer
+nmp_prefix_trie_lookup (const NMPPrefixTrie *trie,
+                        guint32 table,
+                        gconstpointer addr,
+                        guint8 plen)
+{
+	guint8 key[KEY_LEN_MAX];
+	guint bits;
+	Node *node;
+
+	g_return_val_if_fail (trie, NULL);
+
+	bits = _key_init (trie, key, table, addr, plen);
+	node = _node_find (trie, key, bits);
+	return node ? node->value : NULL;
+}
+
+/**
+ * nmp_prefix_trie_lookup_covering:
+ * @trie: the trie
+ * @table: the route table
+ * @addr: the address
+ * @plen: the prefix length of @addr.
+ * @predicate: (allow-none): callback to select a value
+ * @user_data: user data for @predicate
+ * @out_plen: (allow-none): the prefix length of the returned value
+ *
+ * Visits the prefixes in @table that contain @addr/@plen, from the longest
+ * to the shortest one. Thus, with a @plen of the full address length,
+ * this is a longest prefix match for @addr.
+ *
+ * Returns: the first value for which @predicate returns %TRUE, or
+ *   the value of the longest prefix if @predicate is %NULL.
+ */
+gpointer
+nmp_prefix_trie_lookup_covering (const NMPPrefixTrie *trie,
+                                 guint32 table,
+                                 gconstpointer addr,
+                                 guint8 plen,
+                                 NMPPrefixTrieFunc predicate,
+                                 gpointer user_data,
+                                 guint8 *out_plen)
+{
+	guint8 key[KEY_LEN_MAX];
+	const Node *path[KEY_BITS_MAX + 1];
+	guint n_path = 0;
+	guint bits;
+	const Node *node;
+
+	g_return_val_if_fail (trie, NULL);
+
+	bits = _key_init (trie, key, table, addr, plen);
+
+	node = trie->root;
+	while (node && node->key_bits <= bits) {
+		if (_key_common_bits (node->key, key, node->key_bits) < node->key_bits)
+			break;
+		if (node->value) {
+			nm_assert (n_path < G_N_ELEMENTS (path));
+			path[n_path++] = node;
+		}
+		if (node->key_bits == bits)
+			break;
+		node = node->child[_key_bit (key, node->key_bits)];
+	}
+
+	while (n_path > 0) {
+		node = path[--n_path];
+		if (   !predicate
+		    || predicate (node->value, node->key_bits - KEY_TABLE_BITS, user_data)) {
+			NM_SET_OUT (out_plen, node->key_bits - KEY_TABLE_BITS);
+			return node->value;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * nmp_prefix_trie_foreach_within:
+ * @trie: the trie
+ * @table: the route table
+ * @addr: the address
+ * @plen: the prefix length of @addr.
+ * @func: the callback to invoke. Return %FALSE to stop iterating.
+ * @user_data: user data for @func
+ *
+ * Visits all prefixes in @table that are contained in @addr/@plen,
+ * including @addr/@plen itself, shorter prefixes first.
+ * The trie must not be modified while iterating.
+ */
+void
+nmp_prefix_trie_foreach_within (const NMPPrefixTrie *trie,
+                                guint32 table,
+                                gconstpointer addr,
+                                guint8 plen,
+                                NMPPrefixTrieFunc func,
+                                gpointer user_data)
+{
+	guint8 key[KEY_LEN_MAX];
+	guint bits;
+	const Node *node;
+
+	g_return_if_fail (trie);
+	g_return_if_fail (func);
+
+	bits = _key_init (trie, key, table, addr, plen);
+
+	node = trie->root;
+	while (node) {
+		if (node->key_bits >= bits) {
+			if (_key_common_bits (node->key, key, bits) == bits)
+				_node_foreach (node, func, user_data);
+			return;
+		}
+		if (_key_common_bits (node->key, key, node->key_bits) < node->key_bits)
+			return;
+		node = node->child[_key_bit (key, node->key_bits)];
+	}
+}
+
+guint
+nmp_prefix_trie_get_len (const NMPPrefixTrie *trie)
+{
+	g_return_val_if_fail (trie, 0);
+
+	return trie->len;
+}
+
+/*****************************************************************************/
+
+NMPPrefixTrie *
+nmp_prefix_trie_new (int addr_family)
+{
+	NMPPrefixTrie *trie;
+
+	g_return_val_if_fail (NM_IN_SET (addr_family, AF_INET, AF_INET6), NULL);
+
+	trie = g_slice_new0 (NMPPrefixTrie);
+	trie->key_len = 4 + (addr_family == AF_INET ? 4 : 16);
+	return trie;
+}
+
+void
+nmp_prefix_trie_free (NMPPrefixTrie *trie)
+{
+	g_return_if_fail (trie);
+
+	_node_free_all (trie->root);
+	g_slice_free (NMPPrefixTrie, trie);
+}
@@ -0,0 +1,83 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* nmp-prefix-trie.h - Prefix trie for longest prefix match lookups
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ */
+
+#ifndef __NMP_PREFIX_TRIE_H__
+#define __NMP_PREFIX_TRIE_H__
+
+/*****************************************************************************/
+
+/* NMPPrefixTrie maps (table, address/plen) prefixes of one address family
+ * to a non-NULL value. It is a path-compressed binary trie, keyed by the
+ * 32 bits of the table followed by the bits of the address prefix.
+ *
+ * Lookups and insertions take O(plen), independent of the number of
+ * prefixes in the trie. The trie does not own the values. */
+
+typedef struct _NMPPrefixTrie NMPPrefixTrie;
+
+/* callback for visiting prefixes. @plen is the prefix length of the visited
+ * prefix, without the table. */
+typedef gboolean (*NMPPrefixTrieFunc) (gpointer value, guint8 plen, gpointer user_data);
+
+NMPPrefixTrie *nmp_prefix_trie_new (int addr_family);
+void nmp_prefix_trie_free (NMPPrefixTrie *trie);
+
+guint nmp_prefix_trie_get_len (const NMPPrefixTrie *trie);
+
+gpointer nmp_prefix_trie_set (NMPPrefixTrie *trie,
+                              guint32 table,
+                              gconstpointer addr,
+                              guint8 plen,
+                              gpointer value);
+
+gpointer nmp_prefix_trie_remove (NMPPrefixTrie *trie,
+                                 guint32 table,
+                                 gconstpointer addr,
+                                 guint8 plen);
+
+gpointer nmp_prefix_trie_lookup (const NMPPrefixTrie *trie,
+                                 guint32 table,
+                                 gconstpointer addr,
+                                 guint8 plen);
+
+gpointer nmp_prefix_trie_lookup_covering (const NMPPrefixTrie *trie,
+                                          guint32 table,
+                                          gconstpointer addr,
+                                          guint8 plen,
+                                          NMPPrefixTrieFunc predicate,
+                                          gpointer user_data,
+                                          guint8 *out_plen);
+
+void nmp_prefix_trie_foreach_within (const NMPPrefixTrie *trie,
+                                     guint32 table,
+                                     gconstpointer addr,
+                                     guint8 plen,
+                                     NMPPrefixTrieFunc func,
+                                     gpointer user_data);
+
+#define nm_auto_prefix_trie nm_auto(_nm_auto_prefix_trie_free)
+static inline void
+_nm_auto_prefix_trie_free (NMPPrefixTrie **p)
+{
+	if (*p)
+		nmp_prefix_trie_free (*p);
+}
+
+#endif /* __NMP_PREFIX_TRIE_H__ */
@@ -0,0 +1,226 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Flap many links of the fake platform and compare the cost of notifying
+ * one listener per link, once with a handler for the link-changed signal
+ * that filters by ifindex (as NMDevice did) and once with a subscription
+ * by ifindex via nm_platform_object_subscribe(). */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+
+#include "platform/nm-fake-platform.h"
+#include "platform/nmp-object.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+/*****************************************************************************/
+
+static struct {
+	int n_links;
+	int n_flaps;
+	int n_rounds;
+} global_opt = {
+	.n_links = 10000,
+	.n_flaps = 1,
+	.n_rounds = 3,
+};
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "links", 'n', 0, G_OPTION_ARG_INT, &global_opt.n_links, "Number of links to create (default 10000)", "N" },
+		{ "flaps", 'f', 0, G_OPTION_ARG_INT, &global_opt.n_flaps, "How often to flap each link per round (default 1)", "N" },
+		{ "rounds", 'r', 0, G_OPTION_ARG_INT, &global_opt.n_rounds, "How often to repeat each measurement (default 3)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark dispatching of link changes in NMPlatform.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	int ifindex;
+	guint n_changed;
+} Listener;
+
+static guint64 _n_invocations;
+
+static void
+_signal_cb (NMPlatform *platform,
+            int obj_type_i,
+            int ifindex,
+            const NMPlatformLink *plink,
+            int change_type_i,
+            Listener *listener)
+{
+	_n_invocations++;
+	if (ifindex == listener->ifindex)
+		listener->n_changed++;
+}
+
+static void
+_subscribe_cb (NMPlatform *platform,
+               const NMPObject *obj,
+               NMPlatformSignalChangeType change_type,
+               gpointer user_data)
+{
+	Listener *listener = user_data;
+
+	_n_invocations++;
+	listener->n_changed++;
+}
+
+static gint64
+_flap_links (NMPlatform *platform, Listener *listeners, guint n_links)
+{
+	gint64 ts;
+	guint i;
+	int j;
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (j = 0; j < global_opt.n_flaps; j++) {
+		for (i = 0; i < n_links; i++) {
+			if (   !nm_platform_link_set_up (platform, listeners[i].ifindex, NULL)
+			    || !nm_platform_link_set_down (platform, listeners[i].ifindex))
+				g_assert_not_reached ();
+		}
+	}
+	return nm_utils_get_monotonic_timestamp_ns () - ts;
+}
+
+static void
+_print_result (const char *name, guint n_links, gint64 duration_ns, guint64 n_invocations, const Listener *listeners)
+{
+	guint64 n_changed = 0;
+	guint n_flaps = n_links * MAX (global_opt.n_flaps, 0);
+	guint i;
+
+	for (i = 0; i < n_links; i++)
+		n_changed += listeners[i].n_changed;
+
+	g_print ("%-10s %6u links: %10.1f ns/flap, %10.1f callbacks/flap, %5.1f changes/flap\n",
+	         name,
+	         n_links,
+	         (double) duration_ns / MAX (n_flaps, 1u),
+	         (double) n_invocations / MAX (n_flaps, 1u),
+	         (double) n_changed / MAX (n_flaps, 1u));
+}
+
+static void
+_bench_signal (NMPlatform *platform, Listener *listeners, guint n_links)
+{
+	gulong *ids;
+	guint i;
+	gint64 duration_ns;
+	guint64 n_invocations;
+
+	ids = g_new (gulong, n_links);
+	for (i = 0; i < n_links; i++) {
+		listeners[i].n_changed = 0;
+		ids[i] = g_signal_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, G_CALLBACK (_signal_cb), &listeners[i]);
+	}
+
+	n_invocations = _n_invocations;
+	duration_ns = _flap_links (platform, listeners, n_links);
+	_print_result ("signal", n_links, duration_ns, _n_invocations - n_invocations, listeners);
+
+	for (i = 0; i < n_links; i++)
+		g_signal_handler_disconnect (platform, ids[i]);
+	g_free (ids);
+}
+
+static void
+_bench_subscribe (NMPlatform *platform, Listener *listeners, guint n_links)
+{
+	guint i;
+	gint64 duration_ns;
+	guint64 n_invocations;
+
+	for (i = 0; i < n_links; i++) {
+		listeners[i].n_changed = 0;
+		nm_platform_object_subscribe (platform, NMP_OBJECT_TYPE_LINK, listeners[i].ifindex, _subscribe_cb, &listeners[i]);
+	}
+
+	n_invocations = _n_invocations;
+	duration_ns = _flap_links (platform, listeners, n_links);
+	_print_result ("subscribe", n_links, duration_ns, _n_invocations - n_invocations, listeners);
+
+	for (i = 0; i < n_links; i++) {
+		if (!nm_platform_object_unsubscribe (platform, NMP_OBJECT_TYPE_LINK, listeners[i].ifindex, _subscribe_cb, &listeners[i]))
+			g_assert_not_reached ();
+	}
+}
+
+int
+main (int argc, char **argv)
+{
+	NMPlatform *platform;
+	Listener *listeners;
+	guint n_links;
+	guint i;
+	int round;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	nm_fake_platform_setup ();
+	platform = NM_PLATFORM_GET;
+
+	n_links = MAX (global_opt.n_links, 1);
+	listeners = g_new0 (Listener, n_links);
+	for (i = 0; i < n_links; i++) {
+		const NMPlatformLink *pllink;
+		char name[64];
+
+		nm_sprintf_buf (name, "flap%u", i);
+		if (nm_platform_link_dummy_add (platform, name, &pllink) != NM_PLATFORM_ERROR_SUCCESS)
+			g_assert_not_reached ();
+		listeners[i].ifindex = pllink->ifindex;
+	}
+
+	for (round = 0; round < MAX (global_opt.n_rounds, 1); round++) {
+		_bench_signal (platform, listeners, n_links);
+		_bench_subscribe (platform, listeners, n_links);
+	}
+
+	g_free (listeners);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,228 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Replay a dump of routes through the netlink event handling of
+ * NMLinuxPlatform and report the time and the number of allocations
+ * per message.
+ *
+ * Without arguments, a dump of IPv4 routes is generated. With --file,
+ * the raw netlink messages are read from a file, for example captured
+ * from a nlmon device. */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+#include <arpa/inet.h>
+#include <linux/rtnetlink.h>
+#include <netlink/msg.h>
+#include <netlink/attr.h>
+
+#include "platform/nm-linux-platform.h"
+#include "platform/nm-platform-private.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+/*****************************************************************************/
+
+static guint64 _n_allocs;
+
+#if defined (__GLIBC__)
+/* count allocations by interposing malloc(). With G_SLICE=always-malloc,
+ * this includes the allocations of GSlice. */
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+
+void *
+malloc (size_t size)
+{
+	_n_allocs++;
+	return __libc_malloc (size);
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+	_n_allocs++;
+	return __libc_calloc (nmemb, size);
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	_n_allocs++;
+	return __libc_realloc (ptr, size);
+}
+#endif
+
+/*****************************************************************************/
+
+static struct {
+	int n_routes;
+	char *file;
+	int n_rounds;
+} global_opt = {
+	.n_routes = 100000,
+	.n_rounds = 3,
+};
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "routes", 'n', 0, G_OPTION_ARG_INT, &global_opt.n_routes, "Number of routes to generate (default 100000)", "N" },
+		{ "file", 'f', 0, G_OPTION_ARG_FILENAME, &global_opt.file, "Read raw netlink messages from file", "FILE" },
+		{ "rounds", 'r', 0, G_OPTION_ARG_INT, &global_opt.n_rounds, "How often to replay the messages (default 3)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark processing of netlink messages in NMPlatform.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static GByteArray *
+_generate_route_dump (guint n_routes)
+{
+	GByteArray *arr;
+	guint i;
+
+	arr = g_byte_array_sized_new (n_routes * 80);
+
+	for (i = 0; i < n_routes; i++) {
+		struct nl_msg *nlmsg;
+		const struct rtmsg rtmsg = {
+			.rtm_family = AF_INET,
+			.rtm_dst_len = 32,
+			.rtm_table = RT_TABLE_COMPAT,
+			.rtm_protocol = RTPROT_STATIC,
+			.rtm_scope = RT_SCOPE_UNIVERSE,
+			.rtm_type = RTN_UNICAST,
+		};
+		in_addr_t dst = htonl (0x0a000000u + i);
+		struct nlmsghdr *hdr;
+
+		nlmsg = nlmsg_alloc_simple (RTM_NEWROUTE, NLM_F_MULTI);
+		g_assert (nlmsg);
+
+		if (   nlmsg_append (nlmsg, (void *) &rtmsg, sizeof (rtmsg), NLMSG_ALIGNTO) < 0
+		    || nla_put_u32 (nlmsg, RTA_TABLE, 10000) < 0
+		    || nla_put (nlmsg, RTA_DST, sizeof (dst), &dst) < 0
+		    || nla_put_u32 (nlmsg, RTA_OIF, 1) < 0
+		    || nla_put_u32 (nlmsg, RTA_PRIORITY, 100) < 0)
+			g_assert_not_reached ();
+
+		hdr = nlmsg_hdr (nlmsg);
+		g_byte_array_append (arr, (const guint8 *) hdr, NLMSG_ALIGN (hdr->nlmsg_len));
+		nlmsg_free (nlmsg);
+	}
+
+	return arr;
+}
+
+static guint
+_count_msgs (const GByteArray *arr)
+{
+	struct nlmsghdr *hdr = (struct nlmsghdr *) arr->data;
+	int n = arr->len;
+	guint count = 0;
+
+	while (nlmsg_ok (hdr, n)) {
+		count++;
+		hdr = nlmsg_next (hdr, &n);
+	}
+	return count;
+}
+
+int
+main (int argc, char **argv)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	GByteArray *arr;
+	guint n_msgs;
+	int i;
+
+	g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	if (global_opt.file) {
+		gs_free_error GError *error = NULL;
+		char *contents;
+		gsize len;
+
+		if (!g_file_get_contents (global_opt.file, &contents, &len, &error)) {
+			g_printerr ("Cannot read %s: %s\n", global_opt.file, error->message);
+			return EXIT_FAILURE;
+		}
+		arr = g_byte_array_new_take ((guint8 *) contents, len);
+	} else
+		arr = _generate_route_dump (MAX (global_opt.n_routes, 1));
+
+	n_msgs = _count_msgs (arr);
+	if (!n_msgs) {
+		g_printerr ("No netlink messages to replay\n");
+		return EXIT_FAILURE;
+	}
+
+	platform = nm_linux_platform_new (TRUE, NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	for (i = 0; i < global_opt.n_rounds; i++) {
+		gint64 start_ns;
+		gint64 duration_ns;
+		guint64 n_allocs;
+
+		n_allocs = _n_allocs;
+		start_ns = nm_utils_get_monotonic_timestamp_ns ();
+
+		_nmtst_linux_platform_process_netlink_msgs (platform, arr->data, arr->len);
+
+		duration_ns = nm_utils_get_monotonic_timestamp_ns () - start_ns;
+		n_allocs = _n_allocs - n_allocs;
+
+		g_print ("round %d: %u messages, %.1f ns/message, %.2f allocations/message\n",
+		         i + 1,
+		         n_msgs,
+		         (double) duration_ns / n_msgs,
+		         (double) n_allocs / n_msgs);
+	}
+
+	g_byte_array_unref (arr);
+	g_free (global_opt.file);
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,777 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Scale benchmarks for the platform cache.
+ *
+ * The scenarios "links", "routes", "route-flaps" and "address-churn" fill
+ * a NMPCache with generated objects and measure the cost of
+ * nmp_cache_update_netlink(), of lookups and the memory per object. Then
+ * they repeat the changes on the fake platform, with listeners connected
+ * to the change signals, to measure the cost of notifying them.
+ *
+ * With --file, the scenario "dump" replays raw netlink messages (for example
+ * captured from a nlmon device) through NMLinuxPlatform.
+ *
+ * Each result is printed as one line "scenario<TAB>metric<TAB>value<TAB>unit",
+ * so that the output of two runs can be compared with a script. */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+#include <malloc.h>
+#include <arpa/inet.h>
+#include <linux/rtnetlink.h>
+
+#include "platform/nm-fake-platform.h"
+#include "platform/nm-linux-platform.h"
+#include "platform/nm-platform-private.h"
+#include "platform/nmp-object.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+/*****************************************************************************/
+
+static gint64 _n_bytes;
+static guint64 _n_allocs;
+
+#if defined (__GLIBC__)
+/* count allocations and the allocated bytes by interposing malloc().
+ * With G_SLICE=always-malloc, this includes the allocations of GSlice.
+ *
+ * free() subtracts the size of every pointer, so all functions that
+ * allocate from the glibc heap must be interposed, including the aligned
+ * variants. Otherwise, freeing their memory would be subtracted without
+ * having been counted. */
+extern void *__libc_malloc (size_t size);
+extern void *__libc_calloc (size_t nmemb, size_t size);
+extern void *__libc_realloc (void *ptr, size_t size);
+extern void *__libc_memalign (size_t alignment, size_t size);
+extern void *__libc_valloc (size_t size);
+extern void *__libc_pvalloc (size_t size);
+extern void __libc_free (void *ptr);
+
+static void *
+_count_alloc (void *p)
+{
+	_n_allocs++;
+	if (p)
+		_n_bytes += malloc_usable_size (p);
+	return p;
+}
+
+void *
+malloc (size_t size)
+{
+	return _count_alloc (__libc_malloc (size));
+}
+
+void *
+calloc (size_t nmemb, size_t size)
+{
+	return _count_alloc (__libc_calloc (nmemb, size));
+}
+
+void *
+memalign (size_t alignment, size_t size)
+{
+	return _count_alloc (__libc_memalign (alignment, size));
+}
+
+void *
+aligned_alloc (size_t alignment, size_t size)
+{
+	return _count_alloc (__libc_memalign (alignment, size));
+}
+
+int
+posix_memalign (void **memptr, size_t alignment, size_t size)
+{
+	void *p;
+
+	if (   alignment % sizeof (void *) != 0
+	    || (alignment & (alignment - 1)) != 0
+	    || alignment == 0)
+		return EINVAL;
+
+	p = _count_alloc (__libc_memalign (alignment, size));
+	if (!p)
+		return ENOMEM;
+	*memptr = p;
+	return 0;
+}
+
+void *
+valloc (size_t size)
+{
+	return _count_alloc (__libc_valloc (size));
+}
+
+void *
+pvalloc (size_t size)
+{
+	return _count_alloc (__libc_pvalloc (size));
+}
+
+void *
+realloc (void *ptr, size_t size)
+{
+	void *p;
+
+	if (ptr)
+		_n_bytes -= malloc_usable_size (ptr);
+	p = __libc_realloc (ptr, size);
+	_n_allocs++;
+	if (p)
+		_n_bytes += malloc_usable_size (p);
+	else if (ptr && size > 0)
+		_n_bytes += malloc_usable_size (ptr);
+	return p;
+}
+
+void
+free (void *ptr)
+{
+	if (ptr)
+		_n_bytes -= malloc_usable_size (ptr);
+	__libc_free (ptr);
+}
+#endif
+
+/*****************************************************************************/
+
+static struct {
+	char *scenarios;
+	char *file;
+	int n_links;
+	int n_routes;
+	int n_flap_routes;
+	int n_flaps;
+	int n_addresses;
+	int n_churn;
+	int n_listeners;
+	int n_fake_ops;
+} global_opt = {
+	.n_links = 10000,
+	.n_routes = 1000000,
+	.n_flap_routes = 10000,
+	.n_flaps = 100000,
+	.n_addresses = 10000,
+	.n_churn = 10,
+	.n_listeners = 10,
+	.n_fake_ops = 10000,
+};
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "scenario", 's', 0, G_OPTION_ARG_STRING, &global_opt.scenarios, "Comma separated scenarios to run (default: all)", "NAMES" },
+		{ "file", 'f', 0, G_OPTION_ARG_FILENAME, &global_opt.file, "Replay raw netlink messages from file (scenario \"dump\")", "FILE" },
+		{ "links", 0, 0, G_OPTION_ARG_INT, &global_opt.n_links, "Number of links (default 10000)", "N" },
+		{ "routes", 0, 0, G_OPTION_ARG_INT, &global_opt.n_routes, "Number of routes (default 1000000)", "N" },
+		{ "flap-routes", 0, 0, G_OPTION_ARG_INT, &global_opt.n_flap_routes, "Number of routes for route-flaps (default 10000)", "N" },
+		{ "flaps", 0, 0, G_OPTION_ARG_INT, &global_opt.n_flaps, "Number of route flaps (default 100000)", "N" },
+		{ "addresses", 0, 0, G_OPTION_ARG_INT, &global_opt.n_addresses, "Number of addresses (default 10000)", "N" },
+		{ "churn", 0, 0, G_OPTION_ARG_INT, &global_opt.n_churn, "How often the lifetime of each address is updated (default 10)", "N" },
+		{ "listeners", 0, 0, G_OPTION_ARG_INT, &global_opt.n_listeners, "Number of signal listeners on the fake platform (default 10)", "N" },
+		{ "fake-ops", 0, 0, G_OPTION_ARG_INT, &global_opt.n_fake_ops, "Number of changes on the fake platform per scenario (default 10000)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark the platform cache at scale.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+static void
+_print (const char *scenario, const char *metric, double value, const char *unit)
+{
+	g_print ("%s\t%s\t%.1f\t%s\n", scenario, metric, value, unit);
+}
+
+static gint64
+_now (void)
+{
+	return nm_utils_get_monotonic_timestamp_ns ();
+}
+
+static guint *
+_shuffled_indexes (guint n)
+{
+	guint *idx;
+	guint i;
+
+	idx = g_new (guint, n);
+	for (i = 0; i < n; i++)
+		idx[i] = i;
+	for (i = n - 1; i > 0; i--) {
+		guint j = nmtst_get_rand_int () % (i + 1);
+		guint tmp = idx[i];
+
+		idx[i] = idx[j];
+		idx[j] = tmp;
+	}
+	return idx;
+}
+
+static void
+_cache_update (NMPCache *cache, NMPObject *obj, NMPCacheOpsType expected)
+{
+	const NMPObject *obj_old = NULL;
+	const NMPObject *obj_new = NULL;
+
+	if (nmp_cache_update_netlink (cache, obj, FALSE, &obj_old, &obj_new) != expected)
+		g_assert_not_reached ();
+	nmp_object_unref (obj_old);
+	nmp_object_unref (obj_new);
+}
+
+static void
+_cache_remove (NMPCache *cache, const NMPObject *obj_needle)
+{
+	const NMPObject *obj_old = NULL;
+	const NMPObject *obj_new = NULL;
+
+	if (nmp_cache_remove_netlink (cache, obj_needle, &obj_old, &obj_new) != NMP_CACHE_OPS_REMOVED)
+		g_assert_not_reached ();
+	nmp_object_unref (obj_old);
+	nmp_object_unref (obj_new);
+}
+
+/* add all @objs to a new cache and report the throughput and the memory.
+ * @objs are handed over to the cache. */
+static NMPCache *
+_cache_fill (const char *scenario, NMDedupMultiIndex *multi_idx, NMPObject **objs, guint n, gint64 n_bytes_before)
+{
+	NMPCache *cache;
+	gint64 ts;
+	guint i;
+
+	cache = nmp_cache_new (multi_idx, FALSE);
+
+	ts = _now ();
+	for (i = 0; i < n; i++) {
+		_cache_update (cache, objs[i], NMP_CACHE_OPS_ADDED);
+		nmp_object_unref (objs[i]);
+	}
+	_print (scenario, "cache-add", (double) (_now () - ts) / n, "ns/object");
+	_print (scenario, "memory", (double) (_n_bytes - n_bytes_before) / n, "bytes/object");
+	return cache;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	guint64 n_callbacks;
+} FanoutData;
+
+static void
+_signal_cb (NMPlatform *platform,
+            int obj_type_i,
+            int ifindex,
+            gconstpointer plobj,
+            int change_type_i,
+            FanoutData *data)
+{
+	data->n_callbacks++;
+}
+
+static void
+_subscribe_cb (NMPlatform *platform,
+               const NMPObject *obj,
+               NMPlatformSignalChangeType change_type,
+               gpointer user_data)
+{
+	FanoutData *data = user_data;
+
+	data->n_callbacks++;
+}
+
+static gulong *
+_fanout_connect (NMPlatform *platform, const char *signal, FanoutData *data)
+{
+	gulong *ids;
+	guint i;
+
+	ids = g_new (gulong, MAX (global_opt.n_listeners, 0) + 1);
+	for (i = 0; i < MAX (global_opt.n_listeners, 0); i++)
+		ids[i] = g_signal_connect (platform, signal, G_CALLBACK (_signal_cb), data);
+	ids[i] = 0;
+	return ids;
+}
+
+static void
+_fanout_disconnect (NMPlatform *platform, gulong *ids)
+{
+	guint i;
+
+	for (i = 0; ids[i]; i++)
+		g_signal_handler_disconnect (platform, ids[i]);
+	g_free (ids);
+}
+
+static void
+_fanout_print (const char *scenario, gint64 duration_ns, guint n_changes, const FanoutData *data)
+{
+	_print (scenario, "fanout", (double) duration_ns / MAX (n_changes, 1u), "ns/change");
+	_print (scenario, "fanout-callbacks", (double) data->n_callbacks / MAX (n_changes, 1u), "callbacks/change");
+}
+
+static int
+_fake_link_add (NMPlatform *platform, const char *name)
+{
+	const NMPlatformLink *pllink;
+
+	if (nm_platform_link_dummy_add (platform, name, &pllink) != NM_PLATFORM_ERROR_SUCCESS)
+		g_assert_not_reached ();
+	if (!nm_platform_link_set_up (platform, pllink->ifindex, NULL))
+		g_assert_not_reached ();
+	return pllink->ifindex;
+}
+
+/*****************************************************************************/
+
+static void
+bench_links (NMPlatform *platform)
+{
+	const char *const scenario = "links";
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPCache *cache;
+	NMPObject **objs;
+	gs_free guint *order = NULL;
+	gs_free int *ifindexes = NULL;
+	FanoutData fanout = { 0 };
+	guint n = MAX (global_opt.n_links, 1);
+	guint n_fake = MIN (n, (guint) MAX (global_opt.n_fake_ops, 1));
+	gint64 n_bytes;
+	gint64 ts;
+	gulong *ids;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+
+	objs = g_new (NMPObject *, n);
+	n_bytes = _n_bytes;
+	for (i = 0; i < n; i++) {
+		objs[i] = nmp_object_new (NMP_OBJECT_TYPE_LINK, NULL);
+		objs[i]->link.ifindex = i + 1;
+		objs[i]->link.type = NM_LINK_TYPE_DUMMY;
+		objs[i]->link.n_ifi_flags = IFF_UP;
+		nm_sprintf_buf (objs[i]->link.name, "bench%u", i);
+		objs[i]->_link.netlink.is_in_netlink = TRUE;
+	}
+	cache = _cache_fill (scenario, multi_idx, objs, n, n_bytes);
+	g_free (objs);
+
+	order = _shuffled_indexes (n);
+
+	ts = _now ();
+	for (i = 0; i < n; i++) {
+		if (!nmp_cache_lookup_link (cache, order[i] + 1))
+			g_assert_not_reached ();
+	}
+	_print (scenario, "lookup-ifindex", (double) (_now () - ts) / n, "ns/lookup");
+
+	ts = _now ();
+	for (i = 0; i < n; i++) {
+		char name[IFNAMSIZ];
+
+		nm_sprintf_buf (name, "bench%u", order[i]);
+		if (!nmp_cache_lookup_link_full (cache, 0, name, FALSE, NM_LINK_TYPE_NONE, NULL, NULL))
+			g_assert_not_reached ();
+	}
+	_print (scenario, "lookup-ifname", (double) (_now () - ts) / n, "ns/lookup");
+
+	ts = _now ();
+	for (i = 0; i < n; i++) {
+		NMPObject obj_id;
+
+		_cache_remove (cache, nmp_object_stackinit_id_link (&obj_id, order[i] + 1));
+	}
+	_print (scenario, "cache-remove", (double) (_now () - ts) / n, "ns/object");
+
+	nmp_cache_free (cache);
+
+	/* every link has a subscriber (like NMDevice), and there are other
+	 * listeners for all links. */
+	ifindexes = g_new (int, n_fake);
+	for (i = 0; i < n_fake; i++) {
+		char name[IFNAMSIZ];
+
+		nm_sprintf_buf (name, "bl%u", i);
+		ifindexes[i] = _fake_link_add (platform, name);
+		nm_platform_object_subscribe (platform, NMP_OBJECT_TYPE_LINK, ifindexes[i], _subscribe_cb, &fanout);
+	}
+	ids = _fanout_connect (platform, NM_PLATFORM_SIGNAL_LINK_CHANGED, &fanout);
+
+	ts = _now ();
+	for (i = 0; i < n_fake; i++) {
+		if (!nm_platform_link_set_down (platform, ifindexes[i]))
+			g_assert_not_reached ();
+	}
+	_fanout_print (scenario, _now () - ts, n_fake, &fanout);
+
+	_fanout_disconnect (platform, ids);
+	for (i = 0; i < n_fake; i++) {
+		nm_platform_object_unsubscribe (platform, NMP_OBJECT_TYPE_LINK, ifindexes[i], _subscribe_cb, &fanout);
+		nm_platform_link_delete (platform, ifindexes[i]);
+	}
+}
+
+/*****************************************************************************/
+
+#define BENCH_N_IFINDEXES 16
+
+static NMPObject *
+_ip4_route_new (guint i, guint n_ifindexes)
+{
+	NMPObject *obj;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+	obj->ip4_route.ifindex = 1 + (i % n_ifindexes);
+	obj->ip4_route.network = htonl (0x0a000000u + i);
+	obj->ip4_route.plen = 32;
+	obj->ip4_route.metric = 100;
+	obj->ip4_route.rt_source = NM_IP_CONFIG_SOURCE_RTPROT_STATIC;
+	obj->ip4_route.table_coerced = nm_platform_route_table_coerce (RT_TABLE_MAIN);
+	return obj;
+}
+
+static void
+bench_routes (NMPlatform *platform)
+{
+	const char *const scenario = "routes";
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPCache *cache;
+	NMPObject **objs;
+	gs_free guint *order = NULL;
+	guint n = MAX (global_opt.n_routes, 1);
+	guint n_lookup = MIN (n, 100000u);
+	gint64 n_bytes;
+	gint64 ts;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+
+	objs = g_new (NMPObject *, n);
+	n_bytes = _n_bytes;
+	for (i = 0; i < n; i++)
+		objs[i] = _ip4_route_new (i, BENCH_N_IFINDEXES);
+	cache = _cache_fill (scenario, multi_idx, objs, n, n_bytes);
+	g_free (objs);
+
+	order = _shuffled_indexes (n);
+
+	ts = _now ();
+	for (i = 0; i < n_lookup; i++) {
+		nm_auto_nmpobj NMPObject *obj = _ip4_route_new (order[i], BENCH_N_IFINDEXES);
+
+		if (!nmp_cache_lookup_obj (cache, obj))
+			g_assert_not_reached ();
+	}
+	_print (scenario, "lookup-id", (double) (_now () - ts) / n_lookup, "ns/lookup");
+
+	ts = _now ();
+	for (i = 0; i < n_lookup; i++) {
+		NMPLookup lookup;
+
+		nmp_lookup_init_addrroute (&lookup, NMP_OBJECT_TYPE_IP4_ROUTE, 1 + (order[i] % BENCH_N_IFINDEXES));
+		if (!nmp_cache_lookup (cache, &lookup))
+			g_assert_not_reached ();
+	}
+	_print (scenario, "lookup-ifindex", (double) (_now () - ts) / n_lookup, "ns/lookup");
+
+	ts = _now ();
+	for (i = 0; i < n_lookup; i++) {
+		in_addr_t addr = htonl (0x0a000000u + order[i]);
+		NMPLookup lookup;
+
+		nmp_lookup_init_route_by_destination (&lookup, NMP_OBJECT_TYPE_IP4_ROUTE,
+		                                      nm_platform_route_table_coerce (RT_TABLE_MAIN),
+		                                      &addr, 32);
+		if (!nmp_cache_lookup (cache, &lookup))
+			g_assert_not_reached ();
+	}
+	_print (scenario, "lookup-destination", (double) (_now () - ts) / n_lookup, "ns/lookup");
+
+	ts = _now ();
+	for (i = 0; i < n; i++) {
+		nm_auto_nmpobj NMPObject *obj = _ip4_route_new (order[i], BENCH_N_IFINDEXES);
+
+		_cache_remove (cache, obj);
+	}
+	_print (scenario, "cache-remove", (double) (_now () - ts) / n, "ns/object");
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static void
+bench_route_flaps (NMPlatform *platform)
+{
+	const char *const scenario = "route-flaps";
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPCache *cache;
+	NMPObject **objs;
+	FanoutData fanout = { 0 };
+	guint n = MAX (global_opt.n_flap_routes, 1);
+	guint n_flaps = MAX (global_opt.n_flaps, 1);
+	guint n_fake = MIN (n, (guint) MAX (global_opt.n_fake_ops, 1));
+	gint64 n_bytes;
+	gint64 ts;
+	gulong *ids;
+	int ifindex;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+
+	objs = g_new (NMPObject *, n);
+	n_bytes = _n_bytes;
+	for (i = 0; i < n; i++)
+		objs[i] = _ip4_route_new (i, BENCH_N_IFINDEXES);
+	cache = _cache_fill (scenario, multi_idx, objs, n, n_bytes);
+	g_free (objs);
+
+	/* a flap removes a route and adds it again. */
+	ts = _now ();
+	for (i = 0; i < n_flaps; i++) {
+		guint r = nmtst_get_rand_int () % n;
+		NMPObject *obj = _ip4_route_new (r, BENCH_N_IFINDEXES);
+
+		_cache_remove (cache, obj);
+		_cache_update (cache, obj, NMP_CACHE_OPS_ADDED);
+		nmp_object_unref (obj);
+	}
+	_print (scenario, "cache-flap", (double) (_now () - ts) / n_flaps, "ns/flap");
+
+	nmp_cache_free (cache);
+
+	ifindex = _fake_link_add (platform, "bench-flap");
+	for (i = 0; i < n_fake; i++) {
+		nm_auto_nmpobj NMPObject *obj = _ip4_route_new (i, 1);
+
+		obj->ip4_route.ifindex = ifindex;
+		if (nm_platform_ip_route_add (platform, NMP_NLM_FLAG_REPLACE, obj) != NM_PLATFORM_ERROR_SUCCESS)
+			g_assert_not_reached ();
+	}
+
+	ids = _fanout_connect (platform, NM_PLATFORM_SIGNAL_IP4_ROUTE_CHANGED, &fanout);
+	ts = _now ();
+	for (i = 0; i < n_fake; i++) {
+		nm_auto_nmpobj NMPObject *obj = _ip4_route_new (nmtst_get_rand_int () % n_fake, 1);
+
+		obj->ip4_route.ifindex = ifindex;
+		if (   !nm_platform_ip_route_delete (platform, obj)
+		    || nm_platform_ip_route_add (platform, NMP_NLM_FLAG_REPLACE, obj) != NM_PLATFORM_ERROR_SUCCESS)
+			g_assert_not_reached ();
+	}
+	_fanout_print (scenario, _now () - ts, 2 * n_fake, &fanout);
+	_fanout_disconnect (platform, ids);
+
+	nm_platform_link_delete (platform, ifindex);
+}
+
+/*****************************************************************************/
+
+static NMPObject *
+_ip4_address_new (guint i, guint32 timestamp, guint32 lifetime)
+{
+	NMPObject *obj;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ADDRESS, NULL);
+	obj->ip4_address.ifindex = 1 + (i % BENCH_N_IFINDEXES);
+	obj->ip4_address.address = htonl (0xac100000u + i);
+	obj->ip4_address.peer_address = obj->ip4_address.address;
+	obj->ip4_address.plen = 24;
+	obj->ip4_address.timestamp = timestamp;
+	obj->ip4_address.lifetime = lifetime;
+	obj->ip4_address.preferred = lifetime / 2;
+	return obj;
+}
+
+static void
+bench_address_churn (NMPlatform *platform)
+{
+	const char *const scenario = "address-churn";
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPCache *cache;
+	NMPObject **objs;
+	FanoutData fanout = { 0 };
+	guint n = MAX (global_opt.n_addresses, 1);
+	guint n_churn = MAX (global_opt.n_churn, 1);
+	guint n_fake = MIN (n, (guint) MAX (global_opt.n_fake_ops, 1));
+	gint64 n_bytes;
+	gint64 ts;
+	gulong *ids;
+	int ifindex;
+	guint i, j;
+
+	multi_idx = nm_dedup_multi_index_new ();
+
+	objs = g_new (NMPObject *, n);
+	n_bytes = _n_bytes;
+	for (i = 0; i < n; i++)
+		objs[i] = _ip4_address_new (i, 1, 3600);
+	cache = _cache_fill (scenario, multi_idx, objs, n, n_bytes);
+	g_free (objs);
+
+	/* like a DHCP renewal or kernel refreshing the lifetimes, every
+	 * churn updates all addresses. */
+	ts = _now ();
+	for (j = 0; j < n_churn; j++) {
+		for (i = 0; i < n; i++) {
+			NMPObject *obj = _ip4_address_new (i, 2 + j, 3600);
+
+			_cache_update (cache, obj, NMP_CACHE_OPS_UPDATED);
+			nmp_object_unref (obj);
+		}
+	}
+	_print (scenario, "cache-update", (double) (_now () - ts) / ((guint64) n * n_churn), "ns/update");
+
+	nmp_cache_free (cache);
+
+	ifindex = _fake_link_add (platform, "bench-addr");
+	for (i = 0; i < n_fake; i++) {
+		if (!nm_platform_ip4_address_add (platform, ifindex, htonl (0xac100000u + i), 24,
+		                                  htonl (0xac100000u + i), 3600, 1800, 0, NULL))
+			g_assert_not_reached ();
+	}
+
+	ids = _fanout_connect (platform, NM_PLATFORM_SIGNAL_IP4_ADDRESS_CHANGED, &fanout);
+	ts = _now ();
+	for (i = 0; i < n_fake; i++) {
+		if (!nm_platform_ip4_address_add (platform, ifindex, htonl (0xac100000u + i), 24,
+		                                  htonl (0xac100000u + i), 7200, 3600, 0, NULL))
+			g_assert_not_reached ();
+	}
+	_fanout_print (scenario, _now () - ts, n_fake, &fanout);
+	_fanout_disconnect (platform, ids);
+
+	nm_platform_link_delete (platform, ifindex);
+}
+
+/*****************************************************************************/
+
+static void
+bench_dump (const char *file)
+{
+	const char *const scenario = "dump";
+	gs_unref_object NMPlatform *platform = NULL;
+	gs_free_error GError *error = NULL;
+	gs_free char *contents = NULL;
+	struct nlmsghdr *hdr;
+	gsize len;
+	guint n_msgs = 0;
+	gint64 n_bytes;
+	guint64 n_allocs;
+	gint64 ts;
+	int remaining;
+
+	if (!g_file_get_contents (file, &contents, &len, &error)) {
+		g_printerr ("Cannot read %s: %s\n", file, error->message);
+		return;
+	}
+
+	for (hdr = (struct nlmsghdr *) contents, remaining = len;
+	     NLMSG_OK (hdr, remaining);
+	     hdr = NLMSG_NEXT (hdr, remaining))
+		n_msgs++;
+	if (!n_msgs) {
+		g_printerr ("No netlink messages in %s\n", file);
+		return;
+	}
+
+	platform = nm_linux_platform_new (TRUE, NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	n_bytes = _n_bytes;
+	n_allocs = _n_allocs;
+	ts = _now ();
+	_nmtst_linux_platform_process_netlink_msgs (platform, contents, len);
+	_print (scenario, "process", (double) (_now () - ts) / n_msgs, "ns/message");
+	_print (scenario, "allocations", (double) (_n_allocs - n_allocs) / n_msgs, "allocations/message");
+	_print (scenario, "memory", (double) (_n_bytes - n_bytes) / n_msgs, "bytes/message");
+}
+
+/*****************************************************************************/
+
+static gboolean
+_scenario_enabled (const char *name)
+{
+	gs_strfreev char **names = NULL;
+
+	if (!global_opt.scenarios)
+		return !nm_streq (name, "dump") || global_opt.file;
+
+	names = g_strsplit (global_opt.scenarios, ",", -1);
+	return g_strv_contains ((const char *const*) names, name);
+}
+
+int
+main (int argc, char **argv)
+{
+	NMPlatform *platform;
+
+	g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	nm_fake_platform_setup ();
+	platform = NM_PLATFORM_GET;
+
+	g_print ("# scenario\tmetric\tvalue\tunit\n");
+
+	if (_scenario_enabled ("links"))
+		bench_links (platform);
+	if (_scenario_enabled ("routes"))
+		bench_routes (platform);
+	if (_scenario_enabled ("route-flaps"))
+		bench_route_flaps (platform);
+	if (_scenario_enabled ("address-churn"))
+		bench_address_churn (platform);
+	if (_scenario_enabled ("dump")) {
+		if (global_opt.file)
+			bench_dump (global_opt.file);
+		else
+			g_printerr ("Scenario \"dump\" requires --file\n");
+	}
+
+	g_free (global_opt.scenarios);
+	g_free (global_opt.file);
+	return EXIT_SUCCESS;
+}
@@ -249,6 +249,107 @@ test_ip6_address_general_2 (void)
 
 /*****************************************************************************/
 
+#define SYNC_N_ADDRESSES 100
+
+static void
+test_ip4_address_sync (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	gs_unref_ptrarray GPtrArray *known_addresses = NULL;
+	gs_unref_array GArray *addresses = NULL;
+	guint i;
+
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, DEVICE_IFINDEX, NULL));
+
+	known_addresses = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < SYNC_N_ADDRESSES; i++) {
+		NMPlatformIP4Address a = {
+			.ifindex = ifindex,
+			.address = htonl (0xc0000200u + i + 1),
+			.peer_address = htonl (0xc0000200u + i + 1),
+			.plen = IP4_PLEN,
+			.lifetime = NM_PLATFORM_LIFETIME_PERMANENT,
+			.preferred = NM_PLATFORM_LIFETIME_PERMANENT,
+		};
+
+		g_ptr_array_add (known_addresses, nmp_object_new (NMP_OBJECT_TYPE_IP4_ADDRESS, (const NMPlatformObject *) &a));
+	}
+
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_addresses));
+	for (i = 0; i < SYNC_N_ADDRESSES; i++) {
+		const NMPlatformIP4Address *a = NMP_OBJECT_CAST_IP4_ADDRESS (known_addresses->pdata[i]);
+
+		g_assert (a);
+		g_assert (nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, a->address, a->plen, a->peer_address));
+	}
+
+	/* drop every second address. */
+	for (i = 0; i < SYNC_N_ADDRESSES; i += 2)
+		g_ptr_array_remove_index (known_addresses, SYNC_N_ADDRESSES - i - 1);
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, known_addresses));
+	addresses = nmtstp_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addresses->len, ==, SYNC_N_ADDRESSES / 2);
+	for (i = 0; i < known_addresses->len; i++) {
+		const NMPlatformIP4Address *a = NMP_OBJECT_CAST_IP4_ADDRESS (known_addresses->pdata[i]);
+
+		g_assert (a);
+		g_assert (nm_platform_ip4_address_get (NM_PLATFORM_GET, ifindex, a->address, a->plen, a->peer_address));
+	}
+
+	g_assert (nm_platform_ip4_address_sync (NM_PLATFORM_GET, ifindex, NULL));
+	g_array_unref (addresses);
+	addresses = nmtstp_platform_ip4_address_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (addresses->len, ==, 0);
+}
+
+static void
+test_ip6_address_sync (void)
+{
+	const int ifindex = DEVICE_IFINDEX;
+	gs_unref_ptrarray GPtrArray *known_addresses = NULL;
+	struct in6_addr addr;
+	guint i;
+
+	g_assert (nm_platform_link_set_up (NM_PLATFORM_GET, DEVICE_IFINDEX, NULL));
+
+	inet_pton (AF_INET6, IP6_ADDRESS, &addr);
+
+	known_addresses = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < SYNC_N_ADDRESSES; i++) {
+		NMPlatformIP6Address a = {
+			.ifindex = ifindex,
+			.address = addr,
+			.plen = IP6_PLEN,
+			.lifetime = NM_PLATFORM_LIFETIME_PERMANENT,
+			.preferred = NM_PLATFORM_LIFETIME_PERMANENT,
+			.n_ifa_flags = IFA_F_NODAD,
+		};
+
+		a.address.s6_addr[15] = i + 1;
+		g_ptr_array_add (known_addresses, nmp_object_new (NMP_OBJECT_TYPE_IP6_ADDRESS, (const NMPlatformObject *) &a));
+	}
+
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, known_addresses, TRUE));
+	for (i = 0; i < SYNC_N_ADDRESSES; i++)
+		g_assert (nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, NMP_OBJECT_CAST_IP6_ADDRESS (known_addresses->pdata[i])->address));
+
+	/* keep only the first half. */
+	g_ptr_array_set_size (known_addresses, SYNC_N_ADDRESSES / 2);
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, known_addresses, TRUE));
+	for (i = 0; i < SYNC_N_ADDRESSES; i++) {
+		addr.s6_addr[15] = i + 1;
+		g_assert ((!!nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, addr)) == (i < SYNC_N_ADDRESSES / 2));
+	}
+
+	g_assert (nm_platform_ip6_address_sync (NM_PLATFORM_GET, ifindex, NULL, TRUE));
+	for (i = 0; i < SYNC_N_ADDRESSES; i++) {
+		addr.s6_addr[15] = i + 1;
+		g_assert (!nm_platform_ip6_address_get (NM_PLATFORM_GET, ifindex, addr));
+	}
+}
+
+/*****************************************************************************/
+
 static void
 test_ip4_address_peer (void)
 {
@@ -375,6 +476,9 @@ _nmtstp_setup_tests (void)
 	add_test_func ("/address/ipv4/general-2", test_ip4_address_general_2);
 	add_test_func ("/address/ipv6/general-2", test_ip6_address_general_2);
 
+	add_test_func ("/address/ipv4/sync", test_ip4_address_sync);
+	add_test_func ("/address/ipv6/sync", test_ip6_address_sync);
+
 	add_test_func ("/address/ipv4/peer", test_ip4_address_peer);
 	add_test_func ("/address/ipv4/peer/zero", test_ip4_address_peer_zero);
 }
@@ -21,9 +21,13 @@
 #include "nm-default.h"
 
 #include <linux/rtnetlink.h>
+#include <linux/if_arp.h>
+#include <netlink/msg.h>
+#include <netlink/attr.h>
 
 #include "platform/nm-platform-utils.h"
 #include "platform/nm-linux-platform.h"
+#include "platform/nm-platform-private.h"
 
 #include "nm-test-utils-core.h"
 
@@ -53,6 +57,150 @@ test_link_get_all (void)
 
 /*****************************************************************************/
 
+static void
+test_ip_route_filter (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	const NMPlatformIPRouteFilter *filter;
+
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("bird"), ==, 12);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("186"), ==, 186);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("256"), ==, -1);
+	g_assert_cmpint (nmp_utils_rtprot_from_string ("foo"), ==, -1);
+
+	platform = g_object_new (NM_TYPE_LINUX_PLATFORM,
+	                         NM_PLATFORM_LOG_WITH_PTR, TRUE,
+	                         NM_PLATFORM_IGNORE_ROUTE_TABLES, "5000-6000, 100;local 250-300",
+	                         NM_PLATFORM_IGNORE_ROUTE_PROTOCOLS, "zebra,42",
+	                         NULL);
+	filter = nm_platform_get_ip_route_filter (platform);
+	g_assert (filter);
+
+	g_assert (nm_platform_ip_route_filter_ignores_table (filter, 100));
+	g_assert (nm_platform_ip_route_filter_ignores_table (filter, 255));
+	g_assert (nm_platform_ip_route_filter_ignores_table (filter, 250));
+	g_assert (nm_platform_ip_route_filter_ignores_table (filter, 300));
+	g_assert (nm_platform_ip_route_filter_ignores_table (filter, 5500));
+	g_assert (!nm_platform_ip_route_filter_ignores_table (filter, 254));
+	g_assert (!nm_platform_ip_route_filter_ignores_table (filter, 301));
+	g_assert (!nm_platform_ip_route_filter_ignores_table (filter, 6001));
+
+	g_assert (nm_platform_ip_route_filter_ignores_protocol (filter, 11));
+	g_assert (nm_platform_ip_route_filter_ignores_protocol (filter, 42));
+	g_assert (!nm_platform_ip_route_filter_ignores_protocol (filter, RTPROT_STATIC));
+}
+
+/*****************************************************************************/
+
+/* an ifindex that doesn't exist, so that all ethtool requests fail. */
+#define ETHTOOL_TEST_IFINDEX 0x7FFFFF00
+
+static void
+_inject_link (NMPlatform *platform, int nlmsg_type, guint32 mtu)
+{
+	const struct ifinfomsg ifi = {
+		.ifi_family = AF_UNSPEC,
+		.ifi_type = ARPHRD_ETHER,
+		.ifi_index = ETHTOOL_TEST_IFINDEX,
+	};
+	struct nl_msg *nlmsg;
+	struct nlmsghdr *hdr;
+
+	nlmsg = nlmsg_alloc_simple (nlmsg_type, 0);
+	g_assert (nlmsg);
+	if (   nlmsg_append (nlmsg, (void *) &ifi, sizeof (ifi), NLMSG_ALIGNTO) < 0
+	    || nla_put_string (nlmsg, IFLA_IFNAME, "nm-ethtool-tst") < 0
+	    || nla_put_u32 (nlmsg, IFLA_MTU, mtu) < 0)
+		g_assert_not_reached ();
+
+	hdr = nlmsg_hdr (nlmsg);
+	_nmtst_linux_platform_process_netlink_msgs (platform, hdr, hdr->nlmsg_len);
+	nlmsg_free (nlmsg);
+}
+
+static void
+test_ethtool_cache (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	NMLinuxPlatformEthtoolStats stats_0, stats;
+
+	platform = nm_linux_platform_new (TRUE, NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	_inject_link (platform, RTM_NEWLINK, 1500);
+	g_assert (nm_platform_link_get (platform, ETHTOOL_TEST_IFINDEX));
+
+	/* the failed requests are asked once, and then answered from the cache. */
+	nm_linux_platform_get_ethtool_stats (platform, &stats_0);
+	g_assert (!nm_platform_link_supports_carrier_detect (platform, ETHTOOL_TEST_IFINDEX));
+	g_assert (!nm_platform_link_supports_vlans (platform, ETHTOOL_TEST_IFINDEX));
+	nm_linux_platform_get_ethtool_stats (platform, &stats);
+	g_assert_cmpint (stats.n_requests - stats_0.n_requests, ==, 3);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 0);
+
+	stats_0 = stats;
+	g_assert (!nm_platform_link_supports_carrier_detect (platform, ETHTOOL_TEST_IFINDEX));
+	g_assert (!nm_platform_link_supports_vlans (platform, ETHTOOL_TEST_IFINDEX));
+	nm_linux_platform_get_ethtool_stats (platform, &stats);
+	g_assert_cmpint (stats.n_requests - stats_0.n_requests, ==, 0);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 2);
+
+	/* after the link changed, they are asked again. */
+	_inject_link (platform, RTM_NEWLINK, 1400);
+	nm_linux_platform_get_ethtool_stats (platform, &stats_0);
+	g_assert (!nm_platform_link_supports_carrier_detect (platform, ETHTOOL_TEST_IFINDEX));
+	g_assert (!nm_platform_link_supports_vlans (platform, ETHTOOL_TEST_IFINDEX));
+	nm_linux_platform_get_ethtool_stats (platform, &stats);
+	g_assert_cmpint (stats.n_requests - stats_0.n_requests, ==, 3);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 0);
+
+	/* without the link, nothing is cached. */
+	_inject_link (platform, RTM_DELLINK, 1400);
+	g_assert (!nm_platform_link_get (platform, ETHTOOL_TEST_IFINDEX));
+	nm_linux_platform_get_ethtool_stats (platform, &stats_0);
+	g_assert (!nm_platform_link_supports_carrier_detect (platform, ETHTOOL_TEST_IFINDEX));
+	g_assert (!nm_platform_link_supports_carrier_detect (platform, ETHTOOL_TEST_IFINDEX));
+	nm_linux_platform_get_ethtool_stats (platform, &stats);
+	g_assert_cmpint (stats.n_requests - stats_0.n_requests, ==, 4);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 0);
+}
+
+/*****************************************************************************/
+
+static void
+test_resync_stats (void)
+{
+	gs_unref_object NMPlatform *platform = NULL;
+	NMLinuxPlatformResyncStats stats;
+
+	platform = nm_linux_platform_new (TRUE, NM_PLATFORM_NETNS_SUPPORT_DEFAULT);
+
+	nm_linux_platform_get_resync_stats (platform, &stats);
+	g_assert_cmpint (stats.n_overflows, ==, 0);
+	g_assert_cmpint (stats.n_resyncs, ==, 0);
+
+	/* an overflow of the route events only resyncs the routes. */
+	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_INFO, "*netlink: read: too many netlink events. Need to resynchronize routes*");
+	_nmtst_linux_platform_netlink_overflow (platform, TRUE);
+	g_test_assert_expected_messages ();
+	nm_linux_platform_get_resync_stats (platform, &stats);
+	g_assert_cmpint (stats.n_overflows, ==, 1);
+	g_assert_cmpint (stats.n_resyncs, ==, 1);
+	g_assert_cmpint (stats.n_resyncs_full, ==, 0);
+	g_assert_cmpint (stats.duration_total_ns, ==, stats.duration_last_ns);
+
+	/* an overflow of the main socket resyncs everything. */
+	g_test_expect_message ("NetworkManager", G_LOG_LEVEL_INFO, "*netlink: read: too many netlink events. Need to resynchronize platform cache*");
+	_nmtst_linux_platform_netlink_overflow (platform, FALSE);
+	g_test_assert_expected_messages ();
+	nm_linux_platform_get_resync_stats (platform, &stats);
+	g_assert_cmpint (stats.n_overflows, ==, 2);
+	g_assert_cmpint (stats.n_resyncs, ==, 2);
+	g_assert_cmpint (stats.n_resyncs_full, ==, 1);
+	g_assert_cmpint (stats.duration_total_ns, >=, stats.duration_last_ns);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -62,6 +210,9 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/general/init_linux_platform", test_init_linux_platform);
 	g_test_add_func ("/general/link_get_all", test_link_get_all);
+	g_test_add_func ("/general/ip_route_filter", test_ip_route_filter);
+	g_test_add_func ("/general/ethtool_cache", test_ethtool_cache);
+	g_test_add_func ("/general/resync_stats", test_resync_stats);
 
 	return g_test_run ();
 }
@@ -24,6 +24,8 @@
 #include <sys/mount.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 
 #include "platform/nmp-object.h"
 #include "platform/nmp-netns.h"
@@ -620,6 +622,299 @@ test_internal (void)
 
 /*****************************************************************************/
 
+typedef struct {
+	int ifindex;
+	guint n_changed;
+	guint n_removed;
+	gboolean unsubscribe;
+} SubscribeData;
+
+static void
+_subscribe_cb (NMPlatform *platform,
+               const NMPObject *obj,
+               NMPlatformSignalChangeType change_type,
+               gpointer user_data)
+{
+	SubscribeData *data = user_data;
+
+	g_assert (NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_LINK);
+	if (data->ifindex)
+		g_assert_cmpint (obj->link.ifindex, ==, data->ifindex);
+
+	if (change_type == NM_PLATFORM_SIGNAL_REMOVED)
+		data->n_removed++;
+	else if (change_type == NM_PLATFORM_SIGNAL_CHANGED)
+		data->n_changed++;
+
+	if (data->unsubscribe) {
+		g_assert (nm_platform_object_unsubscribe (platform, NMP_OBJECT_TYPE_LINK, data->ifindex, _subscribe_cb, data));
+		data->unsubscribe = FALSE;
+	}
+}
+
+static void
+test_subscribe (void)
+{
+	SubscribeData data_1 = { 0 };
+	SubscribeData data_1_once = { 0 };
+	SubscribeData data_all = { 0 };
+	int ifindex_1, ifindex_2;
+
+	ifindex_1 = nmtstp_link_dummy_add (NULL, -1, DEVICE_NAME)->ifindex;
+	ifindex_2 = nmtstp_link_dummy_add (NULL, -1, SLAVE_NAME)->ifindex;
+
+	data_1.ifindex = ifindex_1;
+	data_1_once.ifindex = ifindex_1;
+	data_1_once.unsubscribe = TRUE;
+	nm_platform_object_subscribe (NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK, ifindex_1, _subscribe_cb, &data_1_once);
+	nm_platform_object_subscribe (NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK, ifindex_1, _subscribe_cb, &data_1);
+	nm_platform_object_subscribe (NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK, 0, _subscribe_cb, &data_all);
+
+	/* changes of another link only reach the wildcard subscription. */
+	nmtstp_link_set_updown (NULL, -1, ifindex_2, TRUE);
+	g_assert_cmpint (data_1.n_changed, ==, 0);
+	g_assert_cmpint (data_1_once.n_changed, ==, 0);
+	g_assert_cmpint (data_all.n_changed, >, 0);
+
+	data_all.n_changed = 0;
+	nmtstp_link_set_updown (NULL, -1, ifindex_1, TRUE);
+	g_assert_cmpint (data_1.n_changed, >, 0);
+	g_assert_cmpint (data_1_once.n_changed, ==, 1);
+	g_assert_cmpint (data_all.n_changed, >=, data_1.n_changed);
+
+	nmtstp_link_set_updown (NULL, -1, ifindex_1, FALSE);
+	g_assert_cmpint (data_1_once.n_changed, ==, 1);
+	g_assert (!nm_platform_object_unsubscribe (NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK, ifindex_1, _subscribe_cb, &data_1_once));
+
+	nmtstp_link_del (NULL, -1, ifindex_1, DEVICE_NAME);
+	g_assert_cmpint (data_1.n_removed, ==, 1);
+	g_assert_cmpint (data_all.n_removed, ==, 1);
+
+	g_assert (nm_platform_object_unsubscribe (NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK, ifindex_1, _subscribe_cb, &data_1));
+	g_assert (nm_platform_object_unsubscribe (NM_PLATFORM_GET, NMP_OBJECT_TYPE_LINK, 0, _subscribe_cb, &data_all));
+
+	nmtstp_link_del (NULL, -1, ifindex_2, SLAVE_NAME);
+	g_assert_cmpint (data_all.n_removed, ==, 1);
+}
+
+/*****************************************************************************/
+
+static void
+_stats_send_udp (in_addr_t dst, guint n)
+{
+	struct sockaddr_in sin = {
+		.sin_family = AF_INET,
+		.sin_addr.s_addr = dst,
+		.sin_port = htons (9),
+	};
+	int fd;
+	guint i;
+
+	fd = socket (AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	g_assert (fd >= 0);
+	for (i = 0; i < n; i++)
+		g_assert_cmpint (sendto (fd, "x", 1, 0, (struct sockaddr *) &sin, sizeof (sin)), ==, 1);
+	close (fd);
+}
+
+static void
+test_stats_subscribe (void)
+{
+	GMainLoop *loop;
+	SignalData *link_changed;
+	const NMPlatformLink *pllink;
+	guint64 tx_packets;
+	int ifindex;
+
+	loop = g_main_loop_new (NULL, FALSE);
+
+	ifindex = nmtstp_link_dummy_add (NULL, -1, DEVICE_NAME)->ifindex;
+
+	/* without IPv6, kernel sends no packets on its own and the counters
+	 * of the link only change with the traffic that we generate. */
+	nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "disable_ipv6", "1");
+	nmtstp_link_set_updown (NULL, -1, ifindex, TRUE);
+
+	link_changed = add_signal_ifindex (NM_PLATFORM_SIGNAL_LINK_CHANGED, NM_PLATFORM_SIGNAL_CHANGED, link_callback, ifindex);
+
+	/* subscriptions are counted, and links with different refresh
+	 * rates are polled separately. */
+	nm_platform_link_stats_subscribe (NM_PLATFORM_GET, ifindex, 50);
+	nm_platform_link_stats_subscribe (NM_PLATFORM_GET, ifindex, 50);
+	nm_platform_link_stats_subscribe (NM_PLATFORM_GET, LO_INDEX, 70);
+
+	g_assert (!nmtst_main_loop_run (loop, 200));
+	pllink = nmtstp_link_get (NM_PLATFORM_GET, ifindex, DEVICE_NAME);
+	g_assert (NM_FLAGS_HAS (pllink->n_ifi_flags, IFF_UP));
+
+	/* the link is polled several times meanwhile, but as its counters
+	 * don't change, it is not emitted again. */
+	link_changed->received_count = 0;
+	g_assert (!nmtst_main_loop_run (loop, 300));
+	ensure_no_signal (link_changed);
+
+	if (nmtstp_is_root_test ()) {
+		/* the dummy link has no ARP, so the packets get sent (and dropped)
+		 * right away. The next poll picks up the new counters. */
+		nmtstp_ip4_address_add (NULL, -1, ifindex, nmtst_inet4_from_string ("192.0.2.1"), 24,
+		                        nmtst_inet4_from_string ("192.0.2.1"),
+		                        NM_PLATFORM_LIFETIME_PERMANENT, NM_PLATFORM_LIFETIME_PERMANENT, 0, NULL);
+		g_assert (!nmtst_main_loop_run (loop, 100));
+		pllink = nmtstp_link_get (NM_PLATFORM_GET, ifindex, DEVICE_NAME);
+		tx_packets = pllink->tx_packets;
+		link_changed->received_count = 0;
+
+		_stats_send_udp (nmtst_inet4_from_string ("192.0.2.2"), 5);
+		g_assert (!nmtst_main_loop_run (loop, 200));
+		accept_signals (link_changed, 1, G_MAXINT);
+		pllink = nmtstp_link_get (NM_PLATFORM_GET, ifindex, DEVICE_NAME);
+		g_assert_cmpint (pllink->tx_packets, >=, tx_packets + 5);
+	}
+
+	nm_platform_link_stats_unsubscribe (NM_PLATFORM_GET, ifindex, 50);
+	g_assert (!nmtst_main_loop_run (loop, 100));
+	nm_platform_link_stats_unsubscribe (NM_PLATFORM_GET, ifindex, 50);
+	nm_platform_link_stats_unsubscribe (NM_PLATFORM_GET, LO_INDEX, 70);
+
+	/* without subscription, the link is no longer polled. */
+	if (nmtstp_is_root_test ()) {
+		link_changed->received_count = 0;
+		_stats_send_udp (nmtst_inet4_from_string ("192.0.2.2"), 5);
+		g_assert (!nmtst_main_loop_run (loop, 200));
+		ensure_no_signal (link_changed);
+	} else
+		g_assert (!nmtst_main_loop_run (loop, 100));
+
+	free_signal (link_changed);
+	nmtstp_link_del (NULL, -1, ifindex, DEVICE_NAME);
+	g_main_loop_unref (loop);
+}
+
+/*****************************************************************************/
+
+static void
+test_sysctl_ifdir (void)
+{
+	static const NMPlatformSysctlEntry entries[] = {
+		{ "use_tempaddr", "1" },
+		{ "accept_ra",    "0" },
+	};
+	NMPlatformSysctlStats stats_0, stats;
+	gs_free char *value = NULL;
+	int ifindex;
+
+	ifindex = nmtstp_link_dummy_add (NULL, -1, DEVICE_NAME)->ifindex;
+
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats_0);
+
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set - stats_0.n_ifdir_set, ==, 2);
+	g_assert_cmpint (stats.n_ifdir_set_skipped - stats_0.n_ifdir_set_skipped, ==, 1);
+
+	value = nm_platform_sysctl_ifdir_get (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr");
+	g_assert_cmpstr (value, ==, "1");
+	nm_clear_g_free (&value);
+
+	/* the batch only writes what changed. */
+	g_assert (nm_platform_sysctl_ifdir_set_batch (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, entries, G_N_ELEMENTS (entries)));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set - stats_0.n_ifdir_set, ==, 4);
+	g_assert_cmpint (stats.n_ifdir_set_skipped - stats_0.n_ifdir_set_skipped, ==, 2);
+
+	/* writing the absolute path invalidates the shadow value. */
+	g_assert (nm_platform_sysctl_set (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE ("/proc/sys/net/ipv6/conf/"DEVICE_NAME"/use_tempaddr"), "0"));
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set_skipped - stats_0.n_ifdir_set_skipped, ==, 2);
+	value = nm_platform_sysctl_get (NM_PLATFORM_GET, NMP_SYSCTL_PATHID_ABSOLUTE ("/proc/sys/net/ipv6/conf/"DEVICE_NAME"/use_tempaddr"));
+	g_assert_cmpstr (value, ==, "1");
+	nm_clear_g_free (&value);
+
+	/* after invalidating, the same value is written again. */
+	nm_platform_sysctl_ifdir_invalidate (NM_PLATFORM_GET, ifindex);
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set_skipped - stats_0.n_ifdir_set_skipped, ==, 2);
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set_skipped - stats_0.n_ifdir_set_skipped, ==, 3);
+
+	/* an MTU below the IPv6 minimum makes kernel drop the IPv6 directory,
+	 * and re-create it with default values afterwards. The value must be
+	 * written again. */
+	g_assert (nm_platform_link_set_mtu (NM_PLATFORM_GET, ifindex, 1200));
+	g_assert (nm_platform_link_set_mtu (NM_PLATFORM_GET, ifindex, 1500));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats_0);
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set_skipped, ==, stats_0.n_ifdir_set_skipped);
+	value = nm_platform_sysctl_ifdir_get (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr");
+	g_assert_cmpstr (value, ==, "1");
+	nm_clear_g_free (&value);
+
+	/* after re-creating the link, nothing is known about it. */
+	nmtstp_link_del (NULL, -1, ifindex, DEVICE_NAME);
+	g_assert (!nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	g_assert_cmpint (errno, ==, ENODEV);
+
+	ifindex = nmtstp_link_dummy_add (NULL, -1, DEVICE_NAME)->ifindex;
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats_0);
+	g_assert (nm_platform_sysctl_ifdir_set (NM_PLATFORM_GET, ifindex, NMP_SYSCTL_IFDIR_IP6_CONF, "use_tempaddr", "1"));
+	nm_platform_sysctl_get_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_ifdir_set_skipped, ==, stats_0.n_ifdir_set_skipped);
+
+	nmtstp_link_del (NULL, -1, ifindex, DEVICE_NAME);
+}
+
+/*****************************************************************************/
+
+static void
+test_ethtool_cache (void)
+{
+	gs_free char *driver_1 = NULL;
+	gs_free char *driver_2 = NULL;
+	NMLinuxPlatformEthtoolStats stats_0, stats;
+	int ifindex;
+
+	ifindex = nmtstp_link_dummy_add (NULL, -1, DEVICE_NAME)->ifindex;
+
+	/* the second request is answered from the cache. */
+	g_assert (nm_platform_link_get_driver_info (NM_PLATFORM_GET, ifindex, &driver_1, NULL, NULL));
+	nm_linux_platform_get_ethtool_stats (NM_PLATFORM_GET, &stats_0);
+	g_assert (nm_platform_link_get_driver_info (NM_PLATFORM_GET, ifindex, &driver_2, NULL, NULL));
+	nm_linux_platform_get_ethtool_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_requests, ==, stats_0.n_requests);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 1);
+	g_assert_cmpstr (driver_1, ==, "dummy");
+	g_assert_cmpstr (driver_2, ==, driver_1);
+
+	/* also the missing carrier-detect support is cached. */
+	g_assert (!nm_platform_link_supports_carrier_detect (NM_PLATFORM_GET, ifindex));
+	nm_linux_platform_get_ethtool_stats (NM_PLATFORM_GET, &stats_0);
+	g_assert (!nm_platform_link_supports_carrier_detect (NM_PLATFORM_GET, ifindex));
+	nm_linux_platform_get_ethtool_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_requests, ==, stats_0.n_requests);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 1);
+
+	/* only the index of the feature is cached, whether it is active is
+	 * always requested. */
+	g_assert (nm_platform_link_supports_vlans (NM_PLATFORM_GET, ifindex));
+	nm_linux_platform_get_ethtool_stats (NM_PLATFORM_GET, &stats_0);
+	g_assert (nm_platform_link_supports_vlans (NM_PLATFORM_GET, ifindex));
+	nm_linux_platform_get_ethtool_stats (NM_PLATFORM_GET, &stats);
+	g_assert_cmpint (stats.n_requests - stats_0.n_requests, ==, 1);
+	g_assert_cmpint (stats.n_cached - stats_0.n_cached, ==, 1);
+
+	/* ... until the link goes away. */
+	nmtstp_link_del (NULL, -1, ifindex, DEVICE_NAME);
+	g_assert (!nm_platform_link_get_driver_info (NM_PLATFORM_GET, ifindex, NULL, NULL, NULL));
+	g_assert (!nm_platform_link_supports_vlans (NM_PLATFORM_GET, ifindex));
+}
+
+/*****************************************************************************/
+
 static void
 test_external (void)
 {
@@ -2512,9 +2807,13 @@ _nmtstp_setup_tests (void)
 	g_test_add_func ("/link/software/team", test_team);
 	g_test_add_func ("/link/software/vlan", test_vlan);
 	g_test_add_func ("/link/software/bridge/addr", test_bridge_addr);
+	g_test_add_func ("/link/subscribe", test_subscribe);
+	g_test_add_func ("/link/stats-subscribe", test_stats_subscribe);
+	g_test_add_func ("/link/sysctl-ifdir", test_sysctl_ifdir);
 
 	if (nmtstp_is_root_test ()) {
 		g_test_add_func ("/link/external", test_external);
+		g_test_add_func ("/link/ethtool-cache", test_ethtool_cache);
 
 		test_software_detect_add ("/link/software/detect/gre", NM_LINK_TYPE_GRE, 0);
 		test_software_detect_add ("/link/software/detect/ip6tnl", NM_LINK_TYPE_IP6TNL, 0);
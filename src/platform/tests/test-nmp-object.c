@@ -21,8 +21,11 @@
 #include "nm-default.h"
 
 #include <libudev.h>
+#include <netlink/errno.h>
 
 #include "platform/nmp-object.h"
+#include "platform/nmp-prefix-trie.h"
+#include "platform/nmp-nl-builder.h"
 #include "nm-utils/nm-udev-utils.h"
 
 #include "nm-test-utils-core.h"
@@ -233,7 +236,7 @@ _nmp_cache_update_netlink (NMPCache *cache, NMPObject *obj, const NMPObject **ou
 	obj_new_expected = nmp_object_clone (obj, FALSE);
 	if (obj_prev && obj_prev->_link.udev.device)
 		obj_new_expected->_link.udev.device = udev_device_ref (obj_prev->_link.udev.device);
-	_nmp_object_fixup_link_udev_fields (&obj_new_expected, NULL, nmp_cache_use_udev_get (cache));
+	_nmp_object_fixup_link_udev_fields (&obj_new_expected, NULL, NULL, nmp_cache_use_udev_get (cache));
 
 	ops_type = nmp_cache_update_netlink (cache, obj, FALSE, &obj_old, &obj_new);
 	ops_post_check (cache, ops_type, obj_old, obj_new,
@@ -272,11 +275,13 @@ test_cache_link (void)
 	struct udev_device *udev_device_2 = g_list_nth_data (global.udev_devices, 0);
 	struct udev_device *udev_device_3 = g_list_nth_data (global.udev_devices, 0);
 	NMPCacheOpsType ops_type;
+	guint64 generation;
 	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
 
 	multi_idx = nm_dedup_multi_index_new ();
 
 	cache = nmp_cache_new (multi_idx, nmtst_get_rand_int () % 2);
+	generation = nmp_cache_get_generation (cache);
 
 	/* if we have a link, and don't set is_in_netlink, adding it has no effect. */
 	objm1 = nmp_object_new (NMP_OBJECT_TYPE_LINK, (NMPlatformObject *) &pl_link_2);
@@ -286,6 +291,7 @@ test_cache_link (void)
 	ASSERT_nmp_cache_is_consistent (cache);
 	g_assert (!obj_old);
 	g_assert (!obj_new);
+	g_assert_cmpint (nmp_cache_get_generation (cache), ==, generation);
 	g_assert (!nmp_cache_lookup_obj (cache, objm1));
 	g_assert (!nmp_cache_lookup_obj (cache, nmp_object_stackinit_id_link (&objs1, pl_link_2.ifindex)));
 	nmp_object_unref (objm1);
@@ -299,6 +305,8 @@ test_cache_link (void)
 	g_assert (!obj_old);
 	g_assert (obj_new);
 	g_assert (objm1 == obj_new);
+	g_assert_cmpint (nmp_cache_get_generation (cache), >, generation);
+	generation = nmp_cache_get_generation (cache);
 	g_assert (nmp_object_equal (objm1, obj_new));
 	g_assert (nmp_cache_lookup_obj (cache, objm1) == obj_new);
 	g_assert (nmp_cache_lookup_obj (cache, nmp_object_stackinit_id_link (&objs1, pl_link_2.ifindex)) == obj_new);
@@ -317,6 +325,7 @@ test_cache_link (void)
 	g_assert (obj_old);
 	g_assert (obj_new);
 	g_assert (obj_new != objm1);
+	g_assert_cmpint (nmp_cache_get_generation (cache), ==, generation);
 	g_assert (nmp_object_equal (objm1, obj_new));
 	g_assert (nmp_cache_lookup_obj (cache, objm1) == obj_new);
 	g_assert (nmp_cache_lookup_obj (cache, nmp_object_stackinit_id_link (&objs1, pl_link_2.ifindex)) == obj_new);
@@ -332,6 +341,7 @@ test_cache_link (void)
 	g_assert (obj_old);
 	g_assert (!obj_new);
 	g_assert (!nmp_cache_lookup_obj (cache, objm1));
+	g_assert_cmpint (nmp_cache_get_generation (cache), >, generation);
 	g_assert (!nmp_cache_lookup_obj (cache, nmp_object_stackinit_id_link (&objs1, pl_link_2.ifindex)));
 	nmp_object_unref (objm1);
 	nmp_object_unref (obj_old);
@@ -456,6 +466,488 @@ test_cache_link (void)
 
 /*****************************************************************************/
 
+static void
+test_obj_pool (void)
+{
+	NMPObjectPoolStats stats_before;
+	NMPObjectPoolStats stats;
+	gs_unref_ptrarray GPtrArray *objs = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	guint n = 3000 + (nmtst_get_rand_int () % 3000);
+	guint i;
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ROUTE, &stats_before);
+
+	for (i = 0; i < n; i++) {
+		NMPObject *obj;
+
+		obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+		g_assert (obj);
+		g_assert_cmpint (obj->ip4_route.network, ==, 0);
+		obj->ip4_route.network = htonl (0x0a000000u + i);
+		g_ptr_array_add (objs, obj);
+	}
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ROUTE, &stats);
+	g_assert_cmpint (stats.n_objects, ==, stats_before.n_objects + n);
+	g_assert_cmpint (stats.n_bytes, >, stats_before.n_bytes);
+	g_assert_cmpint (stats.n_bytes_slabs, ==, stats.n_slabs * (64 * 1024));
+
+	/* release objects in random order and allocate again. */
+	for (i = 0; i < n / 2; i++) {
+		g_ptr_array_remove_index_fast (objs, nmtst_get_rand_int () % objs->len);
+		g_ptr_array_add (objs, nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL));
+	}
+	for (i = 0; i < objs->len; i++) {
+		const NMPObject *obj = objs->pdata[i];
+
+		g_assert (NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_IP4_ROUTE);
+	}
+
+	g_ptr_array_set_size (objs, 0);
+
+	nmp_object_pool_get_stats (NMP_OBJECT_TYPE_IP4_ROUTE, &stats);
+	g_assert_cmpint (stats.n_objects, ==, stats_before.n_objects);
+	g_assert_cmpint (stats.n_bytes, ==, stats_before.n_bytes);
+}
+
+/*****************************************************************************/
+
+static void
+test_link_udev_fields_memo (void)
+{
+	nm_auto_nmpobj NMPObject *obj_prev = NULL;
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	const char *kind_veth = g_intern_static_string ("veth");
+
+	/* without udev device, the driver is not looked up via ethtool.
+	 *
+	 * Without udev, it would be. Use no ifindex, so that the test does not
+	 * send ethtool requests to whatever link has that ifindex on the host. */
+	obj = nmp_object_new (NMP_OBJECT_TYPE_LINK, NULL);
+	obj->link.ifindex = 0;
+	obj->_link.netlink.is_in_netlink = TRUE;
+	_nmp_object_fixup_link_udev_fields (&obj, NULL, NULL, TRUE);
+	g_assert_cmpstr (obj->link.driver, ==, "unknown");
+	g_assert (!obj->link.initialized);
+
+	_nmp_object_fixup_link_udev_fields (&obj, NULL, NULL, FALSE);
+	g_assert_cmpstr (obj->link.driver, ==, "unknown");
+	g_assert (obj->link.initialized);
+	g_clear_pointer (&obj, nmp_object_unref);
+
+	/* the driver of the previous object is reused, as long as the
+	 * udev device and kind are the same. */
+	obj_prev = nmp_object_new (NMP_OBJECT_TYPE_LINK, NULL);
+	obj_prev->link.ifindex = 5;
+	obj_prev->link.kind = kind_veth;
+	obj_prev->link.driver = g_intern_static_string ("memoized");
+	obj_prev->_link.netlink.is_in_netlink = TRUE;
+
+	obj = nmp_object_clone (obj_prev, FALSE);
+	obj->link.driver = NULL;
+	_nmp_object_fixup_link_udev_fields (&obj, NULL, obj_prev, FALSE);
+	g_assert_cmpstr (obj->link.driver, ==, "memoized");
+
+	obj->link.kind = NULL;
+	obj->link.driver = NULL;
+	_nmp_object_fixup_link_udev_fields (&obj, NULL, obj_prev, TRUE);
+	g_assert_cmpstr (obj->link.driver, ==, "unknown");
+
+	obj->link.kind = kind_veth;
+	_nmp_object_fixup_link_udev_fields (&obj, NULL, NULL, TRUE);
+	g_assert_cmpstr (obj->link.driver, ==, "veth");
+}
+
+/*****************************************************************************/
+
+static void
+test_obj_hash_memo (void)
+{
+	NMDedupMultiIndex *multi_idx;
+	nm_auto_nmpobj NMPObject *obj = NULL;
+	nm_auto_nmpobj NMPObject *obj2 = NULL;
+	const NMPObject *obj_interned;
+	NMPObject obj_stack;
+	NMPObject obj_id;
+	guint hash, hash_id;
+
+	multi_idx = nm_dedup_multi_index_new ();
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+	obj->ip4_route.ifindex = 5;
+	obj->ip4_route.network = htonl (0x0a000000u);
+	obj->ip4_route.plen = 24;
+	obj->ip4_route.metric = 100;
+
+	hash = nmp_object_hash (obj);
+	hash_id = nmp_object_id_hash (obj);
+	g_assert_cmpint (obj->parent._hash_full, ==, 0);
+	g_assert_cmpint (obj->parent._hash_id, ==, 0);
+
+	/* the object is not interned, it can still be modified. */
+	obj->ip4_route.network = htonl (0x0b000000u);
+	g_assert_cmpint (nmp_object_id_hash (obj), !=, hash_id);
+	obj->ip4_route.network = htonl (0x0a000000u);
+
+	obj_interned = nm_dedup_multi_index_obj_intern (multi_idx, obj);
+	g_assert (obj_interned == obj);
+	g_assert_cmpint (obj_interned->parent._hash_full, ==, hash);
+	g_assert_cmpint (nmp_object_hash (obj_interned), ==, hash);
+	g_assert_cmpint (nmp_object_id_hash (obj_interned), ==, hash_id);
+	g_assert_cmpint (obj_interned->parent._hash_id, ==, hash_id);
+
+	/* stack objects hash alike, but never remember the hash. */
+	nmp_object_stackinit (&obj_stack, NMP_OBJECT_TYPE_IP4_ROUTE, &obj->object);
+	g_assert_cmpint (nmp_object_hash (&obj_stack), ==, hash);
+	g_assert (nmp_object_equal (&obj_stack, obj_interned));
+	g_assert (nm_dedup_multi_index_obj_find (multi_idx, &obj_stack) == obj_interned);
+
+	nmp_object_stackinit_id (&obj_id, obj_interned);
+	g_assert_cmpint (nmp_object_id_hash (&obj_id), ==, hash_id);
+	g_assert_cmpint (obj_id.parent._hash_id, ==, 0);
+	g_assert (nmp_object_id_equal (&obj_id, obj_interned));
+
+	obj_stack.ip4_route.metric = 101;
+	g_assert (!nmp_object_equal (&obj_stack, obj_interned));
+	g_assert (!nm_dedup_multi_index_obj_find (multi_idx, &obj_stack));
+
+	nm_dedup_multi_index_obj_release (multi_idx, obj_interned);
+	g_assert_cmpint (obj_interned->parent._hash_full, ==, 0);
+	g_assert_cmpint (obj_interned->parent._hash_id, ==, 0);
+	nmp_object_unref (obj_interned);
+
+	/* once released, the object can be modified again and must not
+	 * compare by its stale hash. */
+	obj->ip4_route.network = htonl (0x0b000000u);
+	obj2 = nmp_object_clone (obj, FALSE);
+	obj_interned = nm_dedup_multi_index_obj_intern (multi_idx, obj2);
+	g_assert (obj_interned == obj2);
+	g_assert_cmpint (nmp_object_id_hash (obj_interned), !=, hash_id);
+	g_assert (nmp_object_id_equal (obj, obj_interned));
+	nm_dedup_multi_index_obj_release (multi_idx, obj_interned);
+	nmp_object_unref (obj_interned);
+	obj->ip4_route.network = htonl (0x0a000000u);
+
+	/* destroying the index also forgets the hashes of its objects. */
+	obj_interned = nm_dedup_multi_index_obj_intern (multi_idx, obj);
+	g_assert_cmpint (nmp_object_id_hash (obj_interned), ==, hash_id);
+	g_assert_cmpint (obj_interned->parent._hash_id, ==, hash_id);
+	nm_dedup_multi_index_unref (multi_idx);
+	g_assert_cmpint (obj_interned->parent._hash_full, ==, 0);
+	g_assert_cmpint (obj_interned->parent._hash_id, ==, 0);
+	nmp_object_unref (obj_interned);
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	guint32 table;
+	in_addr_t addr;
+	guint8 plen;
+	gpointer value;
+} TriePrefix;
+
+static gboolean
+_trie_prefix_covers (const TriePrefix *p, guint32 table, in_addr_t addr, guint8 plen)
+{
+	return    p->value
+	       && p->table == table
+	       && p->plen <= plen
+	       && nm_utils_ip4_address_clear_host_address (p->addr, p->plen) == nm_utils_ip4_address_clear_host_address (addr, p->plen);
+}
+
+static gboolean
+_trie_within_cb (gpointer value, guint8 plen, gpointer user_data)
+{
+	guint *n = user_data;
+
+	(*n)++;
+	return TRUE;
+}
+
+static void
+test_prefix_trie (void)
+{
+	nm_auto_prefix_trie NMPPrefixTrie *trie = NULL;
+	TriePrefix prefixes[200] = { { 0 } };
+	guint n_values = 0;
+	guint i, j, round;
+
+	trie = nmp_prefix_trie_new (AF_INET);
+
+	for (round = 0; round < 5000; round++) {
+		TriePrefix *p = &prefixes[nmtst_get_rand_int () % G_N_ELEMENTS (prefixes)];
+		TriePrefix needle;
+		const TriePrefix *expected = NULL;
+		guint n_expected, n_within;
+
+		if (!p->value) {
+			/* use few distinct tables and short networks, so that the
+			 * prefixes overlap. */
+			p->table = nmtst_get_rand_int () % 3;
+			p->addr = htonl (nmtst_get_rand_int () & 0xFFFF0000u);
+			p->plen = nmtst_get_rand_int () % 33;
+			for (j = 0; j < G_N_ELEMENTS (prefixes); j++) {
+				if (   prefixes[j].value
+				    && prefixes[j].table == p->table
+				    && prefixes[j].plen == p->plen
+				    && _trie_prefix_covers (&prefixes[j], p->table, p->addr, p->plen))
+					break;
+			}
+			if (j < G_N_ELEMENTS (prefixes))
+				continue;
+			p->value = p;
+			g_assert (!nmp_prefix_trie_set (trie, p->table, &p->addr, p->plen, p->value));
+			n_values++;
+		} else {
+			g_assert (nmp_prefix_trie_remove (trie, p->table, &p->addr, p->plen) == p->value);
+			p->value = NULL;
+			n_values--;
+		}
+		g_assert_cmpint (nmp_prefix_trie_get_len (trie), ==, n_values);
+
+		needle.table = nmtst_get_rand_int () % 3;
+		needle.addr = htonl (nmtst_get_rand_int () & 0xFFFF00FFu);
+		needle.plen = nmtst_get_rand_int () % 33;
+		needle.value = &needle;
+
+		n_expected = 0;
+		for (i = 0; i < G_N_ELEMENTS (prefixes); i++) {
+			if (_trie_prefix_covers (&prefixes[i], needle.table, needle.addr, needle.plen)) {
+				if (!expected || expected->plen < prefixes[i].plen)
+					expected = &prefixes[i];
+			}
+			if (   prefixes[i].value
+			    && _trie_prefix_covers (&needle, prefixes[i].table, prefixes[i].addr, prefixes[i].plen))
+				n_expected++;
+		}
+		g_assert (nmp_prefix_trie_lookup_covering (trie, needle.table, &needle.addr, needle.plen, NULL, NULL, NULL) == (expected ? expected->value : NULL));
+		if (expected)
+			g_assert (nmp_prefix_trie_lookup (trie, expected->table, &expected->addr, expected->plen) == expected->value);
+
+		n_within = 0;
+		nmp_prefix_trie_foreach_within (trie, needle.table, &needle.addr, needle.plen, _trie_within_cb, &n_within);
+		g_assert_cmpint (n_within, ==, n_expected);
+	}
+}
+
+static void
+_cache_add_ip4_route (NMPCache *cache, int ifindex, const char *network, guint8 plen, guint32 metric)
+{
+	NMPObject *obj;
+	const NMPObject *obj_old;
+	const NMPObject *obj_new;
+
+	obj = nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+	obj->ip4_route.ifindex = ifindex;
+	obj->ip4_route.network = nmtst_inet4_from_string (network);
+	obj->ip4_route.plen = plen;
+	obj->ip4_route.metric = metric;
+	g_assert_cmpint (nmp_cache_update_netlink (cache, obj, FALSE, &obj_old, &obj_new), ==, NMP_CACHE_OPS_ADDED);
+	nmp_object_unref (obj_new);
+	nmp_object_unref (obj);
+}
+
+static void
+_cache_remove_ip4_route (NMPCache *cache, int ifindex, const char *network, guint8 plen, guint32 metric)
+{
+	NMPObject obj;
+	const NMPObject *obj_old;
+
+	nmp_object_stackinit (&obj, NMP_OBJECT_TYPE_IP4_ROUTE, NULL);
+	obj.ip4_route.ifindex = ifindex;
+	obj.ip4_route.network = nmtst_inet4_from_string (network);
+	obj.ip4_route.plen = plen;
+	obj.ip4_route.metric = metric;
+	g_assert_cmpint (nmp_cache_remove (cache, &obj, FALSE, FALSE, &obj_old), ==, NMP_CACHE_OPS_REMOVED);
+	nmp_object_unref (obj_old);
+}
+
+static guint
+_lookup_destination_len (NMPCache *cache, const char *network, guint8 plen)
+{
+	NMPLookup lookup;
+	in_addr_t a = nmtst_inet4_from_string (network);
+	const NMDedupMultiHeadEntry *head_entry;
+
+	head_entry = nmp_cache_lookup (cache,
+	                               nmp_lookup_init_route_by_destination (&lookup,
+	                                                                     NMP_OBJECT_TYPE_IP4_ROUTE,
+	                                                                     0,
+	                                                                     &a,
+	                                                                     plen));
+	return head_entry ? head_entry->len : 0;
+}
+
+static void
+test_cache_route_by_destination (void)
+{
+	nm_auto_unref_dedup_multi_index NMDedupMultiIndex *multi_idx = NULL;
+	NMPCache *cache;
+
+	multi_idx = nm_dedup_multi_index_new ();
+	cache = nmp_cache_new (multi_idx, FALSE);
+
+	_cache_add_ip4_route (cache, 2, "10.0.0.0", 8, 100);
+	_cache_add_ip4_route (cache, 2, "10.1.0.0", 16, 100);
+	_cache_add_ip4_route (cache, 3, "10.1.0.0", 16, 200);
+	_cache_add_ip4_route (cache, 3, "10.1.2.0", 24, 100);
+
+	g_assert_cmpint (_lookup_destination_len (cache, "192.168.1.0", 24), ==, 0);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.0.0.0", 8), ==, 1);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.0.0", 16), ==, 2);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.2.0", 24), ==, 1);
+
+	/* the host part is ignored */
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.255.255", 16), ==, 2);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.0.0", 24), ==, 0);
+
+	_cache_remove_ip4_route (cache, 3, "10.1.2.0", 24, 100);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.2.0", 24), ==, 0);
+
+	_cache_remove_ip4_route (cache, 2, "10.1.0.0", 16, 100);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.0.0", 16), ==, 1);
+
+	_cache_remove_ip4_route (cache, 3, "10.1.0.0", 16, 200);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.1.0.0", 16), ==, 0);
+
+	_cache_remove_ip4_route (cache, 2, "10.0.0.0", 8, 100);
+	g_assert_cmpint (_lookup_destination_len (cache, "10.0.0.0", 8), ==, 0);
+
+	nmp_cache_free (cache);
+}
+
+/*****************************************************************************/
+
+static const struct nlattr *
+_nla_next (const struct nlattr *nla, int *remaining)
+{
+	g_assert_cmpint (nla->nla_len, >=, NLA_HDRLEN);
+	g_assert_cmpint (NLA_ALIGN (nla->nla_len), <=, *remaining);
+
+	*remaining -= NLA_ALIGN (nla->nla_len);
+	return (const struct nlattr *) (((const char *) nla) + NLA_ALIGN (nla->nla_len));
+}
+
+static void
+_assert_nla_u32 (const struct nlattr *nla, guint16 type, guint32 val)
+{
+	g_assert_cmpint (nla->nla_type, ==, type);
+	g_assert_cmpint (nla->nla_len, ==, NLA_HDRLEN + sizeof (guint32));
+	g_assert_cmpint (*((const guint32 *) (((const char *) nla) + NLA_HDRLEN)), ==, val);
+}
+
+static void
+test_nl_builder (void)
+{
+	NMP_NL_BUILDER_DEFINE_STACK (builder, 64);
+	const struct {
+		guint8 family;
+		guint8 pad[3];
+		guint32 val;
+	} family_hdr = { .family = 10, .val = 0x1234 };
+	const struct nlmsghdr *nlhdr;
+	const struct nlattr *nla;
+	gsize len;
+	int remaining;
+	int attrs_remaining;
+	guint i;
+
+	g_assert (!nmp_nl_builder_get_msgs (&builder, &len));
+	g_assert_cmpint (len, ==, 0);
+
+	/* a message with a string (that needs padding) and a nested attribute. */
+	nmp_nl_builder_msg_begin (&builder, 20, 0x5, &family_hdr, sizeof (family_hdr),
+	                            NMP_NL_BUILDER_ATTR_SIZE (strlen ("eth0") + 1)
+	                          + NMP_NL_BUILDER_ATTR_SIZE (0)
+	                          + 2 * NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32)));
+	g_assert_cmpint (nmp_nl_builder_put_string (&builder, 3, "eth0"), ==, 0);
+	{
+		gsize nest;
+
+		nest = nmp_nl_builder_nest_start (&builder, 7);
+		g_assert_cmpint (nest, >, 0);
+		g_assert_cmpint (nmp_nl_builder_put_u32 (&builder, 1, 42), ==, 0);
+		g_assert_cmpint (nmp_nl_builder_put_u32 (&builder, 2, 43), ==, 0);
+		nmp_nl_builder_nest_end (&builder, nest);
+	}
+	nmp_nl_builder_msg_end (&builder);
+
+	/* more messages, than fit into the buffer on the stack. */
+	for (i = 0; i < 10; i++) {
+		nmp_nl_builder_msg_begin (&builder, 21, 0, NULL, 0, NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32)));
+		g_assert_cmpint (nmp_nl_builder_put_u32 (&builder, 1, i), ==, 0);
+		nmp_nl_builder_msg_end (&builder);
+	}
+	g_assert (!builder.buf_static);
+	g_assert_cmpint (nmp_nl_builder_get_n_msgs (&builder), ==, 11);
+
+	/* attributes that exceed the reserved space are rejected, and the
+	 * incomplete message can be dropped. */
+	nmp_nl_builder_get_msgs (&builder, &len);
+	nmp_nl_builder_msg_begin (&builder, 22, 0, NULL, 0, NMP_NL_BUILDER_ATTR_SIZE (sizeof (guint32)));
+	g_assert_cmpint (nmp_nl_builder_put_u32 (&builder, 1, 1), ==, 0);
+	g_assert_cmpint (nmp_nl_builder_put_u32 (&builder, 2, 2), ==, -NLE_NOMEM);
+	g_assert_cmpint (nmp_nl_builder_nest_start (&builder, 3), ==, 0);
+	nmp_nl_builder_msg_cancel (&builder);
+	g_assert_cmpint (nmp_nl_builder_get_n_msgs (&builder), ==, 11);
+	{
+		gsize len2;
+
+		nmp_nl_builder_get_msgs (&builder, &len2);
+		g_assert_cmpint (len2, ==, len);
+	}
+
+	nlhdr = nmp_nl_builder_get_msgs (&builder, &len);
+	g_assert (nlhdr);
+	remaining = len;
+
+	g_assert (NLMSG_OK (nlhdr, remaining));
+	g_assert_cmpint (nlhdr->nlmsg_type, ==, 20);
+	g_assert_cmpint (nlhdr->nlmsg_flags, ==, 0x5);
+	g_assert_cmpint (nlhdr->nlmsg_seq, ==, 0);
+	g_assert (memcmp (NLMSG_DATA (nlhdr), &family_hdr, sizeof (family_hdr)) == 0);
+	g_assert_cmpint (nlhdr->nlmsg_len, ==, NLMSG_LENGTH (sizeof (family_hdr)) + 12 + 4 + 16);
+
+	nla = (const struct nlattr *) (((const char *) NLMSG_DATA (nlhdr)) + NLMSG_ALIGN (sizeof (family_hdr)));
+	attrs_remaining = nlhdr->nlmsg_len - NLMSG_LENGTH (sizeof (family_hdr));
+	g_assert_cmpint (nla->nla_type, ==, 3);
+	g_assert_cmpint (nla->nla_len, ==, NLA_HDRLEN + 5);
+	g_assert_cmpstr (((const char *) nla) + NLA_HDRLEN, ==, "eth0");
+	nla = _nla_next (nla, &attrs_remaining);
+	g_assert_cmpint (nla->nla_type, ==, 7);
+	g_assert_cmpint (nla->nla_len, ==, NLA_HDRLEN + 16);
+	{
+		const struct nlattr *nested = (const struct nlattr *) (((const char *) nla) + NLA_HDRLEN);
+		int nested_remaining = 16;
+
+		_assert_nla_u32 (nested, 1, 42);
+		nested = _nla_next (nested, &nested_remaining);
+		_assert_nla_u32 (nested, 2, 43);
+		_nla_next (nested, &nested_remaining);
+		g_assert_cmpint (nested_remaining, ==, 0);
+	}
+	_nla_next (nla, &attrs_remaining);
+	g_assert_cmpint (attrs_remaining, ==, 0);
+
+	for (i = 0; i < 10; i++) {
+		nlhdr = NLMSG_NEXT (nlhdr, remaining);
+		g_assert (NLMSG_OK (nlhdr, remaining));
+		g_assert_cmpint (nlhdr->nlmsg_type, ==, 21);
+		g_assert_cmpint (nlhdr->nlmsg_len, ==, NLMSG_LENGTH (8));
+		_assert_nla_u32 (NLMSG_DATA (nlhdr), 1, i);
+	}
+	nlhdr = NLMSG_NEXT (nlhdr, remaining);
+	g_assert_cmpint (remaining, ==, 0);
+
+	/* resetting keeps the buffer. */
+	nmp_nl_builder_reset (&builder);
+	g_assert (!nmp_nl_builder_get_msgs (&builder, NULL));
+	g_assert (builder.buf);
+}
+
+/*****************************************************************************/
+
 NMTST_DEFINE ();
 
 int
@@ -500,6 +992,12 @@ main (int argc, char **argv)
 
 	g_test_add_func ("/nmp-object/obj-base", test_obj_base);
 	g_test_add_func ("/nmp-object/cache_link", test_cache_link);
+	g_test_add_func ("/nmp-object/obj-pool", test_obj_pool);
+	g_test_add_func ("/nmp-object/obj-hash-memo", test_obj_hash_memo);
+	g_test_add_func ("/nmp-object/link-udev-fields-memo", test_link_udev_fields_memo);
+	g_test_add_func ("/nmp-object/prefix-trie", test_prefix_trie);
+	g_test_add_func ("/nmp-object/cache-route-by-destination", test_cache_route_by_destination);
+	g_test_add_func ("/nmp-object/nl-builder", test_nl_builder);
 
 	result = g_test_run ();
 
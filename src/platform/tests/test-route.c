@@ -24,6 +24,8 @@
 
 #include "nm-core-utils.h"
 #include "platform/nm-platform-utils.h"
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
 
 #include "test-common.h"
 
@@ -753,6 +755,570 @@ again_find_idx:
 
 /*****************************************************************************/
 
+typedef struct {
+	int ifindex;
+	guint n_emitted;
+	guint n_added;
+	guint n_removed;
+} ChangesBatchData;
+
+static void
+_changes_batch_cb (NMPlatform *platform,
+                   int obj_type_i,
+                   const NMPlatformChange *changes,
+                   guint n_changes,
+                   ChangesBatchData *data)
+{
+	guint i;
+
+	if (obj_type_i != NMP_OBJECT_TYPE_IP4_ROUTE)
+		return;
+
+	g_assert (changes);
+	g_assert_cmpint (n_changes, >, 0);
+
+	data->n_emitted++;
+	for (i = 0; i < n_changes; i++) {
+		const NMPlatformChange *c = &changes[i];
+		const NMPObject *obj = c->obj_new ?: c->obj_old;
+
+		g_assert (NMP_OBJECT_GET_TYPE (obj) == NMP_OBJECT_TYPE_IP4_ROUTE);
+		if (obj->object.ifindex != data->ifindex)
+			continue;
+
+		switch (c->change_type) {
+		case NM_PLATFORM_SIGNAL_ADDED:
+			g_assert (!c->obj_old && c->obj_new);
+			data->n_added++;
+			break;
+		case NM_PLATFORM_SIGNAL_REMOVED:
+			g_assert (c->obj_old && !c->obj_new);
+			data->n_removed++;
+			break;
+		default:
+			g_assert (c->obj_old && c->obj_new);
+			break;
+		}
+	}
+}
+
+static void
+test_ip4_route_changes_batch (void)
+{
+	ChangesBatchData data = {
+		.ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME),
+	};
+	const int metric = 22987;
+	guint i;
+
+	g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_CHANGES_BATCH, G_CALLBACK (_changes_batch_cb), &data);
+
+	/* without a batch, every change is emitted on its own. */
+	nmtstp_ip4_route_add (NM_PLATFORM_GET, data.ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                      nmtst_inet4_from_string ("192.0.4.0"), 24, INADDR_ANY, 0, metric, 0);
+	g_assert_cmpint (data.n_added, ==, 1);
+	g_assert_cmpint (data.n_emitted, >=, 1);
+
+	nm_platform_changes_batch_begin (NM_PLATFORM_GET);
+	data.n_emitted = 0;
+	for (i = 1; i < 4; i++) {
+		nmtstp_ip4_route_add (NM_PLATFORM_GET, data.ifindex, NM_IP_CONFIG_SOURCE_USER,
+		                      htonl (0xc0000400u + (i << 8)), 24, INADDR_ANY, 0, metric, 0);
+	}
+	g_assert_cmpint (data.n_emitted, ==, 0);
+	nm_platform_changes_batch_end (NM_PLATFORM_GET);
+	g_assert_cmpint (data.n_emitted, ==, 1);
+	g_assert_cmpint (data.n_added, ==, 4);
+
+	nm_platform_changes_batch_begin (NM_PLATFORM_GET);
+	data.n_emitted = 0;
+	for (i = 0; i < 4; i++)
+		g_assert (nmtstp_platform_ip4_route_delete (NM_PLATFORM_GET, data.ifindex, htonl (0xc0000400u + (i << 8)), 24, metric));
+	nm_platform_changes_batch_end (NM_PLATFORM_GET);
+	g_assert_cmpint (data.n_emitted, ==, 1);
+	g_assert_cmpint (data.n_removed, ==, 4);
+
+	g_signal_handlers_disconnect_by_func (NM_PLATFORM_GET, G_CALLBACK (_changes_batch_cb), &data);
+}
+
+typedef struct {
+	int ifindex;
+	guint n_emitted;
+	guint emitted_route_1;
+	guint emitted_address;
+	guint emitted_route_2;
+} ChangesBatchOrderData;
+
+static void
+_changes_batch_order_cb (NMPlatform *platform,
+                         int obj_type_i,
+                         const NMPlatformChange *changes,
+                         guint n_changes,
+                         ChangesBatchOrderData *data)
+{
+	guint i;
+
+	data->n_emitted++;
+	for (i = 0; i < n_changes; i++) {
+		const NMPObject *obj = changes[i].obj_new ?: changes[i].obj_old;
+
+		g_assert_cmpint (NMP_OBJECT_GET_TYPE (obj), ==, obj_type_i);
+		if (   obj->object.ifindex != data->ifindex
+		    || changes[i].change_type != NM_PLATFORM_SIGNAL_ADDED)
+			continue;
+
+		switch (NMP_OBJECT_GET_TYPE (obj)) {
+		case NMP_OBJECT_TYPE_IP4_ADDRESS:
+			if (obj->ip4_address.address == nmtst_inet4_from_string ("192.0.6.1"))
+				data->emitted_address = data->n_emitted;
+			break;
+		case NMP_OBJECT_TYPE_IP4_ROUTE:
+			if (obj->ip4_route.network == nmtst_inet4_from_string ("192.0.7.0"))
+				data->emitted_route_1 = data->n_emitted;
+			else if (obj->ip4_route.network == nmtst_inet4_from_string ("192.0.8.0"))
+				data->emitted_route_2 = data->n_emitted;
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+static void
+test_ip4_route_changes_batch_order (void)
+{
+	ChangesBatchOrderData data = {
+		.ifindex = nm_platform_link_get_ifindex (NM_PLATFORM_GET, DEVICE_NAME),
+	};
+	const int metric = 22987;
+
+	g_signal_connect (NM_PLATFORM_GET, NM_PLATFORM_SIGNAL_CHANGES_BATCH, G_CALLBACK (_changes_batch_order_cb), &data);
+
+	/* the changes of different types are emitted in the order in which
+	 * they happened, and not grouped by their type. */
+	nm_platform_changes_batch_begin (NM_PLATFORM_GET);
+	nmtstp_ip4_route_add (NM_PLATFORM_GET, data.ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                      nmtst_inet4_from_string ("192.0.7.0"), 24, INADDR_ANY, 0, metric, 0);
+	nmtstp_ip4_address_add (NM_PLATFORM_GET, FALSE, data.ifindex,
+	                        nmtst_inet4_from_string ("192.0.6.1"), 24,
+	                        nmtst_inet4_from_string ("192.0.6.1"),
+	                        NM_PLATFORM_LIFETIME_PERMANENT, NM_PLATFORM_LIFETIME_PERMANENT,
+	                        0, NULL);
+	nmtstp_ip4_route_add (NM_PLATFORM_GET, data.ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                      nmtst_inet4_from_string ("192.0.8.0"), 24, INADDR_ANY, 0, metric, 0);
+	g_assert_cmpint (data.n_emitted, ==, 0);
+	nm_platform_changes_batch_end (NM_PLATFORM_GET);
+
+	g_assert_cmpint (data.emitted_route_1, >, 0);
+	g_assert_cmpint (data.emitted_address, >, data.emitted_route_1);
+	g_assert_cmpint (data.emitted_route_2, >, data.emitted_address);
+
+	g_signal_handlers_disconnect_by_func (NM_PLATFORM_GET, G_CALLBACK (_changes_batch_order_cb), &data);
+
+	g_assert (nmtstp_platform_ip4_route_delete (NM_PLATFORM_GET, data.ifindex, nmtst_inet4_from_string ("192.0.7.0"), 24, metric));
+	g_assert (nmtstp_platform_ip4_route_delete (NM_PLATFORM_GET, data.ifindex, nmtst_inet4_from_string ("192.0.8.0"), 24, metric));
+	nmtstp_ip4_address_del (NM_PLATFORM_GET, FALSE, data.ifindex,
+	                        nmtst_inet4_from_string ("192.0.6.1"), 24,
+	                        nmtst_inet4_from_string ("192.0.6.1"));
+}
+
+/*****************************************************************************/
+
+static void
+_ip4_route_sync_many_check (int ifindex, GPtrArray *routes, guint n_routes)
+{
+	gs_unref_ptrarray GPtrArray *plat_routes = NULL;
+	guint i;
+
+	plat_routes = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	g_assert_cmpint (plat_routes->len, ==, n_routes);
+	for (i = 0; i < n_routes; i++) {
+		g_assert (nm_platform_lookup_entry (NM_PLATFORM_GET,
+		                                    NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+		                                    routes->pdata[i]));
+	}
+}
+
+static void
+test_ip4_route_sync_many (gconstpointer user_data)
+{
+	const guint N_ROUTES = GPOINTER_TO_UINT (user_data);
+	NMPlatform *platform = NM_PLATFORM_GET;
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	const NMPlatformLink *l;
+	gint64 time, start_time;
+	int ifindex;
+	guint i;
+
+	/* on the fake platform, the large counts are cheap enough for every run. */
+	if (   N_ROUTES > 1000
+	    && nmtstp_is_root_test ()
+	    && nmtst_test_quick ()) {
+		g_print ("Skipping test: don't run long running test %s (NMTST_DEBUG=slow)\n", g_get_prgname () ?: "test-route-linux");
+		g_test_skip ("Skip long running test");
+		return;
+	}
+
+	l = nmtstp_link_veth_add (platform, -1, "nm-test-veth0", "nm-test-veth1");
+	ifindex = l->ifindex;
+	nmtstp_link_set_updown (platform, -1, ifindex, TRUE);
+	nmtstp_link_set_updown (platform, -1, nmtstp_link_get (platform, -1, "nm-test-veth1")->ifindex, TRUE);
+	nmtstp_ip4_address_add (platform, -1, ifindex,
+	                        nmtst_inet4_from_string ("192.168.10.1"), 24,
+	                        nmtst_inet4_from_string ("192.168.10.1"),
+	                        NM_PLATFORM_LIFETIME_PERMANENT, NM_PLATFORM_LIFETIME_PERMANENT,
+	                        0, NULL);
+	if (!nmtstp_is_root_test ()) {
+		/* the fake platform doesn't add the prefix route of the address like
+		 * the kernel does. Add it, it is ignored by route-sync. */
+		nmtstp_ip4_route_add (platform, ifindex, NM_IP_CONFIG_SOURCE_RTPROT_KERNEL,
+		                      nmtst_inet4_from_string ("192.168.10.0"), 24,
+		                      INADDR_ANY, 0, 0, 0);
+	}
+
+	/* Every fourth route is a gateway route. As route-sync adds the device routes
+	 * first, the gateway routes must not fail with ENETUNREACH. */
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < N_ROUTES; i++) {
+		NMPlatformIP4Route r = {
+			.ifindex = ifindex,
+			.rt_source = NM_IP_CONFIG_SOURCE_USER,
+			.network = htonl (0x0a000000u | (i << 8)),
+			.plen = 24,
+			.metric = 100,
+			.gateway = (i % 4 == 3) ? nmtst_inet4_from_string ("192.168.10.2") : 0,
+		};
+
+		g_ptr_array_add (routes, nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (const NMPlatformObject *) &r));
+	}
+
+	_LOGI (">>> sync %u routes...", N_ROUTES);
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, routes, NULL, NULL,
+	                                     nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+	_LOGI (">>> added %u routes in %ld.%09ld seconds", N_ROUTES, (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
+	_ip4_route_sync_many_check (ifindex, routes, N_ROUTES);
+
+	/* syncing again is a no-op. */
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, routes, NULL, NULL,
+	                                     nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	_ip4_route_sync_many_check (ifindex, routes, N_ROUTES);
+
+	/* drop the second half. */
+	g_ptr_array_set_size (routes, N_ROUTES / 2);
+	start_time = nm_utils_get_monotonic_timestamp_ns ();
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, routes, NULL, NULL,
+	                                     nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	time = nm_utils_get_monotonic_timestamp_ns () - start_time;
+	_LOGI (">>> deleted %u routes in %ld.%09ld seconds", N_ROUTES - N_ROUTES / 2, (long) (time / NM_UTILS_NS_PER_SECOND), (long) (time % NM_UTILS_NS_PER_SECOND));
+	_ip4_route_sync_many_check (ifindex, routes, N_ROUTES / 2);
+
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, NULL, NULL, NULL,
+	                                     nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	_ip4_route_sync_many_check (ifindex, NULL, 0);
+
+	nmtstp_link_del (platform, -1, ifindex, "nm-test-veth0");
+}
+
+static NMPObject *
+_ip4_route_sync_delta_new (int ifindex, guint i)
+{
+	NMPlatformIP4Route r = {
+		.ifindex = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = htonl (0x0a000000u | (i << 8)),
+		.plen = 24,
+		.metric = 100,
+	};
+
+	return nmp_object_new (NMP_OBJECT_TYPE_IP4_ROUTE, (const NMPlatformObject *) &r);
+}
+
+static void
+test_ip4_route_sync_delta (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_ptrarray GPtrArray *routes_del = NULL;
+	gs_unref_ptrarray GPtrArray *routes_add = NULL;
+	const NMPlatformLink *l;
+	guint64 generation;
+	int ifindex;
+	guint i;
+
+	l = nmtstp_link_veth_add (platform, -1, "nm-test-veth0", "nm-test-veth1");
+	ifindex = l->ifindex;
+	nmtstp_link_set_updown (platform, -1, ifindex, TRUE);
+	nmtstp_link_set_updown (platform, -1, nmtstp_link_get (platform, -1, "nm-test-veth1")->ifindex, TRUE);
+
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < 20; i++)
+		g_ptr_array_add (routes, _ip4_route_sync_delta_new (ifindex, i));
+
+	g_assert (nm_platform_ip_route_sync (platform, AF_INET, ifindex, routes, NULL, NULL,
+	                                     nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	_ip4_route_sync_many_check (ifindex, routes, 20);
+
+	/* an empty delta does nothing. */
+	generation = nm_platform_get_addrroute_generation (platform, ifindex);
+	g_assert (nm_platform_ip_route_sync_delta (platform, AF_INET, ifindex, NULL, NULL,
+	                                           nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	g_assert_cmpuint (nm_platform_get_addrroute_generation (platform, ifindex), ==, generation);
+
+	/* remove the first route and add another one. */
+	routes_del = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	g_ptr_array_add (routes_del, (gpointer) nmp_object_ref (routes->pdata[0]));
+	routes_add = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	g_ptr_array_add (routes_add, _ip4_route_sync_delta_new (ifindex, 20));
+
+	g_assert (nm_platform_ip_route_sync_delta (platform, AF_INET, ifindex, routes_del, routes_add,
+	                                           nm_platform_lookup_predicate_routes_main_skip_rtprot_kernel, NULL));
+	g_assert_cmpuint (nm_platform_get_addrroute_generation (platform, ifindex), !=, generation);
+
+	g_assert (!nm_platform_lookup_entry (platform, NMP_CACHE_ID_TYPE_OBJECT_TYPE, routes->pdata[0]));
+	g_ptr_array_remove_index (routes, 0);
+	g_ptr_array_add (routes, (gpointer) nmp_object_ref (routes_add->pdata[0]));
+	_ip4_route_sync_many_check (ifindex, routes, 20);
+
+	nmtstp_link_del (platform, -1, ifindex, "nm-test-veth0");
+}
+
+static NMPlatformIP4Route
+_ip4_config_commit_route (int ifindex, guint i)
+{
+	return (NMPlatformIP4Route) {
+		.ifindex = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = htonl (0x0a000000u | (i << 8)),
+		.plen = 24,
+		.metric = 100,
+	};
+}
+
+static void
+_ip4_config_commit_check (int ifindex, const NMIP4Config *config)
+{
+	gs_unref_ptrarray GPtrArray *plat_routes = NULL;
+	const NMPlatformIP4Route *r;
+	NMDedupMultiIter iter;
+	guint n = 0;
+
+	plat_routes = nmtstp_ip4_route_get_all (NM_PLATFORM_GET, ifindex);
+	nm_ip_config_iter_ip4_route_for_each (&iter, config, &r) {
+		const NMDedupMultiEntry *plat_entry;
+		NMPObject obj_stack;
+
+		plat_entry = nm_platform_lookup_entry (NM_PLATFORM_GET,
+		                                       NMP_CACHE_ID_TYPE_OBJECT_TYPE,
+		                                       nmp_object_stackinit (&obj_stack, NMP_OBJECT_TYPE_IP4_ROUTE, r));
+		g_assert (plat_entry);
+		g_assert_cmpint (nm_platform_ip4_route_cmp (r,
+		                                            NMP_OBJECT_CAST_IP4_ROUTE (plat_entry->obj),
+		                                            NM_PLATFORM_IP_ROUTE_CMP_TYPE_SEMANTICALLY), ==, 0);
+		n++;
+	}
+	g_assert_cmpint (plat_routes->len, ==, n);
+}
+
+static gboolean
+_ip4_config_commit_state_valid (const NMIPConfigCommitState *state, int ifindex)
+{
+	gboolean sync_addresses;
+
+	return _nm_ip_config_commit_state_check (state, NM_PLATFORM_GET, ifindex, NULL, &sync_addresses);
+}
+
+static void
+test_ip4_config_commit_delta (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	gs_unref_object NMIP4Config *config = NULL;
+	nm_auto (nm_ip_config_commit_state_clear) NMIPConfigCommitState state = { 0 };
+	NMPlatformIP4Route r;
+	const NMPlatformLink *l;
+	int ifindex;
+	guint i;
+
+	l = nmtstp_link_veth_add (platform, -1, "nm-test-veth0", "nm-test-veth1");
+	ifindex = l->ifindex;
+	nmtstp_link_set_updown (platform, -1, ifindex, TRUE);
+	nmtstp_link_set_updown (platform, -1, nmtstp_link_get (platform, -1, "nm-test-veth1")->ifindex, TRUE);
+
+	config = nm_ip4_config_new (nm_platform_get_multi_idx (platform), ifindex);
+	for (i = 0; i < 10; i++) {
+		r = _ip4_config_commit_route (ifindex, i);
+		nm_ip4_config_add_route (config, &r);
+	}
+
+	/* the first commit syncs everything. */
+	g_assert (!_ip4_config_commit_state_valid (&state, ifindex));
+	g_assert (nm_ip4_config_commit (config, platform, 100, &state));
+	_ip4_config_commit_check (ifindex, config);
+	g_assert (_ip4_config_commit_state_valid (&state, ifindex));
+
+	/* change a route (same ID, different MTU), drop one, add one. That
+	 * is pushed as a delta. */
+	r = _ip4_config_commit_route (ifindex, 0);
+	r.mtu = 1400;
+	nm_ip4_config_add_route (config, &r);
+	_nmtst_nm_ip4_config_del_route (config, 1);
+	r = _ip4_config_commit_route (ifindex, 10);
+	nm_ip4_config_add_route (config, &r);
+	g_assert (nm_ip4_config_commit (config, platform, 100, &state));
+	_ip4_config_commit_check (ifindex, config);
+	g_assert (_ip4_config_commit_state_valid (&state, ifindex));
+
+	/* somebody else adds and removes routes. The next commit must
+	 * fall back to a full sync, that reverts both. */
+	nmtstp_ip4_route_add (platform, ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                      htonl (0x0a000000u | (20 << 8)), 24, 0, 0, 100, 0);
+	g_assert (nmtstp_platform_ip4_route_delete (platform, ifindex, htonl (0x0a000000u | (2 << 8)), 24, 100));
+	g_assert (!_ip4_config_commit_state_valid (&state, ifindex));
+	g_assert (nm_ip4_config_commit (config, platform, 100, &state));
+	_ip4_config_commit_check (ifindex, config);
+	g_assert (_ip4_config_commit_state_valid (&state, ifindex));
+
+	/* a route that cannot be added, but whose failure route-sync
+	 * ignores, leaves the state invalid. Every commit retries it. */
+	r = (NMPlatformIP4Route) {
+		.ifindex = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_DHCP,
+		.network = htonl (0x0b000000u),
+		.plen = 24,
+		.gateway = htonl (0xc0a86401u),
+		.metric = 100,
+	};
+	nm_ip4_config_add_route (config, &r);
+	g_assert (nm_ip4_config_commit (config, platform, 100, &state));
+	g_assert (!_ip4_config_commit_state_valid (&state, ifindex));
+	g_assert (nm_ip4_config_commit (config, platform, 100, &state));
+	g_assert (!_ip4_config_commit_state_valid (&state, ifindex));
+
+	nm_ip4_config_reset_routes (config);
+	g_assert (nm_ip4_config_commit (config, platform, 100, &state));
+	_ip4_config_commit_check (ifindex, config);
+	g_assert (_ip4_config_commit_state_valid (&state, ifindex));
+
+	nmtstp_link_del (platform, -1, ifindex, "nm-test-veth0");
+}
+
+static NMPlatformIP6Route
+_ip6_config_commit_route (int ifindex, guint i)
+{
+	NMPlatformIP6Route r = {
+		.ifindex = ifindex,
+		.rt_source = NM_IP_CONFIG_SOURCE_USER,
+		.network = *nmtst_inet6_from_string ("2001:db8::"),
+		.plen = 64,
+		.metric = 100,
+	};
+
+	r.network.s6_addr[5] = i;
+	return r;
+}
+
+static void
+test_ip6_config_commit_delta (void)
+{
+	NMPlatform *platform = NM_PLATFORM_GET;
+	gs_unref_object NMIP6Config *config = NULL;
+	nm_auto (nm_ip_config_commit_state_clear) NMIPConfigCommitState state = { 0 };
+	gs_unref_ptrarray GPtrArray *plat_routes = NULL;
+	NMPlatformIP6Route r;
+	const NMPlatformLink *l;
+	gboolean sync_addresses;
+	int ifindex;
+	guint i;
+
+	l = nmtstp_link_veth_add (platform, -1, "nm-test-veth0", "nm-test-veth1");
+	ifindex = l->ifindex;
+	nmtstp_link_set_updown (platform, -1, ifindex, TRUE);
+	nmtstp_link_set_updown (platform, -1, nmtstp_link_get (platform, -1, "nm-test-veth1")->ifindex, TRUE);
+
+	config = nm_ip6_config_new (nm_platform_get_multi_idx (platform), ifindex);
+	for (i = 0; i < 5; i++) {
+		r = _ip6_config_commit_route (ifindex, i);
+		nm_ip6_config_add_route (config, &r);
+	}
+
+	g_assert (nm_ip6_config_commit (config, platform, &state));
+	g_assert (_nm_ip_config_commit_state_check (&state, platform, ifindex, NULL, &sync_addresses));
+
+	/* a change of somebody else forces a full sync, which removes
+	 * the foreign route. */
+	r = _ip6_config_commit_route (ifindex, 20);
+	nmtstp_ip6_route_add (platform, ifindex, NM_IP_CONFIG_SOURCE_USER,
+	                      r.network, r.plen, in6addr_any, in6addr_any, r.metric, 0);
+	g_assert (!_nm_ip_config_commit_state_check (&state, platform, ifindex, NULL, &sync_addresses));
+	g_assert (nm_ip6_config_commit (config, platform, &state));
+	g_assert (_nm_ip_config_commit_state_check (&state, platform, ifindex, NULL, &sync_addresses));
+
+	plat_routes = nmtstp_ip6_route_get_all (platform, ifindex);
+	g_assert_cmpint (plat_routes->len, ==, 5);
+	g_clear_pointer (&plat_routes, g_ptr_array_unref);
+
+	/* dropping a route is pushed as a delta. */
+	_nmtst_ip6_config_del_route (config, 0);
+	g_assert (nm_ip6_config_commit (config, platform, &state));
+	g_assert (_nm_ip_config_commit_state_check (&state, platform, ifindex, NULL, &sync_addresses));
+	plat_routes = nmtstp_ip6_route_get_all (platform, ifindex);
+	g_assert_cmpint (plat_routes->len, ==, 4);
+
+	nmtstp_link_del (platform, -1, ifindex, "nm-test-veth0");
+}
+
+static void
+test_ip_config_commit_state_diff_routes (void)
+{
+	nm_auto (nm_ip_config_commit_state_clear) NMIPConfigCommitState state = { 0 };
+	gs_unref_ptrarray GPtrArray *routes = NULL;
+	gs_unref_ptrarray GPtrArray *routes_del = NULL;
+	gs_unref_ptrarray GPtrArray *routes_add = NULL;
+	nm_auto_nmpobj NMPObject *r_changed = NULL;
+	nm_auto_nmpobj NMPObject *r_dup = NULL;
+	guint i;
+
+	state.routes = g_hash_table_new_full ((GHashFunc) nmp_object_id_hash,
+	                                      (GEqualFunc) nmp_object_id_equal,
+	                                      (GDestroyNotify) nmp_object_unref,
+	                                      NULL);
+
+	routes = g_ptr_array_new_with_free_func ((GDestroyNotify) nmp_object_unref);
+	for (i = 0; i < 5; i++)
+		g_ptr_array_add (routes, _ip4_route_sync_delta_new (1, i));
+
+	_nm_ip_config_commit_state_diff_routes (&state, NULL, routes, &routes_del, &routes_add);
+	g_assert (!routes_del);
+	g_assert (routes_add && routes_add->len == 5);
+	g_clear_pointer (&routes_add, g_ptr_array_unref);
+
+	/* nothing changed. */
+	_nm_ip_config_commit_state_diff_routes (&state, NULL, routes, &routes_del, &routes_add);
+	g_assert (!routes_del);
+	g_assert (!routes_add);
+
+	/* a duplicate of the first route is ignored, even if it differs. The
+	 * second route changes with the same ID, the last one is removed. */
+	r_dup = nmp_object_clone (routes->pdata[0], FALSE);
+	NMP_OBJECT_CAST_IP4_ROUTE (r_dup)->mtu = 1400;
+	g_ptr_array_add (routes, (gpointer) nmp_object_ref (r_dup));
+	r_changed = nmp_object_clone (routes->pdata[1], FALSE);
+	NMP_OBJECT_CAST_IP4_ROUTE (r_changed)->mtu = 1400;
+	nmp_object_unref (routes->pdata[1]);
+	routes->pdata[1] = (gpointer) nmp_object_ref (r_changed);
+	g_ptr_array_remove_index (routes, 4);
+
+	_nm_ip_config_commit_state_diff_routes (&state, NULL, routes, &routes_del, &routes_add);
+	g_assert (routes_del && routes_del->len == 2);
+	g_assert (routes_add && routes_add->len == 1);
+	g_assert (routes_add->pdata[0] == r_changed);
+	g_assert (nmp_object_id_equal (routes_del->pdata[0], r_changed) || nmp_object_id_equal (routes_del->pdata[1], r_changed));
+	g_assert_cmpint (g_hash_table_size (state.routes), ==, 4);
+}
+
+/*****************************************************************************/
+
 NMTstpSetupFunc const _nmtstp_setup_platform_func = SETUP;
 
 void
@@ -769,14 +1335,23 @@ _nmtstp_setup_tests (void)
 	add_test_func ("/route/ip4", test_ip4_route);
 	add_test_func ("/route/ip6", test_ip6_route);
 	add_test_func ("/route/ip4_metric0", test_ip4_route_metric0);
+	add_test_func ("/route/ip4_changes_batch", test_ip4_route_changes_batch);
+	add_test_func ("/route/ip4_changes_batch_order", test_ip4_route_changes_batch_order);
 	add_test_func ("/route/ip4_options", test_ip4_route_options);
 	add_test_func_data ("/route/ip6_options/1", test_ip6_route_options, GINT_TO_POINTER (1));
 	add_test_func_data ("/route/ip6_options/2", test_ip6_route_options, GINT_TO_POINTER (2));
 	add_test_func_data ("/route/ip6_options/3", test_ip6_route_options, GINT_TO_POINTER (3));
+	add_test_func ("/route/ip_config_commit_state_diff_routes", test_ip_config_commit_state_diff_routes);
+	add_test_func_data ("/route/ip4_sync_many/100", test_ip4_route_sync_many, GUINT_TO_POINTER (100));
+	add_test_func_data ("/route/ip4_sync_many/5000", test_ip4_route_sync_many, GUINT_TO_POINTER (5000));
+	add_test_func_data ("/route/ip4_sync_many/20000", test_ip4_route_sync_many, GUINT_TO_POINTER (20000));
 
 	if (nmtstp_is_root_test ()) {
 		add_test_func_data ("/route/ip/1", test_ip, GINT_TO_POINTER (1));
 		add_test_func ("/route/ip_route_get", test_ip_route_get);
 		add_test_func ("/route/ip4_zero_gateway", test_ip4_zero_gateway);
+		add_test_func ("/route/ip4_sync_delta", test_ip4_route_sync_delta);
+		add_test_func ("/route/ip4_config_commit_delta", test_ip4_config_commit_delta);
+		add_test_func ("/route/ip6_config_commit_delta", test_ip6_config_commit_delta);
 	}
 }
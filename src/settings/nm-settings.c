@@ -323,7 +323,12 @@ nm_settings_get_connection_by_uuid (NMSettings *self, const char *uuid)
 
 	g_hash_table_iter_init (&iter, priv->connections);
 	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &candidate)) {
-		if (g_strcmp0 (uuid, nm_settings_connection_get_uuid (candidate)) == 0)
+		const char *candidate_uuid = nm_settings_connection_get_uuid (candidate);
+
+		/* the UUID of a connection is interned and shared with its copies,
+		 * so usually the caller passes the very same string. */
+		if (   uuid == candidate_uuid
+		    || nm_streq0 (uuid, candidate_uuid))
 			return candidate;
 	}
 
@@ -0,0 +1,316 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Compare interning, lookup and removal of objects in NMDedupMultiIndex
+ * with a GHashTable that uses the same hash and equal functions, as
+ * NMDedupMultiIndex did before it got its own hash table. */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+
+#include "nm-utils/nm-dedup-multi.h"
+#include "nm-core-utils.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+/*****************************************************************************/
+
+typedef struct {
+	NMDedupMultiObj parent;
+	guint32 val;
+	guint32 other;
+} BenchObj;
+
+static const NMDedupMultiObjClass bench_obj_class;
+
+static const NMDedupMultiObj *
+_bench_obj_clone (const NMDedupMultiObj *obj)
+{
+	const BenchObj *o = (const BenchObj *) obj;
+	BenchObj *o2;
+
+	o2 = g_slice_new0 (BenchObj);
+	o2->parent.klass = &bench_obj_class;
+	o2->parent._ref_count = 1;
+	o2->val = o->val;
+	o2->other = o->other;
+	return (NMDedupMultiObj *) o2;
+}
+
+static void
+_bench_obj_destroy (NMDedupMultiObj *obj)
+{
+	g_slice_free (BenchObj, (BenchObj *) obj);
+}
+
+static guint
+_bench_obj_full_hash (const NMDedupMultiObj *obj)
+{
+	const BenchObj *o = (const BenchObj *) obj;
+	guint h = 1527413723;
+
+	h = NM_HASH_COMBINE (h, o->val);
+	h = NM_HASH_COMBINE (h, o->other);
+	return h;
+}
+
+static gboolean
+_bench_obj_full_equal (const NMDedupMultiObj *obj_a,
+                       const NMDedupMultiObj *obj_b)
+{
+	const BenchObj *o_a = (const BenchObj *) obj_a;
+	const BenchObj *o_b = (const BenchObj *) obj_b;
+
+	return    o_a->val == o_b->val
+	       && o_a->other == o_b->other;
+}
+
+static const NMDedupMultiObjClass bench_obj_class = {
+	.obj_clone = _bench_obj_clone,
+	.obj_destroy = _bench_obj_destroy,
+	.obj_full_hash = _bench_obj_full_hash,
+	.obj_full_equal = _bench_obj_full_equal,
+};
+
+#define BENCH_OBJ_INIT(val_val) \
+	((BenchObj) { \
+		.parent = { \
+			.klass = &bench_obj_class, \
+			._ref_count = NM_OBJ_REF_COUNT_STACKINIT, \
+		}, \
+		.val = (val_val), \
+		.other = (val_val) ^ 0x5bd1e995u, \
+	})
+
+/* the hash and equal functions that NMDedupMultiIndex passed to
+ * GHashTable for its objects. */
+static guint
+_ghash_obj_hash (gconstpointer obj)
+{
+	return ((const NMDedupMultiObj *) obj)->klass->obj_full_hash (obj);
+}
+
+static gboolean
+_ghash_obj_equal (gconstpointer obj_a, gconstpointer obj_b)
+{
+	const NMDedupMultiObj *a = obj_a;
+	const NMDedupMultiObj *b = obj_b;
+
+	return    a == b
+	       || (   a->klass == b->klass
+	           && a->klass->obj_full_equal (a, b));
+}
+
+/*****************************************************************************/
+
+static struct {
+	int n_rounds;
+} global_opt = {
+	.n_rounds = 3,
+};
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "rounds", 'r', 0, G_OPTION_ARG_INT, &global_opt.n_rounds, "How often to repeat each measurement (default 3)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark the hash table of NMDedupMultiIndex against GHashTable.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	gint64 intern;
+	gint64 lookup;
+	gint64 remove;
+} BenchResult;
+
+static void
+_bench_result_min (BenchResult *best, const BenchResult *r)
+{
+	if (!best->intern || r->intern < best->intern)
+		best->intern = r->intern;
+	if (!best->lookup || r->lookup < best->lookup)
+		best->lookup = r->lookup;
+	if (!best->remove || r->remove < best->remove)
+		best->remove = r->remove;
+}
+
+static void
+_bench_dedup_multi (BenchObj *const*objs, const guint32 *order, guint n, BenchResult *result)
+{
+	NMDedupMultiIndex *multi_idx;
+	gint64 ts;
+	guint i;
+
+	multi_idx = nm_dedup_multi_index_new ();
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n; i++) {
+		if (nm_dedup_multi_index_obj_intern (multi_idx, objs[i]) != objs[i])
+			g_assert_not_reached ();
+	}
+	result->intern = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n; i++) {
+		BenchObj key = BENCH_OBJ_INIT (order[i]);
+
+		if (nm_dedup_multi_index_obj_find (multi_idx, &key) != objs[order[i]])
+			g_assert_not_reached ();
+	}
+	result->lookup = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n; i++)
+		nm_dedup_multi_index_obj_release (multi_idx, objs[order[i]]);
+	result->remove = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	for (i = 0; i < n; i++)
+		nm_dedup_multi_obj_unref ((const NMDedupMultiObj *) objs[i]);
+
+	nm_dedup_multi_index_unref (multi_idx);
+}
+
+static void
+_bench_ghash (BenchObj *const*objs, const guint32 *order, guint n, BenchResult *result)
+{
+	GHashTable *hash;
+	gint64 ts;
+	guint i;
+
+	hash = g_hash_table_new (_ghash_obj_hash, _ghash_obj_equal);
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n; i++) {
+		if (!nm_g_hash_table_add (hash, objs[i]))
+			g_assert_not_reached ();
+	}
+	result->intern = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n; i++) {
+		BenchObj key = BENCH_OBJ_INIT (order[i]);
+
+		if (g_hash_table_lookup (hash, &key) != objs[order[i]])
+			g_assert_not_reached ();
+	}
+	result->lookup = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	for (i = 0; i < n; i++) {
+		if (!g_hash_table_remove (hash, objs[order[i]]))
+			g_assert_not_reached ();
+	}
+	result->remove = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	g_hash_table_unref (hash);
+}
+
+static void
+_print_result (const char *name, guint n, const BenchResult *r)
+{
+	g_print ("%-10s %8u: intern %7.1f ns, lookup %7.1f ns, remove %7.1f ns\n",
+	         name,
+	         n,
+	         (double) r->intern / n,
+	         (double) r->lookup / n,
+	         (double) r->remove / n);
+}
+
+int
+main (int argc, char **argv)
+{
+	static const guint sizes[] = { 1000, 100000, 1000000 };
+	guint i_size;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	for (i_size = 0; i_size < G_N_ELEMENTS (sizes); i_size++) {
+		const guint n = sizes[i_size];
+		BenchObj **objs;
+		guint32 *order;
+		BenchResult best_dedup = { 0 };
+		BenchResult best_ghash = { 0 };
+		guint i;
+		int round;
+
+		objs = g_new (BenchObj *, n);
+		order = g_new (guint32, n);
+		for (i = 0; i < n; i++) {
+			BenchObj key = BENCH_OBJ_INIT (i);
+
+			objs[i] = (BenchObj *) _bench_obj_clone ((NMDedupMultiObj *) &key);
+			order[i] = i;
+		}
+
+		/* look up and remove in random order, to not favor the access
+		 * pattern of either table. */
+		for (i = n - 1; i > 0; i--) {
+			guint j = nmtst_get_rand_int () % (i + 1);
+			guint32 tmp = order[i];
+
+			order[i] = order[j];
+			order[j] = tmp;
+		}
+
+		for (round = 0; round < MAX (global_opt.n_rounds, 1); round++) {
+			BenchResult r;
+
+			_bench_dedup_multi (objs, order, n, &r);
+			_bench_result_min (&best_dedup, &r);
+
+			_bench_ghash (objs, order, n, &r);
+			_bench_result_min (&best_ghash, &r);
+		}
+
+		_print_result ("dedup", n, &best_dedup);
+		_print_result ("ghash", n, &best_ghash);
+
+		for (i = 0; i < n; i++)
+			nm_dedup_multi_obj_unref ((const NMDedupMultiObj *) objs[i]);
+		g_free (objs);
+		g_free (order);
+	}
+
+	return EXIT_SUCCESS;
+}
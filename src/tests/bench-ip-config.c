@@ -0,0 +1,213 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright 2017 Red Hat, Inc.
+ */
+
+/* Measure nm_ip4_config_merge(), nm_ip4_config_subtract() and their IPv6
+ * counterparts for configurations with many nameservers, domains and
+ * search domains. The two configurations overlap by half of their
+ * entries. */
+
+#include "nm-default.h"
+
+#include <stdlib.h>
+#include <arpa/inet.h>
+
+#include "nm-ip4-config.h"
+#include "nm-ip6-config.h"
+#include "nm-core-utils.h"
+
+#include "nm-test-utils-core.h"
+
+NMTST_DEFINE ();
+
+/*****************************************************************************/
+
+static struct {
+	int n_rounds;
+} global_opt = {
+	.n_rounds = 3,
+};
+
+static gboolean
+read_argv (int *argc, char ***argv)
+{
+	GOptionContext *context;
+	GOptionEntry options[] = {
+		{ "rounds", 'r', 0, G_OPTION_ARG_INT, &global_opt.n_rounds, "How often to repeat each measurement (default 3)", "N" },
+		{ 0 },
+	};
+	gs_free_error GError *error = NULL;
+
+	context = g_option_context_new (NULL);
+	g_option_context_set_summary (context, "Benchmark merging and subtracting the DNS settings of IP configurations.");
+	g_option_context_add_main_entries (context, options, NULL);
+
+	if (!g_option_context_parse (context, argc, argv, &error)) {
+		g_warning ("Error parsing command line arguments: %s", error->message);
+		g_option_context_free (context);
+		return FALSE;
+	}
+
+	g_option_context_free (context);
+	return TRUE;
+}
+
+/*****************************************************************************/
+
+typedef struct {
+	gint64 merge;
+	gint64 subtract;
+} BenchResult;
+
+static void
+_bench_result_min (BenchResult *best, const BenchResult *r)
+{
+	if (!best->merge || r->merge < best->merge)
+		best->merge = r->merge;
+	if (!best->subtract || r->subtract < best->subtract)
+		best->subtract = r->subtract;
+}
+
+static void
+_fill_ip4 (NMIP4Config *config, guint start, guint n)
+{
+	char buf[64];
+	guint i;
+
+	for (i = start; i < start + n; i++) {
+		nm_ip4_config_add_nameserver (config, htonl (0x0a000000u + i));
+		nm_sprintf_buf (buf, "domain%u.example", i);
+		nm_ip4_config_add_domain (config, buf);
+		nm_sprintf_buf (buf, "search%u.example", i);
+		nm_ip4_config_add_search (config, buf);
+	}
+}
+
+static void
+_fill_ip6 (NMIP6Config *config, guint start, guint n)
+{
+	char buf[64];
+	guint i;
+
+	for (i = start; i < start + n; i++) {
+		struct in6_addr addr = IN6ADDR_ANY_INIT;
+
+		addr.s6_addr32[0] = htonl (0x20010db8u);
+		addr.s6_addr32[3] = htonl (i);
+		nm_ip6_config_add_nameserver (config, &addr);
+		nm_sprintf_buf (buf, "domain%u.example", i);
+		nm_ip6_config_add_domain (config, buf);
+		nm_sprintf_buf (buf, "search%u.example", i);
+		nm_ip6_config_add_search (config, buf);
+	}
+}
+
+static void
+_bench_ip4 (guint n, BenchResult *result)
+{
+	gs_unref_object NMIP4Config *dst = NULL;
+	gs_unref_object NMIP4Config *src = NULL;
+	gint64 ts;
+
+	dst = nmtst_ip4_config_new (1);
+	src = nmtst_ip4_config_new (1);
+	_fill_ip4 (dst, 0, n);
+	_fill_ip4 (src, n / 2, n);
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	nm_ip4_config_merge (dst, src, NM_IP_CONFIG_MERGE_DEFAULT);
+	result->merge = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	g_assert_cmpuint (nm_ip4_config_get_num_nameservers (dst), ==, n + n / 2);
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	nm_ip4_config_subtract (dst, src);
+	result->subtract = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	g_assert_cmpuint (nm_ip4_config_get_num_nameservers (dst), ==, n / 2);
+}
+
+static void
+_bench_ip6 (guint n, BenchResult *result)
+{
+	gs_unref_object NMIP6Config *dst = NULL;
+	gs_unref_object NMIP6Config *src = NULL;
+	gint64 ts;
+
+	dst = nmtst_ip6_config_new (1);
+	src = nmtst_ip6_config_new (1);
+	_fill_ip6 (dst, 0, n);
+	_fill_ip6 (src, n / 2, n);
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	nm_ip6_config_merge (dst, src, NM_IP_CONFIG_MERGE_DEFAULT);
+	result->merge = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	g_assert_cmpuint (nm_ip6_config_get_num_nameservers (dst), ==, n + n / 2);
+
+	ts = nm_utils_get_monotonic_timestamp_ns ();
+	nm_ip6_config_subtract (dst, src);
+	result->subtract = nm_utils_get_monotonic_timestamp_ns () - ts;
+
+	g_assert_cmpuint (nm_ip6_config_get_num_nameservers (dst), ==, n / 2);
+}
+
+static void
+_print_result (const char *name, guint n, const BenchResult *r)
+{
+	g_print ("%-4s %8u: merge %7.1f ns, subtract %7.1f ns (per entry)\n",
+	         name,
+	         n,
+	         (double) r->merge / n,
+	         (double) r->subtract / n);
+}
+
+int
+main (int argc, char **argv)
+{
+	static const guint sizes[] = { 10, 1000, 100000 };
+	guint i_size;
+
+	nmtst_init_with_logging (&argc, &argv, "WARN", "DEFAULT");
+
+	if (!read_argv (&argc, &argv))
+		return 2;
+
+	for (i_size = 0; i_size < G_N_ELEMENTS (sizes); i_size++) {
+		const guint n = sizes[i_size];
+		BenchResult best_ip4 = { 0 };
+		BenchResult best_ip6 = { 0 };
+		int round;
+
+		for (round = 0; round < MAX (global_opt.n_rounds, 1); round++) {
+			BenchResult r;
+
+			_bench_ip4 (n, &r);
+			_bench_result_min (&best_ip4, &r);
+
+			_bench_ip6 (n, &r);
+			_bench_result_min (&best_ip6, &r);
+		}
+
+		_print_result ("ip4", n, &best_ip4);
+		_print_result ("ip6", n, &best_ip6);
+	}
+
+	return EXIT_SUCCESS;
+}
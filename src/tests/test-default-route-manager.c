@@ -0,0 +1,234 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2017 Red Hat, Inc.
+ *
+ */
+
+#include "nm-default.h"
+
+#include <sys/socket.h>
+
+#include "nm-default-route-manager.h"
+#include "platform/nm-fake-platform.h"
+
+#include "nm-test-utils-core.h"
+
+/*****************************************************************************/
+
+typedef struct {
+	GObject *source;
+	guint32 metric;
+	bool never_default;
+	bool synced;
+} TestEntry;
+
+static int
+_test_entry_cmp (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const TestEntry *e_a = a;
+	const TestEntry *e_b = b;
+
+	/* the same order as _sort_entries_cmp() */
+	NM_CMP_FIELD (e_a, e_b, metric);
+	NM_CMP_FIELD_BOOL (e_a, e_b, never_default);
+	NM_CMP_FIELD_BOOL (e_a, e_b, synced);
+	return 0;
+}
+
+static void
+_assert_entries (NMDefaultRouteManager *self, GArray *expected)
+{
+	guint i;
+
+	g_assert_cmpint (_nmtst_default_route_manager_get_num_entries (self, AF_INET), ==, expected->len);
+	for (i = 0; i < expected->len; i++) {
+		const TestEntry *e = &g_array_index (expected, TestEntry, i);
+
+		g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, i) == e->source);
+		g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, e->source), ==, i);
+	}
+}
+
+static guint
+_expected_find (GArray *expected, GObject *source)
+{
+	guint i;
+
+	for (i = 0; i < expected->len; i++) {
+		if (g_array_index (expected, TestEntry, i).source == source)
+			return i;
+	}
+	return G_MAXUINT;
+}
+
+/*****************************************************************************/
+
+static void
+test_entries_bsearch (void)
+{
+	gs_unref_object NMDefaultRouteManager *self = nm_default_route_manager_new (FALSE, NM_PLATFORM_GET);
+	GObject *sources[6];
+	const guint32 metrics[G_N_ELEMENTS (sources)] = { 20, 30, 20, 10, 20, 20 };
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++) {
+		sources[i] = g_object_new (G_TYPE_OBJECT, NULL);
+		_nmtst_default_route_manager_entry_set (self, AF_INET, sources[i], metrics[i], i == 5, TRUE);
+	}
+
+	/* 10, 20, 20, 20, 20 (never-default), 30 */
+	g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, 0) == sources[3]);
+	g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, 1) == sources[0]);
+	g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, 2) == sources[2]);
+	g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, 3) == sources[4]);
+	g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, 4) == sources[5]);
+	g_assert (_nmtst_default_route_manager_entry_get_source (self, AF_INET, 5) == sources[1]);
+
+	/* the range of the equal entries. */
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 20, FALSE, TRUE, FALSE), ==, 1);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 20, FALSE, TRUE, TRUE), ==, 4);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 20, TRUE, TRUE, FALSE), ==, 4);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 20, TRUE, TRUE, TRUE), ==, 5);
+
+	/* assumed entries sort before synced ones. */
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 20, FALSE, FALSE, FALSE), ==, 1);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 20, FALSE, FALSE, TRUE), ==, 1);
+
+	/* keys without equal entries. */
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 5, FALSE, TRUE, FALSE), ==, 0);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 5, FALSE, TRUE, TRUE), ==, 0);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 25, FALSE, TRUE, FALSE), ==, 5);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 25, FALSE, TRUE, TRUE), ==, 5);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET, 40, FALSE, TRUE, FALSE), ==, 6);
+
+	/* the other family is independent. */
+	g_assert_cmpint (_nmtst_default_route_manager_get_num_entries (self, AF_INET6), ==, 0);
+	g_assert_cmpint (_nmtst_default_route_manager_entries_bsearch (self, AF_INET6, 20, FALSE, TRUE, FALSE), ==, 0);
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		g_object_unref (sources[i]);
+}
+
+/*****************************************************************************/
+
+static void
+test_entries_reposition (void)
+{
+	gs_unref_object NMDefaultRouteManager *self = nm_default_route_manager_new (FALSE, NM_PLATFORM_GET);
+	gs_unref_array GArray *expected = g_array_new (FALSE, FALSE, sizeof (TestEntry));
+	GObject *sources[30];
+	guint i, j;
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		sources[i] = g_object_new (G_TYPE_OBJECT, NULL);
+
+	/* add, update and remove entries with few distinct keys, so that there
+	 * are many equal entries. After each step, the entries must be ordered
+	 * like a stable sort orders them. */
+	for (i = 0; i < 2000; i++) {
+		GObject *source = sources[nmtst_get_rand_int () % G_N_ELEMENTS (sources)];
+		TestEntry e = {
+			.source = source,
+			.metric = (nmtst_get_rand_int () % 4) * 10,
+			.never_default = (nmtst_get_rand_int () % 4) == 0,
+			.synced = (nmtst_get_rand_int () % 2) == 0,
+		};
+		guint idx;
+
+		j = _expected_find (expected, source);
+
+		if (   j != G_MAXUINT
+		    && (nmtst_get_rand_int () % 4) == 0) {
+			_nmtst_default_route_manager_entry_remove (self, AF_INET, source);
+			g_array_remove_index (expected, j);
+			g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, source), ==, G_MAXUINT);
+		} else {
+			if (j == G_MAXUINT)
+				g_array_append_val (expected, e);
+			else
+				g_array_index (expected, TestEntry, j) = e;
+			g_array_sort_with_data (expected, _test_entry_cmp, NULL);
+
+			idx = _nmtst_default_route_manager_entry_set (self, AF_INET, source, e.metric, e.never_default, e.synced);
+			g_assert_cmpint (idx, ==, _expected_find (expected, source));
+		}
+
+		_assert_entries (self, expected);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		g_object_unref (sources[i]);
+}
+
+/*****************************************************************************/
+
+static void
+test_entries_by_source (void)
+{
+	gs_unref_object NMDefaultRouteManager *self = nm_default_route_manager_new (FALSE, NM_PLATFORM_GET);
+	GObject *sources[50];
+	guint i;
+
+	/* all entries compare equal, so the lookup cannot rely on their order. */
+	for (i = 0; i < G_N_ELEMENTS (sources); i++) {
+		sources[i] = g_object_new (G_TYPE_OBJECT, NULL);
+		g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[i]), ==, G_MAXUINT);
+		g_assert_cmpint (_nmtst_default_route_manager_entry_set (self, AF_INET, sources[i], 100, FALSE, TRUE), ==, i);
+	}
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[i]), ==, i);
+
+	/* removing an entry moves the ones after it. */
+	_nmtst_default_route_manager_entry_remove (self, AF_INET, sources[0]);
+	g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[0]), ==, G_MAXUINT);
+	for (i = 1; i < G_N_ELEMENTS (sources); i++)
+		g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[i]), ==, i - 1);
+
+	/* a better metric moves the last entry to the front. */
+	g_assert_cmpint (_nmtst_default_route_manager_entry_set (self, AF_INET, sources[G_N_ELEMENTS (sources) - 1], 50, FALSE, TRUE), ==, 0);
+	g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[G_N_ELEMENTS (sources) - 1]), ==, 0);
+	for (i = 1; i < G_N_ELEMENTS (sources) - 1; i++)
+		g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[i]), ==, i);
+
+	/* the same source can have an entry per family. */
+	g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET6, sources[1]), ==, G_MAXUINT);
+	g_assert_cmpint (_nmtst_default_route_manager_entry_set (self, AF_INET6, sources[1], 100, FALSE, TRUE), ==, 0);
+	g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET6, sources[1]), ==, 0);
+	g_assert_cmpint (_nmtst_default_route_manager_entry_find_by_source (self, AF_INET, sources[1]), ==, 1);
+
+	for (i = 0; i < G_N_ELEMENTS (sources); i++)
+		g_object_unref (sources[i]);
+}
+
+/*****************************************************************************/
+
+NMTST_DEFINE ();
+
+int
+main (int argc, char **argv)
+{
+	nmtst_init_with_logging (&argc, &argv, NULL, "ALL");
+
+	nm_fake_platform_setup ();
+
+	g_test_add_func ("/default-route-manager/entries-bsearch", test_entries_bsearch);
+	g_test_add_func ("/default-route-manager/entries-reposition", test_entries_reposition);
+	g_test_add_func ("/default-route-manager/entries-by-source", test_entries_by_source);
+
+	return g_test_run ();
+}
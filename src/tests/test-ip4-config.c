@@ -322,6 +322,110 @@ test_strip_search_trailing_dot (void)
 	g_object_unref (config);
 }
 
+static void
+test_merge_subtract_dns_many (void)
+{
+	NMIP4Config *cfg1, *cfg2;
+	char buf[64];
+	guint i;
+
+	/* enough entries to exercise the indexed lookups. */
+	cfg1 = nmtst_ip4_config_new (1);
+	cfg2 = nmtst_ip4_config_new (1);
+
+	for (i = 0; i < 40; i++) {
+		nm_ip4_config_add_nameserver (cfg1, htonl (0x0a000000 + i));
+		nm_sprintf_buf (buf, "domain%u.example", i);
+		nm_ip4_config_add_domain (cfg1, buf);
+	}
+	for (i = 20; i < 60; i++) {
+		nm_ip4_config_add_nameserver (cfg2, htonl (0x0a000000 + i));
+		nm_sprintf_buf (buf, "domain%u.example", i);
+		nm_ip4_config_add_domain (cfg2, buf);
+	}
+
+	/* duplicates are ignored. */
+	nm_ip4_config_add_nameserver (cfg1, htonl (0x0a000000 + 5));
+	nm_ip4_config_add_domain (cfg1, "domain5.example");
+	g_assert_cmpuint (nm_ip4_config_get_num_nameservers (cfg1), ==, 40);
+	g_assert_cmpuint (nm_ip4_config_get_num_domains (cfg1), ==, 40);
+
+	nm_ip4_config_merge (cfg1, cfg2, NM_IP_CONFIG_MERGE_DEFAULT);
+	g_assert_cmpuint (nm_ip4_config_get_num_nameservers (cfg1), ==, 60);
+	g_assert_cmpuint (nm_ip4_config_get_num_domains (cfg1), ==, 60);
+	for (i = 0; i < 60; i++) {
+		g_assert_cmpuint (nm_ip4_config_get_nameserver (cfg1, i), ==, htonl (0x0a000000 + i));
+		nm_sprintf_buf (buf, "domain%u.example", i);
+		g_assert_cmpstr (nm_ip4_config_get_domain (cfg1, i), ==, buf);
+	}
+
+	nm_ip4_config_del_nameserver (cfg1, 0);
+	nm_ip4_config_del_domain (cfg1, 0);
+	nm_ip4_config_add_nameserver (cfg1, htonl (0x0a000000));
+	nm_ip4_config_add_domain (cfg1, "domain0.example");
+	g_assert_cmpuint (nm_ip4_config_get_num_nameservers (cfg1), ==, 60);
+	g_assert_cmpuint (nm_ip4_config_get_nameserver (cfg1, 59), ==, htonl (0x0a000000));
+	g_assert_cmpstr (nm_ip4_config_get_domain (cfg1, 59), ==, "domain0.example");
+
+	nm_ip4_config_subtract (cfg1, cfg2);
+	g_assert_cmpuint (nm_ip4_config_get_num_nameservers (cfg1), ==, 20);
+	g_assert_cmpuint (nm_ip4_config_get_num_domains (cfg1), ==, 20);
+	for (i = 0; i < 19; i++) {
+		g_assert_cmpuint (nm_ip4_config_get_nameserver (cfg1, i), ==, htonl (0x0a000000 + i + 1));
+		nm_sprintf_buf (buf, "domain%u.example", i + 1);
+		g_assert_cmpstr (nm_ip4_config_get_domain (cfg1, i), ==, buf);
+	}
+	g_assert_cmpuint (nm_ip4_config_get_nameserver (cfg1, 19), ==, htonl (0x0a000000));
+	g_assert_cmpstr (nm_ip4_config_get_domain (cfg1, 19), ==, "domain0.example");
+
+	g_object_unref (cfg1);
+	g_object_unref (cfg2);
+}
+
+static void
+test_cached_variants (void)
+{
+	NMIP4Config *config;
+	GVariant *v1, *v2;
+	gs_unref_variant GVariant *addr = NULL;
+	guint32 u;
+
+	config = build_test_config ();
+
+	/* unchanged properties return the same variant. */
+	g_object_get (config, NM_IP4_CONFIG_NAMESERVERS, &v1, NULL);
+	g_object_get (config, NM_IP4_CONFIG_NAMESERVERS, &v2, NULL);
+	g_assert (v1 == v2);
+	g_assert_cmpuint (g_variant_n_children (v1), ==, 2);
+	g_variant_unref (v1);
+	g_variant_unref (v2);
+
+	nm_ip4_config_add_nameserver (config, nmtst_inet4_from_string ("4.2.2.3"));
+	g_object_get (config, NM_IP4_CONFIG_NAMESERVERS, &v1, NULL);
+	g_assert_cmpuint (g_variant_n_children (v1), ==, 3);
+	g_variant_unref (v1);
+
+	g_object_get (config, NM_IP4_CONFIG_WINS_SERVERS, &v1, NULL);
+	nm_ip4_config_del_wins (config, 0);
+	g_object_get (config, NM_IP4_CONFIG_WINS_SERVERS, &v2, NULL);
+	g_assert_cmpuint (g_variant_n_children (v1), ==, 2);
+	g_assert_cmpuint (g_variant_n_children (v2), ==, 1);
+	g_variant_unref (v1);
+	g_variant_unref (v2);
+
+	/* the legacy addresses contain the gateway and follow its changes. */
+	g_object_get (config, NM_IP4_CONFIG_ADDRESSES, &v1, NULL);
+	g_variant_unref (v1);
+	nm_ip4_config_set_gateway (config, nmtst_inet4_from_string ("192.168.1.2"));
+	g_object_get (config, NM_IP4_CONFIG_ADDRESSES, &v1, NULL);
+	addr = g_variant_get_child_value (v1, 0);
+	g_variant_get_child (addr, 2, "u", &u);
+	g_assert_cmpuint (u, ==, nmtst_inet4_from_string ("192.168.1.2"));
+	g_variant_unref (v1);
+
+	g_object_unref (config);
+}
+
 /*****************************************************************************/
 
 NMTST_DEFINE ();
@@ -337,6 +441,8 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip4-config/add-route-with-source", test_add_route_with_source);
 	g_test_add_func ("/ip4-config/merge-subtract-mss-mtu", test_merge_subtract_mss_mtu);
 	g_test_add_func ("/ip4-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
+	g_test_add_func ("/ip4-config/merge-subtract-dns-many", test_merge_subtract_dns_many);
+	g_test_add_func ("/ip4-config/cached-variants", test_cached_variants);
 
 	return g_test_run ();
 }
@@ -343,6 +343,38 @@ test_strip_search_trailing_dot (void)
 	g_object_unref (config);
 }
 
+static void
+test_seal_unshare (void)
+{
+	NMIP6Config *sealed, *config, *shared;
+
+	sealed = build_test_config ();
+	g_assert (!nm_ip6_config_is_sealed (sealed));
+	nm_ip6_config_seal (sealed);
+	g_assert (nm_ip6_config_is_sealed (sealed));
+
+	/* sharing a sealed config is just a reference. */
+	shared = g_object_ref (sealed);
+
+	/* unsharing a sealed config drops the reference and returns a clone. */
+	config = nm_ip6_config_unshare (&shared);
+	g_assert (config == shared);
+	g_assert (config != sealed);
+	g_assert (!nm_ip6_config_is_sealed (config));
+	g_assert (nm_ip6_config_equal (config, sealed));
+
+	/* an unsealed config is already writable. */
+	g_assert (nm_ip6_config_unshare (&shared) == config);
+
+	nm_ip6_config_del_nameserver (config, 0);
+	g_assert_cmpuint (nm_ip6_config_get_num_nameservers (config), ==, 1);
+	g_assert_cmpuint (nm_ip6_config_get_num_nameservers (sealed), ==, 2);
+	g_assert (!nm_ip6_config_equal (config, sealed));
+
+	g_object_unref (config);
+	g_object_unref (sealed);
+}
+
 /*****************************************************************************/
 
 NMTST_DEFINE();
@@ -358,6 +390,7 @@ main (int argc, char **argv)
 	g_test_add_func ("/ip6-config/add-route-with-source", test_add_route_with_source);
 	g_test_add_func ("/ip6-config/test_nm_ip6_config_addresses_sort", test_nm_ip6_config_addresses_sort);
 	g_test_add_func ("/ip6-config/strip-search-trailing-dot", test_strip_search_trailing_dot);
+	g_test_add_func ("/ip6-config/seal-unshare", test_seal_unshare);
 
 	return g_test_run ();
 }
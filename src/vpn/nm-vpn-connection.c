@@ -1151,14 +1151,16 @@ nm_vpn_connection_apply_config (NMVpnConnection *self)
 			nm_assert (priv->ip_ifindex == nm_ip4_config_get_ifindex (priv->ip4_config));
 			if (!nm_ip4_config_commit (priv->ip4_config,
 			                           nm_netns_get_platform (priv->netns),
-			                           nm_vpn_connection_get_ip4_route_metric (self)))
+			                           nm_vpn_connection_get_ip4_route_metric (self),
+			                           NULL))
 				return FALSE;
 		}
 
 		if (priv->ip6_config) {
 			nm_assert (priv->ip_ifindex == nm_ip6_config_get_ifindex (priv->ip6_config));
 			if (!nm_ip6_config_commit (priv->ip6_config,
-			                           nm_netns_get_platform (priv->netns)))
+			                           nm_netns_get_platform (priv->netns),
+			                           NULL))
 				return FALSE;
 		}
 